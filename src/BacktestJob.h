@@ -0,0 +1,38 @@
+#include <string>
+#include <vector>
+#include <memory>
+#include <ctime>
+#include "BacktestProject.h"
+#include "BacktestProjectTemplate.h"
+#include "TimeAlignedReader.h"
+
+#pragma once
+
+class BacktestJob {
+public:
+    // Traded portfolio, prepared together with timestamp alignment
+    std::vector<std::string> symbols;
+    // Cross-rate symbols needed to value P/L in the account currency
+    std::vector<std::string> conversionSymbols;
+    AlignmentMode alignment = AlignmentMode::Union;
+    // Instruments are ordered as symbols followed by conversionSymbols
+    BacktestProject project;
+    // Compiled once from project, per-window fields are spliced in.
+    // Shared by all parameter sets of the same portfolio.
+    std::shared_ptr<const BacktestProjectTemplate> projectTemplate;
+};
+
+// One week of history, the unit in which data is prepared
+class BacktestWindow {
+public:
+    std::tm start;
+    long long startTime;
+    long long endTime;
+};
+
+// A single backtester run: one job over one window
+class BacktestTask {
+public:
+    std::shared_ptr<const BacktestJob> job;
+    BacktestWindow window;
+};
@@ -7,14 +7,7 @@
 #include <vector>
 #include <stdexcept>
 #include "BacktestProject.h"
-
-std::string formatDateTime(long long timestamp) {
-    std::time_t time = static_cast<std::time_t>(timestamp);
-    std::tm* tm = std::gmtime(&time);
-    std::stringstream ss;
-    ss << std::put_time(tm, "%Y-%m-%d %H:%M:%S");
-    return ss.str();
-}
+#include "TimeUtils.h"
 
 void BacktestProjectSerializer::serialize(const BacktestProject& project, const std::string& path) {
     std::ofstream file(path);
@@ -26,8 +19,8 @@ void BacktestProjectSerializer::serialize(const BacktestProject& project, const
     file << "<project>\n";
     file << " <simplified-format value=\"1\"/>\n";
     file << " <strategy value=\"" << project.strategy << "\"/>\n";
-    file << " <date-from value=\"" << formatDateTime(project.startTime) << "\"/>\n";
-    file << " <date-to value=\"" << formatDateTime(project.endTime) << "\"/>\n";
+    file << " <date-from value=\"" << TimeUtils::formatDateTime(project.startTime) << "\"/>\n";
+    file << " <date-to value=\"" << TimeUtils::formatDateTime(project.endTime) << "\"/>\n";
     file << " <account-currency value=\"" << project.accountCurrency << "\"/>\n";
     file << " <initial-amount value=\"" << std::fixed << std::setprecision(2) << project.initialAmount << std::defaultfloat << "\"/>\n";
     file << " <default-period value=\"" << project.defaultPeriod << "\"/>\n";
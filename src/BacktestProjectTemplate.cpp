@@ -0,0 +1,117 @@
+#include "BacktestProjectTemplate.h"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <stdexcept>
+#include "TimeUtils.h"
+
+namespace {
+    // Moves what has been rendered so far into segment, the stream keeps its formatting state
+    void takeSegment(std::ostringstream& ss, std::string& segment) {
+        segment = ss.str();
+        ss.str("");
+    }
+}
+
+BacktestProjectTemplate::BacktestProjectTemplate(const BacktestProject& prototype) {
+    // Same statements and manipulators as BacktestProjectSerializer, so sticky stream state matches
+    std::ostringstream ss;
+    ss << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n";
+    ss << "<project>\n";
+    ss << " <simplified-format value=\"1\"/>\n";
+    ss << " <strategy value=\"" << prototype.strategy << "\"/>\n";
+    ss << " <date-from value=\"";
+    takeSegment(ss, head);
+    ss << "\"/>\n";
+    ss << " <date-to value=\"";
+    takeSegment(ss, betweenDates);
+    ss << "\"/>\n";
+    ss << " <account-currency value=\"" << prototype.accountCurrency << "\"/>\n";
+    ss << " <initial-amount value=\"" << std::fixed << std::setprecision(2) << prototype.initialAmount << std::defaultfloat << "\"/>\n";
+    ss << " <default-period value=\"" << prototype.defaultPeriod << "\"/>\n";
+    ss << " <account-lot-size value=\"" << prototype.accountLotSize << "\"/>\n";
+    ss << " <instruments>\n";
+    takeSegment(ss, afterDates);
+    for (const auto& instrument : prototype.instruments) {
+        ss << " <instrument name=\"" << instrument.name << "\"";
+        instrumentOpenings.emplace_back();
+        takeSegment(ss, instrumentOpenings.back());
+        ss << ">\n";
+        ss << " <mmr value=\"" << std::fixed << std::setprecision(2) << instrument.mmr << std::defaultfloat << "\"/>\n";
+        ss << " <pipSize value=\"" << instrument.pipSize << "\"/>\n";
+        ss << " <precision value=\"" << instrument.precision << "\"/>\n";
+        ss << " <contractCurrency value=\"" << instrument.contractCurrency << "\"/>\n";
+        ss << " <profitCurrency value=\"" << instrument.profitCurrency << "\"/>\n";
+        ss << " <contractMultiplier value=\"" << instrument.contractMultiplier << "\"/>\n";
+        ss << " <baseUnitSize value=\"" << instrument.baseUnitSize << "\"/>\n";
+        ss << " <instrumentType value=\"" << instrument.instrumentType << "\"/>\n";
+        ss << " </instrument>\n";
+        instrumentBodies.emplace_back();
+        takeSegment(ss, instrumentBodies.back());
+    }
+    ss << " </instruments>\n";
+    ss << " <strategy-params>\n";
+    takeSegment(ss, parametersOpening);
+    for (const auto& strategyParameter : prototype.strategyParameters) {
+        ss << " <strategy-param id=\"" << strategyParameter.name << "\" value=\"";
+        parameterPrefixes.emplace_back();
+        takeSegment(ss, parameterPrefixes.back());
+    }
+    ss << " </strategy-params>\n";
+    ss << " </project>\n";
+    takeSegment(ss, closing);
+
+    invariantSize = head.size() + betweenDates.size() + afterDates.size() + parametersOpening.size() + closing.size();
+    for (size_t i = 0; i < instrumentOpenings.size(); i++) {
+        invariantSize += instrumentOpenings[i].size() + instrumentBodies[i].size();
+    }
+    for (const auto& prefix : parameterPrefixes) {
+        invariantSize += prefix.size() + 4;
+    }
+}
+
+void BacktestProjectTemplate::render(const BacktestProject& project, std::string& buffer) const {
+    if (project.instruments.size() != instrumentBodies.size() || project.strategyParameters.size() != parameterPrefixes.size()) {
+        throw std::runtime_error("Project does not match the compiled template of strategy " + project.strategy);
+    }
+    buffer.clear();
+    buffer.reserve(invariantSize + 64 + project.instruments.size() * 256);
+
+    buffer += head;
+    TimeUtils::appendDateTime(buffer, project.startTime);
+    buffer += betweenDates;
+    TimeUtils::appendDateTime(buffer, project.endTime);
+    buffer += afterDates;
+    for (size_t i = 0; i < instrumentBodies.size(); i++) {
+        buffer += instrumentOpenings[i];
+        const auto& pricesFilePath = project.instruments[i].pricesFilePath;
+        if (pricesFilePath.has_value()) {
+            buffer += " filename=\"";
+            buffer += pricesFilePath.value();
+            buffer += "\"";
+        }
+        buffer += instrumentBodies[i];
+    }
+    buffer += parametersOpening;
+    for (size_t i = 0; i < parameterPrefixes.size(); i++) {
+        buffer += parameterPrefixes[i];
+        buffer += project.strategyParameters[i].value;
+        buffer += "\"/>\n";
+    }
+    buffer += closing;
+}
+
+void BacktestProjectTemplate::write(const BacktestProject& project, const std::string& path) const {
+    // Reused per thread so a sweep does not allocate a new buffer for every job
+    thread_local std::string buffer;
+    render(project, buffer);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file: " + path);
+    }
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    if (!file) {
+        throw std::runtime_error("Failed to write file: " + path);
+    }
+}
@@ -0,0 +1,25 @@
+#include <string>
+#include <vector>
+#include "BacktestProject.h"
+
+#pragma once
+
+// Pre-rendered project file for a sweep. Everything except the dates, the instrument
+// price files and the strategy parameter values is rendered once, per-job fields are
+// spliced in. The output is byte-identical to BacktestProjectSerializer.
+class BacktestProjectTemplate {
+    std::string head;
+    std::string betweenDates;
+    std::string afterDates;
+    std::vector<std::string> instrumentOpenings;
+    std::vector<std::string> instrumentBodies;
+    std::string parametersOpening;
+    std::vector<std::string> parameterPrefixes;
+    std::string closing;
+    size_t invariantSize;
+public:
+    BacktestProjectTemplate(const BacktestProject& prototype);
+    // project must have the same instruments and strategy parameter ids as the prototype
+    void render(const BacktestProject& project, std::string& buffer) const;
+    void write(const BacktestProject& project, const std::string& path) const;
+};
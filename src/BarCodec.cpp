@@ -0,0 +1,521 @@
+#include "BarCodec.h"
+#include "MappedFile.h"
+#include "FileHash.h"
+#include <algorithm>
+#include <array>
+#include <utility>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace {
+    const char Magic[4] = { 'F', 'X', 'B', 'C' };
+    const uint32_t Version = 1;
+    // Bytes after packed bits, so the decoder may always load a whole 64-bit word
+    const size_t Padding = 8;
+    // Widths above this do not fit a shifted 64-bit load and are stored as raw 64-bit values
+    const int MaxPackedWidth = 56;
+    // Prices are stored as raw bits when no scale up to this many decimals is exact
+    const int MaxDigits = 9;
+    const uint8_t RawPrices = 0xFF;
+    // Scaled prices stay below 2^51 so that adding them to the bits of 2^52 + 2^51 converts them to double
+    const double MaxScaled = 2251799813685248.0;
+    const uint64_t MagicBits = 0x4338000000000000ULL;
+    const double MagicValue = 6755399441055744.0;
+    // rows, payload bytes, checksum
+    const size_t BlockHeaderBytes = 4 + 4 + 8;
+
+    uint64_t zigzag(int64_t value) {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    int64_t unzigzag(uint64_t value) {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    // Two's complement wrap-around, raw price bits may be far apart
+    int64_t difference(int64_t left, int64_t right) {
+        return static_cast<int64_t>(static_cast<uint64_t>(left) - static_cast<uint64_t>(right));
+    }
+
+    int64_t sum(int64_t left, int64_t right) {
+        return static_cast<int64_t>(static_cast<uint64_t>(left) + static_cast<uint64_t>(right));
+    }
+
+    void truncate(BarColumns& bars, size_t rows) {
+        bars.time.resize(rows);
+        bars.bidOpen.resize(rows);
+        bars.bidHigh.resize(rows);
+        bars.bidLow.resize(rows);
+        bars.bidClose.resize(rows);
+        bars.askOpen.resize(rows);
+        bars.askHigh.resize(rows);
+        bars.askLow.resize(rows);
+        bars.askClose.resize(rows);
+        bars.volume.resize(rows);
+    }
+
+    int bitLength(uint64_t value) {
+        int bits = 0;
+        while (value != 0) {
+            bits++;
+            value >>= 1;
+        }
+        return bits;
+    }
+
+    template <class T>
+    void putValue(std::string& output, T value) {
+        output.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    template <class T>
+    bool getValue(const char*& data, const char* end, T& value) {
+        if (static_cast<size_t>(end - data) < sizeof(value)) {
+            return false;
+        }
+        std::memcpy(&value, data, sizeof(value));
+        data += sizeof(value);
+        return true;
+    }
+
+    void putVarint(std::string& output, uint64_t value) {
+        while (value >= 0x80) {
+            output.push_back(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        output.push_back(static_cast<char>(value));
+    }
+
+    bool getVarint(const char*& data, const char* end, uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64 && data < end; shift += 7) {
+            uint8_t byte = static_cast<uint8_t>(*data++);
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Width that minimizes packed bits plus the patches of wider values
+    int chooseWidth(const std::vector<uint64_t>& values) {
+        size_t counts[65] = {};
+        for (uint64_t value : values) {
+            counts[bitLength(value)]++;
+        }
+        int best = 64;
+        size_t bestBytes = values.size() * 8;
+        for (int width = 0; width <= MaxPackedWidth; width++) {
+            size_t bytes = (values.size() * width + 7) / 8 + Padding;
+            for (int bits = width + 1; bits <= 64 && bytes < bestBytes; bits++) {
+                // Index gap and high bits as varints
+                bytes += counts[bits] * (2 + static_cast<size_t>(bits - width + 6) / 7);
+            }
+            if (bytes < bestBytes) {
+                best = width;
+                bestBytes = bytes;
+            }
+        }
+        return best;
+    }
+
+    // u8 width, varint patch count, packed low bits, then varint (index gap, high bits) per patch
+    void putStream(std::string& output, const std::vector<uint64_t>& values) {
+        int width = chooseWidth(values);
+        output.push_back(static_cast<char>(width));
+        if (width == 64) {
+            putVarint(output, 0);
+            output.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(uint64_t));
+            return;
+        }
+        uint64_t mask = width == 0 ? 0 : (uint64_t(1) << width) - 1;
+        size_t patches = 0;
+        for (uint64_t value : values) {
+            patches += (value & ~mask) != 0 ? 1 : 0;
+        }
+        putVarint(output, patches);
+        size_t offset = output.size();
+        output.append((values.size() * width + 7) / 8 + Padding, '\0');
+        char* packed = &output[offset];
+        for (size_t i = 0; i < values.size() && width > 0; i++) {
+            size_t bit = i * width;
+            uint64_t word;
+            std::memcpy(&word, packed + bit / 8, sizeof(word));
+            word |= (values[i] & mask) << (bit % 8);
+            std::memcpy(packed + bit / 8, &word, sizeof(word));
+        }
+        size_t previous = 0;
+        for (size_t i = 0; i < values.size(); i++) {
+            if ((values[i] & ~mask) != 0) {
+                putVarint(output, i - previous);
+                putVarint(output, values[i] >> width);
+                previous = i;
+            }
+        }
+    }
+
+    // Eight values always take Width bytes, so inside a group every offset and shift is a
+    // constant and the loop unrolls into plain loads, shifts and masks
+    template <int Width>
+    void unpack(const char* packed, size_t count, uint64_t* values) {
+        const uint64_t mask = Width == 0 ? 0 : (uint64_t(1) << Width) - 1;
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            const char* group = packed + i / 8 * Width;
+            for (size_t j = 0; j < 8; j++) {
+                uint64_t word;
+                std::memcpy(&word, group + j * Width / 8, sizeof(word));
+                values[i + j] = (word >> (j * Width % 8)) & mask;
+            }
+        }
+        const char* group = packed + i / 8 * Width;
+        for (size_t j = 0; j < count - i; j++) {
+            uint64_t word;
+            std::memcpy(&word, group + j * Width / 8, sizeof(word));
+            values[i + j] = (word >> (j * Width % 8)) & mask;
+        }
+    }
+
+    using Unpacker = void (*)(const char*, size_t, uint64_t*);
+
+    template <size_t... Widths>
+    std::array<Unpacker, sizeof...(Widths)> makeUnpackers(std::index_sequence<Widths...>) {
+        return { { &unpack<static_cast<int>(Widths)>... } };
+    }
+
+    const std::array<Unpacker, MaxPackedWidth + 1> Unpackers = makeUnpackers(std::make_index_sequence<MaxPackedWidth + 1>());
+
+    bool getStream(const char*& data, const char* end, size_t count, uint64_t* values) {
+        if (data >= end) {
+            return false;
+        }
+        int width = static_cast<uint8_t>(*data++);
+        uint64_t patches;
+        if ((width > MaxPackedWidth && width != 64) || !getVarint(data, end, patches)) {
+            return false;
+        }
+        if (width == 64) {
+            if (static_cast<size_t>(end - data) < count * sizeof(uint64_t)) {
+                return false;
+            }
+            std::memcpy(values, data, count * sizeof(uint64_t));
+            data += count * sizeof(uint64_t);
+            return true;
+        }
+        size_t bytes = (count * width + 7) / 8 + Padding;
+        if (static_cast<size_t>(end - data) < bytes) {
+            return false;
+        }
+        Unpackers[width](data, count, values);
+        data += bytes;
+        size_t index = 0;
+        for (uint64_t i = 0; i < patches; i++) {
+            uint64_t gap;
+            uint64_t high;
+            if (!getVarint(data, end, gap) || !getVarint(data, end, high) || index + gap >= count) {
+                return false;
+            }
+            index += gap;
+            values[index] |= high << width;
+        }
+        return true;
+    }
+
+    // Smallest number of decimals that turns every price of the block into an exact integer
+    uint8_t chooseDigits(const std::vector<const double*>& prices, size_t begin, size_t count) {
+        double scale = 1;
+        for (int digits = 0; digits <= MaxDigits; digits++, scale *= 10) {
+            bool exact = true;
+            for (size_t column = 0; column < prices.size() && exact; column++) {
+                for (size_t i = begin; i < begin + count; i++) {
+                    double scaled = prices[column][i] * scale;
+                    if (!(std::fabs(scaled) < MaxScaled) || static_cast<double>(std::llround(scaled)) / scale != prices[column][i]) {
+                        exact = false;
+                        break;
+                    }
+                }
+            }
+            if (exact) {
+                return static_cast<uint8_t>(digits);
+            }
+        }
+        return RawPrices;
+    }
+
+    void encodeBlock(const BarColumns& bars, size_t begin, size_t count, std::string& output) {
+        std::vector<const double*> prices = { bars.bidOpen.data(), bars.bidHigh.data(), bars.bidLow.data(), bars.bidClose.data(),
+            bars.askOpen.data(), bars.askHigh.data(), bars.askLow.data(), bars.askClose.data() };
+        uint8_t digits = chooseDigits(prices, begin, count);
+        double scale = std::pow(10.0, digits == RawPrices ? 0 : digits);
+        std::vector<std::vector<int64_t>> scaled(prices.size(), std::vector<int64_t>(count));
+        for (size_t column = 0; column < prices.size(); column++) {
+            for (size_t i = 0; i < count; i++) {
+                double price = prices[column][begin + i];
+                if (digits == RawPrices) {
+                    std::memcpy(&scaled[column][i], &price, sizeof(price));
+                } else {
+                    scaled[column][i] = std::llround(price * scale);
+                }
+            }
+        }
+        const auto& open = scaled[0];
+        const auto& high = scaled[1];
+        const auto& low = scaled[2];
+        const auto& close = scaled[3];
+
+        const long long* time = bars.time.data() + begin;
+        long long firstDelta = count > 1 ? time[1] - time[0] : 0;
+        std::string payload;
+        payload.push_back(static_cast<char>(digits));
+        putValue<int64_t>(payload, time[0]);
+        putValue<int64_t>(payload, firstDelta);
+
+        std::vector<uint64_t> values(count);
+        long long previousDelta = firstDelta;
+        values[0] = 0;
+        for (size_t i = 1; i < count; i++) {
+            long long delta = time[i] - time[i - 1];
+            values[i] = zigzag(difference(delta, previousDelta));
+            previousDelta = delta;
+        }
+        putStream(payload, values);
+        for (size_t i = 0; i < count; i++) {
+            values[i] = zigzag(difference(close[i], i > 0 ? close[i - 1] : 0));
+        }
+        putStream(payload, values);
+        for (size_t i = 0; i < count; i++) {
+            values[i] = zigzag(difference(open[i], i > 0 ? close[i - 1] : close[0]));
+        }
+        putStream(payload, values);
+        for (size_t i = 0; i < count; i++) {
+            values[i] = zigzag(difference(high[i], std::max(open[i], close[i])));
+        }
+        putStream(payload, values);
+        for (size_t i = 0; i < count; i++) {
+            values[i] = zigzag(difference(std::min(open[i], close[i]), low[i]));
+        }
+        putStream(payload, values);
+        // Ask against bid of the same field: the spread
+        for (size_t column = 4; column < 8; column++) {
+            for (size_t i = 0; i < count; i++) {
+                values[i] = zigzag(difference(scaled[column][i], scaled[column - 4][i]));
+            }
+            putStream(payload, values);
+        }
+        for (size_t i = 0; i < count; i++) {
+            values[i] = zigzag(bars.volume[begin + i]);
+        }
+        putStream(payload, values);
+
+        putValue<uint32_t>(output, static_cast<uint32_t>(count));
+        putValue<uint32_t>(output, static_cast<uint32_t>(payload.size()));
+        putValue<uint64_t>(output, BarCodec::checksum(payload.data(), payload.size()));
+        output += payload;
+    }
+
+    // Turns unpacked integers back into prices of the scale
+    void toPrices(const int64_t* values, size_t count, uint8_t digits, double* prices) {
+        if (digits == RawPrices) {
+            std::memcpy(prices, values, count * sizeof(double));
+            return;
+        }
+        double scale = std::pow(10.0, digits);
+        for (size_t i = 0; i < count; i++) {
+            // Exact int64 to double below 2^51 with integer adds, which vectorize where the conversion instruction does not
+            uint64_t bits = static_cast<uint64_t>(values[i]) + MagicBits;
+            double value;
+            std::memcpy(&value, &bits, sizeof(value));
+            prices[i] = (value - MagicValue) / scale;
+        }
+    }
+
+    bool decodeBlock(const char*& data, const char* end, BarColumns& output, std::vector<uint64_t>& stream, std::vector<int64_t>& scaled) {
+        uint32_t count;
+        uint32_t payloadBytes;
+        uint64_t checksum;
+        // The header is outside the checksum, so count is bounded before anything is allocated for it
+        if (!getValue(data, end, count) || !getValue(data, end, payloadBytes) || !getValue(data, end, checksum)
+            || count == 0 || count > BarCodec::BlockRows || static_cast<size_t>(end - data) < payloadBytes
+            || BarCodec::checksum(data, payloadBytes) != checksum) {
+            return false;
+        }
+        const char* payloadEnd = data + payloadBytes;
+        uint8_t digits;
+        int64_t firstTime;
+        int64_t firstDelta;
+        if (!getValue(data, payloadEnd, digits) || !getValue(data, payloadEnd, firstTime) || !getValue(data, payloadEnd, firstDelta)) {
+            return false;
+        }
+        stream.resize(count);
+        // open, high, low, close; then ask of each
+        scaled.resize(static_cast<size_t>(count) * 8);
+        int64_t* open = scaled.data();
+        int64_t* high = open + count;
+        int64_t* low = high + count;
+        int64_t* close = low + count;
+
+        size_t offset = output.size();
+        output.time.resize(offset + count);
+        if (!getStream(data, payloadEnd, count, stream.data())) {
+            return false;
+        }
+        long long* time = output.time.data() + offset;
+        long long delta = firstDelta;
+        time[0] = firstTime;
+        for (size_t i = 1; i < count; i++) {
+            delta = sum(delta, unzigzag(stream[i]));
+            time[i] = time[i - 1] + delta;
+        }
+        if (!getStream(data, payloadEnd, count, stream.data())) {
+            return false;
+        }
+        int64_t previous = 0;
+        for (size_t i = 0; i < count; i++) {
+            previous = sum(previous, unzigzag(stream[i]));
+            close[i] = previous;
+        }
+        if (!getStream(data, payloadEnd, count, stream.data())) {
+            return false;
+        }
+        open[0] = sum(close[0], unzigzag(stream[0]));
+        for (size_t i = 1; i < count; i++) {
+            open[i] = sum(close[i - 1], unzigzag(stream[i]));
+        }
+        if (!getStream(data, payloadEnd, count, stream.data())) {
+            return false;
+        }
+        for (size_t i = 0; i < count; i++) {
+            high[i] = sum(std::max(open[i], close[i]), unzigzag(stream[i]));
+        }
+        if (!getStream(data, payloadEnd, count, stream.data())) {
+            return false;
+        }
+        for (size_t i = 0; i < count; i++) {
+            low[i] = difference(std::min(open[i], close[i]), unzigzag(stream[i]));
+        }
+        for (size_t column = 4; column < 8; column++) {
+            if (!getStream(data, payloadEnd, count, stream.data())) {
+                return false;
+            }
+            int64_t* ask = scaled.data() + column * count;
+            const int64_t* bid = ask - 4 * static_cast<size_t>(count);
+            for (size_t i = 0; i < count; i++) {
+                ask[i] = sum(bid[i], unzigzag(stream[i]));
+            }
+        }
+        if (!getStream(data, payloadEnd, count, stream.data())) {
+            return false;
+        }
+        output.volume.resize(offset + count);
+        for (size_t i = 0; i < count; i++) {
+            output.volume[offset + i] = static_cast<int>(unzigzag(stream[i]));
+        }
+
+        std::vector<double>* columns[8] = { &output.bidOpen, &output.bidHigh, &output.bidLow, &output.bidClose,
+            &output.askOpen, &output.askHigh, &output.askLow, &output.askClose };
+        for (size_t column = 0; column < 8; column++) {
+            columns[column]->resize(offset + count);
+            toPrices(scaled.data() + column * count, count, digits, columns[column]->data() + offset);
+        }
+        data = payloadEnd;
+        return true;
+    }
+}
+
+const size_t BarCodec::BlockRows;
+
+uint64_t BarCodec::checksum(const char* data, size_t size) {
+    return FileHash::fnv1aWords(data, size);
+}
+
+void BarCodec::encode(const BarColumns& bars, std::string& output) {
+    output.append(Magic, sizeof(Magic));
+    putValue<uint32_t>(output, Version);
+    for (size_t begin = 0; begin < bars.size(); begin += BlockRows) {
+        encodeBlock(bars, begin, std::min(BlockRows, bars.size() - begin), output);
+    }
+}
+
+bool BarCodec::decode(const char* data, size_t size, BarColumns& output) {
+    const char* end = data + size;
+    uint32_t version;
+    if (size < sizeof(Magic) || std::memcmp(data, Magic, sizeof(Magic)) != 0) {
+        return false;
+    }
+    data += sizeof(Magic);
+    if (!getValue(data, end, version) || version != Version) {
+        return false;
+    }
+    std::vector<uint64_t> stream;
+    std::vector<int64_t> scaled;
+    while (data < end) {
+        size_t rows = output.size();
+        if (!decodeBlock(data, end, output, stream, scaled)) {
+            // Columns of the failed block may be partly grown
+            truncate(output, rows);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BarCodec::writeFile(const std::string& path, const BarColumns& bars) {
+    std::string encoded;
+    encode(bars, encoded);
+    std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file.write(encoded.data(), static_cast<std::streamsize>(encoded.size()))) {
+            return false;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, path, error);
+    return !error;
+}
+
+size_t BarCodec::countRows(const std::string& path) {
+    MappedFile file(path);
+    const char* data = file.data();
+    const char* end = data + file.size();
+    uint32_t version;
+    if (file.size() < sizeof(Magic) || std::memcmp(data, Magic, sizeof(Magic)) != 0) {
+        return 0;
+    }
+    data += sizeof(Magic);
+    if (!getValue(data, end, version) || version != Version) {
+        return 0;
+    }
+    size_t rows = 0;
+    while (data < end) {
+        uint32_t count;
+        uint32_t payloadBytes;
+        uint64_t checksum;
+        if (!getValue(data, end, count) || !getValue(data, end, payloadBytes) || !getValue(data, end, checksum)
+            || count > BlockRows || static_cast<size_t>(end - data) < payloadBytes) {
+            return 0;
+        }
+        rows += count;
+        data += payloadBytes;
+    }
+    return rows;
+}
+
+bool BarCodec::readFile(const std::string& path, BarColumns& output) {
+    MappedFile file(path);
+    if (file.size() == 0) {
+        return false;
+    }
+    size_t rows = output.size();
+    if (!decode(file.data(), file.size(), output)) {
+        std::cerr << "Warning: Corrupt compressed history " << path << std::endl;
+        truncate(output, rows);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,29 @@
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include "BarColumns.h"
+
+#pragma once
+
+// Compact encoding of m1 bid/ask bars, without any external library. Bars are cut into blocks of BlockRows,
+// each with its own checksum. Inside a block prices are scaled to integers (raw bits when no decimal scale is
+// exact) and stored as deltas: closes across bars, open/high/low against the bar itself, ask against bid.
+// Timestamps are stored as delta-of-delta. Every column is zig-zag encoded and bit-packed at one width
+// per block, values wider than it patched afterwards, so the decoder is a branch-free unpack loop per column.
+class BarCodec {
+public:
+    static const size_t BlockRows = 4096;
+    // Appends the file header and every bar to output
+    static void encode(const BarColumns& bars, std::string& output);
+    // Appends the bars of an encoded file to output. False if the header is wrong or a block is truncated
+    // or fails its checksum; output then holds the bars of the blocks before it.
+    static bool decode(const char* data, size_t size, BarColumns& output);
+    // Written to a temporary file first, so readers never see a partial file
+    static bool writeFile(const std::string& path, const BarColumns& bars);
+    // Output is left as it was when the file is missing or corrupt
+    static bool readFile(const std::string& path, BarColumns& output);
+    // Bars of an encoded file from its block headers alone, without decoding; 0 for a missing or damaged file
+    static size_t countRows(const std::string& path);
+    // Block checksum, FileHash::fnv1aWords of the payload
+    static uint64_t checksum(const char* data, size_t size);
+};
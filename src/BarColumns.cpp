@@ -0,0 +1,115 @@
+#include "BarColumns.h"
+#include "TimeUtils.h"
+
+size_t BarColumns::size() const {
+    return time.size();
+}
+
+void BarColumns::clear() {
+    time.clear();
+    bidOpen.clear();
+    bidHigh.clear();
+    bidLow.clear();
+    bidClose.clear();
+    askOpen.clear();
+    askHigh.clear();
+    askLow.clear();
+    askClose.clear();
+    volume.clear();
+}
+
+void BarColumns::reserve(size_t count) {
+    time.reserve(count);
+    bidOpen.reserve(count);
+    bidHigh.reserve(count);
+    bidLow.reserve(count);
+    bidClose.reserve(count);
+    askOpen.reserve(count);
+    askHigh.reserve(count);
+    askLow.reserve(count);
+    askClose.reserve(count);
+    volume.reserve(count);
+}
+
+void BarColumns::push(const Data& data) {
+    push(TimeUtils::toEpochSeconds(data.timestamp), data);
+}
+
+void BarColumns::push(long long timestamp, const Data& data) {
+    time.push_back(timestamp);
+    bidOpen.push_back(data.bid.open);
+    bidHigh.push_back(data.bid.high);
+    bidLow.push_back(data.bid.low);
+    bidClose.push_back(data.bid.close);
+    askOpen.push_back(data.ask.open);
+    askHigh.push_back(data.ask.high);
+    askLow.push_back(data.ask.low);
+    askClose.push_back(data.ask.close);
+    volume.push_back(data.volume);
+}
+
+Data BarColumns::get(size_t index) const {
+    Data data;
+    data.timestamp = TimeUtils::toUtc(time[index]);
+    data.bid.open = bidOpen[index];
+    data.bid.high = bidHigh[index];
+    data.bid.low = bidLow[index];
+    data.bid.close = bidClose[index];
+    data.ask.open = askOpen[index];
+    data.ask.high = askHigh[index];
+    data.ask.low = askLow[index];
+    data.ask.close = askClose[index];
+    data.volume = volume[index];
+    return data;
+}
+
+double ColumnKernels::maxOf(const double* values, size_t count) {
+    double lanes[4] = { values[0], values[0], values[0], values[0] };
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        for (size_t lane = 0; lane < 4; lane++) {
+            lanes[lane] = values[i + lane] > lanes[lane] ? values[i + lane] : lanes[lane];
+        }
+    }
+    double result = lanes[0];
+    for (size_t lane = 1; lane < 4; lane++) {
+        result = lanes[lane] > result ? lanes[lane] : result;
+    }
+    for (; i < count; i++) {
+        result = values[i] > result ? values[i] : result;
+    }
+    return result;
+}
+
+double ColumnKernels::minOf(const double* values, size_t count) {
+    double lanes[4] = { values[0], values[0], values[0], values[0] };
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        for (size_t lane = 0; lane < 4; lane++) {
+            lanes[lane] = values[i + lane] < lanes[lane] ? values[i + lane] : lanes[lane];
+        }
+    }
+    double result = lanes[0];
+    for (size_t lane = 1; lane < 4; lane++) {
+        result = lanes[lane] < result ? lanes[lane] : result;
+    }
+    for (; i < count; i++) {
+        result = values[i] < result ? values[i] : result;
+    }
+    return result;
+}
+
+long long ColumnKernels::sumOf(const int* values, size_t count) {
+    long long lanes[4] = { 0, 0, 0, 0 };
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        for (size_t lane = 0; lane < 4; lane++) {
+            lanes[lane] += values[i + lane];
+        }
+    }
+    long long result = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    for (; i < count; i++) {
+        result += values[i];
+    }
+    return result;
+}
@@ -0,0 +1,35 @@
+#include <vector>
+#include <cstddef>
+#include "StorageReader.h"
+
+#pragma once
+
+// Columnar (structure of arrays) bid/ask bars, timestamps are UTC seconds since epoch
+class BarColumns {
+public:
+    std::vector<long long> time;
+    std::vector<double> bidOpen;
+    std::vector<double> bidHigh;
+    std::vector<double> bidLow;
+    std::vector<double> bidClose;
+    std::vector<double> askOpen;
+    std::vector<double> askHigh;
+    std::vector<double> askLow;
+    std::vector<double> askClose;
+    std::vector<int> volume;
+
+    size_t size() const;
+    void clear();
+    void reserve(size_t count);
+    void push(const Data& data);
+    void push(long long timestamp, const Data& data);
+    Data get(size_t index) const;
+};
+
+// Reductions over contiguous columns, written with independent accumulators so they vectorize
+class ColumnKernels {
+public:
+    static double maxOf(const double* values, size_t count);
+    static double minOf(const double* values, size_t count);
+    static long long sumOf(const int* values, size_t count);
+};
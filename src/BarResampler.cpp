@@ -0,0 +1,94 @@
+#include "BarResampler.h"
+#include <algorithm>
+#include <utility>
+
+BarResampler::BarResampler(long long periodSeconds, long long sessionOffsetSeconds) {
+    this->periodSeconds = periodSeconds;
+    this->sessionOffsetSeconds = sessionOffsetSeconds;
+    this->pendingBucket = 0;
+}
+
+std::optional<long long> BarResampler::parsePeriod(const std::string& period) {
+    static const std::pair<const char*, long long> periods[] = {
+        { "m1", 60 }, { "m5", 300 }, { "m15", 900 }, { "m30", 1800 }, { "H1", 3600 }, { "H4", 14400 }, { "D1", 86400 }
+    };
+    for (const auto& supported : periods) {
+        if (period == supported.first) {
+            return supported.second;
+        }
+    }
+    return std::nullopt;
+}
+
+long long BarResampler::bucketOf(long long timestamp) const {
+    long long shifted = timestamp - sessionOffsetSeconds;
+    long long bucket = shifted >= 0 ? shifted / periodSeconds : (shifted - periodSeconds + 1) / periodSeconds;
+    return bucket * periodSeconds + sessionOffsetSeconds;
+}
+
+void BarResampler::aggregate(const BarColumns& input, size_t begin, size_t end, long long bucket) {
+    size_t count = end - begin;
+    double bidHigh = ColumnKernels::maxOf(input.bidHigh.data() + begin, count);
+    double bidLow = ColumnKernels::minOf(input.bidLow.data() + begin, count);
+    double askHigh = ColumnKernels::maxOf(input.askHigh.data() + begin, count);
+    double askLow = ColumnKernels::minOf(input.askLow.data() + begin, count);
+    long long volume = ColumnKernels::sumOf(input.volume.data() + begin, count);
+
+    if (pending.size() > 0 && pendingBucket == bucket) {
+        pending.bidHigh[0] = std::max(pending.bidHigh[0], bidHigh);
+        pending.bidLow[0] = std::min(pending.bidLow[0], bidLow);
+        pending.askHigh[0] = std::max(pending.askHigh[0], askHigh);
+        pending.askLow[0] = std::min(pending.askLow[0], askLow);
+        pending.bidClose[0] = input.bidClose[end - 1];
+        pending.askClose[0] = input.askClose[end - 1];
+        pending.volume[0] = static_cast<int>(pending.volume[0] + volume);
+        return;
+    }
+
+    pending.clear();
+    pendingBucket = bucket;
+    pending.time.push_back(bucket);
+    pending.bidOpen.push_back(input.bidOpen[begin]);
+    pending.bidHigh.push_back(bidHigh);
+    pending.bidLow.push_back(bidLow);
+    pending.bidClose.push_back(input.bidClose[end - 1]);
+    pending.askOpen.push_back(input.askOpen[begin]);
+    pending.askHigh.push_back(askHigh);
+    pending.askLow.push_back(askLow);
+    pending.askClose.push_back(input.askClose[end - 1]);
+    pending.volume.push_back(static_cast<int>(volume));
+}
+
+void BarResampler::push(const BarColumns& input, BarColumns& output) {
+    size_t begin = 0;
+    while (begin < input.size()) {
+        // Gaps simply produce no bar, a run ends where the bucket changes
+        long long bucket = bucketOf(input.time[begin]);
+        size_t end = begin + 1;
+        while (end < input.size() && input.time[end] >= bucket && input.time[end] < bucket + periodSeconds) {
+            end++;
+        }
+        if (pending.size() > 0 && pendingBucket != bucket) {
+            flush(output);
+        }
+        aggregate(input, begin, end, bucket);
+        begin = end;
+    }
+}
+
+void BarResampler::flush(BarColumns& output) {
+    if (pending.size() == 0) {
+        return;
+    }
+    output.time.push_back(pending.time[0]);
+    output.bidOpen.push_back(pending.bidOpen[0]);
+    output.bidHigh.push_back(pending.bidHigh[0]);
+    output.bidLow.push_back(pending.bidLow[0]);
+    output.bidClose.push_back(pending.bidClose[0]);
+    output.askOpen.push_back(pending.askOpen[0]);
+    output.askHigh.push_back(pending.askHigh[0]);
+    output.askLow.push_back(pending.askLow[0]);
+    output.askClose.push_back(pending.askClose[0]);
+    output.volume.push_back(pending.volume[0]);
+    pending.clear();
+}
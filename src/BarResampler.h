@@ -0,0 +1,26 @@
+#include <string>
+#include <optional>
+#include "BarColumns.h"
+
+#pragma once
+
+// Streams m1 bars into a higher timeframe. Input is consumed in columnar chunks and a
+// partially filled bar is carried over between chunks, so memory does not depend on file size.
+class BarResampler {
+    long long periodSeconds;
+    long long sessionOffsetSeconds;
+    BarColumns pending;
+    long long pendingBucket;
+public:
+    // sessionOffsetSeconds moves bar boundaries, e.g. 22:00 UTC for a D1 trading day starting at 17:00 New York
+    BarResampler(long long periodSeconds, long long sessionOffsetSeconds);
+    // Returns the length of m1, m5, m15, m30, H1, H4 and D1, nothing for any other period
+    static std::optional<long long> parsePeriod(const std::string& period);
+    // Appends every bar completed by the chunk to output
+    void push(const BarColumns& input, BarColumns& output);
+    // Appends the last, possibly incomplete bar
+    void flush(BarColumns& output);
+    long long bucketOf(long long timestamp) const;
+private:
+    void aggregate(const BarColumns& input, size_t begin, size_t end, long long bucket);
+};
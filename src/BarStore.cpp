@@ -0,0 +1,366 @@
+#include "BarStore.h"
+#include "TimeUtils.h"
+#include <filesystem>
+#include <fstream>
+#include <algorithm>
+#include <utility>
+#include <cstring>
+
+namespace {
+    const size_t ColumnCount = 10;
+    const char* const ColumnFiles[ColumnCount] = { "time.i64", "bid_open.f64", "bid_high.f64", "bid_low.f64", "bid_close.f64",
+        "ask_open.f64", "ask_high.f64", "ask_low.f64", "ask_close.f64", "volume.i32" };
+    const char* const IndexFile = "time.idx";
+
+    // Raw data and element width of a column
+    std::pair<char*, size_t> column(BarColumns& bars, size_t index) {
+        switch (index) {
+        case 0: return { reinterpret_cast<char*>(bars.time.data()), sizeof(long long) };
+        case 1: return { reinterpret_cast<char*>(bars.bidOpen.data()), sizeof(double) };
+        case 2: return { reinterpret_cast<char*>(bars.bidHigh.data()), sizeof(double) };
+        case 3: return { reinterpret_cast<char*>(bars.bidLow.data()), sizeof(double) };
+        case 4: return { reinterpret_cast<char*>(bars.bidClose.data()), sizeof(double) };
+        case 5: return { reinterpret_cast<char*>(bars.askOpen.data()), sizeof(double) };
+        case 6: return { reinterpret_cast<char*>(bars.askHigh.data()), sizeof(double) };
+        case 7: return { reinterpret_cast<char*>(bars.askLow.data()), sizeof(double) };
+        case 8: return { reinterpret_cast<char*>(bars.askClose.data()), sizeof(double) };
+        default: return { reinterpret_cast<char*>(bars.volume.data()), sizeof(int) };
+        }
+    }
+
+    std::pair<const char*, size_t> column(const BarColumns& bars, size_t index) {
+        return column(const_cast<BarColumns&>(bars), index);
+    }
+
+    size_t columnWidth(size_t index) {
+        return index == 0 ? sizeof(long long) : index == ColumnCount - 1 ? sizeof(int) : sizeof(double);
+    }
+
+    void resize(BarColumns& bars, size_t count) {
+        bars.time.resize(count);
+        bars.bidOpen.resize(count);
+        bars.bidHigh.resize(count);
+        bars.bidLow.resize(count);
+        bars.bidClose.resize(count);
+        bars.askOpen.resize(count);
+        bars.askHigh.resize(count);
+        bars.askLow.resize(count);
+        bars.askClose.resize(count);
+        bars.volume.resize(count);
+    }
+
+    int yearOf(long long time) {
+        return TimeUtils::toUtc(time).tm_year + 1900;
+    }
+
+    long long yearStart(int year) {
+        std::tm date{};
+        date.tm_year = year - 1900;
+        date.tm_mday = 1;
+        return TimeUtils::toEpochSeconds(date);
+    }
+
+    std::filesystem::path yearPath(const std::string& directory, int year) {
+        return std::filesystem::path(directory) / std::to_string(year);
+    }
+
+    std::vector<int> listYears(const std::string& directory) {
+        std::vector<int> years;
+        std::error_code error;
+        for (std::filesystem::directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+            std::string name = it->path().filename().string();
+            if (it->is_directory() && !name.empty() && std::all_of(name.begin(), name.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+                years.push_back(std::stoi(name));
+            }
+        }
+        std::sort(years.begin(), years.end());
+        return years;
+    }
+
+    size_t rowsIn(const std::filesystem::path& directory) {
+        size_t rows = 0;
+        for (size_t i = 0; i < ColumnCount; i++) {
+            std::error_code error;
+            auto bytes = std::filesystem::file_size(directory / ColumnFiles[i], error);
+            if (error) {
+                return 0;
+            }
+            size_t columnRows = static_cast<size_t>(bytes) / columnWidth(i);
+            rows = i == 0 ? columnRows : std::min(rows, columnRows);
+        }
+        return rows;
+    }
+
+    // Appends count rows from row begin to output
+    bool readRows(const std::filesystem::path& directory, size_t begin, size_t count, BarColumns& output) {
+        size_t offset = output.size();
+        resize(output, offset + count);
+        for (size_t i = 0; i < ColumnCount; i++) {
+            auto [data, width] = column(output, i);
+            std::ifstream file(directory / ColumnFiles[i], std::ios::binary);
+            file.seekg(static_cast<std::streamoff>(begin * width));
+            if (!file.read(data + offset * width, static_cast<std::streamsize>(count * width))) {
+                resize(output, offset);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Cuts the columns to their shortest one and rewrites the index when it does not cover exactly those rows
+    void repairYear(const std::filesystem::path& directory) {
+        size_t rows = rowsIn(directory);
+        std::error_code error;
+        for (size_t i = 0; i < ColumnCount; i++) {
+            std::filesystem::path path = directory / ColumnFiles[i];
+            if (std::filesystem::exists(path, error) && std::filesystem::file_size(path, error) != rows * columnWidth(i)) {
+                std::filesystem::resize_file(path, rows * columnWidth(i), error);
+            }
+        }
+        size_t entries = (rows + BarStore::IndexStride - 1) / BarStore::IndexStride;
+        auto indexBytes = std::filesystem::file_size(directory / IndexFile, error);
+        if (!error && indexBytes == entries * sizeof(long long)) {
+            return;
+        }
+        std::ifstream times(directory / ColumnFiles[0], std::ios::binary);
+        std::ofstream index(directory / IndexFile, std::ios::binary | std::ios::trunc);
+        for (size_t row = 0; row < rows; row += BarStore::IndexStride) {
+            long long time = 0;
+            times.seekg(static_cast<std::streamoff>(row * sizeof(long long)));
+            times.read(reinterpret_cast<char*>(&time), sizeof(time));
+            index.write(reinterpret_cast<const char*>(&time), sizeof(time));
+        }
+    }
+
+    // Appends rows [begin, end) of bars to one year, merging a first bar at the time of its last row
+    bool appendYear(const std::filesystem::path& directory, const BarColumns& bars, size_t begin, size_t end) {
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+        size_t rows = rowsIn(directory);
+        BarColumns last;
+        if (rows > 0 && readRows(directory, rows - 1, 1, last) && bars.time[begin] == last.time[0]) {
+            last.bidHigh[0] = std::max(last.bidHigh[0], bars.bidHigh[begin]);
+            last.bidLow[0] = std::min(last.bidLow[0], bars.bidLow[begin]);
+            last.bidClose[0] = bars.bidClose[begin];
+            last.askHigh[0] = std::max(last.askHigh[0], bars.askHigh[begin]);
+            last.askLow[0] = std::min(last.askLow[0], bars.askLow[begin]);
+            last.askClose[0] = bars.askClose[begin];
+            last.volume[0] += bars.volume[begin];
+            for (size_t i = 0; i < ColumnCount; i++) {
+                auto [data, width] = column(last, i);
+                std::fstream file(directory / ColumnFiles[i], std::ios::binary | std::ios::in | std::ios::out);
+                file.seekp(static_cast<std::streamoff>((rows - 1) * width));
+                if (!file.write(data, static_cast<std::streamsize>(width))) {
+                    return false;
+                }
+            }
+            begin++;
+        }
+        if (begin == end) {
+            return true;
+        }
+        for (size_t i = 0; i < ColumnCount; i++) {
+            auto [data, width] = column(bars, i);
+            std::ofstream file(directory / ColumnFiles[i], std::ios::binary | std::ios::app);
+            if (!file.write(data + begin * width, static_cast<std::streamsize>((end - begin) * width))) {
+                return false;
+            }
+        }
+        // Index entries for the appended multiples of the stride, written last so that repair can rebuild them
+        std::ofstream index(directory / IndexFile, std::ios::binary | std::ios::app);
+        size_t added = end - begin;
+        for (size_t row = (rows + BarStore::IndexStride - 1) / BarStore::IndexStride * BarStore::IndexStride; row < rows + added; row += BarStore::IndexStride) {
+            index.write(reinterpret_cast<const char*>(&bars.time[begin + row - rows]), sizeof(long long));
+        }
+        return static_cast<bool>(index);
+    }
+}
+
+const size_t BarStore::IndexStride;
+
+BarStore::BarStore(const std::string& directory) {
+    this->directory = directory;
+}
+
+std::vector<int> BarStore::years() const {
+    return listYears(directory);
+}
+
+size_t BarStore::size() const {
+    size_t rows = 0;
+    for (int year : years()) {
+        rows += rowsIn(yearPath(directory, year));
+    }
+    return rows;
+}
+
+std::optional<long long> BarStore::lastTime() const {
+    std::vector<int> stored = years();
+    for (auto it = stored.rbegin(); it != stored.rend(); ++it) {
+        std::filesystem::path path = yearPath(directory, *it);
+        size_t rows = rowsIn(path);
+        BarColumns last;
+        if (rows > 0 && readRows(path, rows - 1, 1, last)) {
+            return last.time[0];
+        }
+    }
+    return std::nullopt;
+}
+
+void BarStore::repair() {
+    for (int year : years()) {
+        repairYear(yearPath(directory, year));
+    }
+}
+
+bool BarStore::append(const BarColumns& bars) {
+    if (bars.size() == 0) {
+        return true;
+    }
+    // Seeks binary-search the times, so a batch going back in time is refused before any column is written
+    for (size_t i = 1; i < bars.size(); i++) {
+        if (bars.time[i] < bars.time[i - 1]) {
+            return false;
+        }
+    }
+    repair();
+    std::optional<long long> last = lastTime();
+    if (last.has_value() && bars.time[0] < last.value()) {
+        return false;
+    }
+    size_t begin = 0;
+    while (begin < bars.size()) {
+        int year = yearOf(bars.time[begin]);
+        long long nextYear = yearStart(year + 1);
+        size_t end = begin;
+        while (end < bars.size() && bars.time[end] < nextYear) {
+            end++;
+        }
+        if (!appendYear(yearPath(directory, year), bars, begin, end)) {
+            return false;
+        }
+        begin = end;
+    }
+    return true;
+}
+
+bool BarStore::read(BarColumns& output) const {
+    for (int year : years()) {
+        std::filesystem::path path = yearPath(directory, year);
+        size_t rows = rowsIn(path);
+        if (rows > 0 && !readRows(path, 0, rows, output)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void BarStore::clear() {
+    for (int year : years()) {
+        std::error_code error;
+        std::filesystem::remove_all(yearPath(directory, year), error);
+    }
+}
+
+BarStoreReader::BarStoreReader(const std::string& directory) {
+    this->directory = directory;
+    years = listYears(directory);
+}
+
+BarStoreReader::Year& BarStoreReader::map(int year) {
+    auto found = mapped.find(year);
+    if (found != mapped.end()) {
+        return *found->second;
+    }
+    auto entry = std::make_unique<Year>();
+    std::filesystem::path path = yearPath(directory, year);
+    size_t rows = 0;
+    for (size_t i = 0; i < ColumnCount; i++) {
+        entry->columns.push_back(std::make_unique<MappedFile>((path / ColumnFiles[i]).string()));
+        size_t columnRows = entry->columns.back()->size() / columnWidth(i);
+        rows = i == 0 ? columnRows : std::min(rows, columnRows);
+    }
+    entry->index = std::make_unique<MappedFile>((path / IndexFile).string());
+    BarSpan& span = entry->rows;
+    span.time = reinterpret_cast<const long long*>(entry->columns[0]->data());
+    span.bidOpen = reinterpret_cast<const double*>(entry->columns[1]->data());
+    span.bidHigh = reinterpret_cast<const double*>(entry->columns[2]->data());
+    span.bidLow = reinterpret_cast<const double*>(entry->columns[3]->data());
+    span.bidClose = reinterpret_cast<const double*>(entry->columns[4]->data());
+    span.askOpen = reinterpret_cast<const double*>(entry->columns[5]->data());
+    span.askHigh = reinterpret_cast<const double*>(entry->columns[6]->data());
+    span.askLow = reinterpret_cast<const double*>(entry->columns[7]->data());
+    span.askClose = reinterpret_cast<const double*>(entry->columns[8]->data());
+    span.volume = reinterpret_cast<const int*>(entry->columns[9]->data());
+    span.count = rows;
+    return *(mapped[year] = std::move(entry));
+}
+
+size_t BarStoreReader::seek(int year, long long time) {
+    const Year& entry = map(year);
+    const BarSpan& span = entry.rows;
+    const long long* index = reinterpret_cast<const long long*>(entry.index->data());
+    size_t entries = std::min(entry.index->size() / sizeof(long long), (span.count + BarStore::IndexStride - 1) / BarStore::IndexStride);
+    if (entries == 0) {
+        // An index lost with a crash, search every row
+        return std::lower_bound(span.time, span.time + span.count, time) - span.time;
+    }
+    // Entries before the first one at or after time tell which stride holds the row
+    size_t block = std::lower_bound(index, index + entries, time) - index;
+    if (block == 0) {
+        return 0;
+    }
+    size_t begin = (block - 1) * BarStore::IndexStride;
+    size_t end = block == entries ? span.count : std::min(block * BarStore::IndexStride, span.count);
+    return std::lower_bound(span.time + begin, span.time + end, time) - span.time;
+}
+
+std::vector<BarSpan> BarStoreReader::range(long long start, long long end) {
+    std::vector<BarSpan> spans;
+    if (end <= start) {
+        return spans;
+    }
+    int firstYear = yearOf(start);
+    int lastYear = yearOf(end - 1);
+    for (int year : years) {
+        if (year < firstYear || year > lastYear) {
+            continue;
+        }
+        const BarSpan& rows = map(year).rows;
+        size_t begin = year == firstYear ? seek(year, start) : 0;
+        size_t stop = year == lastYear ? seek(year, end) : rows.count;
+        if (begin >= stop) {
+            continue;
+        }
+        BarSpan span;
+        span.time = rows.time + begin;
+        span.bidOpen = rows.bidOpen + begin;
+        span.bidHigh = rows.bidHigh + begin;
+        span.bidLow = rows.bidLow + begin;
+        span.bidClose = rows.bidClose + begin;
+        span.askOpen = rows.askOpen + begin;
+        span.askHigh = rows.askHigh + begin;
+        span.askLow = rows.askLow + begin;
+        span.askClose = rows.askClose + begin;
+        span.volume = rows.volume + begin;
+        span.count = stop - begin;
+        spans.push_back(span);
+    }
+    return spans;
+}
+
+size_t BarStoreReader::read(long long start, long long end, BarColumns& output) {
+    size_t total = 0;
+    for (const auto& span : range(start, end)) {
+        size_t offset = output.size();
+        resize(output, offset + span.count);
+        const void* sources[ColumnCount] = { span.time, span.bidOpen, span.bidHigh, span.bidLow, span.bidClose,
+            span.askOpen, span.askHigh, span.askLow, span.askClose, span.volume };
+        for (size_t i = 0; i < ColumnCount; i++) {
+            auto [data, width] = column(output, i);
+            std::memcpy(data + offset * width, sources[i], span.count * width);
+        }
+        total += span.count;
+    }
+    return total;
+}
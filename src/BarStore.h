@@ -0,0 +1,77 @@
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <optional>
+#include <cstddef>
+#include "BarColumns.h"
+#include "MappedFile.h"
+
+#pragma once
+
+// Bars of one symbol in timestamp order, as append-only column files (time.i64, bid_open.f64, ...,
+// volume.i32) in one directory per UTC year. Each year has a sparse timestamp index, time.idx,
+// holding the time of every IndexStride-th row, so a seek reads a page of index and one stride of times.
+class BarStore {
+    std::string directory;
+public:
+    static const size_t IndexStride = 1024;
+
+    explicit BarStore(const std::string& directory);
+    // Rows in the store, a year counts its shortest column when a write was interrupted
+    size_t size() const;
+    std::optional<long long> lastTime() const;
+    // Appends bars, which must be in timestamp order and not start before lastTime; otherwise nothing
+    // is written and false returned. A first bar at lastTime is merged into the last row, as when the
+    // ticks of one minute arrive in two updates.
+    bool append(const BarColumns& bars);
+    // Appends every row to output
+    bool read(BarColumns& output) const;
+    // Removes every year
+    void clear();
+    // Cuts the columns of each year to the same length after an interrupted append and rebuilds its index
+    void repair();
+    // Years with bars, ascending
+    std::vector<int> years() const;
+};
+
+// Column pointers into the mapped files of one year of a BarStore
+class BarSpan {
+public:
+    const long long* time = nullptr;
+    const double* bidOpen = nullptr;
+    const double* bidHigh = nullptr;
+    const double* bidLow = nullptr;
+    const double* bidClose = nullptr;
+    const double* askOpen = nullptr;
+    const double* askHigh = nullptr;
+    const double* askLow = nullptr;
+    const double* askClose = nullptr;
+    const int* volume = nullptr;
+    size_t count = 0;
+};
+
+// Extracts any time range of a BarStore without copying. Only the years the range touches are mapped,
+// both ends are found in O(log n). Spans stay valid while the reader lives; a reader is not shared between threads.
+class BarStoreReader {
+public:
+    explicit BarStoreReader(const std::string& directory);
+    // Bars with start <= time < end, one span per year
+    std::vector<BarSpan> range(long long start, long long end);
+    // Appends the bars of the range to output, returns their number
+    size_t read(long long start, long long end, BarColumns& output);
+    // First row of year at or after time: a binary search of the sparse index, then of one stride
+    size_t seek(int year, long long time);
+private:
+    class Year {
+    public:
+        std::vector<std::unique_ptr<MappedFile>> columns;
+        std::unique_ptr<MappedFile> index;
+        BarSpan rows;
+    };
+    std::string directory;
+    std::vector<int> years;
+    std::map<int, std::unique_ptr<Year>> mapped;
+
+    Year& map(int year);
+};
@@ -0,0 +1,542 @@
+#include "BulkReader.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#ifdef _WIN32
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <cstring>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+namespace {
+    class ReadyFile {
+    public:
+        size_t index = 0;
+        const char* data = nullptr;
+        size_t size = 0;
+        bool ok = false;
+        // Registered buffer holding the data, -1 when the file owns it
+        int slot = -1;
+        std::vector<char> owned;
+    };
+
+    // Files on their way from the I/O side to the parser threads. At most limit files are held at once,
+    // in flight, waiting or being parsed, which bounds memory; every held file may take one of the slots.
+    class Handoff {
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::deque<ReadyFile> ready;
+        std::vector<int> freeSlots;
+        size_t held = 0;
+        size_t limit;
+        bool finished = false;
+    public:
+        explicit Handoff(size_t limit) : limit(limit) {
+            for (size_t i = limit; i > 0; i--) {
+                freeSlots.push_back(static_cast<int>(i - 1));
+            }
+        }
+
+        // Takes room for one more file, waiting for it only when wait is set
+        bool reserve(bool wait) {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (!wait && held >= limit) {
+                return false;
+            }
+            changed.wait(lock, [this]() { return held < limit; });
+            held++;
+            return true;
+        }
+
+        int takeSlot() {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (freeSlots.empty()) {
+                return -1;
+            }
+            int slot = freeSlots.back();
+            freeSlots.pop_back();
+            return slot;
+        }
+
+        void push(ReadyFile&& file) {
+            std::lock_guard<std::mutex> lock(mutex);
+            ready.push_back(std::move(file));
+            changed.notify_all();
+        }
+
+        // Next complete file, nothing once finished and drained
+        std::optional<ReadyFile> pop() {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [this]() { return !ready.empty() || finished; });
+            if (ready.empty()) {
+                return std::nullopt;
+            }
+            ReadyFile file = std::move(ready.front());
+            ready.pop_front();
+            return file;
+        }
+
+        void release(const ReadyFile& file) {
+            std::lock_guard<std::mutex> lock(mutex);
+            held--;
+            if (file.slot >= 0) {
+                freeSlots.push_back(file.slot);
+            }
+            changed.notify_all();
+        }
+
+        void finish() {
+            std::lock_guard<std::mutex> lock(mutex);
+            finished = true;
+            changed.notify_all();
+        }
+    };
+
+    bool readWhole(const std::string& path, size_t blockBytes, std::vector<char>& output) {
+#ifdef _WIN32
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) {
+            return false;
+        }
+        output.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        return output.empty() || static_cast<bool>(file.read(output.data(), static_cast<std::streamsize>(output.size())));
+#else
+        int descriptor = open(path.c_str(), O_RDONLY);
+        if (descriptor < 0) {
+            return false;
+        }
+        struct stat status;
+        bool ok = fstat(descriptor, &status) == 0;
+        if (ok) {
+            output.resize(static_cast<size_t>(status.st_size));
+        }
+        size_t offset = 0;
+        while (ok && offset < output.size()) {
+            ssize_t result = pread(descriptor, output.data() + offset, std::min(blockBytes, output.size() - offset), static_cast<off_t>(offset));
+            if (result < 0 && errno == EINTR) {
+                continue;
+            }
+            ok = result > 0;
+            offset += ok ? static_cast<size_t>(result) : 0;
+        }
+        close(descriptor);
+        return ok;
+#endif
+    }
+
+    void readPread(const std::vector<std::string>& paths, const BulkReader::Settings& settings, Handoff& handoff) {
+        std::atomic<size_t> next(0);
+        auto worker = [&]() {
+            for (size_t i = next++; i < paths.size(); i = next++) {
+                handoff.reserve(true);
+                ReadyFile file;
+                file.index = i;
+                file.ok = readWhole(paths[i], settings.blockBytes, file.owned);
+                file.data = file.owned.data();
+                file.size = file.ok ? file.owned.size() : 0;
+                handoff.push(std::move(file));
+            }
+        };
+        size_t threadCount = std::min<size_t>(std::max<size_t>(1, settings.queueDepth), paths.size());
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < threadCount; i++) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+#ifdef __linux__
+    // A submission and a completion ring set up with raw system calls, without liburing
+    class Ring {
+        void* sqRing = MAP_FAILED;
+        size_t sqRingBytes = 0;
+        void* cqRing = MAP_FAILED;
+        size_t cqRingBytes = 0;
+        void* sqeMemory = MAP_FAILED;
+        size_t sqeBytes = 0;
+        unsigned* sqTail = nullptr;
+        unsigned sqMask = 0;
+        unsigned* sqArray = nullptr;
+        unsigned* cqHead = nullptr;
+        unsigned* cqTail = nullptr;
+        unsigned cqMask = 0;
+        io_uring_sqe* sqes = nullptr;
+        io_uring_cqe* cqes = nullptr;
+        // Written but not yet passed to the kernel
+        unsigned pending = 0;
+    public:
+        int fd = -1;
+
+        bool setup(unsigned entries) {
+            io_uring_params params{};
+            fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+            if (fd < 0) {
+                return false;
+            }
+            sqRingBytes = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            cqRingBytes = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+            if (single) {
+                sqRingBytes = cqRingBytes = std::max(sqRingBytes, cqRingBytes);
+            }
+            sqRing = mmap(nullptr, sqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+            if (sqRing == MAP_FAILED) {
+                return false;
+            }
+            cqRing = single ? sqRing : mmap(nullptr, cqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+            sqeBytes = params.sq_entries * sizeof(io_uring_sqe);
+            sqeMemory = mmap(nullptr, sqeBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+            if (cqRing == MAP_FAILED || sqeMemory == MAP_FAILED) {
+                return false;
+            }
+            char* sq = static_cast<char*>(sqRing);
+            char* cq = static_cast<char*>(cqRing);
+            sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+            sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+            sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+            cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+            cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+            cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+            cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+            sqes = static_cast<io_uring_sqe*>(sqeMemory);
+            return true;
+        }
+
+        ~Ring() {
+            if (sqeMemory != MAP_FAILED) {
+                munmap(sqeMemory, sqeBytes);
+            }
+            if (cqRing != MAP_FAILED && cqRing != sqRing) {
+                munmap(cqRing, cqRingBytes);
+            }
+            if (sqRing != MAP_FAILED) {
+                munmap(sqRing, sqRingBytes);
+            }
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+
+        bool registerBuffers(const std::vector<iovec>& buffers) {
+            return syscall(__NR_io_uring_register, fd, IORING_REGISTER_BUFFERS, buffers.data(), static_cast<unsigned>(buffers.size())) == 0;
+        }
+
+        // Queues a read of length bytes at offset, into registered buffer slot unless it is negative
+        void read(int file, char* buffer, size_t length, size_t offset, int slot, uint64_t id) {
+            unsigned tail = *sqTail;
+            unsigned index = tail & sqMask;
+            io_uring_sqe& sqe = sqes[index];
+            std::memset(&sqe, 0, sizeof(sqe));
+            sqe.opcode = slot >= 0 ? IORING_OP_READ_FIXED : IORING_OP_READ;
+            sqe.fd = file;
+            sqe.addr = reinterpret_cast<uint64_t>(buffer);
+            sqe.len = static_cast<unsigned>(length);
+            sqe.off = offset;
+            sqe.buf_index = static_cast<uint16_t>(slot >= 0 ? slot : 0);
+            sqe.user_data = id;
+            sqArray[index] = index;
+            __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+            pending++;
+        }
+
+        // Passes the queued reads to the kernel and waits for at least one completion
+        bool submitAndWait() {
+            long result = syscall(__NR_io_uring_enter, fd, pending, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (result < 0) {
+                return errno == EINTR || errno == EAGAIN || errno == EBUSY;
+            }
+            pending -= static_cast<unsigned>(result);
+            return true;
+        }
+
+        template <class Handler>
+        void reap(Handler handle) {
+            unsigned head = *cqHead;
+            unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+            for (; head != tail; head++) {
+                const io_uring_cqe& cqe = cqes[head & cqMask];
+                handle(cqe.user_data, cqe.res);
+            }
+            __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+        }
+
+        // Waits for every read the kernel took out of inFlight queued ones and drops their completions. False when
+        // waiting failed, those reads may then still write into their buffers.
+        bool drain(size_t inFlight) {
+            size_t taken = inFlight - pending;
+            while (true) {
+                reap([&](uint64_t, int) { taken--; });
+                if (taken == 0) {
+                    return true;
+                }
+                long result = syscall(__NR_io_uring_enter, fd, 0, static_cast<unsigned>(taken), IORING_ENTER_GETEVENTS, nullptr, 0);
+                if (result < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                    return false;
+                }
+            }
+        }
+    };
+
+    // False when no ring could be set up, before anything was read. slotMemory holds the buffers handed
+    // to the parsers and must outlive them.
+    bool readIoUring(const std::vector<std::string>& paths, const BulkReader::Settings& settings, Handoff& handoff, size_t slots, std::vector<char>& slotMemory) {
+        Ring ring;
+        unsigned depth = static_cast<unsigned>(std::max<size_t>(1, settings.queueDepth));
+        if (!ring.setup(depth)) {
+            return false;
+        }
+        slotMemory.resize(slots * settings.blockBytes);
+        std::vector<iovec> buffers(slots);
+        for (size_t i = 0; i < slots; i++) {
+            buffers[i].iov_base = slotMemory.data() + i * settings.blockBytes;
+            buffers[i].iov_len = settings.blockBytes;
+        }
+        // Registration needs locked memory, plain reads into the same buffers work without it
+        bool registered = ring.registerBuffers(buffers);
+
+        class OpenFile {
+        public:
+            ReadyFile ready;
+            int fd = -1;
+            size_t submitted = 0;
+            size_t completed = 0;
+            size_t reads = 0;
+            bool failed = false;
+        };
+        class Read {
+        public:
+            size_t file = 0;
+            size_t offset = 0;
+            size_t length = 0;
+        };
+        std::vector<std::unique_ptr<OpenFile>> files(paths.size());
+        std::vector<Read> reads(depth);
+        std::vector<uint64_t> freeReads;
+        for (unsigned i = depth; i > 0; i--) {
+            freeReads.push_back(i - 1);
+        }
+        size_t nextPath = 0;
+        size_t inFlight = 0;
+        // File with bytes left to queue
+        std::optional<size_t> current;
+
+        auto submit = [&](uint64_t id) {
+            const Read& read = reads[id];
+            OpenFile& file = *files[read.file];
+            ring.read(file.fd, const_cast<char*>(file.ready.data) + read.offset, read.length, read.offset, registered ? file.ready.slot : -1, id);
+            inFlight++;
+        };
+        auto complete = [&](size_t index) {
+            OpenFile& file = *files[index];
+            if (file.fd >= 0) {
+                close(file.fd);
+            }
+            file.ready.ok = !file.failed;
+            if (file.failed) {
+                file.ready.size = 0;
+            }
+            handoff.push(std::move(file.ready));
+            files[index].reset();
+        };
+
+        while (true) {
+            while (inFlight < depth) {
+                if (!current.has_value()) {
+                    if (nextPath >= paths.size() || !handoff.reserve(inFlight == 0)) {
+                        break;
+                    }
+                    size_t index = nextPath++;
+                    files[index] = std::make_unique<OpenFile>();
+                    OpenFile& file = *files[index];
+                    file.ready.index = index;
+                    file.fd = open(paths[index].c_str(), O_RDONLY);
+                    struct stat status;
+                    if (file.fd < 0 || fstat(file.fd, &status) != 0) {
+                        file.failed = true;
+                    } else {
+                        file.ready.size = static_cast<size_t>(status.st_size);
+                    }
+                    if (file.failed || file.ready.size == 0) {
+                        complete(index);
+                        continue;
+                    }
+                    file.ready.slot = file.ready.size <= settings.blockBytes ? handoff.takeSlot() : -1;
+                    if (file.ready.slot >= 0) {
+                        file.ready.data = slotMemory.data() + static_cast<size_t>(file.ready.slot) * settings.blockBytes;
+                    } else {
+                        file.ready.owned.resize(file.ready.size);
+                        file.ready.data = file.ready.owned.data();
+                    }
+                    current = index;
+                }
+                OpenFile& file = *files[current.value()];
+                uint64_t id = freeReads.back();
+                freeReads.pop_back();
+                reads[id].file = current.value();
+                reads[id].offset = file.submitted;
+                reads[id].length = std::min(settings.blockBytes, file.ready.size - file.submitted);
+                file.submitted += reads[id].length;
+                file.reads++;
+                submit(id);
+                if (file.submitted == file.ready.size) {
+                    current.reset();
+                }
+            }
+            if (inFlight == 0) {
+                break;
+            }
+            if (!ring.submitAndWait()) {
+                std::cerr << "Warning: io_uring failed: " << std::strerror(errno) << ", remaining files not read" << std::endl;
+                if (!ring.drain(inFlight)) {
+                    // Never freed or reused, the kernel may still be reading into them
+                    std::cerr << "Warning: io_uring reads could not be waited for, their buffers are abandoned" << std::endl;
+                    new std::vector<char>(std::move(slotMemory));
+                    for (auto& file : files) {
+                        if (file) {
+                            file->ready.slot = -1;
+                            new std::vector<char>(std::move(file->ready.owned));
+                        }
+                    }
+                }
+                break;
+            }
+            ring.reap([&](uint64_t id, int result) {
+                Read& read = reads[id];
+                OpenFile& file = *files[read.file];
+                inFlight--;
+                if (result == -EAGAIN || result == -EINTR) {
+                    submit(id);
+                    return;
+                }
+                if (result > 0 && static_cast<size_t>(result) < read.length) {
+                    // Short read, queue the rest
+                    file.completed += static_cast<size_t>(result);
+                    read.offset += static_cast<size_t>(result);
+                    read.length -= static_cast<size_t>(result);
+                    submit(id);
+                    return;
+                }
+                if (result <= 0) {
+                    file.failed = true;
+                    if (current == read.file) {
+                        current.reset();
+                    }
+                } else {
+                    file.completed += static_cast<size_t>(result);
+                }
+                file.reads--;
+                freeReads.push_back(id);
+                if (file.reads == 0 && current != read.file && (file.failed || file.completed == file.ready.size)) {
+                    complete(read.file);
+                }
+            });
+        }
+        // Only reached early when the ring broke, after the reads the kernel had taken were waited for
+        for (size_t i = 0; i < files.size(); i++) {
+            if (files[i]) {
+                files[i]->failed = true;
+                complete(i);
+            }
+        }
+        for (size_t i = nextPath; i < paths.size(); i++) {
+            handoff.reserve(true);
+            ReadyFile file;
+            file.index = i;
+            handoff.push(std::move(file));
+        }
+        return true;
+    }
+#endif
+}
+
+BulkReader::BulkReader(const Settings& settings) {
+    this->settings = settings;
+    this->settings.queueDepth = std::max<size_t>(1, settings.queueDepth);
+    this->settings.blockBytes = std::max<size_t>(4096, settings.blockBytes);
+    this->settings.parserThreads = std::max<size_t>(1, settings.parserThreads);
+}
+
+bool BulkReader::ioUringAvailable() {
+#ifdef __linux__
+    static const bool available = []() {
+        Ring ring;
+        return ring.setup(1);
+    }();
+    return available;
+#else
+    return false;
+#endif
+}
+
+const char* BulkReader::name(IoBackend backend) {
+    switch (backend) {
+    case IoBackend::IoUring: return "io_uring";
+    case IoBackend::Pread: return "pread";
+    default: return "auto";
+    }
+}
+
+std::optional<IoBackend> BulkReader::parse(const std::string& name) {
+    for (IoBackend backend : { IoBackend::Auto, IoBackend::IoUring, IoBackend::Pread }) {
+        if (name == BulkReader::name(backend)) {
+            return backend;
+        }
+    }
+    return std::nullopt;
+}
+
+IoBackend BulkReader::read(const std::vector<std::string>& paths, const Consumer& consume) {
+    // Room for a full queue plus the file each parser is working on
+    size_t slots = settings.queueDepth + settings.parserThreads;
+    Handoff handoff(slots);
+    auto parse = [&]() {
+        while (auto file = handoff.pop()) {
+            consume(file->index, file->data, file->size, file->ok);
+            handoff.release(file.value());
+        }
+    };
+    std::vector<std::thread> parsers;
+    for (size_t i = 0; i < settings.parserThreads; i++) {
+        parsers.emplace_back(parse);
+    }
+
+    IoBackend used = IoBackend::Pread;
+    std::vector<char> slotMemory;
+#ifdef __linux__
+    if (settings.backend != IoBackend::Pread && readIoUring(paths, settings, handoff, slots, slotMemory)) {
+        used = IoBackend::IoUring;
+    }
+#endif
+    if (used != IoBackend::IoUring) {
+        if (settings.backend == IoBackend::IoUring) {
+            std::cerr << "Warning: io_uring is unavailable, reading with pread" << std::endl;
+        }
+        readPread(paths, settings, handoff);
+    }
+    handoff.finish();
+    for (auto& thread : parsers) {
+        thread.join();
+    }
+    return used;
+}
@@ -0,0 +1,59 @@
+#include <string>
+#include <vector>
+#include <functional>
+#include <optional>
+#include <istream>
+#include <streambuf>
+#include <cstddef>
+
+#pragma once
+
+enum class IoBackend {
+    // io_uring when the kernel allows it, pread otherwise
+    Auto,
+    IoUring,
+    Pread
+};
+
+// Whole-file reads for the tools that go through an entire history tree. Many reads are kept in flight across
+// files, through io_uring on Linux or a pool of threads calling pread when io_uring is unavailable, and every
+// file is handed to one of the parser threads as soon as it is complete, in completion order.
+class BulkReader {
+public:
+    class Settings {
+    public:
+        IoBackend backend = IoBackend::Auto;
+        // Reads in flight, threads of the pread backend
+        size_t queueDepth = 32;
+        // Length of each read and of each registered io_uring buffer; smaller files are read into one of those
+        size_t blockBytes = 1 << 20;
+        size_t parserThreads = 1;
+    };
+    // Called once per file on a parser thread; ok is false when the file could not be read. data is only valid until it returns.
+    using Consumer = std::function<void(size_t index, const char* data, size_t size, bool ok)>;
+
+    explicit BulkReader(const Settings& settings);
+    // Reads every path and returns the backend that did
+    IoBackend read(const std::vector<std::string>& paths, const Consumer& consume);
+    static bool ioUringAvailable();
+    static const char* name(IoBackend backend);
+    static std::optional<IoBackend> parse(const std::string& name);
+private:
+    Settings settings;
+};
+
+// An istream over memory owned by the caller, for the parsers written against streams
+class MemoryStream : public std::istream {
+    class Buffer : public std::streambuf {
+    public:
+        Buffer(const char* data, size_t size) {
+            char* begin = const_cast<char*>(data);
+            setg(begin, begin, begin + size);
+        }
+    };
+    Buffer buffer;
+public:
+    MemoryStream(const char* data, size_t size) : std::istream(nullptr), buffer(data, size) {
+        rdbuf(&buffer);
+    }
+};
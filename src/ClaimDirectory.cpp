@@ -0,0 +1,130 @@
+#include "ClaimDirectory.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+
+ClaimDirectory::ClaimDirectory(const std::string& planPath, const std::string& node, std::chrono::seconds claimDuration) {
+    this->claimsPath = (std::filesystem::path(planPath) / "claims").string();
+    this->donePath = (std::filesystem::path(planPath) / "done").string();
+    this->node = node;
+    this->claimDuration = claimDuration;
+    std::filesystem::create_directories(claimsPath);
+    std::filesystem::create_directories(donePath);
+}
+
+std::string ClaimDirectory::claimPath(size_t chunk, size_t generation) const {
+    return (std::filesystem::path(claimsPath) / (std::to_string(chunk) + "." + std::to_string(generation) + ".claim")).string();
+}
+
+bool ClaimDirectory::tryCreate(size_t chunk, size_t generation, long long expiresAt) {
+    // "x" makes the open fail if the file exists, which is the atomic part of claiming
+    std::FILE* file = std::fopen(claimPath(chunk, generation).c_str(), "wx");
+    if (file == nullptr) {
+        return false;
+    }
+    std::fprintf(file, "%s %lld\n", node.c_str(), expiresAt);
+    std::fclose(file);
+    return true;
+}
+
+bool ClaimDirectory::readClaim(const std::string& path, std::string& owner, long long& expiresAt) const {
+    std::ifstream file(path);
+    if (file >> owner >> expiresAt) {
+        return true;
+    }
+    // Created but not written yet, or the writer crashed in between
+    std::error_code error;
+    auto modified = std::filesystem::last_write_time(path, error);
+    if (error) {
+        return false;
+    }
+    auto age = std::filesystem::file_time_type::clock::now() - modified;
+    expiresAt = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count()
+        - std::chrono::duration_cast<std::chrono::seconds>(age).count() + claimDuration.count();
+    owner.clear();
+    return true;
+}
+
+std::optional<ClaimDirectory::Claim> ClaimDirectory::claimNext(size_t chunkCount, long long now) {
+    // One listing per pass instead of a stat per chunk keeps the load on the shared filesystem low
+    std::map<size_t, size_t> generations;
+    for (const auto& entry : std::filesystem::directory_iterator(claimsPath)) {
+        std::string name = entry.path().filename().string();
+        size_t chunk = 0;
+        size_t generation = 0;
+        char suffix[8] = {};
+        if (std::sscanf(name.c_str(), "%zu.%zu.%7s", &chunk, &generation, suffix) == 3 && std::string(suffix) == "claim") {
+            auto it = generations.find(chunk);
+            if (it == generations.end() || it->second < generation) {
+                generations[chunk] = generation;
+            }
+        }
+    }
+    std::set<size_t> done;
+    for (const auto& entry : std::filesystem::directory_iterator(donePath)) {
+        done.insert(std::strtoull(entry.path().filename().string().c_str(), nullptr, 10));
+    }
+
+    for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+        if (done.count(chunk) > 0) {
+            continue;
+        }
+        Claim claim;
+        claim.chunk = chunk;
+        claim.expiresAt = now + claimDuration.count();
+        auto it = generations.find(chunk);
+        if (it == generations.end()) {
+            claim.generation = 0;
+        } else {
+            std::string owner;
+            long long expiresAt = 0;
+            if (!readClaim(claimPath(chunk, it->second), owner, expiresAt) || expiresAt > now) {
+                continue;
+            }
+            claim.generation = it->second + 1;
+            std::cerr << "Warning: Claim of chunk " << chunk << " by " << (owner.empty() ? "unknown node" : owner) << " expired, reclaiming" << std::endl;
+        }
+        if (tryCreate(chunk, claim.generation, claim.expiresAt)) {
+            return claim;
+        }
+    }
+    return std::nullopt;
+}
+
+bool ClaimDirectory::renew(Claim& claim, long long now) {
+    std::error_code error;
+    if (std::filesystem::exists(claimPath(claim.chunk, claim.generation + 1), error)) {
+        return false;
+    }
+    // Replace the content atomically so readers never see a half-written claim
+    std::string path = claimPath(claim.chunk, claim.generation);
+    std::string temporaryPath = path + "." + node + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::trunc);
+        file << node << " " << now + claimDuration.count() << "\n";
+    }
+    std::filesystem::rename(temporaryPath, path, error);
+    if (error) {
+        std::filesystem::remove(temporaryPath, error);
+        return false;
+    }
+    claim.expiresAt = now + claimDuration.count();
+    return true;
+}
+
+void ClaimDirectory::complete(const Claim& claim) {
+    std::ofstream marker(std::filesystem::path(donePath) / (std::to_string(claim.chunk) + ".done"));
+    marker << node << "\n";
+}
+
+bool ClaimDirectory::isComplete(size_t chunkCount) const {
+    size_t done = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(donePath)) {
+        (void)entry;
+        done++;
+    }
+    return done >= chunkCount;
+}
@@ -0,0 +1,38 @@
+#include <string>
+#include <optional>
+#include <chrono>
+
+#pragma once
+
+// Chunk claims as files in a shared directory, for nodes that only share a filesystem.
+// A claim is the file claims/<chunk>.<generation>.claim, created exclusively, holding the owner
+// and an expiry time. A node takes over an expired claim by creating the next generation, so
+// of several nodes racing for the same stale chunk exactly one wins. Finished chunks get a
+// marker in done/. Expiry uses wall-clock time, node clocks are expected to be in sync.
+class ClaimDirectory {
+public:
+    class Claim {
+    public:
+        size_t chunk;
+        size_t generation;
+        long long expiresAt;
+    };
+
+    ClaimDirectory(const std::string& planPath, const std::string& node, std::chrono::seconds claimDuration);
+    // Claims the first chunk that is neither done nor held by a live claim
+    std::optional<Claim> claimNext(size_t chunkCount, long long now);
+    // Pushes the expiry of an own claim forward, false once another node took the chunk over
+    bool renew(Claim& claim, long long now);
+    void complete(const Claim& claim);
+    bool isComplete(size_t chunkCount) const;
+private:
+    std::string claimsPath;
+    std::string donePath;
+    std::string node;
+    std::chrono::seconds claimDuration;
+
+    std::string claimPath(size_t chunk, size_t generation) const;
+    bool tryCreate(size_t chunk, size_t generation, long long expiresAt);
+    // Owner and expiry of a claim file, an unreadable claim expires claimDuration after it was written
+    bool readClaim(const std::string& path, std::string& owner, long long& expiresAt) const;
+};
@@ -0,0 +1,96 @@
+#include "ConcurrencyController.h"
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+
+ConcurrencyController::ConcurrencyController(const Settings& settings, size_t initialWorkers) : settings(settings) {
+    this->settings.minWorkers = std::max<size_t>(1, settings.minWorkers);
+    this->settings.maxWorkers = std::max(this->settings.minWorkers, settings.maxWorkers);
+    active = std::min(std::max(initialWorkers, this->settings.minWorkers), this->settings.maxWorkers);
+}
+
+size_t ConcurrencyController::limit() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return active;
+}
+
+ConcurrencyController::Decision ConcurrencyController::update(const Sample& sample) {
+    std::lock_guard<std::mutex> lock(mutex);
+    bool memoryLow = sample.availableMemoryMb < settings.availableMemoryLowMb;
+    bool dropped = hasPrevious && sample.throughput < previousThroughput * (1.0 - settings.throughputTolerance);
+    bool rose = hasPrevious && sample.throughput > previousThroughput * (1.0 + settings.throughputTolerance);
+    previousThroughput = sample.throughput;
+    hasPrevious = true;
+
+    if (memoryLow) {
+        return step(-1, "available memory low");
+    }
+    if (lastStep > 0 && dropped) {
+        // The extra worker made things worse, undo it and stay there for a while
+        Decision decision = step(-1, "throughput dropped after raising");
+        lastStep = 0;
+        cooldown = settings.cooldownSamples;
+        return decision;
+    }
+    if (lastStep < 0 && dropped) {
+        Decision decision = step(1, "throughput dropped after lowering");
+        lastStep = 0;
+        cooldown = settings.cooldownSamples;
+        return decision;
+    }
+    if (lastStep < 0 && rose) {
+        return step(-1, "throughput rose after lowering");
+    }
+    if (cooldown > 0) {
+        cooldown--;
+        return step(0, "cooling down after undoing a change");
+    }
+    if (sample.cpuBusy >= settings.cpuBusyHigh) {
+        return step(0, "CPU saturated");
+    }
+    return step(1, sample.ioWait >= 0.2 ? "CPU left over, waiting on I/O" : "CPU left over");
+}
+
+ConcurrencyController::Decision ConcurrencyController::step(int direction, const std::string& reason) {
+    Decision decision;
+    decision.from = active;
+    decision.reason = reason;
+    if (direction > 0 && active < settings.maxWorkers) {
+        active++;
+    } else if (direction < 0 && active > settings.minWorkers) {
+        active--;
+    } else if (direction != 0) {
+        decision.reason += ", at the bound";
+    }
+    decision.to = active;
+    lastStep = decision.to > decision.from ? 1 : (decision.to < decision.from ? -1 : 0);
+    if (decision.to > decision.from) {
+        changed.notify_all();
+    }
+    return decision;
+}
+
+bool ConcurrencyController::waitForSlot(size_t worker) {
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [&]() { return closed || worker < active; });
+    return !closed;
+}
+
+void ConcurrencyController::close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    closed = true;
+    changed.notify_all();
+}
+
+bool ConcurrencyController::waitClosed(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex);
+    return changed.wait_for(lock, timeout, [&]() { return closed; });
+}
+
+std::string ConcurrencyController::describe(const Decision& decision, const Sample& sample) {
+    std::ostringstream stream;
+    stream << std::fixed << std::setprecision(2) << "Concurrency " << decision.from << " -> " << decision.to << ": " << decision.reason
+           << " (" << sample.throughput << " tasks/s, CPU " << std::setprecision(0) << sample.cpuBusy * 100 << "%, I/O wait "
+           << sample.ioWait * 100 << "%, " << sample.availableMemoryMb << " MB available)";
+    return stream.str();
+}
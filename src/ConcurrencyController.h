@@ -0,0 +1,68 @@
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+#pragma once
+
+// Decides how many backtester processes run at once. Every sample raises the count by one while
+// CPU and memory are left over, lowers it when memory runs low and steps back when the last change
+// made the throughput drop, always within [minWorkers, maxWorkers].
+class ConcurrencyController {
+public:
+    class Settings {
+    public:
+        size_t minWorkers = 1;
+        size_t maxWorkers = 1;
+        // Share of CPU time spent running, above it the workers are CPU-bound
+        double cpuBusyHigh = 0.9;
+        // Below this much available memory workers are stopped
+        double availableMemoryLowMb = 512.0;
+        // Relative throughput change treated as noise
+        double throughputTolerance = 0.05;
+        // Samples to keep the count after undoing a change before exploring again
+        int cooldownSamples = 6;
+    };
+
+    class Sample {
+    public:
+        // Finished tasks per second since the previous sample
+        double throughput = 0.0;
+        // Shares of CPU time since the previous sample, 0..1
+        double cpuBusy = 0.0;
+        double ioWait = 0.0;
+        double availableMemoryMb = 0.0;
+    };
+
+    class Decision {
+    public:
+        size_t from = 0;
+        size_t to = 0;
+        std::string reason;
+    };
+
+    ConcurrencyController(const Settings& settings, size_t initialWorkers);
+    size_t limit() const;
+    // Applies the policy to the sample and wakes workers allowed to run again
+    Decision update(const Sample& sample);
+    // Blocks worker threads numbered at or above the limit, false once closed
+    bool waitForSlot(size_t worker);
+    // Releases every waiting worker, e.g. because the sweep is over
+    void close();
+    // Sleeps up to the timeout, returns true if closed meanwhile
+    bool waitClosed(std::chrono::milliseconds timeout);
+    static std::string describe(const Decision& decision, const Sample& sample);
+private:
+    Settings settings;
+    mutable std::mutex mutex;
+    std::condition_variable changed;
+    size_t active;
+    bool closed = false;
+    bool hasPrevious = false;
+    double previousThroughput = 0.0;
+    // +1 or -1 for the change made at the previous sample, 0 when the count was kept
+    int lastStep = 0;
+    int cooldown = 0;
+
+    Decision step(int direction, const std::string& reason);
+};
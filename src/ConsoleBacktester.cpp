@@ -2,54 +2,59 @@
 #include <string>
 #include <iostream>
 #include <filesystem>
-#include <cstdlib>
+#include <fstream>
+#include <sstream>
 #include "BacktestProject.h"
 #include "BacktestProjectSerializer.h"
 
-ConsoleBacktester::ConsoleBacktester(const std::string& pathToBacktester, const std::string& id) {
+ConsoleBacktester::ConsoleBacktester(const std::string& pathToBacktester, const std::string& id, WorkspaceManager& workspaces) : workspaces(workspaces) {
     this->pathToBacktester = pathToBacktester;
     this->id = id;
 }
 
-void ConsoleBacktester::run(const BacktestProject& project) {
+BacktestResult ConsoleBacktester::run(const BacktestProject& project, ProcessCancellation* cancellation) {
+    return run([&](const std::string& projectPath) { BacktestProjectSerializer::serialize(project, projectPath); }, cancellation);
+}
+
+BacktestResult ConsoleBacktester::run(const BacktestProject& project, const BacktestProjectTemplate& projectTemplate, ProcessCancellation* cancellation) {
+    return run([&](const std::string& projectPath) { projectTemplate.write(project, projectPath); }, cancellation);
+}
+
+BacktestResult ConsoleBacktester::run(const std::function<void(const std::string&)>& saveProject, ProcessCancellation* cancellation) {
+    BacktestResult result;
     if (pathToBacktester.empty()) {
         std::cerr << "Error: Path to backtester is not set" << std::endl;
-        return;
+        return result;
     }
     
-    // Create temporary directory
-    std::filesystem::path tempDir = std::filesystem::temp_directory_path() / "fxts2_backtester";
-    std::filesystem::create_directories(tempDir);
+    // Every attempt gets its own workspace, so copies of the same task and other processes never collide
+    std::filesystem::path tempDir = workspaces.create("attempt_" + id, attemptWorkspaceBytes);
     
-    // Create project file path in temp directory
-    std::filesystem::path projectPath = tempDir / ("project" + id + ".bpj");
+    // Create project file path in the workspace
+    std::filesystem::path projectPath = tempDir / "project.bpj";
     
     try {
-        BacktestProjectSerializer::serialize(project, projectPath.string());
+        saveProject(projectPath.string());
     } catch (const std::exception& e) {
         std::cerr << "Error saving project: " << e.what() << std::endl;
     }
     
-    std::filesystem::path outputPath = tempDir / ("backtest_" + id + ".txt");
-    std::filesystem::path statsPath = tempDir / ("stats" + id + ".txt");
+    std::filesystem::path outputPath = tempDir / "backtest.txt";
+    std::filesystem::path statsPath = tempDir / "stats.txt";
     std::filesystem::path backtesterPath = std::filesystem::path(pathToBacktester) / "ConsoleBacktester.exe";
     
-    std::string command = backtesterPath.string() + " " + projectPath.string() + " /o " + outputPath.string() 
-        + " /so " + statsPath.string();
-    std::system(command.c_str());
+    result.exitCode = ProcessRunner::run({ backtesterPath.string(), projectPath.string(), "/o", outputPath.string(), "/so", statsPath.string() }, cancellation, &result.usage);
+    result.cancelled = cancellation != nullptr && cancellation->isCancelled();
 
-    // Delete temporary files
-    try {
-        if (std::filesystem::exists(projectPath)) {
-            std::filesystem::remove(projectPath);
-        }
-        if (std::filesystem::exists(outputPath)) {
-            std::filesystem::remove(outputPath);
-        }
-        if (std::filesystem::exists(statsPath)) {
-            std::filesystem::remove(statsPath);
-        }
-    } catch (const std::exception& e) {
-        std::cerr << "Warning: Failed to clean up temporary files: " << e.what() << std::endl;
+    std::ifstream statsFile(statsPath);
+    if (statsFile.is_open()) {
+        std::stringstream buffer;
+        buffer << statsFile.rdbuf();
+        result.stats = buffer.str();
+        statsFile.close();
     }
+
+    // Removed in the background, off the critical path
+    workspaces.release(tempDir.string());
+    return result;
 }
\ No newline at end of file
@@ -1,12 +1,36 @@
 #include <string>
 #include "BacktestProject.h"
 #include <optional>
+#include <functional>
+#include "BacktestProjectTemplate.h"
+#include "ProcessRunner.h"
+#include "WorkspaceManager.h"
+
+#pragma once
+
+class BacktestResult {
+public:
+    int exitCode = -1;
+    // Content of the statistics file written by the backtester
+    std::string stats;
+    // Killed through its ProcessCancellation, e.g. because a speculative copy finished first
+    bool cancelled = false;
+    // Resources used by the backtester process
+    ProcessUsage usage;
+};
 
 class ConsoleBacktester {
 private:
     std::string pathToBacktester;
     std::string id;
+    WorkspaceManager& workspaces;
+    // Reserved for the project, output and statistics files of a run
+    static const uintmax_t attemptWorkspaceBytes = 4 * 1024 * 1024;
 public:
-    ConsoleBacktester(const std::string& pathToBacktester, const std::string& id);
-    void run(const BacktestProject& project);
-};
\ No newline at end of file
+    ConsoleBacktester(const std::string& pathToBacktester, const std::string& id, WorkspaceManager& workspaces = WorkspaceManager::shared());
+    BacktestResult run(const BacktestProject& project, ProcessCancellation* cancellation = nullptr);
+    // Writes the project file from a compiled template instead of serializing it from scratch
+    BacktestResult run(const BacktestProject& project, const BacktestProjectTemplate& projectTemplate, ProcessCancellation* cancellation = nullptr);
+private:
+    BacktestResult run(const std::function<void(const std::string&)>& saveProject, ProcessCancellation* cancellation);
+};
@@ -0,0 +1,187 @@
+#include "Coordinator.h"
+#include <iostream>
+#include <thread>
+#include "FileHash.h"
+#include "TaskResultJson.h"
+#include "TimeUtils.h"
+
+Coordinator::Coordinator(const SweepSpec& spec, const std::vector<BacktestTask>& tasks, const std::string& historyPath, RatesStorageProvider& ratesStorageProvider,
+    size_t shardSize, std::chrono::milliseconds leaseDuration, std::ostream& results)
+    : ratesStorageProvider(ratesStorageProvider), results(results), leases(tasks.size(), shardSize, leaseDuration), stopping(false) {
+    this->spec = spec;
+    this->tasks = tasks;
+    this->historyPath = historyPath;
+    this->leaseDuration = leaseDuration;
+    this->listenFd = -1;
+    this->completedTasks = 0;
+    // Jobs are numbered in order of first appearance, which is the planning order
+    std::map<const BacktestJob*, size_t> jobNumbers;
+    for (const auto& task : tasks) {
+        auto inserted = jobNumbers.emplace(task.job.get(), jobNumbers.size());
+        jobIndexes.push_back(inserted.first->second);
+    }
+}
+
+bool Coordinator::listen(int port) {
+    listenFd = SocketChannel::listenTcp(port);
+    return listenFd >= 0;
+}
+
+int Coordinator::port() const {
+    return SocketChannel::localPort(listenFd);
+}
+
+size_t Coordinator::run() {
+    std::thread reaper(&Coordinator::expireLeases, this);
+    std::vector<std::thread> handlers;
+    std::thread acceptor([this, &handlers]() {
+        while (true) {
+            int fd = SocketChannel::accept(listenFd);
+            if (fd < 0) {
+                break;
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            connections.insert(fd);
+            handlers.emplace_back(&Coordinator::handleConnection, this, fd);
+        }
+    });
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        finishedCondition.wait(lock, [this]() { return leases.isFinished(); });
+        stopping = true;
+    }
+    finishedCondition.notify_all();
+    SocketChannel::closeDescriptor(listenFd);
+    acceptor.join();
+    reaper.join();
+    {
+        // Workers get "finished" for their next lease request, whoever is still busy after a grace period is cut off
+        std::unique_lock<std::mutex> lock(mutex);
+        finishedCondition.wait_for(lock, std::min<std::chrono::milliseconds>(leaseDuration, std::chrono::seconds(5)),
+            [this]() { return connections.empty(); });
+        for (int fd : connections) {
+            SocketChannel::interrupt(fd);
+        }
+    }
+    for (auto& handler : handlers) {
+        handler.join();
+    }
+    return completedTasks;
+}
+
+void Coordinator::expireLeases() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        finishedCondition.wait_for(lock, leaseDuration / 4);
+        for (const auto& lease : leases.expire(LeaseTable::Clock::now())) {
+            std::cerr << "Warning: Lease " << lease.id << " of worker " << lease.worker << " expired, "
+                      << lease.tasks.size() << " tasks requeued" << std::endl;
+        }
+    }
+}
+
+std::optional<std::string> Coordinator::hashOf(const std::string& path) {
+    std::lock_guard<std::mutex> lock(hashesMutex);
+    auto it = hashes.find(path);
+    if (it == hashes.end()) {
+        it = hashes.emplace(path, FileHash::compute(path)).first;
+    }
+    return it->second;
+}
+
+nlohmann::json Coordinator::describeLease(const LeaseTable::Lease& lease) {
+    nlohmann::json j;
+    j["event"] = "lease";
+    j["lease"] = lease.id;
+    j["tasks"] = nlohmann::json::array();
+    for (size_t index : lease.tasks) {
+        const BacktestTask& task = tasks[index];
+        nlohmann::json description;
+        description["task"] = index;
+        description["job"] = jobIndexes[index];
+        description["start"] = task.window.startTime;
+        description["end"] = task.window.endTime;
+        // The week file follows the coordinator's calendar date, not the worker's local time
+        description["date"] = TimeUtils::toFields(task.window.start);
+        description["data"] = nlohmann::json::array();
+        std::vector<std::string> symbols = task.job->symbols;
+        symbols.insert(symbols.end(), task.job->conversionSymbols.begin(), task.job->conversionSymbols.end());
+        for (const auto& symbol : symbols) {
+            for (const auto& path : ratesStorageProvider.getWeekDataPaths(symbol, task.window.start)) {
+                auto hash = hashOf(path);
+                // A null hash tells the worker the file must not exist
+                description["data"].push_back({ { "path", path }, { "hash", hash.has_value() ? nlohmann::json(hash.value()) : nlohmann::json() } });
+            }
+        }
+        j["tasks"].push_back(description);
+    }
+    return j;
+}
+
+void Coordinator::handleConnection(int fd) {
+    SocketChannel channel(fd);
+    std::string worker;
+    auto line = channel.readLine();
+    while (line.has_value()) {
+        nlohmann::json request = nlohmann::json::parse(line.value(), nullptr, false);
+        std::string command = request.is_object() ? request.value("command", "") : "";
+        if (command == "hello") {
+            worker = request.value("worker", "worker-" + std::to_string(fd));
+            nlohmann::json welcome;
+            welcome["event"] = "welcome";
+            welcome["sweep"] = nlohmann::json::parse(SweepSpecParser::serialize(spec));
+            welcome["historyPath"] = historyPath;
+            // Workers must align higher timeframe bars to the same session as the coordinator
+            welcome["sessionStartMinutes"] = ratesStorageProvider.getSessionOffset() / 60;
+            auto barStore = ratesStorageProvider.getBarStorePath();
+            welcome["barStore"] = barStore.has_value() ? nlohmann::json(barStore.value()) : nlohmann::json();
+            welcome["heartbeatSeconds"] = std::max<long long>(1, std::chrono::duration_cast<std::chrono::seconds>(leaseDuration).count() / 3);
+            std::cout << "Worker " << worker << " connected" << std::endl;
+            channel.sendLine(welcome.dump());
+        } else if (command == "lease") {
+            std::optional<LeaseTable::Lease> lease;
+            bool finished = false;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                finished = leases.isFinished();
+                if (!finished) {
+                    lease = leases.acquire(worker, LeaseTable::Clock::now());
+                }
+            }
+            if (lease.has_value()) {
+                channel.sendLine(describeLease(lease.value()).dump());
+            } else {
+                channel.sendLine(finished ? "{\"event\":\"finished\"}" : "{\"event\":\"wait\"}");
+            }
+        } else if (command == "heartbeat") {
+            std::lock_guard<std::mutex> lock(mutex);
+            leases.heartbeat(worker, LeaseTable::Clock::now());
+        } else if (command == "result") {
+            size_t index = request.value("task", static_cast<size_t>(0));
+            std::lock_guard<std::mutex> lock(mutex);
+            if (index < tasks.size() && leases.finish(request.value("lease", static_cast<size_t>(0)), index)) {
+                TaskResult taskResult = TaskResultJson::parse(request);
+                if (taskResult.completed) {
+                    completedTasks++;
+                }
+                nlohmann::json result = TaskResultJson::describe(tasks[index], taskResult);
+                result["task"] = index;
+                result["worker"] = worker;
+                results << result.dump() << std::endl;
+                if (leases.isFinished()) {
+                    finishedCondition.notify_all();
+                }
+            }
+        }
+        line = channel.readLine();
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    connections.erase(fd);
+    finishedCondition.notify_all();
+    if (!worker.empty()) {
+        for (const auto& lease : leases.release(worker)) {
+            std::cerr << "Warning: Worker " << worker << " disconnected, " << lease.tasks.size() << " tasks of lease " << lease.id << " requeued" << std::endl;
+        }
+    }
+}
@@ -0,0 +1,63 @@
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <optional>
+#include <ostream>
+#include <chrono>
+#include <nlohmann/json.hpp>
+#include "BacktestJob.h"
+#include "LeaseTable.h"
+#include "RatesStorageProvider.h"
+#include "SweepSpec.h"
+#include "SocketChannel.h"
+
+#pragma once
+
+// Hands the tasks of a sweep to remote workers over TCP, newline-delimited JSON:
+//   worker: {"command": "hello", "worker": NAME}
+//   coordinator: {"event": "welcome", "sweep": {...}, "historyPath": PATH, "sessionStartMinutes": N,
+//                "barStore": PATH or null, "heartbeatSeconds": N}
+//   worker: {"command": "lease"}
+//   coordinator: {"event": "lease", "lease": ID, "tasks": [{"task", "job", "start", "end", "date", "data": [{"path", "hash"}]}]}
+//                or {"event": "wait"} while other workers hold the remaining tasks, or {"event": "finished"}
+//   worker: {"command": "heartbeat"}, {"command": "result", "lease": ID, "task": N, ...}
+// Workers plan the same sweep from the shared history, so a task only carries the job index and
+// its window. The files a task reads, week files or bar store columns, are referenced by path on the
+// shared storage together with a content hash.
+class Coordinator {
+    SweepSpec spec;
+    std::vector<BacktestTask> tasks;
+    std::vector<size_t> jobIndexes;
+    std::string historyPath;
+    RatesStorageProvider& ratesStorageProvider;
+    std::chrono::milliseconds leaseDuration;
+    std::ostream& results;
+
+    std::mutex mutex;
+    std::condition_variable finishedCondition;
+    LeaseTable leases;
+    size_t completedTasks;
+    std::mutex hashesMutex;
+    std::map<std::string, std::optional<std::string>> hashes;
+
+    int listenFd;
+    std::atomic<bool> stopping;
+    std::set<int> connections;
+public:
+    Coordinator(const SweepSpec& spec, const std::vector<BacktestTask>& tasks, const std::string& historyPath, RatesStorageProvider& ratesStorageProvider,
+        size_t shardSize, std::chrono::milliseconds leaseDuration, std::ostream& results);
+    // Binds the listening socket, port 0 picks a free one
+    bool listen(int port);
+    int port() const;
+    // Serves workers until every task has a result, returns the number of completed backtests
+    size_t run();
+private:
+    void handleConnection(int fd);
+    nlohmann::json describeLease(const LeaseTable::Lease& lease);
+    std::optional<std::string> hashOf(const std::string& path);
+    void expireLeases();
+};
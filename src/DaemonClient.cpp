@@ -0,0 +1,34 @@
+#include "DaemonClient.h"
+#include <iostream>
+#include <nlohmann/json.hpp>
+#include "SocketChannel.h"
+
+int DaemonClient::request(const std::string& socketPath, const std::string& requestLine) {
+    int fd = SocketChannel::connectUnix(socketPath);
+    if (fd < 0) {
+        std::cerr << "Error: Failed to connect to daemon at " << socketPath << std::endl;
+        return 1;
+    }
+    SocketChannel channel(fd);
+    if (!channel.sendLine(requestLine)) {
+        std::cerr << "Error: Failed to send request to daemon" << std::endl;
+        return 1;
+    }
+    bool answered = false;
+    auto line = channel.readLine();
+    while (line.has_value()) {
+        std::cout << line.value() << std::endl;
+        nlohmann::json message = nlohmann::json::parse(line.value(), nullptr, false);
+        std::string event = message.is_object() ? message.value("event", "") : "";
+        if (event == "error") {
+            return 1;
+        }
+        if (event == "done" || event == "status") {
+            return 0;
+        }
+        answered = true;
+        line = channel.readLine();
+    }
+    // A detached submission is answered by its acceptance alone
+    return answered ? 0 : 1;
+}
@@ -0,0 +1,10 @@
+#include <string>
+
+#pragma once
+
+// Client side of the daemon socket: sends one request and prints every event line it receives
+class DaemonClient {
+public:
+    // Returns 0 once the daemon answered, 1 on errors or when the connection is lost before any answer
+    static int request(const std::string& socketPath, const std::string& requestLine);
+};
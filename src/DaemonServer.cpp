@@ -0,0 +1,241 @@
+#include "DaemonServer.h"
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <nlohmann/json.hpp>
+#include "JobPlanner.h"
+#include "SweepSpec.h"
+#include "TaskExecutor.h"
+#include "TaskResultJson.h"
+#include "BarResampler.h"
+
+namespace {
+    nlohmann::json describeResult(size_t submission, size_t index, const BacktestTask& task, const TaskResult& result) {
+        nlohmann::json j = TaskResultJson::describe(task, result);
+        j["event"] = "result";
+        j["submission"] = submission;
+        j["task"] = index;
+        return j;
+    }
+
+    std::string errorMessage(const std::string& message) {
+        nlohmann::json j;
+        j["event"] = "error";
+        j["message"] = message;
+        return j.dump();
+    }
+}
+
+DaemonServer::DaemonServer(const std::string& socketPath, const std::string& pathToBacktester, RatesStorageProvider& ratesStorageProvider, int workerCount)
+    : ratesStorageProvider(ratesStorageProvider), preparedData(ratesStorageProvider), stopping(false) {
+    this->socketPath = socketPath;
+    this->pathToBacktester = pathToBacktester;
+    this->workerCount = workerCount;
+    this->listenFd = -1;
+    this->nextHandler = 0;
+}
+
+int DaemonServer::run() {
+    listenFd = SocketChannel::listenUnix(socketPath);
+    if (listenFd < 0) {
+        std::cerr << "Error: Failed to listen on " << socketPath << ": "
+                  << (errno == EADDRINUSE ? "another daemon is already running" : std::strerror(errno)) << std::endl;
+        return 1;
+    }
+    // Warm the symbol catalog before the first submission arrives
+    ratesStorageProvider.getSymbolInfo("");
+    // Prepared files are dropped whenever the daemon runs out of work
+    scheduler.setIdleCallback([this]() { preparedData.clear(); });
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < workerCount; i++) {
+        workers.emplace_back(&DaemonServer::workerLoop, this, i);
+    }
+    std::cout << "Daemon listening on " << socketPath << " with " << workerCount << " workers" << std::endl;
+
+    while (!stopping) {
+        int fd = SocketChannel::accept(listenFd);
+        if (fd < 0) {
+            break;
+        }
+        joinFinishedHandlers();
+        std::lock_guard<std::mutex> lock(connectionsMutex);
+        connections.insert(fd);
+        size_t handler = nextHandler++;
+        handlers.emplace(handler, std::thread(&DaemonServer::handleConnection, this, fd, handler));
+    }
+
+    stop();
+    std::map<size_t, std::thread> remaining;
+    {
+        std::lock_guard<std::mutex> lock(connectionsMutex);
+        remaining.swap(handlers);
+    }
+    for (auto& handler : remaining) {
+        handler.second.join();
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    std::remove(socketPath.c_str());
+    std::cout << "Daemon stopped" << std::endl;
+    return 0;
+}
+
+void DaemonServer::stop() {
+    if (stopping.exchange(true)) {
+        return;
+    }
+    scheduler.shutdown();
+    SocketChannel::closeDescriptor(listenFd);
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    // Each handler closes its own descriptor, here they are only woken up
+    for (int fd : connections) {
+        SocketChannel::interrupt(fd);
+    }
+}
+
+void DaemonServer::joinFinishedHandlers() {
+    std::vector<std::thread> finished;
+    {
+        std::lock_guard<std::mutex> lock(connectionsMutex);
+        for (size_t handler : finishedHandlers) {
+            auto it = handlers.find(handler);
+            finished.push_back(std::move(it->second));
+            handlers.erase(it);
+        }
+        finishedHandlers.clear();
+    }
+    // Each of them has already left handleConnection, so the joins return at once
+    for (auto& thread : finished) {
+        thread.join();
+    }
+}
+
+void DaemonServer::workerLoop(int workerIndex) {
+    ConsoleBacktester backtester(pathToBacktester, std::to_string(workerIndex + 1));
+    TaskExecutor executor(preparedData);
+    auto scheduledTask = scheduler.next();
+    while (scheduledTask.has_value()) {
+        TaskResult result = executor.execute(scheduledTask.value().task, backtester);
+        scheduler.complete(scheduledTask.value(), result);
+        scheduledTask = scheduler.next();
+    }
+}
+
+void DaemonServer::handleConnection(int fd, size_t handler) {
+    SocketChannel channel(fd);
+    auto request = channel.readLine();
+    if (request.has_value()) {
+        try {
+            nlohmann::json j = nlohmann::json::parse(request.value());
+            std::string command = j.value("command", "");
+            if (command == "submit") {
+                handleSubmit(channel, request.value());
+            } else if (command == "results") {
+                streamResults(channel, j.value("submission", static_cast<size_t>(0)), false);
+            } else if (command == "status") {
+                nlohmann::json response;
+                response["event"] = "status";
+                response["submissions"] = nlohmann::json::array();
+                for (const auto& status : scheduler.status()) {
+                    response["submissions"].push_back({
+                        { "submission", status.id }, { "owner", status.owner }, { "total", status.total },
+                        { "running", status.running }, { "finished", status.finished } });
+                }
+                channel.sendLine(response.dump());
+            } else if (command == "shutdown") {
+                channel.sendLine("{\"event\":\"done\"}");
+                stop();
+            } else {
+                channel.sendLine(errorMessage("Unknown command: " + command));
+            }
+        } catch (const std::exception& e) {
+            channel.sendLine(errorMessage(e.what()));
+        }
+    }
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    connections.erase(fd);
+    finishedHandlers.push_back(handler);
+}
+
+void DaemonServer::handleSubmit(SocketChannel& channel, const std::string& request) {
+    nlohmann::json j = nlohmann::json::parse(request);
+    if (!j.contains("sweep")) {
+        channel.sendLine(errorMessage("Submission has no sweep"));
+        return;
+    }
+    SweepSpec spec = SweepSpecParser::parse(j["sweep"].dump());
+    if (!BarResampler::parsePeriod(spec.period).has_value()) {
+        channel.sendLine(errorMessage("Unsupported period: " + spec.period));
+        return;
+    }
+    JobPlanner planner(ratesStorageProvider);
+    auto jobs = planner.planSweep(spec);
+    if (!jobs.has_value()) {
+        channel.sendLine(errorMessage("Unknown symbol or missing conversion pair in sweep"));
+        return;
+    }
+    auto tasks = JobPlanner::planTasks(jobs.value(), JobPlanner::planWindows(std::time(nullptr)));
+    size_t submission = scheduler.submit(spec.owner, tasks);
+
+    nlohmann::json accepted;
+    accepted["event"] = "accepted";
+    accepted["submission"] = submission;
+    accepted["total"] = tasks.size();
+    channel.sendLine(accepted.dump());
+    if (j.value("follow", true)) {
+        streamResults(channel, submission, true);
+    }
+}
+
+void DaemonServer::streamResults(SocketChannel& channel, size_t submission, bool follow) {
+    size_t cursor = 0;
+    size_t completed = 0;
+    while (true) {
+        FairShareScheduler::Results results;
+        auto status = scheduler.waitForResults(submission, cursor, results, std::chrono::milliseconds(follow ? 1000 : 0));
+        if (!status.has_value()) {
+            if (scheduler.isExpired(submission)) {
+                channel.sendLine(errorMessage("Submission " + std::to_string(submission)
+                    + " expired: its results were already fetched or kept past the retention limit"));
+            } else {
+                channel.sendLine(errorMessage("Unknown submission: " + std::to_string(submission)));
+            }
+            return;
+        }
+        cursor += results.size();
+        for (const auto& result : results) {
+            auto task = scheduler.findTask(submission, result.first);
+            if (result.second.completed) {
+                completed++;
+            }
+            if (!task.has_value() || !channel.sendLine(describeResult(submission, result.first, task.value(), result.second).dump())) {
+                return;
+            }
+        }
+        bool finished = status.value().finished == status.value().total;
+        if (!follow || finished || stopping) {
+            nlohmann::json done;
+            done["event"] = "done";
+            done["submission"] = submission;
+            done["finished"] = status.value().finished;
+            done["completed"] = completed;
+            done["total"] = status.value().total;
+            if (channel.sendLine(done.dump()) && finished && cursor == status.value().total) {
+                // Every result reached the client
+                scheduler.release(submission);
+            }
+            return;
+        }
+        nlohmann::json progress;
+        progress["event"] = "progress";
+        progress["submission"] = submission;
+        progress["finished"] = status.value().finished;
+        progress["total"] = status.value().total;
+        if (!channel.sendLine(progress.dump())) {
+            return;
+        }
+    }
+}
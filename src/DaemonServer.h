@@ -0,0 +1,51 @@
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include "RatesStorageProvider.h"
+#include "PreparedDataCache.h"
+#include "FairShareScheduler.h"
+#include "SocketChannel.h"
+
+#pragma once
+
+// Long-lived mode: keeps the symbol catalog, prepared data and worker pool warm and accepts
+// sweep submissions as newline-delimited JSON on a Unix domain socket.
+//
+// Requests:
+//   {"command": "submit", "sweep": {...}, "follow": true}  streams results and progress until done
+//   {"command": "results", "submission": N}                 replays the results collected so far
+//
+// A submission is dropped once a client received all of its results, or a day after it finished.
+//   {"command": "status"}                                   lists submissions
+//   {"command": "shutdown"}
+class DaemonServer {
+    std::string socketPath;
+    std::string pathToBacktester;
+    RatesStorageProvider& ratesStorageProvider;
+    PreparedDataCache preparedData;
+    FairShareScheduler scheduler;
+    int workerCount;
+    int listenFd;
+    std::atomic<bool> stopping;
+    std::mutex connectionsMutex;
+    std::set<int> connections;
+    // Connection handlers by id, the ids of those that returned wait in finishedHandlers to be joined
+    std::map<size_t, std::thread> handlers;
+    std::vector<size_t> finishedHandlers;
+    size_t nextHandler;
+public:
+    DaemonServer(const std::string& socketPath, const std::string& pathToBacktester, RatesStorageProvider& ratesStorageProvider, int workerCount);
+    // Serves until a shutdown request arrives, returns the process exit code
+    int run();
+private:
+    void workerLoop(int workerIndex);
+    void handleConnection(int fd, size_t handler);
+    void joinFinishedHandlers();
+    void handleSubmit(SocketChannel& channel, const std::string& request);
+    void streamResults(SocketChannel& channel, size_t submission, bool follow);
+    void stop();
+};
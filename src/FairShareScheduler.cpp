@@ -0,0 +1,177 @@
+#include "FairShareScheduler.h"
+#include <tuple>
+
+FairShareScheduler::FairShareScheduler(std::chrono::seconds retention) {
+    this->nextSubmissionId = 1;
+    this->retention = retention;
+    this->stopped = false;
+}
+
+size_t FairShareScheduler::submit(const std::string& owner, const std::vector<BacktestTask>& tasks) {
+    std::lock_guard<std::mutex> lock(mutex);
+    evictExpired();
+    size_t id = nextSubmissionId++;
+    Submission& submission = submissions[id];
+    submission.owner = owner;
+    submission.tasks = tasks;
+    submission.finishedAt = std::chrono::steady_clock::now();
+    owners[owner];
+    tasksAvailable.notify_all();
+    resultsAvailable.notify_all();
+    return id;
+}
+
+std::optional<FairShareScheduler::ScheduledTask> FairShareScheduler::next() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        if (stopped) {
+            return std::nullopt;
+        }
+        // Pick the least served owner that has pending work, then its least busy submission
+        Submission* best = nullptr;
+        size_t bestId = 0;
+        for (auto& entry : submissions) {
+            Submission& submission = entry.second;
+            if (submission.nextTask >= submission.tasks.size()) {
+                continue;
+            }
+            if (best == nullptr) {
+                best = &submission;
+                bestId = entry.first;
+                continue;
+            }
+            const Owner& candidate = owners[submission.owner];
+            const Owner& current = owners[best->owner];
+            if (std::make_tuple(candidate.running, candidate.served, submission.running)
+                < std::make_tuple(current.running, current.served, best->running)) {
+                best = &submission;
+                bestId = entry.first;
+            }
+        }
+        if (best != nullptr) {
+            ScheduledTask scheduledTask;
+            scheduledTask.submission = bestId;
+            scheduledTask.index = best->nextTask++;
+            scheduledTask.task = best->tasks[scheduledTask.index];
+            best->running++;
+            Owner& owner = owners[best->owner];
+            owner.running++;
+            owner.served++;
+            return scheduledTask;
+        }
+        tasksAvailable.wait(lock);
+    }
+}
+
+void FairShareScheduler::complete(const ScheduledTask& scheduledTask, const TaskResult& result) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = submissions.find(scheduledTask.submission);
+    if (it != submissions.end()) {
+        it->second.running--;
+        it->second.results.emplace_back(scheduledTask.index, result);
+        owners[it->second.owner].running--;
+        if (it->second.results.size() == it->second.tasks.size()) {
+            it->second.finishedAt = std::chrono::steady_clock::now();
+        }
+    }
+    if (idleCallback && isIdle()) {
+        idleCallback();
+    }
+    resultsAvailable.notify_all();
+}
+
+void FairShareScheduler::setIdleCallback(const std::function<void()>& callback) {
+    std::lock_guard<std::mutex> lock(mutex);
+    idleCallback = callback;
+}
+
+bool FairShareScheduler::isIdle() const {
+    for (const auto& entry : submissions) {
+        if (entry.second.running > 0 || entry.second.nextTask < entry.second.tasks.size()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+FairShareScheduler::SubmissionStatus FairShareScheduler::statusOf(size_t id, const Submission& submission) const {
+    SubmissionStatus status;
+    status.id = id;
+    status.owner = submission.owner;
+    status.total = submission.tasks.size();
+    status.running = submission.running;
+    status.finished = submission.results.size();
+    return status;
+}
+
+std::optional<FairShareScheduler::SubmissionStatus> FairShareScheduler::waitForResults(size_t submission, size_t cursor, Results& results, std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex);
+    auto it = submissions.find(submission);
+    if (it == submissions.end()) {
+        return std::nullopt;
+    }
+    // Looked up again after every wake-up, another connection may have released the submission
+    resultsAvailable.wait_for(lock, timeout, [&]() {
+        it = submissions.find(submission);
+        return stopped || it == submissions.end() || it->second.results.size() > cursor || it->second.results.size() == it->second.tasks.size();
+    });
+    if (it == submissions.end()) {
+        return std::nullopt;
+    }
+    for (size_t i = cursor; i < it->second.results.size(); i++) {
+        results.push_back(it->second.results[i]);
+    }
+    return statusOf(submission, it->second);
+}
+
+std::vector<FairShareScheduler::SubmissionStatus> FairShareScheduler::status() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<SubmissionStatus> result;
+    for (const auto& entry : submissions) {
+        result.push_back(statusOf(entry.first, entry.second));
+    }
+    return result;
+}
+
+std::optional<BacktestTask> FairShareScheduler::findTask(size_t submission, size_t index) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = submissions.find(submission);
+    if (it == submissions.end() || index >= it->second.tasks.size()) {
+        return std::nullopt;
+    }
+    // A copy, the submission may be released by another connection meanwhile
+    return it->second.tasks[index];
+}
+
+void FairShareScheduler::release(size_t submission) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = submissions.find(submission);
+    if (it != submissions.end() && it->second.results.size() == it->second.tasks.size()) {
+        submissions.erase(it);
+        resultsAvailable.notify_all();
+    }
+}
+
+bool FairShareScheduler::isExpired(size_t submission) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return submission > 0 && submission < nextSubmissionId && submissions.find(submission) == submissions.end();
+}
+
+void FairShareScheduler::evictExpired() {
+    auto now = std::chrono::steady_clock::now();
+    for (auto it = submissions.begin(); it != submissions.end();) {
+        bool finished = it->second.results.size() == it->second.tasks.size();
+        if (finished && now - it->second.finishedAt >= retention) {
+            it = submissions.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void FairShareScheduler::shutdown() {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopped = true;
+    tasksAvailable.notify_all();
+    resultsAvailable.notify_all();
+}
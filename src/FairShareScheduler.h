@@ -0,0 +1,85 @@
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <optional>
+#include <chrono>
+#include "BacktestJob.h"
+#include "TaskExecutor.h"
+
+#pragma once
+
+// Shares workers between submissions. The next task always goes to the owner with the fewest
+// running tasks (ties broken by fewest tasks served), so one large sweep cannot starve others.
+class FairShareScheduler {
+public:
+    class ScheduledTask {
+    public:
+        size_t submission;
+        size_t index;
+        BacktestTask task;
+    };
+
+    class SubmissionStatus {
+    public:
+        size_t id;
+        std::string owner;
+        size_t total = 0;
+        size_t running = 0;
+        size_t finished = 0;
+    };
+
+    // Results in completion order, as (task index, result)
+    typedef std::vector<std::pair<size_t, TaskResult>> Results;
+
+    // Finished submissions whose results were never fetched are dropped after retention
+    explicit FairShareScheduler(std::chrono::seconds retention = std::chrono::hours(24));
+    size_t submit(const std::string& owner, const std::vector<BacktestTask>& tasks);
+    // Blocks until a task is available, returns nothing after shutdown
+    std::optional<ScheduledTask> next();
+    void complete(const ScheduledTask& scheduledTask, const TaskResult& result);
+    // Called with the scheduler locked whenever the last running task finishes and nothing is pending
+    void setIdleCallback(const std::function<void()>& callback);
+    // Waits until results beyond cursor exist, the submission is finished or the timeout passes.
+    // Returns nothing for unknown submissions.
+    std::optional<SubmissionStatus> waitForResults(size_t submission, size_t cursor, Results& results, std::chrono::milliseconds timeout);
+    std::vector<SubmissionStatus> status();
+    std::optional<BacktestTask> findTask(size_t submission, size_t index);
+    // Drops a submission whose every result was delivered; unfinished submissions are kept
+    void release(size_t submission);
+    // True for submissions that existed and were dropped, by release or after retention
+    bool isExpired(size_t submission);
+    void shutdown();
+private:
+    class Submission {
+    public:
+        std::string owner;
+        std::vector<BacktestTask> tasks;
+        size_t nextTask = 0;
+        size_t running = 0;
+        Results results;
+        std::chrono::steady_clock::time_point finishedAt;
+    };
+
+    class Owner {
+    public:
+        size_t running = 0;
+        size_t served = 0;
+    };
+
+    std::mutex mutex;
+    std::condition_variable tasksAvailable;
+    std::condition_variable resultsAvailable;
+    std::map<size_t, Submission> submissions;
+    std::map<std::string, Owner> owners;
+    size_t nextSubmissionId;
+    std::chrono::seconds retention;
+    bool stopped;
+    std::function<void()> idleCallback;
+
+    SubmissionStatus statusOf(size_t id, const Submission& submission) const;
+    bool isIdle() const;
+    void evictExpired();
+};
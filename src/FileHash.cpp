@@ -0,0 +1,46 @@
+#include "FileHash.h"
+#include <fstream>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+    const uint64_t FnvPrime = 1099511628211ULL;
+}
+
+const uint64_t FileHash::FnvOffsetBasis;
+
+uint64_t FileHash::fnv1a(const void* data, size_t size, uint64_t state) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        state = (state ^ bytes[i]) * FnvPrime;
+    }
+    return state;
+}
+
+uint64_t FileHash::fnv1aWords(const void* data, size_t size, uint64_t state) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, bytes + i, sizeof(word));
+        state = (state ^ word) * FnvPrime;
+    }
+    return fnv1a(bytes + i, size - i, state);
+}
+
+std::optional<std::string> FileHash::compute(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return std::nullopt;
+    }
+    uint64_t hash = FnvOffsetBasis;
+    std::vector<char> buffer(1 << 16);
+    while (file) {
+        file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        hash = fnv1a(buffer.data(), static_cast<size_t>(file.gcount()), hash);
+    }
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+    return std::string(hex);
+}
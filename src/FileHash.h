@@ -0,0 +1,20 @@
+#include <string>
+#include <optional>
+#include <cstddef>
+#include <cstdint>
+
+#pragma once
+
+// Content fingerprint used to check that nodes see the same file on shared storage
+class FileHash {
+public:
+    // 64-bit FNV-1a of the file content as 16 hex digits, nothing if the file cannot be read
+    static std::optional<std::string> compute(const std::string& path);
+
+    static const uint64_t FnvOffsetBasis = 14695981039346656037ULL;
+    // 64-bit FNV-1a of size bytes; pass a previous result as state to continue the hash over more data
+    static uint64_t fnv1a(const void* data, size_t size, uint64_t state = FnvOffsetBasis);
+    // The same step over 64-bit words, then the remaining bytes; eight times fewer multiplications
+    // but a different value than fnv1a
+    static uint64_t fnv1aWords(const void* data, size_t size, uint64_t state = FnvOffsetBasis);
+};
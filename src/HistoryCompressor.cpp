@@ -0,0 +1,134 @@
+#include "HistoryCompressor.h"
+#include "BarCodec.h"
+#include "SymbolInfoParser.h"
+#include "TickBarReader.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+
+namespace {
+    bool sameBars(const BarColumns& left, const BarColumns& right) {
+        return left.time == right.time && left.bidOpen == right.bidOpen && left.bidHigh == right.bidHigh && left.bidLow == right.bidLow
+            && left.bidClose == right.bidClose && left.askOpen == right.askOpen && left.askHigh == right.askHigh
+            && left.askLow == right.askLow && left.askClose == right.askClose && left.volume == right.volume;
+    }
+}
+
+HistoryCompressor::HistoryCompressor(const Settings& settings) {
+    this->settings = settings;
+}
+
+bool HistoryCompressor::readWeek(const std::string& path, HistoryFormat format, BarColumns& bars, StorageReadErrors& errors) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    readWeek(file, format, bars, errors);
+    return true;
+}
+
+void HistoryCompressor::readWeek(std::istream& input, HistoryFormat format, BarColumns& bars, StorageReadErrors& errors) {
+    if (format == HistoryFormat::Tick) {
+        TickBarReader reader(input, 60, 0);
+        while (reader.readChunk(bars)) {
+        }
+        errors = reader.errors();
+        return;
+    }
+    HistoryFormats::visit(format, [&](auto dialect) {
+        Data data;
+        while (StorageReader::readNext<decltype(dialect)>(input, data, errors)) {
+            bars.push(data);
+        }
+    });
+}
+
+CompressReport HistoryCompressor::compress(const std::string& historyPath, const std::string& outputPath) {
+    class WeekFile {
+    public:
+        std::string path;
+        std::string target;
+        std::string file;
+        HistoryFormat format;
+    };
+    std::vector<WeekFile> files;
+    std::error_code error;
+    std::filesystem::path output(outputPath);
+    bool inPlace = std::filesystem::equivalent(historyPath, outputPath, error);
+    for (const auto& directory : std::filesystem::directory_iterator(historyPath, error)) {
+        if (!directory.is_directory()) {
+            continue;
+        }
+        std::string symbol = directory.path().filename().string();
+        std::filesystem::create_directories(output / symbol, error);
+        HistoryFormat format = HistoryFormat::Standard;
+        auto infoPath = directory.path() / "info.json";
+        if (std::filesystem::exists(infoPath, error)) {
+            try {
+                format = SymbolInfoParser::parse(infoPath.string()).historyFormat;
+            } catch (const std::exception& e) {
+                std::cerr << "Warning: Failed to parse symbol info " << infoPath.string() << ": " << e.what() << std::endl;
+            }
+            if (!inPlace) {
+                std::filesystem::copy_file(infoPath, output / symbol / "info.json", std::filesystem::copy_options::overwrite_existing, error);
+            }
+        }
+        for (const auto& entry : std::filesystem::directory_iterator(directory.path(), error)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".csv") {
+                std::string name = entry.path().stem().string();
+                files.push_back({ entry.path().string(), (output / symbol / (name + ".fxb")).string(), symbol + "/" + entry.path().filename().string(), format });
+            }
+        }
+    }
+    std::filesystem::path quarantine = std::filesystem::path(historyPath) / "quarantine.txt";
+    if (!inPlace && std::filesystem::exists(quarantine, error)) {
+        std::filesystem::copy_file(quarantine, output / "quarantine.txt", std::filesystem::copy_options::overwrite_existing, error);
+    }
+    std::sort(files.begin(), files.end(), [](const WeekFile& a, const WeekFile& b) { return a.file < b.file; });
+
+    CompressReport report;
+    std::mutex reportMutex;
+    std::vector<std::string> paths;
+    for (const auto& file : files) {
+        paths.push_back(file.path);
+    }
+    BulkReader::Settings io;
+    io.backend = settings.io;
+    io.queueDepth = settings.queueDepth;
+    io.parserThreads = std::min<size_t>(std::max<size_t>(1, settings.threads), std::max<size_t>(1, files.size()));
+    BulkReader(io).read(paths, [&](size_t i, const char* data, size_t size, bool ok) {
+        BarColumns bars;
+        StorageReadErrors errors;
+        MemoryStream input(data, size);
+        if (ok) {
+            readWeek(input, files[i].format, bars, errors);
+        }
+        bool written = ok && BarCodec::writeFile(files[i].target, bars);
+        double seconds = 0;
+        if (written && settings.verify) {
+            BarColumns decoded;
+            auto started = std::chrono::steady_clock::now();
+            written = BarCodec::readFile(files[i].target, decoded) && sameBars(bars, decoded);
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        }
+        std::error_code sizeError;
+        auto outputBytes = written ? std::filesystem::file_size(files[i].target, sizeError) : 0;
+
+        std::lock_guard<std::mutex> lock(reportMutex);
+        if (!written) {
+            report.failedFiles.push_back(files[i].file);
+            return;
+        }
+        report.files++;
+        report.bars += bars.size();
+        report.malformedLines += errors.total();
+        report.inputBytes += size;
+        report.outputBytes += static_cast<size_t>(outputBytes);
+        report.decodeSeconds += seconds;
+    });
+    std::sort(report.failedFiles.begin(), report.failedFiles.end());
+    return report;
+}
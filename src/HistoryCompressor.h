@@ -0,0 +1,48 @@
+#include <string>
+#include <vector>
+#include <cstddef>
+#include "BarColumns.h"
+#include "HistoryDialect.h"
+#include "StorageReader.h"
+#include "BulkReader.h"
+
+#pragma once
+
+class CompressReport {
+public:
+    size_t files = 0;
+    size_t bars = 0;
+    size_t malformedLines = 0;
+    // Raw week files read and compressed files written
+    size_t inputBytes = 0;
+    size_t outputBytes = 0;
+    // Relative to the history root, files that could not be read, written or verified
+    std::vector<std::string> failedFiles;
+    // Time spent decoding the written files again, summed over threads; 0 without verification
+    double decodeSeconds = 0;
+};
+
+// Converts every <symbol>/<year>-<week>.csv of a history tree into a BarCodec <year>-<week>.fxb,
+// one file per task on a pool of threads. RatesStorageProvider reads the compressed week when the raw one is absent.
+class HistoryCompressor {
+public:
+    class Settings {
+    public:
+        size_t threads = 1;
+        // Decodes each written file and compares it with the bars it was made from
+        bool verify = false;
+        // How the week files are read, see BulkReader
+        IoBackend io = IoBackend::Auto;
+        size_t queueDepth = 32;
+    };
+
+    explicit HistoryCompressor(const Settings& settings);
+    // Writes the compressed tree to outputPath, which may be historyPath itself.
+    // info.json of each symbol and the quarantine list are copied along.
+    CompressReport compress(const std::string& historyPath, const std::string& outputPath);
+    // Appends the m1 bars of a week file in format, ticks aggregated to minutes
+    static bool readWeek(const std::string& path, HistoryFormat format, BarColumns& bars, StorageReadErrors& errors);
+    static void readWeek(std::istream& input, HistoryFormat format, BarColumns& bars, StorageReadErrors& errors);
+private:
+    Settings settings;
+};
@@ -0,0 +1,31 @@
+#include "HistoryDialect.h"
+
+namespace {
+    const HistoryFormat Formats[] = { HistoryFormat::Standard, HistoryFormat::DotDecimal, HistoryFormat::Iso,
+        HistoryFormat::BidOnly, HistoryFormat::Tick };
+}
+
+std::optional<HistoryFormat> HistoryFormats::parse(const std::string& name) {
+    for (HistoryFormat format : Formats) {
+        if (name == HistoryFormats::name(format)) {
+            return format;
+        }
+    }
+    return std::nullopt;
+}
+
+const char* HistoryFormats::name(HistoryFormat format) {
+    switch (format) {
+    case HistoryFormat::Standard:
+        return "Standard";
+    case HistoryFormat::DotDecimal:
+        return "DotDecimal";
+    case HistoryFormat::Iso:
+        return "Iso";
+    case HistoryFormat::BidOnly:
+        return "BidOnly";
+    case HistoryFormat::Tick:
+        return "Tick";
+    }
+    return "Standard";
+}
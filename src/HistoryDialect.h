@@ -0,0 +1,76 @@
+#include <string>
+#include <optional>
+#include <cstddef>
+
+#pragma once
+
+enum class TimestampFormat {
+    // dd.mm.yyyy HH:MM:SS
+    DayMonthYear,
+    // yyyy-mm-dd HH:MM:SS or yyyy-mm-ddTHH:MM:SS, fractional seconds and a trailing Z are dropped
+    Iso
+};
+
+enum class HistoryLayout {
+    // time, bid open, high, low, close, ask open, high, low, close, volume
+    BidAsk,
+    // time, bid open, high, low, close, volume; the ask is the bid
+    BidOnly,
+    // time, bid, ask, volume; one tick per line, open, high, low and close are the price
+    Tick
+};
+
+// Describes a history CSV at compile time. StorageReader is templated on it,
+// so each dialect gets its own parsing loop without format checks per line.
+template <char Separator, char Decimal, TimestampFormat Timestamp, HistoryLayout Layout>
+class CsvDialect {
+public:
+    static constexpr char separator = Separator;
+    // ',' also accepts '.', '.' is parsed in place without copying the field
+    static constexpr char decimal = Decimal;
+    static constexpr TimestampFormat timestampFormat = Timestamp;
+    static constexpr HistoryLayout layout = Layout;
+    static constexpr size_t fieldCount = Layout == HistoryLayout::BidAsk ? 10 : Layout == HistoryLayout::BidOnly ? 6 : 4;
+};
+
+// The format the history has always been stored in
+using StandardDialect = CsvDialect<';', ',', TimestampFormat::DayMonthYear, HistoryLayout::BidAsk>;
+using DotDecimalDialect = CsvDialect<';', '.', TimestampFormat::DayMonthYear, HistoryLayout::BidAsk>;
+using IsoDialect = CsvDialect<',', '.', TimestampFormat::Iso, HistoryLayout::BidAsk>;
+using BidOnlyDialect = CsvDialect<';', ',', TimestampFormat::DayMonthYear, HistoryLayout::BidOnly>;
+using TickDialect = CsvDialect<',', '.', TimestampFormat::Iso, HistoryLayout::Tick>;
+
+// Runtime name of a dialect, set per symbol by "HistoryFormat" in info.json
+enum class HistoryFormat {
+    Standard,
+    DotDecimal,
+    Iso,
+    BidOnly,
+    Tick
+};
+
+class HistoryFormats {
+public:
+    // "Standard", "DotDecimal", "Iso", "BidOnly" or "Tick"; nothing for anything else
+    static std::optional<HistoryFormat> parse(const std::string& name);
+    static const char* name(HistoryFormat format);
+
+    // Calls visitor with a default-constructed dialect of format, so the caller's loop
+    // is instantiated once per dialect and the format is checked once per file
+    template <class Visitor>
+    static auto visit(HistoryFormat format, Visitor&& visitor) {
+        switch (format) {
+        case HistoryFormat::DotDecimal:
+            return visitor(DotDecimalDialect{});
+        case HistoryFormat::Iso:
+            return visitor(IsoDialect{});
+        case HistoryFormat::BidOnly:
+            return visitor(BidOnlyDialect{});
+        case HistoryFormat::Tick:
+            return visitor(TickDialect{});
+        case HistoryFormat::Standard:
+        default:
+            return visitor(StandardDialect{});
+        }
+    }
+};
@@ -0,0 +1,378 @@
+#include "HistoryIngestor.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <cstring>
+#include <cstdio>
+#include "BarStore.h"
+#include "FileHash.h"
+#include "SymbolInfoParser.h"
+#include "TickBarReader.h"
+
+namespace {
+    const char ManifestMagic[4] = { 'F', 'X', 'H', 'M' };
+    const uint32_t ManifestVersion = 1;
+    // Bytes before the parsed length hashed to recognize an appended file
+    const uint64_t TailHashBytes = 64;
+
+    template <typename T>
+    void writeValue(std::ofstream& file, const T& value) {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    bool readValue(std::ifstream& file, T& value) {
+        return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+
+    void writeString(std::ofstream& file, const std::string& value) {
+        writeValue(file, static_cast<uint32_t>(value.size()));
+        file.write(value.data(), value.size());
+    }
+
+    // Lengths from a corrupt file are checked against what is left of it before anything is allocated
+    bool readString(std::ifstream& file, uint64_t fileSize, std::string& value) {
+        uint32_t length = 0;
+        if (!readValue(file, length)) {
+            return false;
+        }
+        std::streamoff position = file.tellg();
+        if (position < 0 || static_cast<uint64_t>(position) + length > fileSize) {
+            return false;
+        }
+        value.resize(length);
+        return static_cast<bool>(file.read(value.data(), length));
+    }
+
+    // FNV-1a of the TailHashBytes before length
+    std::optional<uint64_t> tailHash(const std::string& path, uint64_t length) {
+        uint64_t begin = length > TailHashBytes ? length - TailHashBytes : 0;
+        std::ifstream file(path, std::ios::binary);
+        char buffer[TailHashBytes];
+        file.seekg(static_cast<std::streamoff>(begin));
+        if (!file.read(buffer, static_cast<std::streamsize>(length - begin))) {
+            return std::nullopt;
+        }
+        return FileHash::fnv1a(buffer, static_cast<size_t>(length - begin));
+    }
+
+    // <year>-<week>.csv as a sortable number, nothing for other names
+    std::optional<long long> weekOrder(const std::string& name) {
+        int year = 0;
+        int week = 0;
+        char tail[8] = {};
+        if (std::sscanf(name.c_str(), "%d-%d%7s", &year, &week, tail) != 3 || std::strcmp(tail, ".csv") != 0) {
+            return std::nullopt;
+        }
+        return static_cast<long long>(year) * 100 + week;
+    }
+}
+
+HistoryIngestor::HistoryIngestor(const std::string& historyPath, const std::string& storePath, size_t threads) {
+    this->historyPath = historyPath;
+    this->storePath = storePath;
+    this->threads = std::max<size_t>(1, threads);
+}
+
+std::vector<std::string> HistoryIngestor::listWeekFiles(const std::string& historyPath, const std::string& symbol) {
+    std::vector<std::pair<long long, std::string>> files;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(std::filesystem::path(historyPath) / symbol, error)) {
+        std::string name = entry.path().filename().string();
+        auto order = weekOrder(name);
+        if (entry.is_regular_file() && order.has_value()) {
+            files.emplace_back(order.value(), name);
+        }
+    }
+    std::sort(files.begin(), files.end());
+    std::vector<std::string> names;
+    for (const auto& file : files) {
+        names.push_back(file.second);
+    }
+    return names;
+}
+
+bool HistoryIngestor::parseTail(const std::string& path, HistoryFormat format, IngestedFile& file, BarColumns& bars, StorageReadErrors& errors) const {
+    std::ifstream input(path, std::ios::binary);
+    if (!input.is_open()) {
+        return false;
+    }
+    input.seekg(static_cast<std::streamoff>(file.parsedBytes));
+    std::string content((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    size_t lastNewline = content.rfind('\n');
+    content.resize(lastNewline == std::string::npos ? 0 : lastNewline + 1);
+
+    if (content.empty()) {
+        // Nothing complete yet
+    } else if (format == HistoryFormat::Tick) {
+        std::istringstream stream(content);
+        TickBarReader reader(stream, 60, 0);
+        while (reader.readChunk(bars)) {
+        }
+        errors = reader.errors();
+    } else {
+        HistoryFormats::visit(format, [&](auto dialect) {
+            std::istringstream stream(content);
+            Data data;
+            while (StorageReader::readNext<decltype(dialect)>(stream, data, errors)) {
+                bars.push(data);
+            }
+        });
+    }
+    file.parsedBytes += content.size();
+    auto hash = tailHash(path, file.parsedBytes);
+    file.tailHash = hash.value_or(0);
+    return hash.has_value();
+}
+
+HistoryIngestor::SymbolResult HistoryIngestor::ingestSymbol(const std::string& symbol, const std::optional<SymbolState>& previous, bool rebuild) const {
+    std::filesystem::path symbolPath = std::filesystem::path(historyPath) / symbol;
+    HistoryFormat format = HistoryFormat::Standard;
+    std::error_code error;
+    if (std::filesystem::exists(symbolPath / "info.json", error)) {
+        try {
+            format = SymbolInfoParser::parse((symbolPath / "info.json").string()).historyFormat;
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: Failed to parse symbol info " << (symbolPath / "info.json").string() << ": " << e.what() << std::endl;
+        }
+    }
+    std::vector<std::string> files = listWeekFiles(historyPath, symbol);
+    BarStore store((std::filesystem::path(storePath) / symbol).string());
+
+    auto ingestFile = [&](const std::string& name, IngestedFile entry, SymbolResult& result) {
+        std::string path = (symbolPath / name).string();
+        std::error_code statError;
+        auto size = std::filesystem::file_size(path, statError);
+        auto modified = std::filesystem::last_write_time(path, statError);
+        BarColumns bars;
+        StorageReadErrors errors;
+        if (statError || !parseTail(path, format, entry, bars, errors)) {
+            return false;
+        }
+        entry.size = size;
+        entry.modified = static_cast<int64_t>(modified.time_since_epoch().count());
+        if (!store.append(bars)) {
+            return false;
+        }
+        entry.bars += bars.size();
+        result.report.appendedBars += bars.size();
+        result.report.malformedLines += errors.total();
+        if (errors.total() > 0) {
+            std::cerr << "Warning: Skipped " << errors.describe() << " in " << path << std::endl;
+        }
+        result.state.files[name] = entry;
+        return true;
+    };
+
+    SymbolResult result;
+    result.state.format = format;
+    bool incremental = !rebuild && previous.has_value() && previous.value().format == format
+        && previous.value().rows == store.size();
+    if (incremental) {
+        // A removed week cannot be taken out of the middle of the store
+        for (const auto& file : previous.value().files) {
+            if (std::find(files.begin(), files.end(), file.first) == files.end()) {
+                incremental = false;
+            }
+        }
+    }
+    if (incremental) {
+        for (const auto& name : files) {
+            std::string path = (symbolPath / name).string();
+            auto it = previous.value().files.find(name);
+            if (it == previous.value().files.end()) {
+                result.report.newFiles++;
+                result.report.parsedBytes += static_cast<size_t>(std::filesystem::file_size(path, error));
+                if (!ingestFile(name, IngestedFile(), result)) {
+                    incremental = false;
+                    break;
+                }
+                continue;
+            }
+            const IngestedFile& known = it->second;
+            auto size = std::filesystem::file_size(path, error);
+            auto modified = static_cast<int64_t>(std::filesystem::last_write_time(path, error).time_since_epoch().count());
+            if (size == known.size && modified == known.modified) {
+                result.report.unchangedFiles++;
+                result.state.files[name] = known;
+                continue;
+            }
+            // Anything but lines appended after the parsed part means the file was rewritten
+            if (size < known.parsedBytes || tailHash(path, known.parsedBytes) != known.tailHash) {
+                incremental = false;
+                break;
+            }
+            result.report.grownFiles++;
+            result.report.parsedBytes += static_cast<size_t>(size - known.parsedBytes);
+            if (!ingestFile(name, known, result)) {
+                incremental = false;
+                break;
+            }
+        }
+    }
+    if (!incremental) {
+        result = SymbolResult();
+        result.state.format = format;
+        result.report.rebuiltSymbols = previous.has_value() ? 1 : 0;
+        store.clear();
+        for (const auto& name : files) {
+            std::string path = (symbolPath / name).string();
+            result.report.newFiles++;
+            result.report.parsedBytes += static_cast<size_t>(std::filesystem::file_size(path, error));
+            if (!ingestFile(name, IngestedFile(), result)) {
+                std::cerr << "Warning: Skipping " << path << ", it cannot be read, goes back in time or overlaps the previous week" << std::endl;
+            }
+        }
+    }
+    result.state.rows = store.size();
+    if (result.report.appendedBars > 0 || result.report.rebuiltSymbols > 0) {
+        result.report.changedSymbols.push_back(symbol);
+    }
+    return result;
+}
+
+std::optional<IngestReport> HistoryIngestor::ingest(bool rebuild) {
+    std::error_code error;
+    std::filesystem::create_directories(storePath, error);
+    std::map<std::string, SymbolState> manifest = rebuild ? std::map<std::string, SymbolState>() : readManifest();
+
+    std::vector<std::string> symbols;
+    for (const auto& directory : std::filesystem::directory_iterator(historyPath, error)) {
+        if (directory.is_directory()) {
+            symbols.push_back(directory.path().filename().string());
+        }
+    }
+    std::sort(symbols.begin(), symbols.end());
+
+    // Symbols are independent, each is brought up to date by one thread
+    std::vector<SymbolResult> results(symbols.size());
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i = next++; i < symbols.size(); i = next++) {
+            auto it = manifest.find(symbols[i]);
+            std::optional<SymbolState> previous;
+            if (it != manifest.end()) {
+                previous = it->second;
+            }
+            results[i] = ingestSymbol(symbols[i], previous, rebuild);
+        }
+    };
+    size_t threadCount = std::min(threads, symbols.size());
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < threadCount; i++) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    IngestReport report;
+    std::map<std::string, SymbolState> updated;
+    for (size_t i = 0; i < symbols.size(); i++) {
+        const IngestReport& symbolReport = results[i].report;
+        report.newFiles += symbolReport.newFiles;
+        report.grownFiles += symbolReport.grownFiles;
+        report.unchangedFiles += symbolReport.unchangedFiles;
+        report.rebuiltSymbols += symbolReport.rebuiltSymbols;
+        report.appendedBars += symbolReport.appendedBars;
+        report.parsedBytes += symbolReport.parsedBytes;
+        report.malformedLines += symbolReport.malformedLines;
+        report.changedSymbols.insert(report.changedSymbols.end(), symbolReport.changedSymbols.begin(), symbolReport.changedSymbols.end());
+        updated[symbols[i]] = results[i].state;
+    }
+    // Symbols removed from the history
+    for (const auto& symbol : manifest) {
+        if (updated.count(symbol.first) == 0) {
+            std::filesystem::remove_all(std::filesystem::path(storePath) / symbol.first, error);
+            report.changedSymbols.push_back(symbol.first);
+        }
+    }
+    if (!writeManifest(updated)) {
+        return std::nullopt;
+    }
+    return report;
+}
+
+std::map<std::string, HistoryIngestor::SymbolState> HistoryIngestor::readManifest() const {
+    std::map<std::string, SymbolState> symbols;
+    std::filesystem::path path = std::filesystem::path(storePath) / "manifest.bin";
+    std::ifstream file(path, std::ios::binary);
+    std::error_code error;
+    uint64_t fileSize = std::filesystem::file_size(path, error);
+    char magic[4];
+    uint32_t version = 0;
+    std::string manifestHistoryPath;
+    uint32_t symbolCount = 0;
+    if (!file.read(magic, sizeof(magic)) || !std::equal(magic, magic + 4, ManifestMagic)
+        || !readValue(file, version) || version != ManifestVersion
+        || !readString(file, fileSize, manifestHistoryPath) || manifestHistoryPath != historyPath
+        || !readValue(file, symbolCount)) {
+        return {};
+    }
+    for (uint32_t i = 0; i < symbolCount; i++) {
+        std::string symbol;
+        uint8_t format = 0;
+        uint32_t fileCount = 0;
+        uint64_t rows = 0;
+        if (!readString(file, fileSize, symbol) || !readValue(file, format) || format > static_cast<uint8_t>(HistoryFormat::Tick)
+            || !readValue(file, rows) || !readValue(file, fileCount)) {
+            return {};
+        }
+        SymbolState& state = symbols[symbol];
+        state.format = static_cast<HistoryFormat>(format);
+        state.rows = rows;
+        for (uint32_t j = 0; j < fileCount; j++) {
+            std::string name;
+            IngestedFile entry;
+            if (!readString(file, fileSize, name) || !readValue(file, entry.size) || !readValue(file, entry.modified)
+                || !readValue(file, entry.parsedBytes) || !readValue(file, entry.tailHash) || !readValue(file, entry.bars)) {
+                return {};
+            }
+            state.files[name] = entry;
+        }
+    }
+    return symbols;
+}
+
+bool HistoryIngestor::writeManifest(const std::map<std::string, SymbolState>& symbols) const {
+    std::filesystem::path path = std::filesystem::path(storePath) / "manifest.bin";
+    // Written aside and renamed, an interrupted update leaves the previous manifest
+    std::filesystem::path temporaryPath = path.string() + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        file.write(ManifestMagic, sizeof(ManifestMagic));
+        writeValue(file, ManifestVersion);
+        writeString(file, historyPath);
+        writeValue(file, static_cast<uint32_t>(symbols.size()));
+        for (const auto& symbol : symbols) {
+            writeString(file, symbol.first);
+            writeValue(file, static_cast<uint8_t>(symbol.second.format));
+            writeValue(file, symbol.second.rows);
+            writeValue(file, static_cast<uint32_t>(symbol.second.files.size()));
+            for (const auto& entry : symbol.second.files) {
+                writeString(file, entry.first);
+                writeValue(file, entry.second.size);
+                writeValue(file, entry.second.modified);
+                writeValue(file, entry.second.parsedBytes);
+                writeValue(file, entry.second.tailHash);
+                writeValue(file, entry.second.bars);
+            }
+        }
+        if (!file) {
+            std::cerr << "Error: Failed to write history manifest: " << temporaryPath.string() << std::endl;
+            return false;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, path, error);
+    if (error) {
+        std::cerr << "Error: Failed to write history manifest: " << error.message() << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,74 @@
+#include <string>
+#include <vector>
+#include <map>
+#include <optional>
+#include <cstdint>
+#include "HistoryDialect.h"
+#include "BarColumns.h"
+
+#pragma once
+
+// What has been ingested from one week file
+class IngestedFile {
+public:
+    uint64_t size = 0;
+    int64_t modified = 0;
+    // Bytes up to the end of the last complete line, parsing resumes there
+    uint64_t parsedBytes = 0;
+    // FNV-1a of the bytes just before parsedBytes, tells an appended file from a rewritten one
+    uint64_t tailHash = 0;
+    uint64_t bars = 0;
+};
+
+class IngestReport {
+public:
+    size_t newFiles = 0;
+    // Files that only had lines appended, parsed from where the last run stopped
+    size_t grownFiles = 0;
+    size_t unchangedFiles = 0;
+    // Symbols read again from scratch, because a file was rewritten, removed or out of order
+    size_t rebuiltSymbols = 0;
+    size_t appendedBars = 0;
+    size_t parsedBytes = 0;
+    size_t malformedLines = 0;
+    // Symbols whose store changed; derived caches of other symbols are still valid
+    std::vector<std::string> changedSymbols;
+};
+
+// Keeps a BarStore per symbol (<storePath>/<SYMBOL>/) in step with the week CSV files of the history.
+// A manifest records the size, modification time and parsed length of every file, so an update
+// only parses what was appended since the last run and appends it to the stores. Only complete
+// lines are taken; a last line without a newline is read once the file grows.
+class HistoryIngestor {
+public:
+    HistoryIngestor(const std::string& historyPath, const std::string& storePath, size_t threads = 1);
+    // Brings every store up to date, rebuilding all of them when rebuild is set.
+    // Nothing if the manifest cannot be written.
+    std::optional<IngestReport> ingest(bool rebuild = false);
+    // Names of the <year>-<week>.csv files of symbol, sorted by year and week
+    static std::vector<std::string> listWeekFiles(const std::string& historyPath, const std::string& symbol);
+private:
+    class SymbolState {
+    public:
+        HistoryFormat format = HistoryFormat::Standard;
+        // By file name
+        std::map<std::string, IngestedFile> files;
+        // Rows of the store after the update, a store changed by anything else is rebuilt
+        uint64_t rows = 0;
+    };
+    class SymbolResult {
+    public:
+        SymbolState state;
+        IngestReport report;
+    };
+
+    std::string historyPath;
+    std::string storePath;
+    size_t threads;
+
+    std::map<std::string, SymbolState> readManifest() const;
+    bool writeManifest(const std::map<std::string, SymbolState>& symbols) const;
+    SymbolResult ingestSymbol(const std::string& symbol, const std::optional<SymbolState>& previous, bool rebuild) const;
+    // Parses the complete lines after file.parsedBytes into bars and advances file
+    bool parseTail(const std::string& path, HistoryFormat format, IngestedFile& file, BarColumns& bars, StorageReadErrors& errors) const;
+};
@@ -0,0 +1,230 @@
+#include "HistoryScanner.h"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include "StorageReader.h"
+#include "SymbolInfoParser.h"
+#include "TickBarReader.h"
+
+size_t QualityKernels::crossedQuotes(const BarColumns& bars) {
+    size_t count = bars.size();
+    size_t result = 0;
+    for (size_t i = 0; i < count; i++) {
+        result += (bars.bidOpen[i] > bars.askOpen[i]) | (bars.bidHigh[i] > bars.askHigh[i])
+            | (bars.bidLow[i] > bars.askLow[i]) | (bars.bidClose[i] > bars.askClose[i]);
+    }
+    return result;
+}
+
+size_t QualityKernels::invertedBars(const BarColumns& bars) {
+    size_t count = bars.size();
+    size_t result = 0;
+    for (size_t i = 0; i < count; i++) {
+        bool bid = (bars.bidHigh[i] < bars.bidLow[i])
+            | (bars.bidOpen[i] > bars.bidHigh[i]) | (bars.bidOpen[i] < bars.bidLow[i])
+            | (bars.bidClose[i] > bars.bidHigh[i]) | (bars.bidClose[i] < bars.bidLow[i]);
+        bool ask = (bars.askHigh[i] < bars.askLow[i])
+            | (bars.askOpen[i] > bars.askHigh[i]) | (bars.askOpen[i] < bars.askLow[i])
+            | (bars.askClose[i] > bars.askHigh[i]) | (bars.askClose[i] < bars.askLow[i]);
+        result += bid | ask;
+    }
+    return result;
+}
+
+size_t QualityKernels::zeroPrices(const BarColumns& bars) {
+    size_t count = bars.size();
+    size_t result = 0;
+    for (size_t i = 0; i < count; i++) {
+        result += (bars.bidOpen[i] <= 0) | (bars.bidHigh[i] <= 0) | (bars.bidLow[i] <= 0) | (bars.bidClose[i] <= 0)
+            | (bars.askOpen[i] <= 0) | (bars.askHigh[i] <= 0) | (bars.askLow[i] <= 0) | (bars.askClose[i] <= 0);
+    }
+    return result;
+}
+
+size_t QualityKernels::timestampRegressions(const long long* time, size_t count) {
+    size_t result = 0;
+    for (size_t i = 1; i < count; i++) {
+        result += time[i] < time[i - 1];
+    }
+    return result;
+}
+
+size_t QualityKernels::duplicateTimes(const long long* time, size_t count) {
+    size_t result = 0;
+    for (size_t i = 1; i < count; i++) {
+        result += time[i] == time[i - 1];
+    }
+    return result;
+}
+
+size_t QualityKernels::gaps(const long long* time, size_t count, long long maxGapSeconds) {
+    size_t result = 0;
+    for (size_t i = 1; i < count; i++) {
+        result += time[i] - time[i - 1] > maxGapSeconds;
+    }
+    return result;
+}
+
+size_t QualityKernels::spikes(const BarColumns& bars, double fraction) {
+    size_t count = bars.size();
+    size_t result = 0;
+    for (size_t i = 1; i < count; i++) {
+        // Compared on doubled mids, the halving cancels out
+        double previous = bars.bidClose[i - 1] + bars.askClose[i - 1];
+        double current = bars.bidClose[i] + bars.askClose[i];
+        result += std::fabs(current - previous) > fraction * std::fabs(previous);
+    }
+    return result;
+}
+
+bool HistoryFileReport::hasIssues() const {
+    return shouldQuarantine() || gaps > 0 || spikes > 0;
+}
+
+bool HistoryFileReport::shouldQuarantine() const {
+    return readFailed || malformedLines > 0 || crossedQuotes > 0 || invertedBars > 0 || zeroPrices > 0
+        || timestampRegressions > 0 || duplicateTimes > 0;
+}
+
+nlohmann::json HistoryFileReport::toJson() const {
+    nlohmann::json json;
+    json["file"] = file;
+    json["symbol"] = symbol;
+    json["read_failed"] = readFailed;
+    json["lines"] = lines;
+    json["bars"] = bars;
+    json["malformed_lines"] = malformedLines;
+    if (firstMalformedLine > 0) {
+        json["first_malformed_line"] = firstMalformedLine;
+    }
+    json["crossed_quotes"] = crossedQuotes;
+    json["inverted_bars"] = invertedBars;
+    json["zero_prices"] = zeroPrices;
+    json["timestamp_regressions"] = timestampRegressions;
+    json["duplicate_times"] = duplicateTimes;
+    json["gaps"] = gaps;
+    json["spikes"] = spikes;
+    json["quarantine"] = shouldQuarantine();
+    return json;
+}
+
+HistoryScanner::HistoryScanner(const Settings& settings) : settings(settings) {
+}
+
+HistoryFileReport HistoryScanner::scanFile(const std::string& path, const std::string& symbol, const std::string& file,
+    HistoryFormat format) {
+    std::ifstream input(path);
+    HistoryFileReport report = scanStream(input, symbol, file, format);
+    report.readFailed = !input.is_open();
+    return report;
+}
+
+HistoryFileReport HistoryScanner::scanStream(std::istream& input, const std::string& symbol, const std::string& file,
+    HistoryFormat format) {
+    HistoryFileReport report;
+    report.file = file;
+    report.symbol = symbol;
+    BarColumns bars;
+    StorageReadErrors errors;
+    if (format == HistoryFormat::Tick) {
+        // Checked as the m1 bars the backtests see, ticks share seconds
+        TickBarReader reader(input, 60, 0);
+        while (reader.readChunk(bars)) {
+        }
+        errors = reader.errors();
+    } else {
+        HistoryFormats::visit(format, [&](auto dialect) {
+            Data data;
+            while (StorageReader::readNext<decltype(dialect)>(input, data, errors)) {
+                bars.push(data);
+            }
+        });
+    }
+    report.lines = errors.lines;
+    report.malformedLines = errors.total();
+    report.firstMalformedLine = errors.lineNumbers.empty() ? 0 : errors.lineNumbers.front();
+    report.bars = bars.size();
+    report.crossedQuotes = QualityKernels::crossedQuotes(bars);
+    report.invertedBars = QualityKernels::invertedBars(bars);
+    report.zeroPrices = QualityKernels::zeroPrices(bars);
+    report.timestampRegressions = QualityKernels::timestampRegressions(bars.time.data(), bars.size());
+    report.duplicateTimes = QualityKernels::duplicateTimes(bars.time.data(), bars.size());
+    report.gaps = QualityKernels::gaps(bars.time.data(), bars.size(), settings.maxGapSeconds);
+    report.spikes = QualityKernels::spikes(bars, settings.spikeFraction);
+    return report;
+}
+
+std::vector<HistoryFileReport> HistoryScanner::scan(const std::string& historyPath) {
+    class WeekFile {
+    public:
+        std::string path;
+        std::string symbol;
+        std::string file;
+        HistoryFormat format;
+    };
+    std::vector<WeekFile> files;
+    std::error_code error;
+    for (const auto& directory : std::filesystem::directory_iterator(historyPath, error)) {
+        if (!directory.is_directory()) {
+            continue;
+        }
+        std::string symbol = directory.path().filename().string();
+        HistoryFormat format = HistoryFormat::Standard;
+        auto infoPath = directory.path() / "info.json";
+        if (std::filesystem::exists(infoPath, error)) {
+            try {
+                format = SymbolInfoParser::parse(infoPath.string()).historyFormat;
+            } catch (const std::exception& e) {
+                std::cerr << "Warning: Failed to parse symbol info " << infoPath.string() << ": " << e.what() << std::endl;
+            }
+        }
+        for (const auto& entry : std::filesystem::directory_iterator(directory.path(), error)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".csv") {
+                files.push_back({ entry.path().string(), symbol, symbol + "/" + entry.path().filename().string(), format });
+            }
+        }
+    }
+    std::sort(files.begin(), files.end(), [](const WeekFile& a, const WeekFile& b) { return a.file < b.file; });
+
+    // Reads stay queued across files while the parser threads scan the ones already read
+    std::vector<HistoryFileReport> reports(files.size());
+    std::vector<std::string> paths;
+    for (const auto& file : files) {
+        paths.push_back(file.path);
+    }
+    BulkReader::Settings io;
+    io.backend = settings.io;
+    io.queueDepth = settings.queueDepth;
+    io.parserThreads = std::min<size_t>(std::max<size_t>(1, settings.threads), std::max<size_t>(1, files.size()));
+    BulkReader(io).read(paths, [&](size_t i, const char* data, size_t size, bool ok) {
+        MemoryStream input(data, ok ? size : 0);
+        reports[i] = scanStream(input, files[i].symbol, files[i].file, files[i].format);
+        reports[i].readFailed = !ok;
+    });
+    return reports;
+}
+
+std::optional<size_t> HistoryScanner::writeQuarantine(const std::string& historyPath, const std::vector<HistoryFileReport>& reports) {
+    std::filesystem::path path = std::filesystem::path(historyPath) / "quarantine.txt";
+    std::vector<std::string> quarantined;
+    for (const auto& report : reports) {
+        if (report.shouldQuarantine()) {
+            quarantined.push_back(report.file);
+        }
+    }
+    if (quarantined.empty()) {
+        std::error_code error;
+        std::filesystem::remove(path, error);
+        return 0;
+    }
+    std::ofstream file(path, std::ios::trunc);
+    for (const auto& entry : quarantined) {
+        file << entry << "\n";
+    }
+    if (!file) {
+        return std::nullopt;
+    }
+    return quarantined.size();
+}
@@ -0,0 +1,88 @@
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <optional>
+#include <nlohmann/json.hpp>
+#include "BarColumns.h"
+#include "HistoryDialect.h"
+#include "BulkReader.h"
+
+#pragma once
+
+// Counts of bars failing each check over contiguous columns. The loops accumulate comparison
+// results without branches or loop-carried dependencies other than the sum, so they vectorize.
+class QualityKernels {
+public:
+    // Bars with a bid above the ask in any of open, high, low and close
+    static size_t crossedQuotes(const BarColumns& bars);
+    // Bars with high below low, or open or close outside the range, on either side
+    static size_t invertedBars(const BarColumns& bars);
+    // Bars with any price at or below zero
+    static size_t zeroPrices(const BarColumns& bars);
+    // Bars timestamped before the previous one
+    static size_t timestampRegressions(const long long* time, size_t count);
+    // Bars with the same timestamp as the previous one
+    static size_t duplicateTimes(const long long* time, size_t count);
+    // Bars more than maxGapSeconds after the previous one
+    static size_t gaps(const long long* time, size_t count, long long maxGapSeconds);
+    // Bars whose mid close moved more than fraction of the previous one
+    static size_t spikes(const BarColumns& bars, double fraction);
+};
+
+class HistoryFileReport {
+public:
+    // Relative to the history root, e.g. EURUSD/2024-3.csv
+    std::string file;
+    std::string symbol;
+    // The file could not be opened or read, its other counts are meaningless
+    bool readFailed = false;
+    size_t lines = 0;
+    size_t bars = 0;
+    size_t malformedLines = 0;
+    // First malformed line, 1-based, 0 without any
+    size_t firstMalformedLine = 0;
+    size_t crossedQuotes = 0;
+    size_t invertedBars = 0;
+    size_t zeroPrices = 0;
+    size_t timestampRegressions = 0;
+    size_t duplicateTimes = 0;
+    size_t gaps = 0;
+    size_t spikes = 0;
+
+    // Anything found, gaps and spikes included
+    bool hasIssues() const;
+    // Errors that make the week unfit for backtesting; gaps and spikes can be genuine market moves
+    bool shouldQuarantine() const;
+    nlohmann::json toJson() const;
+};
+
+// Checks every week file of a history tree for bad bars, one file per task on a pool of threads
+class HistoryScanner {
+public:
+    class Settings {
+    public:
+        // Gaps up to this long are normal, e.g. around the daily rollover
+        long long maxGapSeconds = 30 * 60;
+        // Largest one-bar move of the mid close not reported as a spike
+        double spikeFraction = 0.02;
+        size_t threads = 1;
+        // How the files are read, see BulkReader
+        IoBackend io = IoBackend::Auto;
+        size_t queueDepth = 32;
+    };
+
+    explicit HistoryScanner(const Settings& settings);
+    // Reports of all <symbol>/<year>-<week>.csv files under historyPath, sorted by file.
+    // Files are read in the HistoryFormat of the symbol's info.json.
+    std::vector<HistoryFileReport> scan(const std::string& historyPath);
+    HistoryFileReport scanFile(const std::string& path, const std::string& symbol, const std::string& file,
+        HistoryFormat format = HistoryFormat::Standard);
+    // Same as scanFile for content already in memory
+    HistoryFileReport scanStream(std::istream& input, const std::string& symbol, const std::string& file,
+        HistoryFormat format = HistoryFormat::Standard);
+    // Writes the files to quarantine to <historyPath>/quarantine.txt, which RatesStorageProvider skips.
+    // Removes the list when nothing needs quarantine. Returns the number of quarantined files.
+    static std::optional<size_t> writeQuarantine(const std::string& historyPath, const std::vector<HistoryFileReport>& reports);
+private:
+    Settings settings;
+};
@@ -0,0 +1,277 @@
+#include "IndicatorCache.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include "ProcessRunner.h"
+#include "FileHash.h"
+
+namespace {
+    const char fileMagic[8] = { 'F', 'X', 'I', 'N', 'D', '0', '0', '1' };
+
+    // Fixed-size file header, the values follow as native doubles
+    struct FileHeader {
+        char magic[8];
+        uint64_t count;
+        uint64_t bars;
+    };
+
+    const char* typeName(IndicatorType type) {
+        switch (type) {
+        case IndicatorType::SimpleMovingAverage:
+            return "sma";
+        case IndicatorType::AverageTrueRange:
+            return "atr";
+        case IndicatorType::RelativeStrengthIndex:
+            return "rsi";
+        }
+        return "";
+    }
+}
+
+void IndicatorKernels::prefixSum(const double* values, size_t count, double* output) {
+    output[0] = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        output[i + 1] = output[i] + values[i];
+    }
+}
+
+void IndicatorKernels::rollingMean(const double* prefix, size_t count, size_t period, double* output) {
+    size_t warmUp = std::min(count, period - 1);
+    for (size_t i = 0; i < warmUp; i++) {
+        output[i] = std::numeric_limits<double>::quiet_NaN();
+    }
+    double scale = 1.0 / period;
+    for (size_t i = warmUp; i < count; i++) {
+        output[i] = (prefix[i + 1] - prefix[i + 1 - period]) * scale;
+    }
+}
+
+void IndicatorKernels::relativeStrength(const double* gainPrefix, const double* lossPrefix, size_t count, size_t period, double* output) {
+    size_t warmUp = std::min(count, period);
+    for (size_t i = 0; i < warmUp; i++) {
+        output[i] = std::numeric_limits<double>::quiet_NaN();
+    }
+    for (size_t i = warmUp; i < count; i++) {
+        double gains = gainPrefix[i + 1] - gainPrefix[i + 1 - period];
+        double losses = lossPrefix[i + 1] - lossPrefix[i + 1 - period];
+        double total = gains + losses;
+        output[i] = total > 0 ? 100.0 * gains / total : 50.0;
+    }
+}
+
+void IndicatorKernels::trueRange(const double* high, const double* low, const double* close, size_t count, double* output) {
+    if (count == 0) {
+        return;
+    }
+    output[0] = high[0] - low[0];
+    for (size_t i = 1; i < count; i++) {
+        output[i] = std::max(high[i], close[i - 1]) - std::min(low[i], close[i - 1]);
+    }
+}
+
+std::string IndicatorKey::toString() const {
+    std::string escapedSymbol = symbol;
+    escapedSymbol.erase(std::remove(escapedSymbol.begin(), escapedSymbol.end(), '/'), escapedSymbol.end());
+    std::ostringstream name;
+    name << escapedSymbol << "_" << period << "_" << typeName(type) << "_" << length << "_"
+         << std::hex << std::setw(16) << std::setfill('0') << bars;
+    return name.str();
+}
+
+IndicatorSeries::IndicatorSeries(std::vector<double> values) : owned(std::move(values)) {
+    this->values = owned.data();
+    count = owned.size();
+}
+
+std::shared_ptr<const IndicatorSeries> IndicatorSeries::map(const std::string& path, uint64_t bars) {
+    auto file = std::make_unique<MappedFile>(path);
+    if (file->size() < sizeof(FileHeader)) {
+        return nullptr;
+    }
+    FileHeader header;
+    std::memcpy(&header, file->data(), sizeof(header));
+    if (std::memcmp(header.magic, fileMagic, sizeof(fileMagic)) != 0 || header.bars != bars
+        || sizeof(FileHeader) + header.count * sizeof(double) != file->size()) {
+        return nullptr;
+    }
+    std::shared_ptr<IndicatorSeries> series(new IndicatorSeries());
+    series->values = reinterpret_cast<const double*>(file->data() + sizeof(FileHeader));
+    series->count = header.count;
+    series->file = std::move(file);
+    return series;
+}
+
+double IndicatorCache::Stats::hitRate() const {
+    size_t requests = hits + mapped + computed;
+    return requests > 0 ? static_cast<double>(hits + mapped) / requests : 0.0;
+}
+
+IndicatorCache::IndicatorCache(const std::string& directory, size_t memoryBudgetBytes)
+    : directory(directory), memoryBudget(memoryBudgetBytes) {
+    if (!directory.empty()) {
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+    }
+}
+
+uint64_t IndicatorCache::fingerprint(const BarColumns& bars) {
+    uint64_t hash = FileHash::fnv1a(bars.time.data(), bars.time.size() * sizeof(long long));
+    hash = FileHash::fnv1a(bars.bidClose.data(), bars.bidClose.size() * sizeof(double), hash);
+    return FileHash::fnv1a(bars.askClose.data(), bars.askClose.size() * sizeof(double), hash);
+}
+
+std::vector<double> IndicatorCache::compute(IndicatorType type, size_t length, const BarColumns& bars) {
+    size_t count = bars.size();
+    std::vector<double> output(count, std::numeric_limits<double>::quiet_NaN());
+    if (length == 0 || count == 0) {
+        return output;
+    }
+    std::vector<double> close(count);
+    for (size_t i = 0; i < count; i++) {
+        close[i] = (bars.bidClose[i] + bars.askClose[i]) * 0.5;
+    }
+    std::vector<double> prefix(count + 1);
+    switch (type) {
+    case IndicatorType::SimpleMovingAverage:
+        IndicatorKernels::prefixSum(close.data(), count, prefix.data());
+        IndicatorKernels::rollingMean(prefix.data(), count, length, output.data());
+        break;
+    case IndicatorType::AverageTrueRange: {
+        std::vector<double> high(count);
+        std::vector<double> low(count);
+        for (size_t i = 0; i < count; i++) {
+            high[i] = (bars.bidHigh[i] + bars.askHigh[i]) * 0.5;
+            low[i] = (bars.bidLow[i] + bars.askLow[i]) * 0.5;
+        }
+        std::vector<double> range(count);
+        IndicatorKernels::trueRange(high.data(), low.data(), close.data(), count, range.data());
+        IndicatorKernels::prefixSum(range.data(), count, prefix.data());
+        IndicatorKernels::rollingMean(prefix.data(), count, length, output.data());
+        break;
+    }
+    case IndicatorType::RelativeStrengthIndex: {
+        std::vector<double> gains(count, 0.0);
+        std::vector<double> losses(count, 0.0);
+        for (size_t i = 1; i < count; i++) {
+            double change = close[i] - close[i - 1];
+            gains[i] = std::max(change, 0.0);
+            losses[i] = std::max(-change, 0.0);
+        }
+        std::vector<double> lossPrefix(count + 1);
+        IndicatorKernels::prefixSum(gains.data(), count, prefix.data());
+        IndicatorKernels::prefixSum(losses.data(), count, lossPrefix.data());
+        IndicatorKernels::relativeStrength(prefix.data(), lossPrefix.data(), count, length, output.data());
+        break;
+    }
+    }
+    return output;
+}
+
+size_t IndicatorCache::removeSymbol(const std::string& directory, const std::string& symbol) {
+    // Every name starts with the escaped symbol and an underscore, see IndicatorKey::toString
+    std::string prefix = symbol;
+    prefix.erase(std::remove(prefix.begin(), prefix.end(), '/'), prefix.end());
+    prefix += "_";
+    size_t removed = 0;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+        std::string name = entry.path().filename().string();
+        if (entry.path().extension() == ".f64" && name.compare(0, prefix.size(), prefix) == 0
+            && std::filesystem::remove(entry.path(), error)) {
+            removed++;
+        }
+    }
+    return removed;
+}
+
+std::shared_ptr<const IndicatorSeries> IndicatorCache::get(const IndicatorKey& key, const BarColumns& bars) {
+    std::string name = key.toString();
+    auto cached = find(name);
+    if (cached.has_value()) {
+        return cached.value();
+    }
+    std::string path = directory.empty() ? std::string() : (std::filesystem::path(directory) / (name + ".f64")).string();
+    std::shared_ptr<const IndicatorSeries> series = path.empty() ? nullptr : IndicatorSeries::map(path, key.bars);
+    if (series != nullptr && series->size() == bars.size()) {
+        std::lock_guard<std::mutex> lock(mutex);
+        counters.mapped++;
+    } else {
+        std::vector<double> values = compute(key.type, key.length, bars);
+        if (!path.empty()) {
+            write(path, key.bars, values);
+        }
+        series = std::make_shared<IndicatorSeries>(std::move(values));
+        std::lock_guard<std::mutex> lock(mutex);
+        counters.computed++;
+    }
+    insert(name, series);
+    return series;
+}
+
+std::optional<std::shared_ptr<const IndicatorSeries>> IndicatorCache::find(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(name);
+    if (it == entries.end()) {
+        return std::nullopt;
+    }
+    recent.splice(recent.begin(), recent, it->second.recent);
+    counters.hits++;
+    return it->second.series;
+}
+
+void IndicatorCache::insert(const std::string& name, const std::shared_ptr<const IndicatorSeries>& series) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (entries.count(name) > 0) {
+        // Computed concurrently by another caller
+        return;
+    }
+    recent.push_front(name);
+    entries[name] = Entry{ series, recent.begin() };
+    memoryUsed += series->size() * sizeof(double);
+    // Callers still holding an evicted series keep it alive until they are done
+    while (memoryUsed > memoryBudget && !recent.empty()) {
+        auto it = entries.find(recent.back());
+        memoryUsed -= it->second.series->size() * sizeof(double);
+        entries.erase(it);
+        recent.pop_back();
+        counters.evicted++;
+    }
+}
+
+bool IndicatorCache::write(const std::string& path, uint64_t bars, const std::vector<double>& values) {
+    // Written aside and renamed, so a concurrent run never maps a partial file
+    std::string temporary = path + "." + std::to_string(ProcessRunner::currentProcessId()) + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        FileHeader header;
+        std::memcpy(header.magic, fileMagic, sizeof(fileMagic));
+        header.count = values.size();
+        header.bars = bars;
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(double));
+        if (!file) {
+            file.close();
+            std::error_code error;
+            std::filesystem::remove(temporary, error);
+            return false;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    return !error;
+}
+
+size_t IndicatorCache::memoryInUse() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return memoryUsed;
+}
+
+IndicatorCache::Stats IndicatorCache::stats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return counters;
+}
@@ -0,0 +1,117 @@
+#include <string>
+#include <vector>
+#include <map>
+#include <list>
+#include <mutex>
+#include <memory>
+#include <optional>
+#include <cstdint>
+#include "BarColumns.h"
+#include "MappedFile.h"
+
+#pragma once
+
+enum class IndicatorType {
+    // Simple moving average of the mid close
+    SimpleMovingAverage,
+    // Simple average of the mid true range
+    AverageTrueRange,
+    // Cutler's RSI: simple averages of mid close gains and losses
+    RelativeStrengthIndex
+};
+
+// Rolling-window kernels over contiguous columns. Windows come from prefix sums, so every output
+// element is independent of the others and the loops vectorize.
+class IndicatorKernels {
+public:
+    // output[i] is the sum of the first i values, output has count + 1 elements
+    static void prefixSum(const double* values, size_t count, double* output);
+    // Mean of the last period values from prefix sums; NaN during warm-up
+    static void rollingMean(const double* prefix, size_t count, size_t period, double* output);
+    // 100 * gains / (gains + losses) over the last period changes, 50 without any change; NaN during warm-up
+    static void relativeStrength(const double* gainPrefix, const double* lossPrefix, size_t count, size_t period, double* output);
+    // Range of each bar including the gap from the previous close
+    static void trueRange(const double* high, const double* low, const double* close, size_t count, double* output);
+};
+
+class IndicatorKey {
+public:
+    std::string symbol;
+    std::string period;
+    IndicatorType type = IndicatorType::SimpleMovingAverage;
+    size_t length = 0;
+    // Identifies the bars the series is computed from, see IndicatorCache::fingerprint
+    uint64_t bars = 0;
+
+    // Also the file name of the series
+    std::string toString() const;
+};
+
+// One value per bar, either owned or mapped read-only from a cache file
+class IndicatorSeries {
+public:
+    explicit IndicatorSeries(std::vector<double> values);
+    IndicatorSeries(const IndicatorSeries&) = delete;
+    IndicatorSeries& operator=(const IndicatorSeries&) = delete;
+    // Nothing if the file is missing, truncated or computed from other bars
+    static std::shared_ptr<const IndicatorSeries> map(const std::string& path, uint64_t bars);
+    const double* data() const { return values; }
+    size_t size() const { return count; }
+    double operator[](size_t index) const { return values[index]; }
+private:
+    IndicatorSeries() = default;
+    std::vector<double> owned;
+    std::unique_ptr<MappedFile> file;
+    const double* values = nullptr;
+    size_t count = 0;
+};
+
+// Indicator series shared by every parameter set and run that asks for the same (symbol, period,
+// indicator, length) over the same bars. Series are kept in memory, least recently used dropped
+// beyond the budget, and written to the directory as a header and raw doubles so later runs and
+// other tools map them instead of computing them again.
+class IndicatorCache {
+public:
+    class Stats {
+    public:
+        // Served from memory
+        size_t hits = 0;
+        // Mapped from a file written earlier
+        size_t mapped = 0;
+        size_t computed = 0;
+        size_t evicted = 0;
+        double hitRate() const;
+    };
+
+    // An empty directory keeps the series in memory only
+    IndicatorCache(const std::string& directory, size_t memoryBudgetBytes);
+    // Hash of the bar times and closes, computed once per bar set and passed in every key
+    static uint64_t fingerprint(const BarColumns& bars);
+    // The key's bars must be the fingerprint of bars
+    std::shared_ptr<const IndicatorSeries> get(const IndicatorKey& key, const BarColumns& bars);
+    static std::vector<double> compute(IndicatorType type, size_t length, const BarColumns& bars);
+    // Removes the files of every series of symbol from directory, e.g. after its history changed.
+    // Returns the number of files removed.
+    static size_t removeSymbol(const std::string& directory, const std::string& symbol);
+    // Bytes of the series held in memory
+    size_t memoryInUse();
+    Stats stats();
+private:
+    class Entry {
+    public:
+        std::shared_ptr<const IndicatorSeries> series;
+        std::list<std::string>::iterator recent;
+    };
+    std::string directory;
+    size_t memoryBudget;
+    size_t memoryUsed = 0;
+    std::mutex mutex;
+    std::map<std::string, Entry> entries;
+    // Most recently used first
+    std::list<std::string> recent;
+    Stats counters;
+
+    std::optional<std::shared_ptr<const IndicatorSeries>> find(const std::string& name);
+    void insert(const std::string& name, const std::shared_ptr<const IndicatorSeries>& series);
+    bool write(const std::string& path, uint64_t bars, const std::vector<double>& values);
+};
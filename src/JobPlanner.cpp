@@ -0,0 +1,210 @@
+#include "JobPlanner.h"
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <set>
+#include "DatesIterator.h"
+
+JobPlanner::JobPlanner(RatesStorageProvider& ratesStorageProvider) : ratesStorageProvider(ratesStorageProvider) {
+}
+
+Instrument JobPlanner::createInstrument(const SymbolInfo& symbolInfo) {
+    return Instrument(
+        symbolInfo.name,
+        symbolInfo.mmr,
+        symbolInfo.pipSize,
+        symbolInfo.precision,
+        symbolInfo.contractCurrency,
+        symbolInfo.profitCurrency,
+        symbolInfo.contractMultiplier,
+        symbolInfo.baseUnitSize,
+        symbolInfo.instrumentType,
+        std::optional<std::string>()
+    );
+}
+
+std::optional<std::string> JobPlanner::findConversionSymbol(const std::string& profitCurrency, const std::string& accountCurrency) {
+    // Either direction of the cross is enough for the engine to value P/L
+    std::vector<std::string> candidates = {
+        profitCurrency + "/" + accountCurrency,
+        accountCurrency + "/" + profitCurrency
+    };
+    for (const auto& candidate : candidates) {
+        if (ratesStorageProvider.getSymbolInfo(candidate).has_value()) {
+            return candidate;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<BacktestJob> JobPlanner::planJob(const BacktestProject& baseProject, const std::vector<std::string>& symbols) {
+    BacktestJob job;
+    job.project = baseProject;
+    job.symbols = symbols;
+
+    std::vector<std::string> profitCurrencies;
+    for (const auto& symbol : symbols) {
+        auto symbolInfo = ratesStorageProvider.getSymbolInfo(symbol);
+        if (!symbolInfo.has_value()) {
+            return std::nullopt;
+        }
+        job.project.instruments.push_back(createInstrument(symbolInfo.value()));
+        profitCurrencies.push_back(symbolInfo.value().profitCurrency);
+    }
+
+    for (const auto& profitCurrency : profitCurrencies) {
+        if (profitCurrency.empty() || profitCurrency == baseProject.accountCurrency) {
+            continue;
+        }
+        auto conversionSymbol = findConversionSymbol(profitCurrency, baseProject.accountCurrency);
+        if (!conversionSymbol.has_value()) {
+            // Without the cross the engine cannot value the P/L in the account currency
+            std::string portfolio;
+            for (const auto& symbol : symbols) {
+                portfolio += (portfolio.empty() ? "" : ",") + symbol;
+            }
+            std::cerr << "Error: No " << profitCurrency << "/" << baseProject.accountCurrency << " history to convert the profit of "
+                      << portfolio << " to the account currency" << std::endl;
+            return std::nullopt;
+        }
+        auto contains = [&](const std::vector<std::string>& list) {
+            return std::find(list.begin(), list.end(), conversionSymbol.value()) != list.end();
+        };
+        if (contains(job.symbols) || contains(job.conversionSymbols)) {
+            continue;
+        }
+        auto symbolInfo = ratesStorageProvider.getSymbolInfo(conversionSymbol.value());
+        job.project.instruments.push_back(createInstrument(symbolInfo.value()));
+        job.conversionSymbols.push_back(conversionSymbol.value());
+    }
+    job.projectTemplate = std::make_shared<const BacktestProjectTemplate>(job.project);
+    return job;
+}
+
+std::vector<std::vector<StrategyParameter>> JobPlanner::expandParameters(const std::vector<std::pair<std::string, std::vector<std::string>>>& parameters) {
+    std::vector<std::vector<StrategyParameter>> combinations(1);
+    for (const auto& parameter : parameters) {
+        std::vector<std::vector<StrategyParameter>> expanded;
+        for (const auto& combination : combinations) {
+            for (const auto& value : parameter.second) {
+                auto next = combination;
+                StrategyParameter strategyParameter;
+                strategyParameter.name = parameter.first;
+                strategyParameter.value = value;
+                next.push_back(strategyParameter);
+                expanded.push_back(next);
+            }
+        }
+        combinations = expanded;
+    }
+    return combinations;
+}
+
+std::optional<std::vector<BacktestJob>> JobPlanner::planSweep(const SweepSpec& spec) {
+    auto parameterSets = expandParameters(spec.parameters);
+
+    BacktestProject baseProject;
+    baseProject.strategy = spec.strategy;
+    baseProject.accountCurrency = spec.accountCurrency;
+    baseProject.initialAmount = spec.initialAmount;
+    baseProject.defaultPeriod = spec.period;
+    baseProject.accountLotSize = spec.accountLotSize;
+    baseProject.startTime = 0;
+    baseProject.endTime = 0;
+    if (!parameterSets.empty()) {
+        baseProject.strategyParameters = parameterSets[0];
+    }
+
+    std::vector<BacktestJob> jobs;
+    for (const auto& portfolio : spec.portfolios) {
+        auto job = planJob(baseProject, portfolio);
+        if (!job.has_value()) {
+            return std::nullopt;
+        }
+        job.value().alignment = spec.intersectTimestamps ? AlignmentMode::Intersection : AlignmentMode::Union;
+        // Parameter sets only differ in values, so they reuse the compiled template
+        for (const auto& parameterSet : parameterSets) {
+            BacktestJob parameterJob = job.value();
+            parameterJob.project.strategyParameters = parameterSet;
+            jobs.push_back(parameterJob);
+        }
+    }
+    return jobs;
+}
+
+std::vector<BacktestWindow> JobPlanner::planWindows(std::time_t until) {
+    std::vector<BacktestWindow> windows;
+    DatesIterator datesIterator;
+    std::tm currentDate = datesIterator.current();
+    std::tm nextDate = datesIterator.next();
+    while (std::mktime(&nextDate) < until) {
+        BacktestWindow window;
+        window.start = currentDate;
+        window.startTime = std::mktime(&currentDate);
+        window.endTime = std::mktime(&nextDate);
+        windows.push_back(window);
+        currentDate = nextDate;
+        nextDate = datesIterator.next();
+    }
+    return windows;
+}
+
+std::vector<BacktestTask> JobPlanner::planTasks(const std::vector<BacktestJob>& jobs, const std::vector<BacktestWindow>& windows) {
+    std::vector<std::shared_ptr<const BacktestJob>> sharedJobs;
+    for (const auto& job : jobs) {
+        sharedJobs.push_back(std::make_shared<const BacktestJob>(job));
+    }
+    std::vector<BacktestTask> tasks;
+    tasks.reserve(jobs.size() * windows.size());
+    for (const auto& window : windows) {
+        for (const auto& job : sharedJobs) {
+            BacktestTask task;
+            task.job = job;
+            task.window = window;
+            tasks.push_back(task);
+        }
+    }
+    return tasks;
+}
+
+std::vector<size_t> JobPlanner::localityOrder(const std::vector<BacktestTask>& tasks) {
+    std::vector<std::string> dataKeys;
+    dataKeys.reserve(tasks.size());
+    for (const auto& task : tasks) {
+        std::vector<std::string> symbols = task.job->symbols;
+        symbols.insert(symbols.end(), task.job->conversionSymbols.begin(), task.job->conversionSymbols.end());
+        std::sort(symbols.begin(), symbols.end());
+        std::string key;
+        for (const auto& symbol : symbols) {
+            key += symbol + ",";
+        }
+        dataKeys.push_back(key);
+    }
+    std::vector<size_t> order(tasks.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t left, size_t right) {
+        if (tasks[left].window.startTime != tasks[right].window.startTime) {
+            return tasks[left].window.startTime < tasks[right].window.startTime;
+        }
+        return dataKeys[left] < dataKeys[right];
+    });
+    return order;
+}
+
+size_t JobPlanner::preparedEntriesPerWindow(const std::vector<BacktestJob>& jobs) {
+    std::set<std::string> entries;
+    for (const auto& job : jobs) {
+        if (job.alignment == AlignmentMode::Intersection && job.symbols.size() > 1) {
+            std::string key;
+            for (const auto& symbol : job.symbols) {
+                key += symbol + ",";
+            }
+            entries.insert(key);
+        } else {
+            entries.insert(job.symbols.begin(), job.symbols.end());
+        }
+        entries.insert(job.conversionSymbols.begin(), job.conversionSymbols.end());
+    }
+    return entries.size();
+}
@@ -0,0 +1,34 @@
+#include <string>
+#include <vector>
+#include <optional>
+#include <ctime>
+#include "BacktestJob.h"
+#include "RatesStorageProvider.h"
+#include "SweepSpec.h"
+
+#pragma once
+
+class JobPlanner {
+    RatesStorageProvider& ratesStorageProvider;
+public:
+    JobPlanner(RatesStorageProvider& ratesStorageProvider);
+    // Builds a job for the portfolio on top of baseProject, adding conversion pairs for every
+    // profit currency that differs from the account currency. Returns nothing if a symbol is unknown
+    // or no cross of a profit currency and the account currency exists.
+    std::optional<BacktestJob> planJob(const BacktestProject& baseProject, const std::vector<std::string>& symbols);
+    // One job per portfolio and parameter combination. Returns nothing if any portfolio cannot be planned.
+    std::optional<std::vector<BacktestJob>> planSweep(const SweepSpec& spec);
+    std::optional<std::string> findConversionSymbol(const std::string& profitCurrency, const std::string& accountCurrency);
+    // Cartesian product of the parameter values, a single empty set when there are no parameters
+    static std::vector<std::vector<StrategyParameter>> expandParameters(const std::vector<std::pair<std::string, std::vector<std::string>>>& parameters);
+    // Weekly windows from the start of the history up to until
+    static std::vector<BacktestWindow> planWindows(std::time_t until);
+    // Window-major order, so all jobs of a week run before the next week is prepared
+    static std::vector<BacktestTask> planTasks(const std::vector<BacktestJob>& jobs, const std::vector<BacktestWindow>& windows);
+    // Task indexes ordered by window, then by the symbols they read, so tasks sharing prepared data run together
+    static std::vector<size_t> localityOrder(const std::vector<BacktestTask>& tasks);
+    // Distinct prepared files a window of the jobs needs: symbol files, conversion pairs and aligned portfolios
+    static size_t preparedEntriesPerWindow(const std::vector<BacktestJob>& jobs);
+private:
+    static Instrument createInstrument(const SymbolInfo& symbolInfo);
+};
@@ -0,0 +1,115 @@
+#include "LeaseTable.h"
+#include <algorithm>
+
+LeaseTable::LeaseTable(size_t taskCount, size_t shardSize, std::chrono::milliseconds leaseDuration) {
+    this->finished.assign(taskCount, false);
+    this->finishedTasks = 0;
+    this->nextLeaseId = 1;
+    this->leaseDuration = leaseDuration;
+    shardSize = std::max<size_t>(shardSize, 1);
+    for (size_t start = 0; start < taskCount; start += shardSize) {
+        std::vector<size_t> shard;
+        for (size_t i = start; i < std::min(start + shardSize, taskCount); i++) {
+            shard.push_back(i);
+        }
+        pending.push_back(shard);
+    }
+}
+
+std::optional<LeaseTable::Lease> LeaseTable::acquire(const std::string& worker, Clock::time_point now) {
+    while (!pending.empty()) {
+        std::vector<size_t> shard = pending.front();
+        pending.pop_front();
+        // Tasks of a requeued shard may have been finished by a late report in the meantime
+        shard.erase(std::remove_if(shard.begin(), shard.end(), [this](size_t task) { return finished[task]; }), shard.end());
+        if (shard.empty()) {
+            continue;
+        }
+        Lease lease;
+        lease.id = nextLeaseId++;
+        lease.worker = worker;
+        lease.tasks = shard;
+        lease.expiresAt = now + leaseDuration;
+        leases[lease.id] = lease;
+        return lease;
+    }
+    return std::nullopt;
+}
+
+void LeaseTable::heartbeat(const std::string& worker, Clock::time_point now) {
+    for (auto& entry : leases) {
+        if (entry.second.worker == worker) {
+            entry.second.expiresAt = now + leaseDuration;
+        }
+    }
+}
+
+bool LeaseTable::finish(size_t leaseId, size_t task) {
+    if (task >= finished.size() || finished[task]) {
+        return false;
+    }
+    // A late result of an expired lease still counts, the reassigned copy is dropped instead
+    finished[task] = true;
+    finishedTasks++;
+    auto it = leases.find(leaseId);
+    if (it != leases.end()) {
+        const auto& tasks = it->second.tasks;
+        if (std::all_of(tasks.begin(), tasks.end(), [this](size_t leased) { return finished[leased]; })) {
+            leases.erase(it);
+        }
+    }
+    return true;
+}
+
+void LeaseTable::requeue(const Lease& lease) {
+    std::vector<size_t> shard;
+    for (size_t task : lease.tasks) {
+        if (!finished[task]) {
+            shard.push_back(task);
+        }
+    }
+    if (!shard.empty()) {
+        // Reassigned work goes first, it is the oldest
+        pending.push_front(shard);
+    }
+}
+
+std::vector<LeaseTable::Lease> LeaseTable::expire(Clock::time_point now) {
+    std::vector<Lease> expired;
+    for (auto it = leases.begin(); it != leases.end();) {
+        if (it->second.expiresAt <= now) {
+            requeue(it->second);
+            expired.push_back(it->second);
+            it = leases.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return expired;
+}
+
+std::vector<LeaseTable::Lease> LeaseTable::release(const std::string& worker) {
+    std::vector<Lease> released;
+    for (auto it = leases.begin(); it != leases.end();) {
+        if (it->second.worker == worker) {
+            requeue(it->second);
+            released.push_back(it->second);
+            it = leases.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return released;
+}
+
+size_t LeaseTable::taskCount() const {
+    return finished.size();
+}
+
+size_t LeaseTable::finishedCount() const {
+    return finishedTasks;
+}
+
+bool LeaseTable::isFinished() const {
+    return finishedTasks == finished.size();
+}
@@ -0,0 +1,47 @@
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <optional>
+#include <chrono>
+
+#pragma once
+
+// Bookkeeping of the coordinator: tasks are handed out in shards under time-limited leases.
+// A lease is extended by heartbeats of its worker; when it runs out the unfinished tasks go
+// back to the queue so another worker picks them up. Not thread-safe.
+class LeaseTable {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    class Lease {
+    public:
+        size_t id;
+        std::string worker;
+        std::vector<size_t> tasks;
+        Clock::time_point expiresAt;
+    };
+
+    LeaseTable(size_t taskCount, size_t shardSize, std::chrono::milliseconds leaseDuration);
+    // Next pending shard, nothing when all remaining tasks are leased or finished
+    std::optional<Lease> acquire(const std::string& worker, Clock::time_point now);
+    void heartbeat(const std::string& worker, Clock::time_point now);
+    // Records a task result. False when the task already has a result, which must then be dropped.
+    bool finish(size_t leaseId, size_t task);
+    // Requeues the unfinished tasks of leases that ran out, returns the expired leases
+    std::vector<Lease> expire(Clock::time_point now);
+    // Requeues everything the worker holds, e.g. when its connection drops
+    std::vector<Lease> release(const std::string& worker);
+    size_t taskCount() const;
+    size_t finishedCount() const;
+    bool isFinished() const;
+private:
+    std::deque<std::vector<size_t>> pending;
+    std::map<size_t, Lease> leases;
+    std::vector<bool> finished;
+    size_t finishedTasks;
+    size_t nextLeaseId;
+    std::chrono::milliseconds leaseDuration;
+
+    void requeue(const Lease& lease);
+};
@@ -0,0 +1,37 @@
+#include "LocalityScheduler.h"
+#include <algorithm>
+
+LocalityScheduler::LocalityScheduler(const std::vector<size_t>& order, size_t windowSize)
+    : order(order), windowSize(std::max<size_t>(1, windowSize)) {
+    size_t taskCount = order.empty() ? 0 : *std::max_element(order.begin(), order.end()) + 1;
+    positions.assign(taskCount, 0);
+    for (size_t i = 0; i < order.size(); i++) {
+        positions[order[i]] = i;
+    }
+    finished.assign(order.size(), false);
+}
+
+std::optional<size_t> LocalityScheduler::next(std::chrono::milliseconds wait) {
+    std::unique_lock<std::mutex> lock(mutex);
+    auto hasSlot = [&]() { return cursor >= order.size() || cursor < oldestUnfinished + windowSize; };
+    if (!windowMoved.wait_for(lock, wait, hasSlot) || cursor >= order.size()) {
+        return std::nullopt;
+    }
+    return order[cursor++];
+}
+
+void LocalityScheduler::finish(size_t task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished[positions[task]] = true;
+        while (oldestUnfinished < finished.size() && finished[oldestUnfinished]) {
+            oldestUnfinished++;
+        }
+    }
+    windowMoved.notify_all();
+}
+
+bool LocalityScheduler::exhausted() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return cursor >= order.size();
+}
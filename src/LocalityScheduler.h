@@ -0,0 +1,30 @@
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <optional>
+#include <chrono>
+
+#pragma once
+
+// Hands out tasks in a fixed order while keeping every task in flight within a bounded window:
+// a task is only started if it is less than windowSize positions after the oldest unfinished one.
+// With a locality order this keeps the running tasks on the same few weeks.
+class LocalityScheduler {
+public:
+    LocalityScheduler(const std::vector<size_t>& order, size_t windowSize);
+    // Next task, waiting up to wait for the window to move; nothing if it is still full or every task was handed out
+    std::optional<size_t> next(std::chrono::milliseconds wait = std::chrono::milliseconds(0));
+    void finish(size_t task);
+    // True once every task was handed out
+    bool exhausted();
+private:
+    std::vector<size_t> order;
+    // Position of each task in order
+    std::vector<size_t> positions;
+    std::vector<bool> finished;
+    size_t windowSize;
+    size_t cursor = 0;
+    size_t oldestUnfinished = 0;
+    std::mutex mutex;
+    std::condition_variable windowMoved;
+};
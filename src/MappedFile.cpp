@@ -0,0 +1,55 @@
+#include "MappedFile.h"
+#include <fstream>
+
+#ifdef _WIN32
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& path) {
+#ifdef _WIN32
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return;
+    }
+    owned.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    if (!file.read(owned.data(), static_cast<std::streamsize>(owned.size()))) {
+        owned.clear();
+    }
+    length = owned.size();
+#else
+    int descriptor = open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        return;
+    }
+    struct stat status;
+    if (fstat(descriptor, &status) == 0 && status.st_size > 0) {
+        void* result = mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, descriptor, 0);
+        if (result != MAP_FAILED) {
+            mapping = result;
+            length = static_cast<size_t>(status.st_size);
+        }
+    }
+    close(descriptor);
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifndef _WIN32
+    if (mapping != nullptr) {
+        munmap(mapping, length);
+    }
+#endif
+}
+
+const char* MappedFile::data() const {
+    return mapping != nullptr ? static_cast<const char*>(mapping) : owned.data();
+}
+
+size_t MappedFile::size() const {
+    return length;
+}
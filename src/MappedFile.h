@@ -0,0 +1,20 @@
+#include <string>
+#include <vector>
+#include <cstddef>
+
+#pragma once
+
+// A whole file mapped read-only. Without mmap (Windows) the file is read into memory instead.
+class MappedFile {
+    void* mapping = nullptr;
+    size_t length = 0;
+    std::vector<char> owned;
+public:
+    // An empty file, or one that cannot be opened, maps to no data
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    const char* data() const;
+    size_t size() const;
+};
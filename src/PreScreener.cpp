@@ -0,0 +1,237 @@
+#include "PreScreener.h"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <stdexcept>
+
+void ScreeningKernels::midAndHalfSpread(const double* bid, const double* ask, double* mid, double* halfSpread, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        mid[i] = (bid[i] + ask[i]) * 0.5;
+        halfSpread[i] = (ask[i] - bid[i]) * 0.5;
+    }
+}
+
+void ScreeningKernels::compareSigns(const double* left, const double* right, size_t count, double* output) {
+    for (size_t i = 0; i < count; i++) {
+        output[i] = static_cast<double>(left[i] > right[i]) - static_cast<double>(left[i] < right[i]);
+    }
+}
+
+double ScreeningKernels::positionProfit(const double* position, const double* mid, const double* halfSpread, size_t count) {
+    if (count == 0) {
+        return 0.0;
+    }
+    double lanes[4] = { 0.0, 0.0, 0.0, 0.0 };
+    size_t i = 1;
+    for (; i + 4 <= count; i += 4) {
+        for (size_t lane = 0; lane < 4; lane++) {
+            size_t bar = i + lane;
+            lanes[lane] += position[bar - 1] * (mid[bar] - mid[bar - 1]) - std::fabs(position[bar] - position[bar - 1]) * halfSpread[bar];
+        }
+    }
+    double result = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    for (; i < count; i++) {
+        result += position[i - 1] * (mid[i] - mid[i - 1]) - std::fabs(position[i] - position[i - 1]) * halfSpread[i];
+    }
+    // Opening at the first bar and closing at the last one cross the spread too
+    return result - std::fabs(position[0]) * halfSpread[0] - std::fabs(position[count - 1]) * halfSpread[count - 1];
+}
+
+PreScreener::PreScreener(const BarColumns& bars, IndicatorCache* cache, const std::string& symbol, const std::string& period,
+    const std::vector<size_t>& weekStarts)
+    : bars(bars), count(bars.size()), cache(cache), weekStarts(weekStarts) {
+    if (this->cache == nullptr) {
+        ownedCache = std::make_unique<IndicatorCache>("", std::numeric_limits<size_t>::max());
+        this->cache = ownedCache.get();
+    }
+    key.symbol = symbol;
+    key.period = period;
+    key.bars = IndicatorCache::fingerprint(bars);
+    mid.resize(count);
+    halfSpread.resize(count);
+    ScreeningKernels::midAndHalfSpread(bars.bidClose.data(), bars.askClose.data(), mid.data(), halfSpread.data(), count);
+}
+
+std::optional<ScreeningFamily> PreScreener::parseFamily(const std::string& name) {
+    if (name == "ma_cross") {
+        return ScreeningFamily::MovingAverageCross;
+    }
+    if (name == "breakout") {
+        return ScreeningFamily::Breakout;
+    }
+    if (name == "rsi") {
+        return ScreeningFamily::RsiThreshold;
+    }
+    return std::nullopt;
+}
+
+std::vector<std::string> PreScreener::parameterNames(ScreeningFamily family) {
+    switch (family) {
+    case ScreeningFamily::MovingAverageCross:
+        return { "Fast", "Slow" };
+    case ScreeningFamily::Breakout:
+        return { "Period" };
+    case ScreeningFamily::RsiThreshold:
+        return { "Period", "Lower", "Upper" };
+    }
+    return {};
+}
+
+std::shared_ptr<const IndicatorSeries> PreScreener::indicator(IndicatorType type, size_t length) {
+    IndicatorKey series = key;
+    series.type = type;
+    series.length = length;
+    return cache->get(series, bars);
+}
+
+const std::vector<double>& PreScreener::breakoutSignal(size_t period) {
+    auto found = breakoutSignals.find(period);
+    if (found != breakoutSignals.end()) {
+        return found->second;
+    }
+    std::vector<double> signals(count, 0.0);
+    // Monotonic queues of the previous period closes
+    std::deque<size_t> highs;
+    std::deque<size_t> lows;
+    for (size_t i = 0; i < count; i++) {
+        if (i >= period) {
+            if (mid[i] > mid[highs.front()]) {
+                signals[i] = 1.0;
+            } else if (mid[i] < mid[lows.front()]) {
+                signals[i] = -1.0;
+            }
+        }
+        while (!highs.empty() && mid[highs.back()] <= mid[i]) {
+            highs.pop_back();
+        }
+        highs.push_back(i);
+        while (!lows.empty() && mid[lows.back()] >= mid[i]) {
+            lows.pop_back();
+        }
+        lows.push_back(i);
+        while (highs.front() + period <= i) {
+            highs.pop_front();
+        }
+        while (lows.front() + period <= i) {
+            lows.pop_front();
+        }
+    }
+    std::vector<double>& held = breakoutSignals[period];
+    holdSignals(signals, held);
+    return held;
+}
+
+void PreScreener::holdSignals(const std::vector<double>& signals, std::vector<double>& position) {
+    position.resize(signals.size());
+    double current = 0.0;
+    for (size_t i = 0; i < signals.size(); i++) {
+        current = signals[i] != 0.0 ? signals[i] : current;
+        position[i] = current;
+    }
+}
+
+ScreeningScore PreScreener::simulate() {
+    // Flat over every weekend, so the gap to the next open is not traded
+    for (size_t start : weekStarts) {
+        if (start > 0 && start <= count) {
+            position[start - 1] = 0.0;
+        }
+    }
+    ScreeningScore result;
+    result.profit = ScreeningKernels::positionProfit(position.data(), mid.data(), halfSpread.data(), count);
+    double previous = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        result.trades += position[i] != previous && position[i] != 0.0 ? 1 : 0;
+        previous = position[i];
+    }
+    return result;
+}
+
+std::optional<ScreeningScore> PreScreener::score(ScreeningFamily family, const std::vector<StrategyParameter>& parameters) {
+    std::map<std::string, double> values;
+    for (const auto& name : parameterNames(family)) {
+        auto found = std::find_if(parameters.begin(), parameters.end(), [&](const StrategyParameter& parameter) { return parameter.name == name; });
+        if (found == parameters.end()) {
+            return std::nullopt;
+        }
+        try {
+            values[name] = std::stod(found->value);
+        } catch (const std::exception&) {
+            return std::nullopt;
+        }
+    }
+    auto periodOf = [&](const std::string& name) -> std::optional<size_t> {
+        double value = values[name];
+        if (!(value >= 1.0) || value >= static_cast<double>(count)) {
+            return std::nullopt;
+        }
+        return static_cast<size_t>(value);
+    };
+
+    position.assign(count, 0.0);
+    switch (family) {
+    case ScreeningFamily::MovingAverageCross: {
+        auto fast = periodOf("Fast");
+        auto slow = periodOf("Slow");
+        if (!fast.has_value() || !slow.has_value()) {
+            return std::nullopt;
+        }
+        auto fastAverage = indicator(IndicatorType::SimpleMovingAverage, fast.value());
+        auto slowAverage = indicator(IndicatorType::SimpleMovingAverage, slow.value());
+        ScreeningKernels::compareSigns(fastAverage->data(), slowAverage->data(), count, position.data());
+        break;
+    }
+    case ScreeningFamily::Breakout: {
+        auto period = periodOf("Period");
+        if (!period.has_value()) {
+            return std::nullopt;
+        }
+        position = breakoutSignal(period.value());
+        break;
+    }
+    case ScreeningFamily::RsiThreshold: {
+        auto period = periodOf("Period");
+        if (!period.has_value()) {
+            return std::nullopt;
+        }
+        double lower = values["Lower"];
+        double upper = values["Upper"];
+        if (!(lower < upper)) {
+            return std::nullopt;
+        }
+        auto levels = indicator(IndicatorType::RelativeStrengthIndex, period.value());
+        std::vector<double> signals(count);
+        for (size_t i = 0; i < count; i++) {
+            // NaN during warm-up compares false both ways
+            signals[i] = static_cast<double>((*levels)[i] < lower) - static_cast<double>((*levels)[i] > upper);
+        }
+        holdSignals(signals, position);
+        break;
+    }
+    }
+    return simulate();
+}
+
+std::vector<size_t> PreScreener::selectTop(ScreeningFamily family, const std::vector<BacktestJob>& jobs, size_t count) {
+    std::vector<ScreeningScore> scores;
+    std::vector<size_t> unscored;
+    for (size_t i = 0; i < jobs.size(); i++) {
+        auto result = score(family, jobs[i].project.strategyParameters);
+        if (!result.has_value()) {
+            unscored.push_back(i);
+            continue;
+        }
+        result->job = i;
+        scores.push_back(result.value());
+    }
+    std::stable_sort(scores.begin(), scores.end(), [](const ScreeningScore& left, const ScreeningScore& right) {
+        return left.profit > right.profit;
+    });
+    std::vector<size_t> selected;
+    for (size_t i = 0; i < scores.size() && i < count; i++) {
+        selected.push_back(scores[i].job);
+    }
+    selected.insert(selected.end(), unscored.begin(), unscored.end());
+    return selected;
+}
@@ -0,0 +1,76 @@
+#include <string>
+#include <vector>
+#include <map>
+#include <optional>
+#include "BarColumns.h"
+#include "BacktestJob.h"
+#include "IndicatorCache.h"
+
+#pragma once
+
+enum class ScreeningFamily {
+    // Long while the Fast SMA is above the Slow one, short while below
+    MovingAverageCross,
+    // Long on a close above the highest close of the last Period bars, short below the lowest
+    Breakout,
+    // Long when the Period RSI drops below Lower, short when it rises above Upper
+    RsiThreshold
+};
+
+class ScreeningScore {
+public:
+    // Index of the job in the screened list
+    size_t job = 0;
+    // Net result of a fixed one-unit position in price units, spread included
+    double profit = 0.0;
+    size_t trades = 0;
+};
+
+// Kernels over contiguous columns for the screening simulation, plain loops without loop-carried
+// dependencies so the compiler vectorizes them
+class ScreeningKernels {
+public:
+    // Mid price and half spread of every bar close
+    static void midAndHalfSpread(const double* bid, const double* ask, double* mid, double* halfSpread, size_t count);
+    // +1 where left > right, -1 where left < right, 0 otherwise
+    static void compareSigns(const double* left, const double* right, size_t count, double* output);
+    // Result of holding position[i] from close i to close i + 1, every change filled at the bid or ask
+    static double positionProfit(const double* position, const double* mid, const double* halfSpread, size_t count);
+};
+
+// Bar-close simulation of simple strategy families over columnar bid/ask bars, used to drop
+// parameter sets before they cost a run of the external backtester. Moving averages and RSIs come
+// from the indicator cache, so they are computed once per length and shared by every parameter set.
+class PreScreener {
+public:
+    // bars must outlive the screener; without a cache the series are kept in memory by the screener.
+    // weekStarts are the indexes of bars opening a new week, the position is closed before each of them.
+    PreScreener(const BarColumns& bars, IndicatorCache* cache = nullptr, const std::string& symbol = "", const std::string& period = "",
+        const std::vector<size_t>& weekStarts = {});
+    // ma_cross, breakout or rsi
+    static std::optional<ScreeningFamily> parseFamily(const std::string& name);
+    // Strategy parameters the family reads: Fast and Slow, Period, or Period, Lower and Upper
+    static std::vector<std::string> parameterNames(ScreeningFamily family);
+    // Nothing if a parameter is missing or invalid
+    std::optional<ScreeningScore> score(ScreeningFamily family, const std::vector<StrategyParameter>& parameters);
+    // Scores every job and returns the indexes of the count most profitable ones, best first.
+    // Jobs the family cannot score are kept.
+    std::vector<size_t> selectTop(ScreeningFamily family, const std::vector<BacktestJob>& jobs, size_t count);
+private:
+    const BarColumns& bars;
+    size_t count;
+    std::unique_ptr<IndicatorCache> ownedCache;
+    IndicatorCache* cache;
+    IndicatorKey key;
+    std::vector<size_t> weekStarts;
+    std::vector<double> mid;
+    std::vector<double> halfSpread;
+    std::map<size_t, std::vector<double>> breakoutSignals;
+    std::vector<double> position;
+
+    std::shared_ptr<const IndicatorSeries> indicator(IndicatorType type, size_t length);
+    const std::vector<double>& breakoutSignal(size_t period);
+    ScreeningScore simulate();
+    // Keeps the last non-zero signal until the next one
+    static void holdSignals(const std::vector<double>& signals, std::vector<double>& position);
+};
@@ -0,0 +1,195 @@
+#include "PreparedDataCache.h"
+#include <filesystem>
+#include "TimeUtils.h"
+
+PreparedDataCache::Lease::Lease(Lease&& other) noexcept
+    : cache(other.cache), entries(std::move(other.entries)), paths(std::move(other.paths)) {
+    other.cache = nullptr;
+    other.entries.clear();
+}
+
+PreparedDataCache::Lease& PreparedDataCache::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        release();
+        cache = other.cache;
+        entries = std::move(other.entries);
+        paths = std::move(other.paths);
+        other.cache = nullptr;
+        other.entries.clear();
+    }
+    return *this;
+}
+
+PreparedDataCache::Lease::~Lease() {
+    release();
+}
+
+void PreparedDataCache::Lease::release() {
+    if (cache != nullptr) {
+        for (const auto& entry : entries) {
+            cache->releaseEntry(entry);
+        }
+    }
+    cache = nullptr;
+    entries.clear();
+}
+
+PreparedDataCache::PreparedDataCache(RatesStorageProvider& ratesStorageProvider, WorkspaceManager& workspaces)
+    : ratesStorageProvider(ratesStorageProvider), workspaces(workspaces) {
+}
+
+PreparedDataCache::~PreparedDataCache() {
+    clear();
+}
+
+std::optional<PreparedDataCache::Lease> PreparedDataCache::acquire(const std::string& symbol, const std::tm& weekStart, const std::string& period) {
+    return acquire(std::vector<std::string>{ symbol }, weekStart, AlignmentMode::Union, period);
+}
+
+std::optional<PreparedDataCache::Lease> PreparedDataCache::acquire(const std::vector<std::string>& symbols, const std::tm& weekStart, AlignmentMode mode, const std::string& period) {
+    Lease lease;
+    lease.cache = this;
+    auto add = [&](const std::shared_ptr<Entry>& entry) {
+        lease.entries.push_back(entry);
+        if (!entry->paths.has_value()) {
+            return false;
+        }
+        lease.paths.insert(lease.paths.end(), entry->paths.value().begin(), entry->paths.value().end());
+        return true;
+    };
+    if (mode == AlignmentMode::Intersection && symbols.size() > 1) {
+        if (!add(acquireEntry(symbols, weekStart, mode, period))) {
+            return std::nullopt;
+        }
+        return lease;
+    }
+    // Without alignment a portfolio file is the plain symbol file, so it is shared with every other job using that symbol
+    for (const auto& symbol : symbols) {
+        if (!add(acquireEntry(std::vector<std::string>{ symbol }, weekStart, AlignmentMode::Union, period))) {
+            return std::nullopt;
+        }
+    }
+    return lease;
+}
+
+std::shared_ptr<PreparedDataCache::Entry> PreparedDataCache::acquireEntry(const std::vector<std::string>& symbols, const std::tm& weekStart, AlignmentMode mode, const std::string& period) {
+    std::string key;
+    for (const auto& symbol : symbols) {
+        key += symbol + ",";
+    }
+    key += "@" + std::to_string(TimeUtils::toEpochSeconds(weekStart)) + "@" + period;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    auto it = entries.find(key);
+    if (it != entries.end()) {
+        // Someone else prepares or prepared it, wait until the files are complete
+        std::shared_ptr<Entry> entry = it->second;
+        if (entry->idle) {
+            idleEntries.remove(entry);
+            entry->idle = false;
+        }
+        entry->users++;
+        counters.reused++;
+        entryReady.wait(lock, [&]() { return entry->ready; });
+        return entry;
+    }
+    auto entry = std::make_shared<Entry>();
+    entry->key = key;
+    entry->users = 1;
+    entries[key] = entry;
+    counters.prepared++;
+    lock.unlock();
+
+    // Prepared files are about as large as the m1 history they come from
+    uintmax_t expectedBytes = 0;
+    for (const auto& symbol : symbols) {
+        expectedBytes += ratesStorageProvider.getWeekHistoryBytes(symbol, weekStart);
+    }
+    std::string workspace = workspaces.create("prepared", expectedBytes);
+    std::optional<std::vector<std::string>> paths;
+    try {
+        paths = ratesStorageProvider.prepareWeekData(symbols, weekStart, mode, period, workspace);
+    } catch (...) {
+        paths = std::nullopt;
+    }
+
+    lock.lock();
+    entry->workspace = workspace;
+    entry->paths = paths;
+    entry->ready = true;
+    lock.unlock();
+    entryReady.notify_all();
+    return entry;
+}
+
+void PreparedDataCache::releaseEntry(const std::shared_ptr<Entry>& entry) {
+    std::vector<std::string> released;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--entry->users > 0) {
+            return;
+        }
+        auto it = entries.find(entry->key);
+        if (it == entries.end() || it->second != entry) {
+            return;
+        }
+        // Weeks without history are kept too, so they are not looked up again by every job
+        if (idleLimit > 0) {
+            entry->idle = true;
+            idleEntries.push_back(entry);
+            released = evictIdle(idleLimit);
+        } else {
+            entries.erase(it);
+            released.push_back(entry->workspace);
+        }
+    }
+    for (const auto& workspace : released) {
+        workspaces.release(workspace);
+    }
+}
+
+std::vector<std::string> PreparedDataCache::evictIdle(size_t limit) {
+    std::vector<std::string> released;
+    while (idleEntries.size() > limit) {
+        std::shared_ptr<Entry> entry = idleEntries.front();
+        idleEntries.pop_front();
+        entry->idle = false;
+        entries.erase(entry->key);
+        released.push_back(entry->workspace);
+    }
+    return released;
+}
+
+void PreparedDataCache::clear() {
+    std::vector<std::string> released;
+    {
+        // Entries still leased or being prepared are removed by their last user
+        std::lock_guard<std::mutex> lock(mutex);
+        released = evictIdle(0);
+    }
+    for (const auto& workspace : released) {
+        workspaces.release(workspace);
+    }
+}
+
+void PreparedDataCache::setIdleLimit(size_t limit) {
+    std::vector<std::string> released;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        idleLimit = limit;
+        released = evictIdle(limit);
+    }
+    for (const auto& workspace : released) {
+        workspaces.release(workspace);
+    }
+}
+
+PreparedDataCache::Stats PreparedDataCache::stats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return counters;
+}
+
+size_t PreparedDataCache::size() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
@@ -0,0 +1,84 @@
+#include <string>
+#include <vector>
+#include <map>
+#include <list>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <optional>
+#include <ctime>
+#include "RatesStorageProvider.h"
+#include "WorkspaceManager.h"
+
+#pragma once
+
+// Prepares each (symbols, week, period) once and hands the same read-only files to every job that asks for them.
+// The first requester prepares the files while concurrent requesters wait for them to be complete; the files
+// are removed as soon as the last lease on them is gone, unless the idle limit keeps them for the next job.
+class PreparedDataCache {
+    class Entry {
+    public:
+        std::string key;
+        bool ready = false;
+        std::optional<std::vector<std::string>> paths;
+        // Directory holding the files
+        std::string workspace;
+        size_t users = 0;
+        bool idle = false;
+    };
+public:
+    class Stats {
+    public:
+        // Entries converted from history
+        size_t prepared = 0;
+        // Requests served by an entry that was already prepared or being prepared
+        size_t reused = 0;
+        double hitRate() const { return prepared + reused > 0 ? static_cast<double>(reused) / (prepared + reused) : 0.0; }
+    };
+
+    // Keeps the prepared files alive while a job uses them
+    class Lease {
+        PreparedDataCache* cache = nullptr;
+        std::vector<std::shared_ptr<Entry>> entries;
+        friend class PreparedDataCache;
+    public:
+        // One path per requested symbol
+        std::vector<std::string> paths;
+
+        Lease() = default;
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) noexcept;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease();
+        void release();
+    };
+
+    PreparedDataCache(RatesStorageProvider& ratesStorageProvider, WorkspaceManager& workspaces = WorkspaceManager::shared());
+    ~PreparedDataCache();
+    std::optional<Lease> acquire(const std::string& symbol, const std::tm& weekStart, const std::string& period);
+    // Portfolio files, aligned together; one path per symbol
+    std::optional<Lease> acquire(const std::vector<std::string>& symbols, const std::tm& weekStart, AlignmentMode mode, const std::string& period);
+    // Removes every prepared file, call once no job uses them anymore
+    void clear();
+    // Number of (symbols, week, period) entries with files on disk
+    size_t size();
+    // Entries nobody leases are kept, least recently released removed first, while there are more than limit
+    void setIdleLimit(size_t limit);
+    Stats stats();
+private:
+    RatesStorageProvider& ratesStorageProvider;
+    WorkspaceManager& workspaces;
+    std::mutex mutex;
+    std::condition_variable entryReady;
+    std::map<std::string, std::shared_ptr<Entry>> entries;
+    // Least recently released first
+    std::list<std::shared_ptr<Entry>> idleEntries;
+    size_t idleLimit = 0;
+    Stats counters;
+
+    std::shared_ptr<Entry> acquireEntry(const std::vector<std::string>& symbols, const std::tm& weekStart, AlignmentMode mode, const std::string& period);
+    void releaseEntry(const std::shared_ptr<Entry>& entry);
+    // Drops idle entries beyond the limit, returns their workspaces to remove without the lock
+    std::vector<std::string> evictIdle(size_t limit);
+};
@@ -0,0 +1,185 @@
+#include "ProcessRunner.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <process.h>
+#include <psapi.h>
+#else
+#include <csignal>
+#include <cerrno>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    void killProcess(intptr_t process) {
+#ifdef _WIN32
+        TerminateProcess(reinterpret_cast<HANDLE>(process), 1);
+#else
+        // The child leads its own process group, so helpers it started die with it
+        ::kill(-static_cast<pid_t>(process), SIGKILL);
+#endif
+    }
+}
+
+void ProcessCancellation::cancel() {
+    std::lock_guard<std::mutex> lock(mutex);
+    cancelled = true;
+    if (process != 0) {
+        killProcess(process);
+    }
+}
+
+bool ProcessCancellation::isCancelled() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return cancelled;
+}
+
+bool ProcessCancellation::attach(intptr_t process) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->process = process;
+    return !cancelled;
+}
+
+void ProcessCancellation::detach() {
+    std::lock_guard<std::mutex> lock(mutex);
+    process = 0;
+}
+
+#ifdef _WIN32
+
+int ProcessRunner::run(const std::vector<std::string>& arguments, ProcessCancellation* cancellation, ProcessUsage* usage) {
+    std::string commandLine;
+    for (const auto& argument : arguments) {
+        commandLine += (commandLine.empty() ? "\"" : " \"") + argument + "\"";
+    }
+    STARTUPINFOA startupInfo = {};
+    startupInfo.cb = sizeof(startupInfo);
+    PROCESS_INFORMATION processInfo = {};
+    if (!CreateProcessA(nullptr, &commandLine[0], nullptr, nullptr, FALSE, 0, nullptr, nullptr, &startupInfo, &processInfo)) {
+        return -1;
+    }
+    CloseHandle(processInfo.hThread);
+    if (usage != nullptr) {
+        usage->spawned = true;
+    }
+    if (cancellation != nullptr && !cancellation->attach(reinterpret_cast<intptr_t>(processInfo.hProcess))) {
+        TerminateProcess(processInfo.hProcess, 1);
+    }
+    WaitForSingleObject(processInfo.hProcess, INFINITE);
+    if (cancellation != nullptr) {
+        cancellation->detach();
+    }
+    DWORD exitCode = 0;
+    int result = GetExitCodeProcess(processInfo.hProcess, &exitCode) ? static_cast<int>(exitCode) : -1;
+    if (usage != nullptr) {
+        FILETIME creation, exit, kernel, user;
+        if (GetProcessTimes(processInfo.hProcess, &creation, &exit, &kernel, &user)) {
+            auto toSeconds = [](const FILETIME& time) {
+                return ((static_cast<unsigned long long>(time.dwHighDateTime) << 32) | time.dwLowDateTime) / 1e7;
+            };
+            usage->userSeconds = toSeconds(user);
+            usage->systemSeconds = toSeconds(kernel);
+        }
+        PROCESS_MEMORY_COUNTERS memory = {};
+        if (K32GetProcessMemoryInfo(processInfo.hProcess, &memory, sizeof(memory))) {
+            usage->maxRssKb = static_cast<long>(memory.PeakWorkingSetSize / 1024);
+            usage->minorFaults = static_cast<long>(memory.PageFaultCount);
+        }
+        IO_COUNTERS io = {};
+        if (GetProcessIoCounters(processInfo.hProcess, &io)) {
+            usage->blockInputs = static_cast<long>(io.ReadOperationCount);
+            usage->blockOutputs = static_cast<long>(io.WriteOperationCount);
+        }
+    }
+    CloseHandle(processInfo.hProcess);
+    if (cancellation != nullptr && cancellation->isCancelled()) {
+        return -1;
+    }
+    return result;
+}
+
+long ProcessRunner::currentProcessId() {
+    return static_cast<long>(_getpid());
+}
+
+bool ProcessRunner::isProcessAlive(long processId) {
+    HANDLE process = OpenProcess(SYNCHRONIZE, FALSE, static_cast<DWORD>(processId));
+    if (process == nullptr) {
+        return GetLastError() == ERROR_ACCESS_DENIED;
+    }
+    bool alive = WaitForSingleObject(process, 0) == WAIT_TIMEOUT;
+    CloseHandle(process);
+    return alive;
+}
+
+#else
+
+int ProcessRunner::run(const std::vector<std::string>& arguments, ProcessCancellation* cancellation, ProcessUsage* usage) {
+    if (arguments.empty()) {
+        return -1;
+    }
+    // Build argv before forking, only async-signal-safe calls are allowed in the child
+    std::vector<char*> argv;
+    for (const auto& argument : arguments) {
+        argv.push_back(const_cast<char*>(argument.c_str()));
+    }
+    argv.push_back(nullptr);
+
+    pid_t pid = ::fork();
+    if (pid < 0) {
+        return -1;
+    }
+    if (pid == 0) {
+        ::setpgid(0, 0);
+        ::execv(argv[0], argv.data());
+        ::_exit(127);
+    }
+    if (usage != nullptr) {
+        usage->spawned = true;
+    }
+    // Set the group from both sides, so it exists before anyone can try to kill it
+    ::setpgid(pid, pid);
+    if (cancellation != nullptr && !cancellation->attach(pid)) {
+        killProcess(pid);
+    }
+    // Wait without reaping first, so a concurrent cancel() can never hit a recycled process id
+    siginfo_t info;
+    while (::waitid(P_PID, static_cast<id_t>(pid), &info, WEXITED | WNOWAIT) < 0 && errno == EINTR) {
+    }
+    if (cancellation != nullptr) {
+        cancellation->detach();
+    }
+    int status = 0;
+    struct rusage resources = {};
+    while (::wait4(pid, &status, 0, &resources) < 0 && errno == EINTR) {
+    }
+    if (usage != nullptr) {
+        usage->userSeconds = resources.ru_utime.tv_sec + resources.ru_utime.tv_usec / 1e6;
+        usage->systemSeconds = resources.ru_stime.tv_sec + resources.ru_stime.tv_usec / 1e6;
+        // Kilobytes on Linux, bytes on macOS
+#ifdef __APPLE__
+        usage->maxRssKb = resources.ru_maxrss / 1024;
+#else
+        usage->maxRssKb = resources.ru_maxrss;
+#endif
+        usage->minorFaults = resources.ru_minflt;
+        usage->majorFaults = resources.ru_majflt;
+        usage->blockInputs = resources.ru_inblock;
+        usage->blockOutputs = resources.ru_oublock;
+    }
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+long ProcessRunner::currentProcessId() {
+    return static_cast<long>(::getpid());
+}
+
+bool ProcessRunner::isProcessAlive(long processId) {
+    // EPERM means it exists but belongs to someone else
+    return ::kill(static_cast<pid_t>(processId), 0) == 0 || errno == EPERM;
+}
+
+#endif
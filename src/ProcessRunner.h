@@ -0,0 +1,45 @@
+#include <string>
+#include <vector>
+#include <mutex>
+#include <cstdint>
+
+#pragma once
+
+// Lets another thread kill a child process started by ProcessRunner
+class ProcessCancellation {
+    std::mutex mutex;
+    // Process id, or the process handle on Windows; 0 while nothing runs
+    intptr_t process = 0;
+    bool cancelled = false;
+public:
+    // Kills the running child, or the next one as soon as it starts
+    void cancel();
+    bool isCancelled();
+    // Returns false if cancel() came first, the caller must then kill the child itself
+    bool attach(intptr_t process);
+    void detach();
+};
+
+// Resources used by a child process and the descendants it waited for
+class ProcessUsage {
+public:
+    // A child process was started, even if it failed or was killed later; the fields below are zero otherwise
+    bool spawned = false;
+    double userSeconds = 0.0;
+    double systemSeconds = 0.0;
+    long maxRssKb = 0;
+    long minorFaults = 0;
+    long majorFaults = 0;
+    // Block input and output operations, read and write operations on Windows
+    long blockInputs = 0;
+    long blockOutputs = 0;
+};
+
+class ProcessRunner {
+public:
+    // Runs the program without a shell, arguments[0] is the executable. Returns its exit code,
+    // -1 if it could not be started or did not exit normally (e.g. killed).
+    static int run(const std::vector<std::string>& arguments, ProcessCancellation* cancellation = nullptr, ProcessUsage* usage = nullptr);
+    static long currentProcessId();
+    static bool isProcessAlive(long processId);
+};
@@ -2,11 +2,19 @@
 #include <filesystem>
 #include "StorageReader.h"
 #include "IndicoreRatesSerializer.h"
+#include "BarResampler.h"
+#include "TickBarReader.h"
+#include "BarStore.h"
+#include "BarCodec.h"
+#include "TimeUtils.h"
 #include <algorithm>
 #include <fstream>
+#include <iostream>
 
-RatesStorageProvider::RatesStorageProvider(const std::string& historyPath) {
+RatesStorageProvider::RatesStorageProvider(const std::string& historyPath, const std::optional<std::string>& catalogSnapshotPath)
+    : catalog(historyPath, catalogSnapshotPath) {
     this->historyPath = historyPath;
+    this->sessionOffsetSeconds = 0;
 }
 
 int RatesStorageProvider::getWeekNumber(const std::tm& date) {
@@ -15,6 +23,17 @@ int RatesStorageProvider::getWeekNumber(const std::tm& date) {
     return firstJan.tm_yday / 7 + 1;
 }
 
+std::pair<long long, long long> RatesStorageProvider::getWeekRange(const std::tm& date) {
+    const long long day = 24 * 60 * 60;
+    std::tm firstJan{};
+    firstJan.tm_year = date.tm_year;
+    firstJan.tm_mday = 1;
+    std::tm nextJan = firstJan;
+    nextJan.tm_year++;
+    long long start = TimeUtils::toEpochSeconds(firstJan) + (getWeekNumber(date) - 1) * 7 * day;
+    return { start, std::min(start + 7 * day, TimeUtils::toEpochSeconds(nextJan)) };
+}
+
 std::string RatesStorageProvider::escapeSymbol(const std::string& symbol) {
     std::string escapedSymbol = symbol;
     escapedSymbol.erase(std::remove(escapedSymbol.begin(), escapedSymbol.end(), '/'), escapedSymbol.end());
@@ -22,35 +41,351 @@ std::string RatesStorageProvider::escapeSymbol(const std::string& symbol) {
 }
 
 std::optional<SymbolInfo> RatesStorageProvider::getSymbolInfo(const std::string& symbol) {
-    std::string escapedSymbol = escapeSymbol(symbol);
-    std::string symbolInfoPath = historyPath + "/" + escapedSymbol + "/info.json";
-    if (!std::filesystem::exists(symbolInfoPath)) {
+    std::call_once(catalogLoaded, [this]() { catalog.load(); });
+    return catalog.find(escapeSymbol(symbol));
+}
+
+HistoryFormat RatesStorageProvider::getHistoryFormat(const std::string& symbol) {
+    auto info = getSymbolInfo(symbol);
+    return info.has_value() ? info.value().historyFormat : HistoryFormat::Standard;
+}
+
+void RatesStorageProvider::setSessionOffset(long long sessionOffsetSeconds) {
+    this->sessionOffsetSeconds = sessionOffsetSeconds;
+}
+
+long long RatesStorageProvider::getSessionOffset() const {
+    return sessionOffsetSeconds;
+}
+
+void RatesStorageProvider::setBarStore(const std::string& path) {
+    barStorePath = path;
+}
+
+std::optional<std::string> RatesStorageProvider::getBarStorePath() const {
+    return barStorePath;
+}
+
+std::optional<std::string> RatesStorageProvider::getBarStore(const std::string& symbol) {
+    if (!barStorePath.has_value()) {
+        return std::nullopt;
+    }
+    std::filesystem::path path = std::filesystem::path(barStorePath.value()) / escapeSymbol(symbol);
+    std::error_code error;
+    if (!std::filesystem::is_directory(path, error)) {
+        return std::nullopt;
+    }
+    return path.string();
+}
+
+bool RatesStorageProvider::readRange(const std::string& symbol, long long start, long long end, const std::string& period, BarColumns& output) {
+    auto periodSeconds = BarResampler::parsePeriod(period);
+    auto store = getBarStore(symbol);
+    if (!periodSeconds.has_value() || !store.has_value()) {
+        return false;
+    }
+    BarStoreReader reader(store.value());
+    if (periodSeconds.value() <= 60) {
+        return reader.read(start, end, output) > 0;
+    }
+    // Stored bars are m1, aggregated span by span straight from the mapped columns
+    BarResampler resampler(periodSeconds.value(), sessionOffsetSeconds);
+    BarColumns chunk;
+    bool found = false;
+    for (const auto& span : reader.range(start, end)) {
+        chunk.clear();
+        chunk.time.assign(span.time, span.time + span.count);
+        chunk.bidOpen.assign(span.bidOpen, span.bidOpen + span.count);
+        chunk.bidHigh.assign(span.bidHigh, span.bidHigh + span.count);
+        chunk.bidLow.assign(span.bidLow, span.bidLow + span.count);
+        chunk.bidClose.assign(span.bidClose, span.bidClose + span.count);
+        chunk.askOpen.assign(span.askOpen, span.askOpen + span.count);
+        chunk.askHigh.assign(span.askHigh, span.askHigh + span.count);
+        chunk.askLow.assign(span.askLow, span.askLow + span.count);
+        chunk.askClose.assign(span.askClose, span.askClose + span.count);
+        chunk.volume.assign(span.volume, span.volume + span.count);
+        resampler.push(chunk, output);
+        found = true;
+    }
+    resampler.flush(output);
+    return found;
+}
+
+std::optional<std::string> RatesStorageProvider::prepareWeekData(const std::string& symbol, const std::tm& currentDate, const std::string& period) {
+    auto paths = prepareWeekData(std::vector<std::string>{ symbol }, currentDate, AlignmentMode::Union, period);
+    if (!paths.has_value()) {
         return std::nullopt;
     }
-    return SymbolInfoParser::parse(symbolInfoPath);
+    return paths.value()[0];
 }
 
-std::optional<std::string> RatesStorageProvider::prepareWeekData(const std::string& symbol, const std::tm& currentDate) {
+std::string RatesStorageProvider::getWeekFile(const std::string& symbol, const std::tm& currentDate) {
     int week = getWeekNumber(currentDate);
-    std::string escapedSymbol = escapeSymbol(symbol);
-    std::string fileName = std::to_string(currentDate.tm_year + 1900) + "-" + std::to_string(week) + ".csv";
-    auto storagePath = historyPath + "/" + escapedSymbol + "/" + fileName;
-    std::ifstream file(storagePath);
+    return escapeSymbol(symbol) + "/" + std::to_string(currentDate.tm_year + 1900) + "-" + std::to_string(week) + ".csv";
+}
+
+std::string RatesStorageProvider::getWeekSourcePath(const std::string& symbol, const std::tm& currentDate) {
+    return historyPath + "/" + getWeekFile(symbol, currentDate);
+}
+
+std::string RatesStorageProvider::getCompressedWeekPath(const std::string& symbol, const std::tm& currentDate) {
+    std::string path = getWeekSourcePath(symbol, currentDate);
+    return path.substr(0, path.size() - 4) + ".fxb";
+}
+
+std::vector<std::string> RatesStorageProvider::getWeekDataPaths(const std::string& symbol, const std::tm& currentDate) {
+    std::vector<std::string> paths;
+    std::error_code error;
+    auto store = getBarStore(symbol);
+    if (store.has_value()) {
+        // A week never crosses a year, so it is read from a single year directory
+        std::filesystem::path year = std::filesystem::path(store.value()) / std::to_string(currentDate.tm_year + 1900);
+        for (std::filesystem::directory_iterator it(year, error), end; !error && it != end; it.increment(error)) {
+            if (it->is_regular_file()) {
+                paths.push_back(it->path().string());
+            }
+        }
+        std::sort(paths.begin(), paths.end());
+        return paths;
+    }
+    std::string path = getWeekSourcePath(symbol, currentDate);
+    std::string compressed = getCompressedWeekPath(symbol, currentDate);
+    if (!std::filesystem::exists(path, error) && std::filesystem::exists(compressed, error)) {
+        return { compressed };
+    }
+    return { path };
+}
+
+const uintmax_t RatesStorageProvider::RawRowBytes;
+
+uintmax_t RatesStorageProvider::getWeekHistoryBytes(const std::string& symbol, const std::tm& currentDate) {
+    std::error_code error;
+    if (getBarStore(symbol).has_value()) {
+        auto [start, end] = getWeekRange(currentDate);
+        size_t rows = 0;
+        // Both ends come from the sparse index, nothing but the index and two strides of times is touched
+        for (const auto& span : BarStoreReader(getBarStore(symbol).value()).range(start, end)) {
+            rows += span.count;
+        }
+        return rows * RawRowBytes;
+    }
+    uintmax_t size = std::filesystem::file_size(getWeekSourcePath(symbol, currentDate), error);
+    if (!error) {
+        return size;
+    }
+    return BarCodec::countRows(getCompressedWeekPath(symbol, currentDate)) * RawRowBytes;
+}
+
+bool RatesStorageProvider::readCompressedWeek(const std::string& symbol, const std::tm& currentDate, BarColumns& output) {
+    std::string path = getCompressedWeekPath(symbol, currentDate);
+    std::error_code error;
+    if (!std::filesystem::exists(path, error)) {
+        return false;
+    }
+    return BarCodec::readFile(path, output);
+}
+
+bool RatesStorageProvider::isQuarantined(const std::string& symbol, const std::tm& currentDate) {
+    std::call_once(quarantineLoaded, [this]() {
+        std::ifstream file(historyPath + "/quarantine.txt");
+        std::string line;
+        while (std::getline(file, line)) {
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (!line.empty()) {
+                quarantine.insert(line);
+            }
+        }
+    });
+    if (quarantine.empty()) {
+        return false;
+    }
+    if (quarantine.count(getWeekFile(symbol, currentDate)) == 0) {
+        return false;
+    }
+    std::cerr << "Warning: Skipping quarantined history " << getWeekSourcePath(symbol, currentDate) << std::endl;
+    return true;
+}
+
+bool RatesStorageProvider::readWeekColumns(const std::string& symbol, const std::tm& currentDate, const std::string& period, BarColumns& output) {
+    auto periodSeconds = BarResampler::parsePeriod(period);
+    if (isQuarantined(symbol, currentDate)) {
+        return false;
+    }
+    if (getBarStore(symbol).has_value()) {
+        auto [start, end] = getWeekRange(currentDate);
+        return readRange(symbol, start, end, period, output);
+    }
+    std::string path = getWeekSourcePath(symbol, currentDate);
+    std::ifstream file(path);
+    if (!periodSeconds.has_value()) {
+        return false;
+    }
+    bool resample = periodSeconds.value() > 60;
     if (!file.is_open()) {
-        return std::nullopt;
+        BarColumns week;
+        if (!readCompressedWeek(symbol, currentDate, resample ? week : output)) {
+            return false;
+        }
+        if (resample) {
+            BarResampler resampler(periodSeconds.value(), sessionOffsetSeconds);
+            resampler.push(week, output);
+            resampler.flush(output);
+        }
+        return true;
+    }
+    HistoryFormat format = getHistoryFormat(symbol);
+    if (format == HistoryFormat::Tick) {
+        // Ticks go straight to the requested period, without m1 in between
+        TickBarReader reader(file, periodSeconds.value(), sessionOffsetSeconds);
+        while (reader.readChunk(output)) {
+        }
+        recordReadErrors(path, reader.errors());
+        return true;
+    }
+    BarColumns week;
+    BarColumns& target = resample ? week : output;
+    StorageReadErrors errors;
+    HistoryFormats::visit(format, [&](auto dialect) {
+        Data data;
+        while (StorageReader::readNext<decltype(dialect)>(file, data, errors)) {
+            target.push(data);
+        }
+    });
+    recordReadErrors(path, errors);
+    if (resample) {
+        BarResampler resampler(periodSeconds.value(), sessionOffsetSeconds);
+        resampler.push(week, output);
+        resampler.flush(output);
     }
-    auto targetStoragePath = std::filesystem::temp_directory_path() / "fxts2_backtester" / fileName;
-    std::ofstream targetFile(targetStoragePath);
-    if (!targetFile.is_open()) {
-        file.close();
+    return true;
+}
+
+void RatesStorageProvider::recordReadErrors(const std::string& path, const StorageReadErrors& errors) {
+    if (errors.total() == 0) {
+        return;
+    }
+    std::cerr << "Warning: Skipped " << errors.describe() << " in " << path << std::endl;
+    std::lock_guard<std::mutex> lock(readErrorsMutex);
+    readErrors[path] = errors;
+}
+
+std::map<std::string, StorageReadErrors> RatesStorageProvider::getReadErrors() {
+    std::lock_guard<std::mutex> lock(readErrorsMutex);
+    return readErrors;
+}
+
+std::optional<std::vector<std::string>> RatesStorageProvider::prepareWeekData(const std::vector<std::string>& symbols, const std::tm& currentDate, AlignmentMode mode, const std::string& period, const std::string& targetDirectoryPath) {
+    auto periodSeconds = BarResampler::parsePeriod(period);
+    if (!periodSeconds.has_value()) {
         return std::nullopt;
     }
-    auto data = StorageReader::readNext(file);
-    while (data.has_value()) {
-        IndicoreRatesSerializer::serialize(targetFile, data.value());
-        data = StorageReader::readNext(file);
+    // History is stored as m1, anything longer is aggregated on the way out
+    bool resample = periodSeconds.value() > 60;
+
+    int week = getWeekNumber(currentDate);
+    std::string fileName = std::to_string(currentDate.tm_year + 1900) + "-" + std::to_string(week) + ".csv";
+    auto targetDirectory = targetDirectoryPath.empty() ? std::filesystem::temp_directory_path() / "fxts2_backtester" : std::filesystem::path(targetDirectoryPath);
+    std::filesystem::create_directories(targetDirectory);
+
+    std::vector<std::ifstream> files(symbols.size());
+    // m1 bars of the symbols read from their bar store or compressed week
+    std::vector<BarColumns> stored(symbols.size());
+    std::vector<const BarColumns*> columns(symbols.size(), nullptr);
+    std::vector<std::ofstream> targetFiles(symbols.size());
+    std::vector<std::string> targetPaths;
+    for (size_t i = 0; i < symbols.size(); i++) {
+        std::string escapedSymbol = escapeSymbol(symbols[i]);
+        if (isQuarantined(symbols[i], currentDate)) {
+            return std::nullopt;
+        }
+        if (getBarStore(symbols[i]).has_value()) {
+            auto [start, end] = getWeekRange(currentDate);
+            if (!readRange(symbols[i], start, end, "m1", stored[i])) {
+                return std::nullopt;
+            }
+            columns[i] = &stored[i];
+        }
+        else {
+            files[i].open(getWeekSourcePath(symbols[i], currentDate));
+            if (!files[i].is_open()) {
+                if (!readCompressedWeek(symbols[i], currentDate, stored[i])) {
+                    return std::nullopt;
+                }
+                columns[i] = &stored[i];
+            }
+        }
+        std::string prefix = escapedSymbol + "_";
+        if (mode == AlignmentMode::Intersection) {
+            // Aligned files depend on the whole portfolio
+            prefix += "common";
+            for (const auto& member : symbols) {
+                prefix += "-" + escapeSymbol(member);
+            }
+            prefix += "_";
+        }
+        if (resample) {
+            prefix += period + "_";
+        }
+        auto targetStoragePath = targetDirectory / (prefix + fileName);
+        targetFiles[i].open(targetStoragePath);
+        if (!targetFiles[i].is_open()) {
+            return std::nullopt;
+        }
+        targetPaths.push_back(targetStoragePath.string());
+    }
+
+    std::vector<std::ifstream*> sources;
+    std::vector<HistoryFormat> formats;
+    for (size_t i = 0; i < files.size(); i++) {
+        sources.push_back(columns[i] != nullptr ? nullptr : &files[i]);
+        formats.push_back(getHistoryFormat(symbols[i]));
+    }
+    TimeAlignedReader reader(sources, mode, formats, columns);
+
+    // Bars are resampled in columnar chunks, one resampler per symbol
+    const size_t chunkSize = 4096;
+    std::vector<BarResampler> resamplers(symbols.size(), BarResampler(periodSeconds.value(), sessionOffsetSeconds));
+    std::vector<BarColumns> chunks(symbols.size());
+    BarColumns resampled;
+    auto drain = [&](size_t i, bool last) {
+        resampled.clear();
+        resamplers[i].push(chunks[i], resampled);
+        if (last) {
+            resamplers[i].flush(resampled);
+        }
+        for (size_t row = 0; row < resampled.size(); row++) {
+            IndicoreRatesSerializer::serialize(targetFiles[i], resampled.get(row));
+        }
+        chunks[i].clear();
+    };
+
+    auto aligned = reader.readNext();
+    while (aligned.has_value()) {
+        const auto& bars = aligned.value().bars;
+        for (size_t i = 0; i < bars.size(); i++) {
+            if (!bars[i].has_value()) {
+                continue;
+            }
+            if (!resample) {
+                IndicoreRatesSerializer::serialize(targetFiles[i], bars[i].value());
+                continue;
+            }
+            chunks[i].push(aligned.value().timestamp, bars[i].value());
+            if (chunks[i].size() >= chunkSize) {
+                drain(i, false);
+            }
+        }
+        aligned = reader.readNext();
+    }
+    if (resample) {
+        for (size_t i = 0; i < symbols.size(); i++) {
+            drain(i, true);
+        }
+    }
+    for (size_t i = 0; i < symbols.size(); i++) {
+        recordReadErrors(getWeekSourcePath(symbols[i], currentDate), reader.errors(i));
     }
-    targetFile.close();
-    file.close();
-    return targetStoragePath.string();
+    return targetPaths;
 }
@@ -1,16 +1,80 @@
 #include <string>
 #include <optional>
+#include <vector>
+#include <ctime>
+#include <mutex>
+#include <set>
+#include <map>
+#include <cstdint>
 #include "SymbolInfoParser.h"
+#include "SymbolCatalog.h"
+#include "TimeAlignedReader.h"
+#include "BarColumns.h"
+#include "StorageReader.h"
 
 #pragma once
 
 class RatesStorageProvider {
     std::string historyPath;
+    SymbolCatalog catalog;
+    std::once_flag catalogLoaded;
+    // Week files listed in <historyPath>/quarantine.txt by history_scan, relative to historyPath
+    std::set<std::string> quarantine;
+    std::once_flag quarantineLoaded;
+    // Malformed lines skipped per source file
+    std::map<std::string, StorageReadErrors> readErrors;
+    std::mutex readErrorsMutex;
+    long long sessionOffsetSeconds;
+    // Per-symbol bar stores written by history_ingest, week files are read when empty
+    std::optional<std::string> barStorePath;
 public:
-    RatesStorageProvider(const std::string& historyPath);
+    // The symbol catalog is loaded on first use, from catalogSnapshotPath when it is still valid
+    RatesStorageProvider(const std::string& historyPath, const std::optional<std::string>& catalogSnapshotPath = std::nullopt);
     std::optional<SymbolInfo> getSymbolInfo(const std::string& symbol);
-    std::optional<std::string> prepareWeekData(const std::string& symbol, const std::tm& currentDate);
+    // Start of the trading session, higher timeframe bars are aligned to it
+    void setSessionOffset(long long sessionOffsetSeconds);
+    long long getSessionOffset() const;
+    // Symbols with a bar store under path are read from it, the others from their week files
+    void setBarStore(const std::string& path);
+    std::optional<std::string> getBarStorePath() const;
+    // Appends the stored bars with start <= time < end, resampled to period, to output.
+    // False if the symbol has no bar store or no bars in the range.
+    bool readRange(const std::string& symbol, long long start, long long end, const std::string& period, BarColumns& output);
+    std::optional<std::string> prepareWeekData(const std::string& symbol, const std::tm& currentDate, const std::string& period = "m1");
+    // Prepares the week files of all symbols in a single merged pass, resampled to period.
+    // Returns one prepared file per symbol, in the same order, or nothing if any symbol has no data.
+    // Files are written to targetDirectory, temp/fxts2_backtester when empty.
+    std::optional<std::vector<std::string>> prepareWeekData(const std::vector<std::string>& symbols, const std::tm& currentDate, AlignmentMode mode, const std::string& period = "m1", const std::string& targetDirectory = "");
+    // Raw history file the week of symbol is prepared from
+    std::string getWeekSourcePath(const std::string& symbol, const std::tm& currentDate);
+    // <year>-<week>.fxb next to the raw file, written by history_compress and read when the raw file is absent
+    std::string getCompressedWeekPath(const std::string& symbol, const std::tm& currentDate);
+    // Files the week of symbol is actually read from: those of its bar store year, else the raw or the
+    // compressed week file. The raw path stands for a week without history.
+    std::vector<std::string> getWeekDataPaths(const std::string& symbol, const std::tm& currentDate);
+    // Size of the week as raw m1 history: the raw file, or its bar count in the bar store or the compressed
+    // file times RawRowBytes. Lets prepared data and cost estimates be sized whatever the week is read from.
+    uintmax_t getWeekHistoryBytes(const std::string& symbol, const std::tm& currentDate);
+    // Length of one m1 line of a raw week file
+    static const uintmax_t RawRowBytes = 88;
+    // Quarantined weeks are treated as weeks without history
+    bool isQuarantined(const std::string& symbol, const std::tm& currentDate);
+    // Appends the bars of the week, resampled to period, to output. False if the week has no history.
+    bool readWeekColumns(const std::string& symbol, const std::tm& currentDate, const std::string& period, BarColumns& output);
+    // Source files read so far that had malformed lines, by path
+    std::map<std::string, StorageReadErrors> getReadErrors();
 private:
     int getWeekNumber(const std::tm& date);
+    // <symbol>/<year>-<week>.csv
+    std::string getWeekFile(const std::string& symbol, const std::tm& currentDate);
     std::string escapeSymbol(const std::string& symbol);
-};
\ No newline at end of file
+    // UTC start and end of the week getWeekNumber puts the date in, the last week of a year ends with it
+    std::pair<long long, long long> getWeekRange(const std::tm& date);
+    // Directory of the bar store of symbol, nothing when it has none
+    std::optional<std::string> getBarStore(const std::string& symbol);
+    // Standard for symbols without info.json
+    HistoryFormat getHistoryFormat(const std::string& symbol);
+    // Appends the m1 bars of the compressed week, false if it has none or is corrupt
+    bool readCompressedWeek(const std::string& symbol, const std::tm& currentDate, BarColumns& output);
+    void recordReadErrors(const std::string& path, const StorageReadErrors& errors);
+};
@@ -0,0 +1,52 @@
+#include "ResourceUsageReport.h"
+#include <algorithm>
+#include <iomanip>
+
+void ResourceUsageReport::add(const std::string& strategy, const std::vector<std::string>& runSymbols, const ProcessUsage& usage) {
+    std::lock_guard<std::mutex> lock(mutex);
+    addTo(strategies[strategy], usage);
+    for (const auto& symbol : runSymbols) {
+        addTo(symbols[symbol], usage);
+    }
+}
+
+void ResourceUsageReport::addTo(Totals& totals, const ProcessUsage& usage) {
+    totals.runs++;
+    totals.usage.userSeconds += usage.userSeconds;
+    totals.usage.systemSeconds += usage.systemSeconds;
+    totals.usage.maxRssKb = std::max(totals.usage.maxRssKb, usage.maxRssKb);
+    totals.usage.minorFaults += usage.minorFaults;
+    totals.usage.majorFaults += usage.majorFaults;
+    totals.usage.blockInputs += usage.blockInputs;
+    totals.usage.blockOutputs += usage.blockOutputs;
+}
+
+std::map<std::string, ResourceUsageReport::Totals> ResourceUsageReport::byStrategy() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return strategies;
+}
+
+std::map<std::string, ResourceUsageReport::Totals> ResourceUsageReport::bySymbol() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return symbols;
+}
+
+bool ResourceUsageReport::empty() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return strategies.empty();
+}
+
+void ResourceUsageReport::write(std::ostream& output) const {
+    auto writeGroup = [&](const std::string& title, const std::map<std::string, Totals>& group) {
+        output << "Resource usage per " << title << ":" << std::endl;
+        for (const auto& entry : group) {
+            const ProcessUsage& usage = entry.second.usage;
+            output << "  " << entry.first << ": " << entry.second.runs << " runs, CPU " << std::fixed << std::setprecision(2)
+                   << usage.userSeconds << " s user / " << usage.systemSeconds << " s system, peak RSS " << usage.maxRssKb / 1024
+                   << " MB, page faults " << usage.minorFaults << " minor / " << usage.majorFaults << " major, block I/O "
+                   << usage.blockInputs << " in / " << usage.blockOutputs << " out" << std::endl;
+        }
+    };
+    writeGroup("strategy", byStrategy());
+    writeGroup("symbol", bySymbol());
+}
@@ -0,0 +1,32 @@
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include "ProcessRunner.h"
+
+#pragma once
+
+// Sums the resources of backtester runs per strategy and per symbol. A portfolio run counts in
+// full for each of its symbols.
+class ResourceUsageReport {
+public:
+    class Totals {
+    public:
+        size_t runs = 0;
+        // Sums over the runs, except maxRssKb which is the largest single run
+        ProcessUsage usage;
+    };
+
+    void add(const std::string& strategy, const std::vector<std::string>& symbols, const ProcessUsage& usage);
+    std::map<std::string, Totals> byStrategy() const;
+    std::map<std::string, Totals> bySymbol() const;
+    bool empty() const;
+    void write(std::ostream& output) const;
+private:
+    mutable std::mutex mutex;
+    std::map<std::string, Totals> strategies;
+    std::map<std::string, Totals> symbols;
+
+    static void addTo(Totals& totals, const ProcessUsage& usage);
+};
@@ -0,0 +1,70 @@
+#include "SharedPlan.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <nlohmann/json.hpp>
+#include "TimeUtils.h"
+
+std::optional<SharedPlan> SharedPlan::create(const std::string& planPath, const SharedPlan& plan) {
+    nlohmann::json j;
+    j["sweep"] = nlohmann::json::parse(SweepSpecParser::serialize(plan.spec));
+    j["historyPath"] = plan.historyPath;
+    j["sessionStartMinutes"] = plan.sessionStartMinutes;
+    j["barStore"] = plan.barStore;
+    j["chunkSize"] = plan.chunkSize;
+    j["taskCount"] = plan.taskCount;
+    j["windows"] = nlohmann::json::array();
+    for (const auto& window : plan.windows) {
+        // The calendar date of the planner, nodes in other time zones must resolve the same week files
+        j["windows"].push_back({ window.startTime, window.endTime, TimeUtils::toFields(window.start) });
+    }
+
+    std::filesystem::create_directories(planPath);
+    std::filesystem::path target = std::filesystem::path(planPath) / "plan.json";
+    std::filesystem::path temporary = std::filesystem::path(planPath) / ("plan.json." + std::to_string(std::hash<std::string>()(j.dump())) + ".tmp");
+    {
+        std::ofstream file(temporary);
+        file << j.dump(2) << std::endl;
+    }
+    // A hard link fails if the plan exists, so the complete file appears atomically and only once
+    std::error_code error;
+    std::filesystem::create_hard_link(temporary, target, error);
+    std::filesystem::remove(temporary);
+    return load(planPath);
+}
+
+std::optional<SharedPlan> SharedPlan::load(const std::string& planPath) {
+    std::ifstream file(std::filesystem::path(planPath) / "plan.json");
+    if (!file.is_open()) {
+        return std::nullopt;
+    }
+    try {
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        nlohmann::json j = nlohmann::json::parse(buffer.str());
+        SharedPlan plan;
+        plan.spec = SweepSpecParser::parse(j["sweep"].dump());
+        plan.historyPath = j.value("historyPath", "");
+        plan.sessionStartMinutes = j.value("sessionStartMinutes", 0);
+        plan.barStore = j.value("barStore", "");
+        plan.chunkSize = j.value("chunkSize", plan.chunkSize);
+        plan.taskCount = j.value("taskCount", plan.taskCount);
+        for (const auto& value : j["windows"]) {
+            BacktestWindow window;
+            window.startTime = value[0].get<long long>();
+            window.endTime = value[1].get<long long>();
+            auto date = value.size() > 2 ? TimeUtils::fromFields(value[2].get<std::vector<int>>()) : std::nullopt;
+            if (!date.has_value()) {
+                throw std::runtime_error("window without a calendar date");
+            }
+            window.start = date.value();
+            plan.windows.push_back(window);
+        }
+        return plan;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: Invalid plan in " << planPath << ": " << e.what() << std::endl;
+        return std::nullopt;
+    }
+}
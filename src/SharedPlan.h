@@ -0,0 +1,29 @@
+#include <string>
+#include <vector>
+#include <optional>
+#include "BacktestJob.h"
+#include "SweepSpec.h"
+
+#pragma once
+
+// Job plan kept in plan.json of a directory shared by all nodes. Windows are stored rather than
+// recomputed so that nodes started on different days agree on the task list, together with the
+// planner's calendar date of each, so that nodes in other time zones agree on the week files.
+class SharedPlan {
+public:
+    SweepSpec spec;
+    std::string historyPath;
+    // --session_start of the node that planned, every node aligns higher timeframe bars to it
+    int sessionStartMinutes = 0;
+    // --bar_store of the node that planned, empty when the week files are read
+    std::string barStore;
+    std::vector<BacktestWindow> windows;
+    // Tasks claimed at once
+    size_t chunkSize = 64;
+    // Lets nodes detect that they planned the sweep differently, e.g. against a changed history
+    size_t taskCount = 0;
+
+    // Writes the plan unless another node got there first. Either way the plan on disk is returned.
+    static std::optional<SharedPlan> create(const std::string& planPath, const SharedPlan& plan);
+    static std::optional<SharedPlan> load(const std::string& planPath);
+};
@@ -0,0 +1,156 @@
+#include "SharedPlanNode.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <nlohmann/json.hpp>
+#include "ClaimDirectory.h"
+#include "JobPlanner.h"
+#include "PreparedDataCache.h"
+#include "RatesStorageProvider.h"
+#include "TaskExecutor.h"
+#include "TaskResultJson.h"
+
+namespace {
+    long long wallClockSeconds() {
+        return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+}
+
+SharedPlanNode::SharedPlanNode(const std::string& planPath, const std::string& node, const std::string& pathToBacktester, std::chrono::seconds claimDuration) {
+    this->planPath = planPath;
+    this->node = node;
+    this->pathToBacktester = pathToBacktester;
+    this->claimDuration = claimDuration;
+}
+
+std::optional<size_t> SharedPlanNode::run(int workers) {
+    auto plan = SharedPlan::load(planPath);
+    if (!plan.has_value()) {
+        std::cerr << "Error: No plan in " << planPath << std::endl;
+        return std::nullopt;
+    }
+    RatesStorageProvider ratesStorageProvider(plan.value().historyPath);
+    ratesStorageProvider.setSessionOffset(plan.value().sessionStartMinutes * 60LL);
+    if (!plan.value().barStore.empty()) {
+        ratesStorageProvider.setBarStore(plan.value().barStore);
+    }
+    JobPlanner planner(ratesStorageProvider);
+    auto jobs = planner.planSweep(plan.value().spec);
+    if (!jobs.has_value()) {
+        std::cerr << "Error: Failed to plan jobs" << std::endl;
+        return std::nullopt;
+    }
+    std::vector<BacktestTask> tasks = JobPlanner::planTasks(jobs.value(), plan.value().windows);
+    if (tasks.size() != plan.value().taskCount) {
+        std::cerr << "Error: Planned " << tasks.size() << " tasks but the shared plan has " << plan.value().taskCount << std::endl;
+        return std::nullopt;
+    }
+    size_t chunkSize = std::max<size_t>(plan.value().chunkSize, 1);
+    size_t chunkCount = (tasks.size() + chunkSize - 1) / chunkSize;
+
+    std::filesystem::create_directories(std::filesystem::path(planPath) / "results");
+    std::ofstream shard(std::filesystem::path(planPath) / "results" / (node + ".jsonl"), std::ios::app);
+    std::mutex shardMutex;
+    std::mutex claimsMutex;
+    ClaimDirectory claims(planPath, node, claimDuration);
+    PreparedDataCache preparedData(ratesStorageProvider);
+    size_t completed = 0;
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < workers; i++) {
+        threads.emplace_back([&, i]() {
+            // Backtester files are named after the node so that nodes sharing a machine do not collide
+            ConsoleBacktester backtester(pathToBacktester, node + "_" + std::to_string(i + 1));
+            TaskExecutor executor(preparedData);
+            while (true) {
+                std::optional<ClaimDirectory::Claim> claim;
+                {
+                    std::lock_guard<std::mutex> lock(claimsMutex);
+                    claim = claims.claimNext(chunkCount, wallClockSeconds());
+                    if (!claim.has_value() && claims.isComplete(chunkCount)) {
+                        break;
+                    }
+                }
+                if (!claim.has_value()) {
+                    // Everything left is claimed by others, wait for it to finish or expire
+                    std::this_thread::sleep_for(std::min<std::chrono::seconds>(claimDuration / 4 + std::chrono::seconds(1), std::chrono::seconds(30)));
+                    continue;
+                }
+                size_t first = claim.value().chunk * chunkSize;
+                size_t last = std::min(first + chunkSize, tasks.size());
+                bool lost = false;
+                for (size_t index = first; index < last && !lost; index++) {
+                    TaskResult result = executor.execute(tasks[index], backtester);
+                    nlohmann::json line = TaskResultJson::describe(tasks[index], result);
+                    line["task"] = index;
+                    line["node"] = node;
+                    {
+                        std::lock_guard<std::mutex> lock(shardMutex);
+                        shard << line.dump() << std::endl;
+                        if (result.completed) {
+                            completed++;
+                        }
+                    }
+                    // Renew well before expiry, a chunk taken over by another node is abandoned
+                    if (claim.value().expiresAt - wallClockSeconds() < claimDuration.count() / 2) {
+                        std::lock_guard<std::mutex> lock(claimsMutex);
+                        lost = !claims.renew(claim.value(), wallClockSeconds());
+                    }
+                }
+                if (lost) {
+                    std::cerr << "Warning: Chunk " << claim.value().chunk << " was taken over by another node" << std::endl;
+                    continue;
+                }
+                std::lock_guard<std::mutex> lock(claimsMutex);
+                claims.complete(claim.value());
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return completed;
+}
+
+std::optional<size_t> SharedPlanNode::aggregate(const std::string& planPath, const std::string& outputPath) {
+    auto plan = SharedPlan::load(planPath);
+    if (!plan.has_value()) {
+        std::cerr << "Error: No plan in " << planPath << std::endl;
+        return std::nullopt;
+    }
+    // A task may have been run by several nodes, a completed result wins over a skipped one
+    std::map<size_t, nlohmann::json> results;
+    std::filesystem::path shardsPath = std::filesystem::path(planPath) / "results";
+    if (std::filesystem::exists(shardsPath)) {
+        for (const auto& entry : std::filesystem::directory_iterator(shardsPath)) {
+            std::ifstream shard(entry.path());
+            std::string line;
+            while (std::getline(shard, line)) {
+                nlohmann::json result = nlohmann::json::parse(line, nullptr, false);
+                // The last line of a crashed node may be cut off
+                if (!result.is_object() || !result.contains("task")) {
+                    continue;
+                }
+                size_t task = result["task"].get<size_t>();
+                auto it = results.find(task);
+                if (it == results.end() || (!it->second.value("completed", false) && result.value("completed", false))) {
+                    results[task] = result;
+                }
+            }
+        }
+    }
+
+    std::ofstream output(outputPath);
+    if (!output.is_open()) {
+        std::cerr << "Error: Failed to open results file: " << outputPath << std::endl;
+        return std::nullopt;
+    }
+    for (const auto& entry : results) {
+        output << entry.second.dump() << "\n";
+    }
+    size_t taskCount = plan.value().taskCount;
+    return taskCount > results.size() ? taskCount - results.size() : 0;
+}
@@ -0,0 +1,22 @@
+#include <string>
+#include <chrono>
+#include <optional>
+#include "SharedPlan.h"
+
+#pragma once
+
+// Works through a shared plan directory without a coordinator: chunks of tasks are claimed
+// through ClaimDirectory and results go to results/<node>.jsonl, one shard file per node.
+// A chunk whose claim expired may run twice, aggregate keeps a single result per task.
+class SharedPlanNode {
+    std::string planPath;
+    std::string node;
+    std::string pathToBacktester;
+    std::chrono::seconds claimDuration;
+public:
+    SharedPlanNode(const std::string& planPath, const std::string& node, const std::string& pathToBacktester, std::chrono::seconds claimDuration);
+    // Runs workers backtesters until every chunk is done, returns the number of completed backtests
+    std::optional<size_t> run(int workers);
+    // Merges the shard files into outputPath ordered by task, returns the number of tasks without result
+    static std::optional<size_t> aggregate(const std::string& planPath, const std::string& outputPath);
+};
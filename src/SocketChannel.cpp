@@ -0,0 +1,240 @@
+#include "SocketChannel.h"
+#include <cstring>
+#include <cerrno>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <unistd.h>
+#endif
+
+SocketChannel::SocketChannel(int fd) {
+    this->fd = fd;
+}
+
+SocketChannel::~SocketChannel() {
+    close();
+}
+
+bool SocketChannel::isOpen() const {
+    return fd >= 0;
+}
+
+void SocketChannel::close() {
+    if (fd >= 0) {
+        closeDescriptor(fd);
+        fd = -1;
+    }
+}
+
+#ifndef _WIN32
+
+bool SocketChannel::sendLine(const std::string& line) {
+    if (fd < 0) {
+        return false;
+    }
+    std::string message = line + "\n";
+    size_t sent = 0;
+    while (sent < message.size()) {
+        // MSG_NOSIGNAL keeps a vanished peer from killing the process with SIGPIPE
+        ssize_t count = ::send(fd, message.data() + sent, message.size() - sent, MSG_NOSIGNAL);
+        if (count <= 0) {
+            return false;
+        }
+        sent += static_cast<size_t>(count);
+    }
+    return true;
+}
+
+std::optional<std::string> SocketChannel::readLine() {
+    while (true) {
+        size_t newline = buffer.find('\n');
+        if (newline != std::string::npos) {
+            std::string line = buffer.substr(0, newline);
+            buffer.erase(0, newline + 1);
+            return line;
+        }
+        if (fd < 0) {
+            return std::nullopt;
+        }
+        char chunk[4096];
+        ssize_t count = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (count <= 0) {
+            return std::nullopt;
+        }
+        buffer.append(chunk, static_cast<size_t>(count));
+    }
+}
+
+int SocketChannel::listenUnix(const std::string& path) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    if (path.size() >= sizeof(address.sun_path)) {
+        return -1;
+    }
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+    // A socket somebody still answers on belongs to a running daemon, only a stale one is replaced
+    int running = connectUnix(path);
+    if (running >= 0) {
+        ::close(running);
+        errno = EADDRINUSE;
+        return -1;
+    }
+    struct stat status;
+    if (::lstat(path.c_str(), &status) == 0) {
+        if (!S_ISSOCK(status.st_mode)) {
+            errno = EEXIST;
+            return -1;
+        }
+        ::unlink(path.c_str());
+    }
+    int listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        return -1;
+    }
+    if (::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(listenFd, 16) != 0) {
+        ::close(listenFd);
+        return -1;
+    }
+    return listenFd;
+}
+
+int SocketChannel::connectUnix(const std::string& path) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    if (path.size() >= sizeof(address.sun_path)) {
+        return -1;
+    }
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+    int connectionFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (connectionFd < 0) {
+        return -1;
+    }
+    if (::connect(connectionFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(connectionFd);
+        return -1;
+    }
+    return connectionFd;
+}
+
+int SocketChannel::listenTcp(int port) {
+    int listenFd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        return -1;
+    }
+    int reuse = 1;
+    ::setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    if (::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(listenFd, 64) != 0) {
+        ::close(listenFd);
+        return -1;
+    }
+    return listenFd;
+}
+
+int SocketChannel::connectTcp(const std::string& host, int port) {
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    if (::getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses) != 0) {
+        return -1;
+    }
+    int connectionFd = -1;
+    for (addrinfo* address = addresses; address != nullptr; address = address->ai_next) {
+        connectionFd = ::socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (connectionFd < 0) {
+            continue;
+        }
+        if (::connect(connectionFd, address->ai_addr, address->ai_addrlen) == 0) {
+            break;
+        }
+        ::close(connectionFd);
+        connectionFd = -1;
+    }
+    ::freeaddrinfo(addresses);
+    if (connectionFd >= 0) {
+        // Messages are small request/response lines, do not let Nagle delay them
+        int noDelay = 1;
+        ::setsockopt(connectionFd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    }
+    return connectionFd;
+}
+
+int SocketChannel::localPort(int fd) {
+    sockaddr_in address;
+    socklen_t length = sizeof(address);
+    if (::getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        return -1;
+    }
+    return ntohs(address.sin_port);
+}
+
+int SocketChannel::accept(int listenFd) {
+    return ::accept(listenFd, nullptr, nullptr);
+}
+
+void SocketChannel::closeDescriptor(int fd) {
+    // shutdown wakes up a thread blocked in accept or recv on the same descriptor
+    ::shutdown(fd, SHUT_RDWR);
+    ::close(fd);
+}
+
+void SocketChannel::interrupt(int fd) {
+    ::shutdown(fd, SHUT_RD);
+}
+
+#else
+
+bool SocketChannel::sendLine(const std::string&) {
+    return false;
+}
+
+std::optional<std::string> SocketChannel::readLine() {
+    return std::nullopt;
+}
+
+int SocketChannel::listenUnix(const std::string&) {
+    return -1;
+}
+
+int SocketChannel::connectUnix(const std::string&) {
+    return -1;
+}
+
+int SocketChannel::listenTcp(int) {
+    return -1;
+}
+
+int SocketChannel::connectTcp(const std::string&, int) {
+    return -1;
+}
+
+int SocketChannel::localPort(int) {
+    return -1;
+}
+
+int SocketChannel::accept(int) {
+    return -1;
+}
+
+void SocketChannel::closeDescriptor(int) {
+}
+
+void SocketChannel::interrupt(int) {
+}
+
+#endif
@@ -0,0 +1,38 @@
+#include <string>
+#include <optional>
+
+#pragma once
+
+// Newline-delimited messages over a stream socket. Owns the descriptor.
+// POSIX only: on Windows every call fails, main rejects the modes that need sockets.
+class SocketChannel {
+    int fd;
+    std::string buffer;
+public:
+    explicit SocketChannel(int fd);
+    ~SocketChannel();
+    SocketChannel(const SocketChannel&) = delete;
+    SocketChannel& operator=(const SocketChannel&) = delete;
+
+    bool isOpen() const;
+    bool sendLine(const std::string& line);
+    // Returns nothing on end of stream or error
+    std::optional<std::string> readLine();
+    void close();
+
+    // Listening Unix domain socket, a stale socket file at path is replaced. Returns -1 on failure,
+    // with errno EADDRINUSE when another process still accepts connections on path and EEXIST when
+    // path is not a socket.
+    static int listenUnix(const std::string& path);
+    static int connectUnix(const std::string& path);
+    // Listening TCP socket on all interfaces, port 0 picks a free port. Returns -1 on failure.
+    static int listenTcp(int port);
+    static int connectTcp(const std::string& host, int port);
+    // Port a listening TCP socket is bound to
+    static int localPort(int fd);
+    // Blocks for the next connection, returns -1 once the listening socket is closed
+    static int accept(int listenFd);
+    static void closeDescriptor(int fd);
+    // Wakes up a thread blocked reading from fd without closing it
+    static void interrupt(int fd);
+};
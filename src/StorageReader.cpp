@@ -1,77 +1,277 @@
 #include "StorageReader.h"
+#include <charconv>
 #include <sstream>
-#include <vector>
-#include <algorithm>
-#include <iomanip>
+
+namespace {
+    template <char Decimal>
+    bool parseDecimal(const char* begin, const char* end, double& value) {
+        while (begin < end && *begin == ' ') {
+            begin++;
+        }
+        while (end > begin && end[-1] == ' ') {
+            end--;
+        }
+        if (begin == end) {
+            return false;
+        }
+        if constexpr (Decimal == '.') {
+            auto result = std::from_chars(begin, end, value);
+            return result.ec == std::errc() && result.ptr == end;
+        } else {
+            // from_chars only knows '.', so the field is copied with the decimal replaced
+            char buffer[64];
+            size_t length = static_cast<size_t>(end - begin);
+            if (length >= sizeof(buffer)) {
+                return false;
+            }
+            for (size_t i = 0; i < length; i++) {
+                buffer[i] = begin[i] == Decimal ? '.' : begin[i];
+            }
+            auto result = std::from_chars(buffer, buffer + length, value);
+            return result.ec == std::errc() && result.ptr == buffer + length;
+        }
+    }
+
+    // Reads up to maxDigits digits followed by separator or alternative, or by the end when separator is 0
+    bool parseField(const char*& position, const char* end, int maxDigits, char separator, int& value, char alternative = 0) {
+        value = 0;
+        int digits = 0;
+        while (position < end && *position >= '0' && *position <= '9' && digits < maxDigits) {
+            value = value * 10 + (*position - '0');
+            position++;
+            digits++;
+        }
+        if (digits == 0) {
+            return false;
+        }
+        if (separator == 0) {
+            return position == end;
+        }
+        if (position == end || (*position != separator && (alternative == 0 || *position != alternative))) {
+            return false;
+        }
+        position++;
+        return true;
+    }
+
+    bool makeTimestamp(int year, int month, int day, int hour, int minute, int second, std::tm& timestamp) {
+        if (day < 1 || day > 31 || month < 1 || month > 12 || hour > 23 || minute > 59 || second > 60) {
+            return false;
+        }
+        timestamp = {};
+        timestamp.tm_mday = day;
+        timestamp.tm_mon = month - 1;
+        timestamp.tm_year = year - 1900;
+        timestamp.tm_hour = hour;
+        timestamp.tm_min = minute;
+        timestamp.tm_sec = second;
+        return true;
+    }
+
+    // dd.mm.yyyy HH:MM:SS
+    bool parseDayMonthYear(const char* begin, const char* end, std::tm& timestamp) {
+        int day, month, year, hour, minute, second;
+        if (!parseField(begin, end, 2, '.', day) || !parseField(begin, end, 2, '.', month)
+            || !parseField(begin, end, 4, ' ', year) || !parseField(begin, end, 2, ':', hour)
+            || !parseField(begin, end, 2, ':', minute) || !parseField(begin, end, 2, 0, second)) {
+            return false;
+        }
+        return makeTimestamp(year, month, day, hour, minute, second, timestamp);
+    }
+
+    // yyyy-mm-dd[T ]HH:MM:SS[.fff][Z]
+    bool parseIso(const char* begin, const char* end, std::tm& timestamp) {
+        if (end > begin && end[-1] == 'Z') {
+            end--;
+        }
+        // Bars and ticks are keyed by whole seconds
+        for (const char* position = end; position > begin; position--) {
+            if (position[-1] == '.') {
+                end = position - 1;
+                break;
+            }
+            if (position[-1] < '0' || position[-1] > '9') {
+                break;
+            }
+        }
+        int year, month, day, hour, minute, second;
+        if (!parseField(begin, end, 4, '-', year) || !parseField(begin, end, 2, '-', month)
+            || !parseField(begin, end, 2, 'T', day, ' ') || !parseField(begin, end, 2, ':', hour)
+            || !parseField(begin, end, 2, ':', minute) || !parseField(begin, end, 2, 0, second)) {
+            return false;
+        }
+        return makeTimestamp(year, month, day, hour, minute, second, timestamp);
+    }
+
+    template <TimestampFormat Format>
+    bool parseTimestamp(const char* begin, const char* end, std::tm& timestamp) {
+        if constexpr (Format == TimestampFormat::Iso) {
+            return parseIso(begin, end, timestamp);
+        } else {
+            return parseDayMonthYear(begin, end, timestamp);
+        }
+    }
+}
+
+size_t StorageReadErrors::total() const {
+    return fieldCount + timestamp + price + volume;
+}
+
+void StorageReadErrors::add(StorageLineError error) {
+    switch (error) {
+    case StorageLineError::None:
+        return;
+    case StorageLineError::FieldCount:
+        fieldCount++;
+        break;
+    case StorageLineError::Timestamp:
+        timestamp++;
+        break;
+    case StorageLineError::Price:
+        price++;
+        break;
+    case StorageLineError::Volume:
+        volume++;
+        break;
+    }
+    if (lineNumbers.size() < maxLineNumbers) {
+        lineNumbers.push_back(lines);
+    }
+}
+
+std::string StorageReadErrors::describe() const {
+    std::ostringstream text;
+    text << total() << " malformed lines (";
+    const char* separator = "";
+    auto category = [&](size_t count, const char* name) {
+        if (count > 0) {
+            text << separator << count << " " << name;
+            separator = ", ";
+        }
+    };
+    category(fieldCount, "field count");
+    category(timestamp, "timestamp");
+    category(price, "price");
+    category(volume, "volume");
+    text << "), first at lines ";
+    for (size_t i = 0; i < lineNumbers.size(); i++) {
+        text << (i > 0 ? ", " : "") << lineNumbers[i];
+    }
+    return text.str();
+}
 
 std::optional<Data> StorageReader::readNext(std::ifstream& file) {
     std::string line;
     if (std::getline(file, line)) {
-        // Split line by semicolon
-        std::vector<std::string> tokens;
-        std::stringstream ss(line);
-        std::string token;
-        
-        while (std::getline(ss, token, ';')) {
-            tokens.push_back(token);
-        }
-        
-        // Expected format: time;open bid;high bid;low bid;close bid;open ask;high ask;low ask;close ask;volume
-        if (tokens.size() != 10) {
-            return std::nullopt;
-        }
-        
-        // Helper function to convert comma decimal to dot decimal
-        auto parseDecimal = [](const std::string& str) -> double {
-            std::string normalized = str;
-            std::replace(normalized.begin(), normalized.end(), ',', '.');
-            return std::stod(normalized);
-        };
-
-        // Helper function to parse integer (for volume)
-        auto parseInt = [](const std::string& str) -> int {
-            std::string normalized = str;
-            std::replace(normalized.begin(), normalized.end(), ',', '.');
-            return static_cast<int>(std::stod(normalized));
-        };
-
-        // Helper function to parse timestamp
-        auto parseTimestamp = [](const std::string& str) -> std::optional<std::tm> {
-            std::tm tm = {};
-            std::istringstream ss(str);
-            ss >> std::get_time(&tm, "%d.%m.%Y %H:%M:%S");
-            
-            // Check if parsing failed
-            if (ss.fail()) {
-                return std::nullopt;
-            }
-            
-            return tm;
-        };
-
-        try {
-            // Parse timestamp first and check if it succeeded
-            auto timestampResult = parseTimestamp(tokens[0]);
-            if (!timestampResult.has_value()) {
-                return std::nullopt;
+        return parse(line);
+    }
+    return std::nullopt;
+}
+
+bool StorageReader::readNext(std::istream& file, Data& data, StorageReadErrors& errors) {
+    return readNext<StandardDialect>(file, data, errors);
+}
+
+std::optional<Data> StorageReader::parse(const std::string& line) {
+    Data data;
+    if (parse(line, data) != StorageLineError::None) {
+        return std::nullopt;
+    }
+    return data;
+}
+
+StorageLineError StorageReader::parse(const std::string& line, Data& data) {
+    return parse<StandardDialect>(line.data(), line.data() + line.size(), data);
+}
+
+template <class Dialect>
+bool StorageReader::readNext(std::istream& file, Data& data, StorageReadErrors& errors) {
+    // Reused between calls so steady reading does not allocate
+    thread_local std::string line;
+    while (std::getline(file, line)) {
+        errors.lines++;
+        if (line.find_first_not_of(" \r") == std::string::npos) {
+            continue;
+        }
+        StorageLineError error = parse<Dialect>(line.data(), line.data() + line.size(), data);
+        if (error == StorageLineError::None) {
+            return true;
+        }
+        errors.add(error);
+    }
+    return false;
+}
+
+template <class Dialect>
+StorageLineError StorageReader::parse(const char* begin, const char* end, Data& data) {
+    constexpr size_t fieldCount = Dialect::fieldCount;
+    constexpr char separator = Dialect::separator;
+    if (end > begin && end[-1] == '\r') {
+        end--;
+    }
+    // A trailing separator does not start another field
+    if (end > begin && end[-1] == separator) {
+        end--;
+    }
+    const char* fields[fieldCount + 1];
+    size_t count = 0;
+    fields[count++] = begin;
+    for (const char* position = begin; position < end; position++) {
+        if (*position == separator) {
+            if (count == fieldCount) {
+                return StorageLineError::FieldCount;
             }
-            
-            Data data;
-            data.timestamp = timestampResult.value();
-            data.bid.open = parseDecimal(tokens[1]);
-            data.bid.high = parseDecimal(tokens[2]);
-            data.bid.low = parseDecimal(tokens[3]);
-            data.bid.close = parseDecimal(tokens[4]);
-            data.ask.open = parseDecimal(tokens[5]);
-            data.ask.high = parseDecimal(tokens[6]);
-            data.ask.low = parseDecimal(tokens[7]);
-            data.ask.close = parseDecimal(tokens[8]);
-            data.volume = parseInt(tokens[9]);
-            
-            return data;
-        } catch (const std::exception&) {
-            return std::nullopt;
+            fields[count++] = position + 1;
         }
     }
-    return std::nullopt;
+    if (count != fieldCount) {
+        return StorageLineError::FieldCount;
+    }
+    fields[fieldCount] = end + 1;
+    auto fieldEnd = [&](size_t index) { return fields[index + 1] - 1; };
+
+    if (!parseTimestamp<Dialect::timestampFormat>(fields[0], fieldEnd(0), data.timestamp)) {
+        return StorageLineError::Timestamp;
+    }
+    constexpr size_t priceCount = fieldCount - 2;
+    double prices[priceCount];
+    for (size_t i = 0; i < priceCount; i++) {
+        if (!parseDecimal<Dialect::decimal>(fields[i + 1], fieldEnd(i + 1), prices[i])) {
+            return StorageLineError::Price;
+        }
+    }
+    double volume;
+    if (!parseDecimal<Dialect::decimal>(fields[fieldCount - 1], fieldEnd(fieldCount - 1), volume)) {
+        return StorageLineError::Volume;
+    }
+    data.volume = static_cast<int>(volume);
+
+    if constexpr (Dialect::layout == HistoryLayout::BidAsk) {
+        data.bid = { prices[0], prices[1], prices[2], prices[3] };
+        data.ask = { prices[4], prices[5], prices[6], prices[7] };
+    } else if constexpr (Dialect::layout == HistoryLayout::BidOnly) {
+        data.bid = { prices[0], prices[1], prices[2], prices[3] };
+        data.ask = data.bid;
+    } else {
+        data.bid = { prices[0], prices[0], prices[0], prices[0] };
+        data.ask = { prices[1], prices[1], prices[1], prices[1] };
+    }
+    return StorageLineError::None;
+}
+
+StorageReader::LineReader StorageReader::lineReader(HistoryFormat format) {
+    return HistoryFormats::visit(format, [](auto dialect) -> LineReader {
+        return &StorageReader::readNext<decltype(dialect)>;
+    });
 }
+
+template bool StorageReader::readNext<StandardDialect>(std::istream&, Data&, StorageReadErrors&);
+template bool StorageReader::readNext<DotDecimalDialect>(std::istream&, Data&, StorageReadErrors&);
+template bool StorageReader::readNext<IsoDialect>(std::istream&, Data&, StorageReadErrors&);
+template bool StorageReader::readNext<BidOnlyDialect>(std::istream&, Data&, StorageReadErrors&);
+template bool StorageReader::readNext<TickDialect>(std::istream&, Data&, StorageReadErrors&);
+template StorageLineError StorageReader::parse<StandardDialect>(const char*, const char*, Data&);
+template StorageLineError StorageReader::parse<DotDecimalDialect>(const char*, const char*, Data&);
+template StorageLineError StorageReader::parse<IsoDialect>(const char*, const char*, Data&);
+template StorageLineError StorageReader::parse<BidOnlyDialect>(const char*, const char*, Data&);
+template StorageLineError StorageReader::parse<TickDialect>(const char*, const char*, Data&);
@@ -1,7 +1,10 @@
 #include <string>
+#include <vector>
 #include <optional>
 #include <fstream>
+#include <istream>
 #include <ctime>
+#include "HistoryDialect.h"
 
 #pragma once
 
@@ -21,7 +24,56 @@ public:
     std::tm timestamp;
 };
 
+enum class StorageLineError {
+    None,
+    // Not exactly the number of fields of the dialect
+    FieldCount,
+    Timestamp,
+    Price,
+    Volume
+};
+
+// Malformed lines skipped while reading one file
+class StorageReadErrors {
+public:
+    // At most this many line numbers are kept
+    static const size_t maxLineNumbers = 16;
+
+    // Lines read so far, malformed and blank ones included
+    size_t lines = 0;
+    size_t fieldCount = 0;
+    size_t timestamp = 0;
+    size_t price = 0;
+    size_t volume = 0;
+    // 1-based numbers of the first malformed lines
+    std::vector<size_t> lineNumbers;
+
+    size_t total() const;
+    // Counts error at the current line
+    void add(StorageLineError error);
+    // "3 malformed lines (1 field count, 2 price), first at lines 5, 9, 12"
+    std::string describe() const;
+};
+
 class StorageReader {
 public:
+    // Nothing at the end of the file or at the first malformed line
     static std::optional<Data> readNext(std::ifstream& file);
+    // Skips blank and malformed lines, counting the malformed ones in errors.
+    // False only at the end of the file.
+    static bool readNext(std::istream& file, Data& data, StorageReadErrors& errors);
+    // One history line; nothing if it is malformed
+    static std::optional<Data> parse(const std::string& line);
+    // Parses without exceptions or allocations, data is only complete when None is returned
+    static StorageLineError parse(const std::string& line, Data& data);
+
+    // The tolerant readers and parser specialized for one dialect; the ones above read StandardDialect
+    template <class Dialect>
+    static bool readNext(std::istream& file, Data& data, StorageReadErrors& errors);
+    template <class Dialect>
+    static StorageLineError parse(const char* begin, const char* end, Data& data);
+
+    using LineReader = bool (*)(std::istream& file, Data& data, StorageReadErrors& errors);
+    // readNext for files of format, picked once per file
+    static LineReader lineReader(HistoryFormat format);
 };
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include "StragglerMonitor.h"
+#include <algorithm>
+#include <cmath>
+
+StragglerMonitor::StragglerMonitor(double multiple, size_t minSamples, size_t historySize)
+    : multiple(multiple), minSamples(std::max<size_t>(1, minSamples)), historySize(std::max<size_t>(1, historySize)) {
+}
+
+std::shared_ptr<StragglerMonitor::Attempt> StragglerMonitor::begin(size_t task, const std::string& key, Clock::time_point now) {
+    auto attempt = std::make_shared<Attempt>();
+    attempt->task = task;
+    attempt->key = key;
+    attempt->started = now;
+    std::lock_guard<std::mutex> lock(mutex);
+    running[task].attempts.push_back(attempt);
+    return attempt;
+}
+
+std::shared_ptr<StragglerMonitor::Attempt> StragglerMonitor::speculate(Clock::time_point now) {
+    if (!isEnabled()) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    const Attempt* straggler = nullptr;
+    double worstOverdue = 0.0;
+    for (const auto& entry : running) {
+        // One copy per task is enough
+        if (entry.second.copied || entry.second.attempts.size() != 1) {
+            continue;
+        }
+        const Attempt& original = *entry.second.attempts.front();
+        auto p95 = percentile95Locked(original.key);
+        if (!p95.has_value()) {
+            continue;
+        }
+        double elapsed = std::chrono::duration<double>(now - original.started).count();
+        double overdue = elapsed / std::max(p95.value() * multiple, 1e-3);
+        if (overdue > 1.0 && overdue > worstOverdue) {
+            straggler = &original;
+            worstOverdue = overdue;
+        }
+    }
+    if (straggler == nullptr) {
+        return nullptr;
+    }
+    auto copy = std::make_shared<Attempt>();
+    copy->task = straggler->task;
+    copy->key = straggler->key;
+    copy->copy = true;
+    copy->started = now;
+    running[copy->task].attempts.push_back(copy);
+    running[copy->task].copied = true;
+    counters.copies++;
+    return copy;
+}
+
+bool StragglerMonitor::finish(const std::shared_ptr<Attempt>& attempt, bool completed, Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = running.find(attempt->task);
+    if (found == running.end()) {
+        // Another attempt of the task already won
+        return false;
+    }
+    auto& attempts = found->second.attempts;
+    if (!completed && attempts.size() > 1) {
+        // The other attempt may still complete the task
+        attempts.erase(std::remove(attempts.begin(), attempts.end(), attempt), attempts.end());
+        return false;
+    }
+    for (const auto& other : attempts) {
+        if (other != attempt) {
+            other->cancellation.cancel();
+        }
+    }
+    running.erase(found);
+    if (attempt->copy && completed) {
+        counters.copiesWon++;
+    }
+    if (completed) {
+        auto& history = durations[attempt->key];
+        history.push_back(std::chrono::duration<double>(now - attempt->started).count());
+        while (history.size() > historySize) {
+            history.pop_front();
+        }
+    }
+    return true;
+}
+
+std::optional<double> StragglerMonitor::percentile95(const std::string& key) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return percentile95Locked(key);
+}
+
+std::optional<double> StragglerMonitor::percentile95Locked(const std::string& key) const {
+    auto found = durations.find(key);
+    if (found == durations.end() || found->second.size() < minSamples) {
+        return std::nullopt;
+    }
+    std::vector<double> sorted(found->second.begin(), found->second.end());
+    std::sort(sorted.begin(), sorted.end());
+    size_t rank = static_cast<size_t>(std::ceil(0.95 * sorted.size()));
+    return sorted[std::max<size_t>(rank, 1) - 1];
+}
+
+bool StragglerMonitor::hasRunning() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return !running.empty();
+}
+
+StragglerMonitor::Metrics StragglerMonitor::metrics() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return counters;
+}
@@ -0,0 +1,68 @@
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <memory>
+#include <optional>
+#include <chrono>
+#include "ProcessRunner.h"
+
+#pragma once
+
+// Spots tasks running far longer than usual for their strategy and symbols and hands out a
+// speculative copy of them to idle workers. Whichever attempt completes first wins, the other
+// one is killed through its cancellation.
+class StragglerMonitor {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    class Attempt {
+    public:
+        size_t task = 0;
+        std::string key;
+        // True for the speculative copy
+        bool copy = false;
+        Clock::time_point started;
+        ProcessCancellation cancellation;
+    };
+
+    class Metrics {
+    public:
+        size_t copies = 0;
+        // Copies that finished before the original
+        size_t copiesWon = 0;
+    };
+
+    // A task is a straggler once it runs longer than multiple * p95 of its key, 0 disables copies.
+    // The p95 is only trusted after minSamples durations, at most historySize are kept per key.
+    StragglerMonitor(double multiple, size_t minSamples = 5, size_t historySize = 200);
+    bool isEnabled() const { return multiple > 0.0; }
+    std::shared_ptr<Attempt> begin(size_t task, const std::string& key, Clock::time_point now = Clock::now());
+    // Starts a copy of the longest-overdue straggler, nullptr if there is none
+    std::shared_ptr<Attempt> speculate(Clock::time_point now = Clock::now());
+    // Returns true for the first attempt of its task to complete and cancels the others. A failed attempt
+    // only drops out while another one is still running, and returns true when it was the last one.
+    // Only completed winners add their duration to the history.
+    bool finish(const std::shared_ptr<Attempt>& attempt, bool completed, Clock::time_point now = Clock::now());
+    std::optional<double> percentile95(const std::string& key) const;
+    bool hasRunning() const;
+    Metrics metrics() const;
+private:
+    class RunningTask {
+    public:
+        std::vector<std::shared_ptr<Attempt>> attempts;
+        // A copy was started, so a task whose copy failed is not copied again
+        bool copied = false;
+    };
+
+    double multiple;
+    size_t minSamples;
+    size_t historySize;
+    mutable std::mutex mutex;
+    std::map<size_t, RunningTask> running;
+    std::map<std::string, std::deque<double>> durations;
+    Metrics counters;
+
+    std::optional<double> percentile95Locked(const std::string& key) const;
+};
@@ -0,0 +1,89 @@
+#include "SweepSpec.h"
+#include <stdexcept>
+#include <sstream>
+#include <nlohmann/json.hpp>
+
+namespace {
+    std::vector<std::string> parsePortfolio(const nlohmann::json& value) {
+        std::vector<std::string> symbols;
+        if (value.is_string()) {
+            std::stringstream ss(value.get<std::string>());
+            std::string symbol;
+            while (std::getline(ss, symbol, ',')) {
+                if (!symbol.empty()) {
+                    symbols.push_back(symbol);
+                }
+            }
+        } else if (value.is_array()) {
+            for (const auto& symbol : value) {
+                symbols.push_back(symbol.get<std::string>());
+            }
+        }
+        if (symbols.empty()) {
+            throw std::runtime_error("Invalid portfolio: " + value.dump());
+        }
+        return symbols;
+    }
+
+    std::string parameterValue(const nlohmann::json& value) {
+        return value.is_string() ? value.get<std::string>() : value.dump();
+    }
+}
+
+SweepSpec SweepSpecParser::parse(const std::string& text) {
+    try {
+        nlohmann::json j = nlohmann::json::parse(text);
+        SweepSpec spec;
+        spec.owner = j.value("owner", "");
+        spec.strategy = j.value("strategy", "");
+        spec.accountCurrency = j.value("accountCurrency", spec.accountCurrency);
+        spec.period = j.value("period", spec.period);
+        spec.intersectTimestamps = j.value("intersectTimestamps", spec.intersectTimestamps);
+        spec.initialAmount = j.value("initialAmount", spec.initialAmount);
+        spec.accountLotSize = j.value("accountLotSize", spec.accountLotSize);
+        if (j.contains("symbols")) {
+            for (const auto& portfolio : j["symbols"]) {
+                spec.portfolios.push_back(parsePortfolio(portfolio));
+            }
+        }
+        if (j.contains("parameters")) {
+            for (const auto& parameter : j["parameters"].items()) {
+                std::vector<std::string> values;
+                if (parameter.value().is_array()) {
+                    for (const auto& value : parameter.value()) {
+                        values.push_back(parameterValue(value));
+                    }
+                } else {
+                    values.push_back(parameterValue(parameter.value()));
+                }
+                spec.parameters.emplace_back(parameter.key(), values);
+            }
+        }
+        if (spec.strategy.empty()) {
+            throw std::runtime_error("Sweep has no strategy");
+        }
+        if (spec.portfolios.empty()) {
+            throw std::runtime_error("Sweep has no symbols");
+        }
+        return spec;
+    } catch (const nlohmann::json::exception& e) {
+        throw std::runtime_error(std::string("Invalid sweep: ") + e.what());
+    }
+}
+
+std::string SweepSpecParser::serialize(const SweepSpec& spec) {
+    nlohmann::json j;
+    j["owner"] = spec.owner;
+    j["strategy"] = spec.strategy;
+    j["symbols"] = spec.portfolios;
+    j["accountCurrency"] = spec.accountCurrency;
+    j["period"] = spec.period;
+    j["intersectTimestamps"] = spec.intersectTimestamps;
+    j["initialAmount"] = spec.initialAmount;
+    j["accountLotSize"] = spec.accountLotSize;
+    j["parameters"] = nlohmann::json::object();
+    for (const auto& parameter : spec.parameters) {
+        j["parameters"][parameter.first] = parameter.second;
+    }
+    return j.dump();
+}
@@ -0,0 +1,28 @@
+#include <string>
+#include <vector>
+#include <utility>
+
+#pragma once
+
+// Everything needed to plan a sweep, as submitted from the command line or to the daemon
+class SweepSpec {
+public:
+    // Submissions of the same owner share one fair-share slot in the daemon
+    std::string owner;
+    std::string strategy;
+    std::vector<std::vector<std::string>> portfolios;
+    std::string accountCurrency = "USD";
+    std::string period = "m1";
+    bool intersectTimestamps = false;
+    double initialAmount = 50000.0;
+    int accountLotSize = 0;
+    // Values to try per strategy parameter, every combination is a separate job
+    std::vector<std::pair<std::string, std::vector<std::string>>> parameters;
+};
+
+class SweepSpecParser {
+public:
+    // Throws std::runtime_error for malformed specifications
+    static SweepSpec parse(const std::string& text);
+    static std::string serialize(const SweepSpec& spec);
+};
@@ -0,0 +1,301 @@
+#include "SymbolCatalog.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+namespace {
+    const char SnapshotMagic[4] = { 'F', 'X', 'S', 'C' };
+    const uint32_t SnapshotVersion = 2;
+
+    template <typename T>
+    void writeValue(std::ofstream& file, const T& value) {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    bool readValue(std::ifstream& file, T& value) {
+        return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+
+    void writeString(std::ofstream& file, const std::string& value) {
+        writeValue(file, static_cast<uint32_t>(value.size()));
+        file.write(value.data(), value.size());
+    }
+
+    // Lengths from a corrupt file are checked against what is left of it before anything is allocated
+    bool readString(std::ifstream& file, uint64_t fileSize, std::string& value) {
+        uint32_t length = 0;
+        if (!readValue(file, length)) {
+            return false;
+        }
+        std::streamoff position = file.tellg();
+        if (position < 0 || static_cast<uint64_t>(position) + length > fileSize) {
+            return false;
+        }
+        value.resize(length);
+        return static_cast<bool>(file.read(value.data(), length));
+    }
+}
+
+SymbolCatalog::SymbolCatalog(const std::string& historyPath, const std::optional<std::string>& snapshotPath) {
+    this->historyPath = historyPath;
+    this->snapshotPath = snapshotPath;
+}
+
+void SymbolCatalog::clear() {
+    strings.clear();
+    stringIds.clear();
+    entries.clear();
+    sources.clear();
+    bySymbol.clear();
+    loadedFromSnapshot = false;
+}
+
+uint32_t SymbolCatalog::intern(const std::string& value) {
+    auto it = stringIds.find(value);
+    if (it != stringIds.end()) {
+        return it->second;
+    }
+    uint32_t id = static_cast<uint32_t>(strings.size());
+    strings.push_back(value);
+    stringIds.emplace(value, id);
+    return id;
+}
+
+void SymbolCatalog::add(const std::string& symbol, const SymbolInfo& info, const SourceFile& source) {
+    Entry entry{};
+    entry.provider = info.provider.has_value() ? intern(info.provider.value()) : NoString;
+    entry.contractCurrency = intern(info.contractCurrency);
+    entry.profitCurrency = intern(info.profitCurrency);
+    entry.name = intern(info.name);
+    entry.baseUnitSize = info.baseUnitSize;
+    entry.contractMultiplier = info.contractMultiplier;
+    entry.mmr = info.mmr;
+    entry.pipSize = info.pipSize;
+    entry.instrumentType = info.instrumentType;
+    entry.precision = info.precision;
+    entry.marginEnabled = info.marginEnabled;
+    entry.withoutHistory = info.withoutHistory;
+    entry.endOfHistoryReached = info.endOfHistoryReached;
+    entry.historyFormat = static_cast<uint8_t>(info.historyFormat);
+
+    SourceFile sourceFile = source;
+    sourceFile.symbol = intern(symbol);
+    bySymbol[symbol] = static_cast<uint32_t>(entries.size());
+    entries.push_back(entry);
+    sources.push_back(sourceFile);
+}
+
+std::vector<std::pair<std::string, SymbolCatalog::SourceFile>> SymbolCatalog::listSourceFiles() const {
+    std::vector<std::pair<std::string, SourceFile>> files;
+    std::error_code error;
+    for (const auto& directory : std::filesystem::directory_iterator(historyPath, error)) {
+        auto infoPath = directory.path() / "info.json";
+        std::error_code statError;
+        auto size = std::filesystem::file_size(infoPath, statError);
+        if (statError) {
+            continue;
+        }
+        auto modified = std::filesystem::last_write_time(infoPath, statError);
+        if (statError) {
+            continue;
+        }
+        SourceFile source;
+        source.symbol = NoString;
+        source.size = size;
+        source.modified = static_cast<int64_t>(modified.time_since_epoch().count());
+        files.emplace_back(directory.path().filename().string(), source);
+    }
+    std::sort(files.begin(), files.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    return files;
+}
+
+void SymbolCatalog::scan(const std::vector<std::pair<std::string, SourceFile>>& files) {
+    // Parsing dominates, so it runs in parallel and only the interning is serial
+    std::vector<std::optional<SymbolInfo>> parsed(files.size());
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i = next++; i < files.size(); i = next++) {
+            std::string infoPath = historyPath + "/" + files[i].first + "/info.json";
+            try {
+                parsed[i] = SymbolInfoParser::parse(infoPath);
+            } catch (const std::exception& e) {
+                std::cerr << "Warning: Failed to parse symbol info " << infoPath << ": " << e.what() << std::endl;
+            }
+        }
+    };
+    size_t threadCount = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), files.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < threadCount; i++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (size_t i = 0; i < files.size(); i++) {
+        if (parsed[i].has_value()) {
+            add(files[i].first, parsed[i].value(), files[i].second);
+        }
+    }
+}
+
+void SymbolCatalog::load() {
+    clear();
+    auto files = listSourceFiles();
+    if (snapshotPath.has_value() && readSnapshot(files)) {
+        loadedFromSnapshot = true;
+        return;
+    }
+    clear();
+    scan(files);
+    if (snapshotPath.has_value()) {
+        writeSnapshot();
+    }
+}
+
+bool SymbolCatalog::readSnapshot(const std::vector<std::pair<std::string, SourceFile>>& files) {
+    std::ifstream file(snapshotPath.value(), std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::error_code sizeError;
+    uint64_t fileSize = std::filesystem::file_size(snapshotPath.value(), sizeError);
+    if (sizeError) {
+        return false;
+    }
+    char magic[4];
+    uint32_t version = 0;
+    std::string snapshotHistoryPath;
+    if (!file.read(magic, sizeof(magic)) || !std::equal(magic, magic + 4, SnapshotMagic)
+        || !readValue(file, version) || version != SnapshotVersion
+        || !readString(file, fileSize, snapshotHistoryPath) || snapshotHistoryPath != historyPath) {
+        return false;
+    }
+
+    // Every string takes at least its length and every entry its fixed size, which bounds both counts
+    uint32_t stringCount = 0;
+    if (!readValue(file, stringCount) || stringCount > fileSize / sizeof(uint32_t)) {
+        return false;
+    }
+    strings.resize(stringCount);
+    for (auto& value : strings) {
+        if (!readString(file, fileSize, value)) {
+            return false;
+        }
+    }
+
+    uint32_t entryCount = 0;
+    if (!readValue(file, entryCount) || entryCount > fileSize / (sizeof(Entry) + sizeof(SourceFile))) {
+        return false;
+    }
+    entries.resize(entryCount);
+    sources.resize(entryCount);
+    for (uint32_t i = 0; i < entryCount; i++) {
+        auto valid = [stringCount](uint32_t id) { return id < stringCount; };
+        const Entry& entry = entries[i];
+        if (!readValue(file, entries[i]) || !readValue(file, sources[i]) || !valid(sources[i].symbol)
+            || (entry.provider != NoString && !valid(entry.provider)) || !valid(entry.contractCurrency)
+            || !valid(entry.profitCurrency) || !valid(entry.name)
+            || entry.historyFormat > static_cast<uint8_t>(HistoryFormat::Tick)) {
+            return false;
+        }
+    }
+
+    // An info.json that failed to parse has no entry, so it keeps forcing a rescan until it is fixed
+    size_t matched = 0;
+    for (uint32_t i = 0; i < entryCount; i++) {
+        const std::string& symbol = strings[sources[i].symbol];
+        auto it = std::lower_bound(files.begin(), files.end(), symbol, [](const auto& a, const std::string& b) { return a.first < b; });
+        if (it == files.end() || it->first != symbol || it->second.size != sources[i].size || it->second.modified != sources[i].modified) {
+            return false;
+        }
+        matched++;
+    }
+    if (matched != files.size()) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < stringCount; i++) {
+        stringIds.emplace(strings[i], i);
+    }
+    for (uint32_t i = 0; i < entryCount; i++) {
+        bySymbol[strings[sources[i].symbol]] = i;
+    }
+    return true;
+}
+
+void SymbolCatalog::writeSnapshot() const {
+    std::filesystem::path path(snapshotPath.value());
+    std::error_code error;
+    if (path.has_parent_path()) {
+        std::filesystem::create_directories(path.parent_path(), error);
+    }
+    // Written aside and renamed so a concurrent reader never sees a partial snapshot
+    std::filesystem::path temporaryPath = path.string() + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "Warning: Failed to write symbol catalog snapshot: " << path.string() << std::endl;
+            return;
+        }
+        file.write(SnapshotMagic, sizeof(SnapshotMagic));
+        writeValue(file, SnapshotVersion);
+        writeString(file, historyPath);
+        writeValue(file, static_cast<uint32_t>(strings.size()));
+        for (const auto& value : strings) {
+            writeString(file, value);
+        }
+        writeValue(file, static_cast<uint32_t>(entries.size()));
+        for (size_t i = 0; i < entries.size(); i++) {
+            writeValue(file, entries[i]);
+            writeValue(file, sources[i]);
+        }
+    }
+    std::filesystem::rename(temporaryPath, path, error);
+    if (error) {
+        std::cerr << "Warning: Failed to write symbol catalog snapshot: " << error.message() << std::endl;
+    }
+}
+
+std::optional<SymbolInfo> SymbolCatalog::find(const std::string& symbol) const {
+    auto it = bySymbol.find(symbol);
+    if (it == bySymbol.end()) {
+        return std::nullopt;
+    }
+    const Entry& entry = entries[it->second];
+    SymbolInfo info;
+    if (entry.provider != NoString) {
+        info.provider = strings[entry.provider];
+    }
+    info.contractCurrency = strings[entry.contractCurrency];
+    info.profitCurrency = strings[entry.profitCurrency];
+    info.name = strings[entry.name];
+    info.baseUnitSize = entry.baseUnitSize;
+    info.contractMultiplier = entry.contractMultiplier;
+    info.instrumentType = entry.instrumentType;
+    info.mmr = entry.mmr;
+    info.pipSize = entry.pipSize;
+    info.precision = entry.precision;
+    info.marginEnabled = entry.marginEnabled != 0;
+    info.withoutHistory = entry.withoutHistory != 0;
+    info.endOfHistoryReached = entry.endOfHistoryReached != 0;
+    info.historyFormat = static_cast<HistoryFormat>(entry.historyFormat);
+    return info;
+}
+
+size_t SymbolCatalog::size() const {
+    return entries.size();
+}
+
+size_t SymbolCatalog::internedStringCount() const {
+    return strings.size();
+}
+
+bool SymbolCatalog::isLoadedFromSnapshot() const {
+    return loadedFromSnapshot;
+}
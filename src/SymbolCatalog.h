@@ -0,0 +1,67 @@
+#include <string>
+#include <vector>
+#include <optional>
+#include <unordered_map>
+#include <cstdint>
+#include "SymbolInfoParser.h"
+
+#pragma once
+
+// Flat, in-memory table of every info.json under the history path.
+// Strings are interned, lookups by (escaped) symbol are O(1).
+// The table is persisted as a binary snapshot and reused while the source files are unchanged.
+class SymbolCatalog {
+public:
+    static constexpr uint32_t NoString = 0xFFFFFFFFu;
+
+    class Entry {
+    public:
+        uint32_t provider;
+        uint32_t contractCurrency;
+        uint32_t profitCurrency;
+        uint32_t name;
+        double baseUnitSize;
+        double contractMultiplier;
+        double mmr;
+        double pipSize;
+        int32_t instrumentType;
+        int32_t precision;
+        uint8_t marginEnabled;
+        uint8_t withoutHistory;
+        uint8_t endOfHistoryReached;
+        uint8_t historyFormat;
+    };
+
+    // Identifies the info.json an entry was parsed from
+    class SourceFile {
+    public:
+        uint32_t symbol;
+        uint64_t size;
+        int64_t modified;
+    };
+
+    SymbolCatalog(const std::string& historyPath, const std::optional<std::string>& snapshotPath);
+    // Loads the snapshot if it is still valid, otherwise scans the history path and rewrites it
+    void load();
+    std::optional<SymbolInfo> find(const std::string& symbol) const;
+    size_t size() const;
+    size_t internedStringCount() const;
+    bool isLoadedFromSnapshot() const;
+private:
+    std::string historyPath;
+    std::optional<std::string> snapshotPath;
+    std::vector<std::string> strings;
+    std::unordered_map<std::string, uint32_t> stringIds;
+    std::vector<Entry> entries;
+    std::vector<SourceFile> sources;
+    std::unordered_map<std::string, uint32_t> bySymbol;
+    bool loadedFromSnapshot = false;
+
+    void clear();
+    uint32_t intern(const std::string& value);
+    void add(const std::string& symbol, const SymbolInfo& info, const SourceFile& source);
+    void scan(const std::vector<std::pair<std::string, SourceFile>>& files);
+    std::vector<std::pair<std::string, SourceFile>> listSourceFiles() const;
+    bool readSnapshot(const std::vector<std::pair<std::string, SourceFile>>& files);
+    void writeSnapshot() const;
+};
@@ -33,6 +33,13 @@ SymbolInfo SymbolInfoParser::parse(const std::string& path) {
     info.marginEnabled = j.value("MarginEnabled", false);
     info.withoutHistory = j.value("WithoutHistory", false);
     info.endOfHistoryReached = j.value("EndOfHistoryReached", false);
+
+    std::string historyFormat = j.value("HistoryFormat", HistoryFormats::name(HistoryFormat::Standard));
+    auto format = HistoryFormats::parse(historyFormat);
+    if (!format.has_value()) {
+        throw std::runtime_error("Unknown HistoryFormat: " + historyFormat);
+    }
+    info.historyFormat = format.value();
     
     return info;
 }
\ No newline at end of file
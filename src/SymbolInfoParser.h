@@ -1,5 +1,6 @@
 #include <string>
 #include <optional>
+#include "HistoryDialect.h"
 
 #pragma once
 
@@ -18,6 +19,8 @@ public:
     bool marginEnabled;
     bool withoutHistory;
     bool endOfHistoryReached;
+    // Dialect of the week files, "HistoryFormat" in info.json
+    HistoryFormat historyFormat = HistoryFormat::Standard;
 };
 
 class SymbolInfoParser {
@@ -0,0 +1,124 @@
+#include "SystemSampler.h"
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+SystemSampler::SystemSampler() {
+    previousCpu = readCpuTimes();
+    previousTime = std::chrono::steady_clock::now();
+}
+
+ConcurrencyController::Sample SystemSampler::sample(size_t finishedTasks) {
+    ConcurrencyController::Sample result;
+    auto now = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(now - previousTime).count();
+    if (seconds > 0 && finishedTasks >= previousTasks) {
+        result.throughput = (finishedTasks - previousTasks) / seconds;
+    }
+    auto cpu = readCpuTimes();
+    if (cpu.has_value() && previousCpu.has_value() && cpu->total > previousCpu->total) {
+        double total = static_cast<double>(cpu->total - previousCpu->total);
+        result.cpuBusy = (cpu->busy - previousCpu->busy) / total;
+        result.ioWait = (cpu->ioWait - previousCpu->ioWait) / total;
+    }
+    result.availableMemoryMb = readAvailableMemoryMb();
+    previousCpu = cpu;
+    previousTasks = finishedTasks;
+    previousTime = now;
+    return result;
+}
+
+std::optional<SystemSampler::CpuTimes> SystemSampler::parseProcStat(const std::string& content) {
+    std::istringstream stream(content);
+    std::string line;
+    while (std::getline(stream, line)) {
+        std::istringstream fields(line);
+        std::string name;
+        fields >> name;
+        if (name != "cpu") {
+            continue;
+        }
+        // user nice system idle iowait irq softirq steal ...
+        std::vector<unsigned long long> values;
+        unsigned long long value = 0;
+        while (fields >> value) {
+            values.push_back(value);
+        }
+        if (values.size() < 5) {
+            return std::nullopt;
+        }
+        CpuTimes times;
+        for (size_t i = 0; i < values.size() && i < 8; i++) {
+            times.total += values[i];
+        }
+        times.ioWait = values[4];
+        times.busy = times.total - values[3] - values[4];
+        return times;
+    }
+    return std::nullopt;
+}
+
+std::optional<double> SystemSampler::parseMemInfo(const std::string& content) {
+    std::istringstream stream(content);
+    std::string line;
+    while (std::getline(stream, line)) {
+        if (line.rfind("MemAvailable:", 0) == 0) {
+            std::istringstream fields(line.substr(13));
+            double kilobytes = 0;
+            if (fields >> kilobytes) {
+                return kilobytes / 1024.0;
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+#ifdef _WIN32
+
+std::optional<SystemSampler::CpuTimes> SystemSampler::readCpuTimes() {
+    FILETIME idle, kernel, user;
+    if (!GetSystemTimes(&idle, &kernel, &user)) {
+        return std::nullopt;
+    }
+    auto toTicks = [](const FILETIME& time) { return (static_cast<unsigned long long>(time.dwHighDateTime) << 32) | time.dwLowDateTime; };
+    // Kernel time includes idle time, Windows does not report I/O wait
+    CpuTimes times;
+    times.total = toTicks(kernel) + toTicks(user);
+    times.busy = times.total - toTicks(idle);
+    return times;
+}
+
+double SystemSampler::readAvailableMemoryMb() {
+    MEMORYSTATUSEX status = {};
+    status.dwLength = sizeof(status);
+    if (!GlobalMemoryStatusEx(&status)) {
+        return 1e12;
+    }
+    return status.ullAvailPhys / (1024.0 * 1024.0);
+}
+
+#else
+
+namespace {
+    std::string readFile(const std::string& path) {
+        std::ifstream file(path);
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        return buffer.str();
+    }
+}
+
+std::optional<SystemSampler::CpuTimes> SystemSampler::readCpuTimes() {
+    return parseProcStat(readFile("/proc/stat"));
+}
+
+double SystemSampler::readAvailableMemoryMb() {
+    // Unknown memory never stops workers
+    return parseMemInfo(readFile("/proc/meminfo")).value_or(1e12);
+}
+
+#endif
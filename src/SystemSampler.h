@@ -0,0 +1,33 @@
+#include <string>
+#include <optional>
+#include <chrono>
+#include "ConcurrencyController.h"
+
+#pragma once
+
+// Measures the host for the ConcurrencyController: CPU and I/O wait shares from /proc/stat,
+// available memory from /proc/meminfo (GetSystemTimes and GlobalMemoryStatusEx on Windows)
+// and the task throughput since the previous sample.
+class SystemSampler {
+public:
+    class CpuTimes {
+    public:
+        unsigned long long busy = 0;
+        unsigned long long ioWait = 0;
+        unsigned long long total = 0;
+    };
+
+    SystemSampler();
+    ConcurrencyController::Sample sample(size_t finishedTasks);
+    // The aggregate "cpu" line of /proc/stat
+    static std::optional<CpuTimes> parseProcStat(const std::string& content);
+    // MemAvailable of /proc/meminfo in MB
+    static std::optional<double> parseMemInfo(const std::string& content);
+private:
+    std::optional<CpuTimes> previousCpu;
+    size_t previousTasks = 0;
+    std::chrono::steady_clock::time_point previousTime;
+
+    static std::optional<CpuTimes> readCpuTimes();
+    static double readAvailableMemoryMb();
+};
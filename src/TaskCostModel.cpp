@@ -0,0 +1,100 @@
+#include "TaskCostModel.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+TaskCostModel::TaskCostModel(RatesStorageProvider& ratesStorageProvider) : ratesStorageProvider(ratesStorageProvider) {
+}
+
+std::string TaskCostModel::keyOf(const BacktestJob& job) {
+    std::string key = job.project.strategy + ":" + job.project.defaultPeriod + ":";
+    for (const auto& symbol : job.symbols) {
+        key += symbol + ",";
+    }
+    return key;
+}
+
+uintmax_t TaskCostModel::historyBytes(const BacktestTask& task) {
+    uintmax_t bytes = 0;
+    for (const auto& symbol : task.job->symbols) {
+        // Keyed by the raw path, which names the week whether it is read from it, a bar store or a compressed file
+        std::string path = ratesStorageProvider.getWeekSourcePath(symbol, task.window.start);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = fileSizes.find(path);
+            if (it != fileSizes.end()) {
+                bytes += it->second;
+                continue;
+            }
+        }
+        uintmax_t size = ratesStorageProvider.getWeekHistoryBytes(symbol, task.window.start);
+        std::lock_guard<std::mutex> lock(mutex);
+        bytes += fileSizes.emplace(path, size).first->second;
+    }
+    return bytes;
+}
+
+double TaskCostModel::estimate(const BacktestTask& task) {
+    uintmax_t bytes = historyBytes(task);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = rates.find(keyOf(*task.job));
+    if (it != rates.end()) {
+        return static_cast<double>(bytes) * it->second.secondsPerByte;
+    }
+    double total = 0.0;
+    size_t samples = 0;
+    for (const auto& rate : rates) {
+        total += rate.second.secondsPerByte * static_cast<double>(rate.second.samples);
+        samples += rate.second.samples;
+    }
+    // Without any history of durations the bar count alone orders the tasks
+    double secondsPerByte = samples > 0 ? total / static_cast<double>(samples) : 1e-6;
+    return static_cast<double>(bytes) * secondsPerByte;
+}
+
+void TaskCostModel::record(const BacktestTask& task, double seconds) {
+    uintmax_t bytes = historyBytes(task);
+    if (bytes == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    Rate& rate = rates[keyOf(*task.job)];
+    rate.samples++;
+    rate.secondsPerByte += (seconds / static_cast<double>(bytes) - rate.secondsPerByte) / static_cast<double>(rate.samples);
+}
+
+bool TaskCostModel::load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream ss(line);
+        std::string key;
+        Rate rate;
+        if (std::getline(ss, key, '\t') && ss >> rate.secondsPerByte >> rate.samples) {
+            rates[key] = rate;
+        }
+    }
+    return true;
+}
+
+bool TaskCostModel::save(const std::string& path) {
+    std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::trunc);
+        if (!file.is_open()) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        file.precision(17);
+        for (const auto& rate : rates) {
+            file << rate.first << "\t" << rate.second.secondsPerByte << "\t" << rate.second.samples << "\n";
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, path, error);
+    return !error;
+}
@@ -0,0 +1,35 @@
+#include <string>
+#include <map>
+#include <mutex>
+#include <cstdint>
+#include "BacktestJob.h"
+#include "RatesStorageProvider.h"
+
+#pragma once
+
+// Estimates how long a task will run. The amount of history (bytes of the weeks as raw files, a
+// proxy for the bar count, see RatesStorageProvider::getWeekHistoryBytes) is scaled by the seconds per byte observed for the same strategy and symbols
+// in earlier runs, falling back to the average over everything seen.
+class TaskCostModel {
+    RatesStorageProvider& ratesStorageProvider;
+    std::mutex mutex;
+    std::map<std::string, uintmax_t> fileSizes;
+
+    class Rate {
+    public:
+        double secondsPerByte = 0.0;
+        size_t samples = 0;
+    };
+    std::map<std::string, Rate> rates;
+public:
+    TaskCostModel(RatesStorageProvider& ratesStorageProvider);
+    // Relative cost, 0 for tasks without history
+    double estimate(const BacktestTask& task);
+    void record(const BacktestTask& task, double seconds);
+    // Rates from earlier sweeps, one "key<TAB>seconds per byte<TAB>samples" line each
+    bool load(const std::string& path);
+    bool save(const std::string& path);
+    static std::string keyOf(const BacktestJob& job);
+private:
+    uintmax_t historyBytes(const BacktestTask& task);
+};
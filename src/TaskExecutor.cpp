@@ -0,0 +1,45 @@
+#include "TaskExecutor.h"
+
+TaskExecutor::TaskExecutor(PreparedDataCache& preparedData) : preparedData(preparedData) {
+}
+
+TaskResult TaskExecutor::execute(const BacktestTask& task, ConsoleBacktester& backtester, ProcessCancellation* cancellation) {
+    TaskResult result;
+    const BacktestJob& job = *task.job;
+    BacktestProject project = job.project;
+    project.startTime = task.window.startTime;
+    project.endTime = task.window.endTime;
+
+    // Prepare the history of all portfolio symbols in one pass, the leases keep the files until the backtest is done
+    auto tradingHistory = preparedData.acquire(job.symbols, task.window.start, job.alignment, project.defaultPeriod);
+    if (!tradingHistory.has_value()) {
+        result.message = "no history for the week";
+        return result;
+    }
+    std::vector<std::string> pricesFilePaths = tradingHistory.value().paths;
+    std::vector<PreparedDataCache::Lease> conversionData;
+    for (const auto& conversionSymbol : job.conversionSymbols) {
+        auto conversion = preparedData.acquire(conversionSymbol, task.window.start, project.defaultPeriod);
+        if (!conversion.has_value()) {
+            result.message = "conversion pair data missing for " + conversionSymbol;
+            return result;
+        }
+        pricesFilePaths.push_back(conversion.value().paths[0]);
+        conversionData.push_back(std::move(conversion.value()));
+    }
+    for (size_t i = 0; i < project.instruments.size(); i++) {
+        project.instruments[i].pricesFilePath = pricesFilePaths[i];
+    }
+
+    try {
+        result.backtest = backtester.run(project, *job.projectTemplate, cancellation);
+        // A killed copy exits non-zero as well, but it has lost to another attempt and is ignored
+        result.completed = result.backtest.exitCode == 0 || result.backtest.cancelled;
+        if (!result.completed) {
+            result.message = "backtester exited with code " + std::to_string(result.backtest.exitCode);
+        }
+    } catch (const std::exception& e) {
+        result.message = e.what();
+    }
+    return result;
+}
@@ -0,0 +1,23 @@
+#include <string>
+#include "BacktestJob.h"
+#include "ConsoleBacktester.h"
+#include "PreparedDataCache.h"
+
+#pragma once
+
+class TaskResult {
+public:
+    // False when the task was skipped, e.g. because the week has no history, or the backtester failed
+    bool completed = false;
+    std::string message;
+    BacktestResult backtest;
+};
+
+// Prepares the data of a task through the shared cache and runs the backtester on it
+class TaskExecutor {
+    PreparedDataCache& preparedData;
+public:
+    TaskExecutor(PreparedDataCache& preparedData);
+    // The cancellation lets another thread kill the backtester, e.g. when a speculative copy wins
+    TaskResult execute(const BacktestTask& task, ConsoleBacktester& backtester, ProcessCancellation* cancellation = nullptr);
+};
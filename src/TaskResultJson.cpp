@@ -0,0 +1,59 @@
+#include "TaskResultJson.h"
+#include "TimeUtils.h"
+
+nlohmann::json TaskResultJson::describe(const BacktestTask& task, const TaskResult& result) {
+    nlohmann::json j = serialize(result);
+    std::string symbols;
+    for (const auto& symbol : task.job->symbols) {
+        symbols += (symbols.empty() ? "" : ",") + symbol;
+    }
+    j["strategy"] = task.job->project.strategy;
+    j["symbols"] = symbols;
+    j["week"] = TimeUtils::formatDateTime(task.window.startTime).substr(0, 10);
+    j["parameters"] = nlohmann::json::object();
+    for (const auto& parameter : task.job->project.strategyParameters) {
+        j["parameters"][parameter.name] = parameter.value;
+    }
+    return j;
+}
+
+nlohmann::json TaskResultJson::serialize(const TaskResult& result) {
+    nlohmann::json j;
+    j["completed"] = result.completed;
+    j["message"] = result.message;
+    j["exitCode"] = result.backtest.exitCode;
+    j["stats"] = result.backtest.stats;
+    const ProcessUsage& usage = result.backtest.usage;
+    j["usage"] = {
+        { "spawned", usage.spawned },
+        { "userSeconds", usage.userSeconds },
+        { "systemSeconds", usage.systemSeconds },
+        { "maxRssKb", usage.maxRssKb },
+        { "minorFaults", usage.minorFaults },
+        { "majorFaults", usage.majorFaults },
+        { "blockInputs", usage.blockInputs },
+        { "blockOutputs", usage.blockOutputs }
+    };
+    return j;
+}
+
+TaskResult TaskResultJson::parse(const nlohmann::json& value) {
+    TaskResult result;
+    result.completed = value.value("completed", false);
+    result.message = value.value("message", "");
+    result.backtest.exitCode = value.value("exitCode", -1);
+    result.backtest.stats = value.value("stats", "");
+    if (value.contains("usage") && value["usage"].is_object()) {
+        const nlohmann::json& usage = value["usage"];
+        // Results written before the flag existed only carried the usage of completed runs
+        result.backtest.usage.spawned = usage.value("spawned", result.completed);
+        result.backtest.usage.userSeconds = usage.value("userSeconds", 0.0);
+        result.backtest.usage.systemSeconds = usage.value("systemSeconds", 0.0);
+        result.backtest.usage.maxRssKb = usage.value("maxRssKb", 0L);
+        result.backtest.usage.minorFaults = usage.value("minorFaults", 0L);
+        result.backtest.usage.majorFaults = usage.value("majorFaults", 0L);
+        result.backtest.usage.blockInputs = usage.value("blockInputs", 0L);
+        result.backtest.usage.blockOutputs = usage.value("blockOutputs", 0L);
+    }
+    return result;
+}
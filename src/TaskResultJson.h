@@ -0,0 +1,14 @@
+#include <nlohmann/json.hpp>
+#include "BacktestJob.h"
+#include "TaskExecutor.h"
+
+#pragma once
+
+// JSON form of task results shared by the daemon and the coordinator protocols
+class TaskResultJson {
+public:
+    // Describes what ran (symbols, week, parameters) and how it ended
+    static nlohmann::json describe(const BacktestTask& task, const TaskResult& result);
+    static nlohmann::json serialize(const TaskResult& result);
+    static TaskResult parse(const nlohmann::json& value);
+};
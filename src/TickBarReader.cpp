@@ -0,0 +1,93 @@
+#include "TickBarReader.h"
+#include <cstring>
+
+TickBarReader::TickBarReader(std::istream& file, long long periodSeconds, long long sessionOffsetSeconds, size_t chunkBytes)
+    : file(file), resampler(periodSeconds, sessionOffsetSeconds), buffer(chunkBytes > 0 ? chunkBytes : 1) {
+    this->nextBar = 0;
+    this->tickCount = 0;
+    this->finished = false;
+}
+
+void TickBarReader::parseLine(const char* begin, const char* end) {
+    readErrors.lines++;
+    const char* position = begin;
+    while (position < end && (*position == ' ' || *position == '\r')) {
+        position++;
+    }
+    if (position == end) {
+        return;
+    }
+    Data data;
+    StorageLineError error = StorageReader::parse<TickDialect>(begin, end, data);
+    if (error != StorageLineError::None) {
+        readErrors.add(error);
+        return;
+    }
+    data.volume = 1;
+    ticks.push(data);
+    tickCount++;
+}
+
+bool TickBarReader::readChunk(BarColumns& output) {
+    if (finished) {
+        return false;
+    }
+    ticks.clear();
+    file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    const char* begin = buffer.data();
+    const char* end = begin + file.gcount();
+    const char* lineStart = begin;
+    if (!carry.empty()) {
+        const char* newline = static_cast<const char*>(std::memchr(begin, '\n', static_cast<size_t>(end - begin)));
+        const char* lineEnd = newline != nullptr ? newline : end;
+        carry.append(begin, lineEnd);
+        if (newline != nullptr) {
+            parseLine(carry.data(), carry.data() + carry.size());
+            carry.clear();
+            lineStart = newline + 1;
+        } else {
+            lineStart = end;
+        }
+    }
+    while (lineStart < end) {
+        const char* newline = static_cast<const char*>(std::memchr(lineStart, '\n', static_cast<size_t>(end - lineStart)));
+        if (newline == nullptr) {
+            carry.assign(lineStart, end);
+            break;
+        }
+        parseLine(lineStart, newline);
+        lineStart = newline + 1;
+    }
+
+    bool endOfFile = !file;
+    if (endOfFile && !carry.empty()) {
+        parseLine(carry.data(), carry.data() + carry.size());
+        carry.clear();
+    }
+    resampler.push(ticks, output);
+    if (endOfFile) {
+        resampler.flush(output);
+        finished = true;
+    }
+    return true;
+}
+
+bool TickBarReader::readNext(Data& data) {
+    while (nextBar >= bars.size()) {
+        bars.clear();
+        nextBar = 0;
+        if (!readChunk(bars)) {
+            return false;
+        }
+    }
+    data = bars.get(nextBar++);
+    return true;
+}
+
+const StorageReadErrors& TickBarReader::errors() const {
+    return readErrors;
+}
+
+size_t TickBarReader::ticksRead() const {
+    return tickCount;
+}
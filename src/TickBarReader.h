@@ -0,0 +1,40 @@
+#include <istream>
+#include <string>
+#include <vector>
+#include "StorageReader.h"
+#include "BarColumns.h"
+#include "BarResampler.h"
+
+#pragma once
+
+// Streams a tick history file (TickDialect) as bid/ask bars of one period. The file is read in
+// large chunks and the ticks of each chunk are aggregated right away, so memory depends on the
+// chunk size, not on the file size. The volume of a bar is its tick count.
+class TickBarReader {
+    std::istream& file;
+    BarResampler resampler;
+    std::vector<char> buffer;
+    // Line split by the end of the previous chunk
+    std::string carry;
+    BarColumns ticks;
+    // Bars handed out one by one by readNext
+    BarColumns bars;
+    size_t nextBar;
+    StorageReadErrors readErrors;
+    size_t tickCount;
+    bool finished;
+public:
+    static const size_t defaultChunkBytes = 4 << 20;
+
+    TickBarReader(std::istream& file, long long periodSeconds, long long sessionOffsetSeconds, size_t chunkBytes = defaultChunkBytes);
+    // Appends the bars completed by the next chunk, the last bar with the end of the file.
+    // False once the whole file was returned.
+    bool readChunk(BarColumns& output);
+    // The next bar, for readers merging bars of several files; false at the end of the file
+    bool readNext(Data& data);
+    // Malformed lines skipped so far
+    const StorageReadErrors& errors() const;
+    size_t ticksRead() const;
+private:
+    void parseLine(const char* begin, const char* end);
+};
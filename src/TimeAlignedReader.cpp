@@ -0,0 +1,102 @@
+#include "TimeAlignedReader.h"
+#include "TimeUtils.h"
+
+TimeAlignedReader::TimeAlignedReader(const std::vector<std::ifstream*>& files, AlignmentMode mode, const std::vector<HistoryFormat>& formats, const std::vector<const BarColumns*>& columns) {
+    this->files = files;
+    this->mode = mode;
+    this->heads.resize(files.size());
+    this->headTimes.resize(files.size(), 0);
+    this->readErrors.resize(files.size());
+    this->tickReaders.resize(files.size());
+    this->columns.resize(files.size(), nullptr);
+    this->nextRows.resize(files.size(), 0);
+    for (size_t i = 0; i < files.size(); i++) {
+        if (i < columns.size() && columns[i] != nullptr) {
+            this->columns[i] = columns[i];
+            readers.push_back(nullptr);
+            continue;
+        }
+        HistoryFormat format = i < formats.size() ? formats[i] : HistoryFormat::Standard;
+        readers.push_back(StorageReader::lineReader(format));
+        if (format == HistoryFormat::Tick) {
+            tickReaders[i] = std::make_unique<TickBarReader>(*files[i], 60, 0);
+        }
+    }
+    for (size_t i = 0; i < files.size(); i++) {
+        advance(i);
+    }
+}
+
+void TimeAlignedReader::advance(size_t index) {
+    if (columns[index] != nullptr) {
+        if (nextRows[index] >= columns[index]->size()) {
+            heads[index] = std::nullopt;
+            return;
+        }
+        headTimes[index] = columns[index]->time[nextRows[index]];
+        heads[index] = columns[index]->get(nextRows[index]++);
+        return;
+    }
+    Data data;
+    bool read = tickReaders[index] ? tickReaders[index]->readNext(data) : readers[index](*files[index], data, readErrors[index]);
+    if (!read) {
+        heads[index] = std::nullopt;
+        return;
+    }
+    heads[index] = data;
+    headTimes[index] = TimeUtils::toEpochSeconds(data.timestamp);
+}
+
+const StorageReadErrors& TimeAlignedReader::errors(size_t index) const {
+    return tickReaders[index] ? tickReaders[index]->errors() : readErrors[index];
+}
+
+std::optional<AlignedBars> TimeAlignedReader::readNextAny() {
+    std::optional<long long> minTime;
+    for (size_t i = 0; i < heads.size(); i++) {
+        if (heads[i].has_value() && (!minTime.has_value() || headTimes[i] < minTime.value())) {
+            minTime = headTimes[i];
+        }
+    }
+    if (!minTime.has_value()) {
+        return std::nullopt;
+    }
+
+    AlignedBars aligned;
+    aligned.timestamp = minTime.value();
+    aligned.bars.resize(heads.size());
+    for (size_t i = 0; i < heads.size(); i++) {
+        if (heads[i].has_value() && headTimes[i] == aligned.timestamp) {
+            aligned.bars[i] = heads[i];
+            advance(i);
+        }
+    }
+    return aligned;
+}
+
+std::optional<AlignedBars> TimeAlignedReader::readNext() {
+    auto aligned = readNextAny();
+    if (mode == AlignmentMode::Union) {
+        return aligned;
+    }
+    while (aligned.has_value()) {
+        bool complete = true;
+        for (const auto& bar : aligned.value().bars) {
+            if (!bar.has_value()) {
+                complete = false;
+                break;
+            }
+        }
+        if (complete) {
+            return aligned;
+        }
+        // Once any source is exhausted no further common timestamp can exist
+        for (const auto& head : heads) {
+            if (!head.has_value()) {
+                return std::nullopt;
+            }
+        }
+        aligned = readNextAny();
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,49 @@
+#include <vector>
+#include <optional>
+#include <fstream>
+#include <memory>
+#include "StorageReader.h"
+#include "TickBarReader.h"
+#include "BarColumns.h"
+
+#pragma once
+
+enum class AlignmentMode {
+    // Every bar of every source is emitted
+    Union,
+    // Only timestamps present in all sources are emitted
+    Intersection
+};
+
+class AlignedBars {
+public:
+    long long timestamp;
+    // One entry per source, empty when the source has no bar at this timestamp
+    std::vector<std::optional<Data>> bars;
+};
+
+// Streams several storage files at once and merges them by bar timestamp.
+// Only one pending bar per source is kept in memory, one chunk for tick sources.
+// Malformed lines are skipped and counted per source.
+class TimeAlignedReader {
+    std::vector<std::ifstream*> files;
+    std::vector<std::optional<Data>> heads;
+    std::vector<long long> headTimes;
+    std::vector<StorageReadErrors> readErrors;
+    std::vector<StorageReader::LineReader> readers;
+    // Tick sources are aggregated to m1 on the fly, empty for bar sources
+    std::vector<std::unique_ptr<TickBarReader>> tickReaders;
+    // Sources already in memory, read from their next row instead of a file
+    std::vector<const BarColumns*> columns;
+    std::vector<size_t> nextRows;
+    AlignmentMode mode;
+public:
+    // formats holds the history format of each file, all files are standard when it is empty.
+    // A source with bars in columns has no file, its file pointer may be null.
+    TimeAlignedReader(const std::vector<std::ifstream*>& files, AlignmentMode mode, const std::vector<HistoryFormat>& formats = {}, const std::vector<const BarColumns*>& columns = {});
+    std::optional<AlignedBars> readNext();
+    const StorageReadErrors& errors(size_t index) const;
+private:
+    std::optional<AlignedBars> readNextAny();
+    void advance(size_t index);
+};
@@ -0,0 +1,120 @@
+#include "TimeUtils.h"
+
+namespace {
+    // Days since 1970-01-01 for a proleptic Gregorian date (month is 1-based)
+    long long daysFromCivil(long long year, unsigned month, unsigned day) {
+        year -= month <= 2;
+        const long long era = (year >= 0 ? year : year - 399) / 400;
+        const unsigned yearOfEra = static_cast<unsigned>(year - era * 400);
+        const unsigned dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+        const unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        return era * 146097 + static_cast<long long>(dayOfEra) - 719468;
+    }
+
+    // Inverse of daysFromCivil
+    void civilFromDays(long long days, long long& year, unsigned& month, unsigned& day) {
+        days += 719468;
+        const long long era = (days >= 0 ? days : days - 146096) / 146097;
+        const unsigned dayOfEra = static_cast<unsigned>(days - era * 146097);
+        const unsigned yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        const unsigned dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+        const unsigned monthIndex = (5 * dayOfYear + 2) / 153;
+        day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+        month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+        year = static_cast<long long>(yearOfEra) + era * 400 + (month <= 2);
+    }
+
+    void appendDigits(std::string& buffer, long long value, int width) {
+        char digits[20];
+        int count = 0;
+        do {
+            digits[count++] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value > 0 && count < 20);
+        for (int i = count; i < width; i++) {
+            buffer.push_back('0');
+        }
+        while (count > 0) {
+            buffer.push_back(digits[--count]);
+        }
+    }
+}
+
+long long TimeUtils::toEpochSeconds(const std::tm& date) {
+    long long days = daysFromCivil(date.tm_year + 1900LL, static_cast<unsigned>(date.tm_mon + 1), static_cast<unsigned>(date.tm_mday));
+    return days * 86400LL + date.tm_hour * 3600LL + date.tm_min * 60LL + date.tm_sec;
+}
+
+std::tm TimeUtils::toUtc(long long timestamp) {
+    long long days = timestamp >= 0 ? timestamp / 86400 : (timestamp - 86399) / 86400;
+    long long secondsOfDay = timestamp - days * 86400;
+    long long year = 0;
+    unsigned month = 0;
+    unsigned day = 0;
+    civilFromDays(days, year, month, day);
+
+    std::tm date = {};
+    date.tm_year = static_cast<int>(year - 1900);
+    date.tm_mon = static_cast<int>(month - 1);
+    date.tm_mday = static_cast<int>(day);
+    date.tm_hour = static_cast<int>(secondsOfDay / 3600);
+    date.tm_min = static_cast<int>(secondsOfDay % 3600 / 60);
+    date.tm_sec = static_cast<int>(secondsOfDay % 60);
+    date.tm_wday = static_cast<int>((days % 7 + 11) % 7);
+    date.tm_yday = static_cast<int>(days - daysFromCivil(year, 1, 1));
+    return date;
+}
+
+std::tm TimeUtils::toLocal(long long timestamp) {
+    std::time_t time = static_cast<std::time_t>(timestamp);
+    std::tm date = {};
+#ifdef _WIN32
+    localtime_s(&date, &time);
+#else
+    localtime_r(&time, &date);
+#endif
+    return date;
+}
+
+void TimeUtils::appendDateTime(std::string& buffer, long long timestamp) {
+    std::tm date = toUtc(timestamp);
+    appendDigits(buffer, date.tm_year + 1900LL, 4);
+    buffer.push_back('-');
+    appendDigits(buffer, date.tm_mon + 1, 2);
+    buffer.push_back('-');
+    appendDigits(buffer, date.tm_mday, 2);
+    buffer.push_back(' ');
+    appendDigits(buffer, date.tm_hour, 2);
+    buffer.push_back(':');
+    appendDigits(buffer, date.tm_min, 2);
+    buffer.push_back(':');
+    appendDigits(buffer, date.tm_sec, 2);
+}
+
+std::string TimeUtils::formatDateTime(long long timestamp) {
+    std::string result;
+    result.reserve(19);
+    appendDateTime(result, timestamp);
+    return result;
+}
+
+std::vector<int> TimeUtils::toFields(const std::tm& date) {
+    return { date.tm_year, date.tm_mon, date.tm_mday, date.tm_hour, date.tm_min, date.tm_sec, date.tm_wday, date.tm_yday };
+}
+
+std::optional<std::tm> TimeUtils::fromFields(const std::vector<int>& fields) {
+    if (fields.size() != 8) {
+        return std::nullopt;
+    }
+    std::tm date = {};
+    date.tm_year = fields[0];
+    date.tm_mon = fields[1];
+    date.tm_mday = fields[2];
+    date.tm_hour = fields[3];
+    date.tm_min = fields[4];
+    date.tm_sec = fields[5];
+    date.tm_wday = fields[6];
+    date.tm_yday = fields[7];
+    date.tm_isdst = -1;
+    return date;
+}
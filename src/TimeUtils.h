@@ -0,0 +1,24 @@
+#include <ctime>
+#include <string>
+#include <vector>
+#include <optional>
+
+#pragma once
+
+class TimeUtils {
+public:
+    // Converts broken-down UTC time to seconds since epoch without touching the process time zone
+    static long long toEpochSeconds(const std::tm& date);
+    // Thread-safe replacement for std::gmtime
+    static std::tm toUtc(long long timestamp);
+    // Thread-safe replacement for std::localtime
+    static std::tm toLocal(long long timestamp);
+    // Appends the timestamp as "YYYY-MM-DD HH:MM:SS" (UTC)
+    static void appendDateTime(std::string& buffer, long long timestamp);
+    static std::string formatDateTime(long long timestamp);
+    // Calendar fields of a date (year, month, day, hour, minute, second, weekday, day of year), so that
+    // machines in other time zones rebuild the same date instead of converting a timestamp locally
+    static std::vector<int> toFields(const std::tm& date);
+    // Nothing unless fields holds all eight values
+    static std::optional<std::tm> fromFields(const std::vector<int>& fields);
+};
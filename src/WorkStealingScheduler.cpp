@@ -0,0 +1,87 @@
+#include "WorkStealingScheduler.h"
+#include <algorithm>
+#include <numeric>
+
+WorkStealingScheduler::WorkStealingScheduler(size_t workerCount) {
+    for (size_t i = 0; i < std::max<size_t>(workerCount, 1); i++) {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    this->steals = 0;
+}
+
+void WorkStealingScheduler::assign(const std::vector<double>& costs) {
+    this->costs = costs;
+    std::vector<size_t> order(costs.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&costs](size_t left, size_t right) { return costs[left] > costs[right]; });
+    // Longest processing time first: each task goes to the least loaded worker
+    for (size_t task : order) {
+        auto target = std::min_element(queues.begin(), queues.end(), [](const auto& left, const auto& right) {
+            return left->remainingCost < right->remainingCost || (left->remainingCost == right->remainingCost && left->tasks.size() < right->tasks.size());
+        });
+        (*target)->tasks.push_back(task);
+        (*target)->remainingCost += costs[task];
+    }
+    std::lock_guard<std::mutex> lock(metricsMutex);
+    finished.assign(queues.size(), std::nullopt);
+    started = Clock::now();
+}
+
+std::optional<size_t> WorkStealingScheduler::popFront(WorkerQueue& queue) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return std::nullopt;
+    }
+    size_t task = queue.tasks.front();
+    queue.tasks.pop_front();
+    queue.remainingCost -= costs[task];
+    return task;
+}
+
+std::optional<size_t> WorkStealingScheduler::next(size_t worker) {
+    auto task = popFront(*queues[worker]);
+    while (!task.has_value()) {
+        // Steal from whoever has the most work left, the remaining costs are only a hint
+        WorkerQueue* victim = nullptr;
+        double victimCost = -1.0;
+        for (const auto& queue : queues) {
+            std::lock_guard<std::mutex> lock(queue->mutex);
+            if (!queue->tasks.empty() && queue->remainingCost > victimCost) {
+                victim = queue.get();
+                victimCost = queue->remainingCost;
+            }
+        }
+        if (victim == nullptr) {
+            std::lock_guard<std::mutex> lock(metricsMutex);
+            if (!finished[worker].has_value()) {
+                finished[worker] = Clock::now();
+            }
+            return std::nullopt;
+        }
+        task = popFront(*victim);
+        if (task.has_value()) {
+            std::lock_guard<std::mutex> lock(metricsMutex);
+            steals++;
+        }
+    }
+    return task;
+}
+
+WorkStealingScheduler::Metrics WorkStealingScheduler::metrics() const {
+    std::lock_guard<std::mutex> lock(metricsMutex);
+    Metrics metrics;
+    metrics.steals = steals;
+    Clock::time_point end = started;
+    for (const auto& time : finished) {
+        if (time.has_value() && time.value() > end) {
+            end = time.value();
+        }
+    }
+    metrics.makespanSeconds = std::chrono::duration<double>(end - started).count();
+    for (const auto& time : finished) {
+        if (time.has_value()) {
+            metrics.tailIdleSeconds += std::chrono::duration<double>(end - time.value()).count();
+        }
+    }
+    return metrics;
+}
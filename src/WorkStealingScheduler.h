@@ -0,0 +1,49 @@
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <chrono>
+#include <memory>
+
+#pragma once
+
+// Spreads a fixed set of tasks over per-worker deques. Workers take from the front of their own
+// deque and, once it is empty, steal from the front of the deque with the most remaining cost.
+// Deques are filled most expensive first, so long tasks start early and the cheap ones fill the
+// gaps at the end of the sweep.
+class WorkStealingScheduler {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    class Metrics {
+    public:
+        size_t steals = 0;
+        // From the first worker running dry to the last worker finishing, summed over workers
+        double tailIdleSeconds = 0.0;
+        double makespanSeconds = 0.0;
+    };
+
+    explicit WorkStealingScheduler(size_t workerCount);
+    // Assigns task indexes 0..costs.size()-1 to the workers and starts the clock
+    void assign(const std::vector<double>& costs);
+    // Next task for the worker, nothing once every deque is empty
+    std::optional<size_t> next(size_t worker);
+    // Valid once every worker got nothing from next
+    Metrics metrics() const;
+private:
+    class WorkerQueue {
+    public:
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+        double remainingCost = 0.0;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<double> costs;
+    Clock::time_point started;
+    mutable std::mutex metricsMutex;
+    std::vector<std::optional<Clock::time_point>> finished;
+    size_t steals;
+
+    std::optional<size_t> popFront(WorkerQueue& queue);
+};
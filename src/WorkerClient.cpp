@@ -0,0 +1,172 @@
+#include "WorkerClient.h"
+#include <iostream>
+#include <thread>
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include "FileHash.h"
+#include "JobPlanner.h"
+#include "SweepSpec.h"
+#include "TaskExecutor.h"
+#include "TaskResultJson.h"
+#include "TimeUtils.h"
+
+WorkerClient::WorkerClient(const std::string& host, int port, const std::string& name, const std::string& pathToBacktester, const std::string& backtesterId,
+    const std::shared_ptr<SharedData>& sharedData) {
+    this->sharedData = sharedData;
+    this->host = host;
+    this->port = port;
+    this->name = name;
+    this->pathToBacktester = pathToBacktester;
+    this->backtesterId = backtesterId;
+}
+
+bool WorkerClient::send(SocketChannel& channel, const nlohmann::json& message) {
+    std::lock_guard<std::mutex> lock(sendMutex);
+    return channel.sendLine(message.dump());
+}
+
+bool WorkerClient::verifyData(const nlohmann::json& data, std::string& message) {
+    for (const auto& file : data) {
+        std::string path = file.value("path", "");
+        std::error_code error;
+        bool exists = std::filesystem::exists(path, error);
+        if (file["hash"].is_null()) {
+            if (exists) {
+                message = "history file missing on coordinator: " + path;
+                return false;
+            }
+            continue;
+        }
+        if (!exists) {
+            message = "history file missing: " + path;
+            return false;
+        }
+        uintmax_t size = std::filesystem::file_size(path, error);
+        long long modified = static_cast<long long>(std::filesystem::last_write_time(path, error).time_since_epoch().count());
+        auto cached = hashes.find(path);
+        if (cached == hashes.end() || cached->second.size != size || cached->second.modified != modified) {
+            auto hash = FileHash::compute(path);
+            if (!hash.has_value()) {
+                message = "history file unreadable: " + path;
+                return false;
+            }
+            cached = hashes.insert_or_assign(path, CachedHash{ size, modified, hash.value() }).first;
+        }
+        if (cached->second.hash != file["hash"].get<std::string>()) {
+            message = "history file differs from coordinator: " + path;
+            return false;
+        }
+    }
+    return true;
+}
+
+int WorkerClient::run() {
+    int fd = SocketChannel::connectTcp(host, port);
+    if (fd < 0) {
+        std::cerr << "Error: Failed to connect to coordinator at " << host << ":" << port << std::endl;
+        return 1;
+    }
+    SocketChannel channel(fd);
+    send(channel, { { "command", "hello" }, { "worker", name } });
+    auto welcomeLine = channel.readLine();
+    nlohmann::json welcome = welcomeLine.has_value() ? nlohmann::json::parse(welcomeLine.value(), nullptr, false) : nlohmann::json();
+    if (!welcome.is_object() || welcome.value("event", "") != "welcome") {
+        std::cerr << "Error: Coordinator did not accept worker " << name << std::endl;
+        return 1;
+    }
+
+    // The sweep is planned again from the shared history, jobs are referenced by index
+    std::call_once(sharedData->created, [this, &welcome]() {
+        sharedData->ratesStorageProvider = std::make_unique<RatesStorageProvider>(welcome.value("historyPath", ""));
+        sharedData->ratesStorageProvider->setSessionOffset(welcome.value("sessionStartMinutes", 0LL) * 60);
+        if (welcome.contains("barStore") && welcome["barStore"].is_string()) {
+            sharedData->ratesStorageProvider->setBarStore(welcome["barStore"].get<std::string>());
+        }
+        sharedData->preparedData = std::make_unique<PreparedDataCache>(*sharedData->ratesStorageProvider);
+    });
+    RatesStorageProvider& ratesStorageProvider = *sharedData->ratesStorageProvider;
+    SweepSpec spec;
+    try {
+        spec = SweepSpecParser::parse(welcome["sweep"].dump());
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    JobPlanner planner(ratesStorageProvider);
+    auto plannedJobs = planner.planSweep(spec);
+    if (!plannedJobs.has_value()) {
+        std::cerr << "Error: Worker " << name << " failed to plan the sweep" << std::endl;
+        return 1;
+    }
+    std::vector<std::shared_ptr<const BacktestJob>> jobs;
+    for (const auto& job : plannedJobs.value()) {
+        jobs.push_back(std::make_shared<const BacktestJob>(job));
+    }
+
+    std::mutex heartbeatMutex;
+    std::condition_variable heartbeatCondition;
+    bool done = false;
+    std::chrono::seconds heartbeatInterval(welcome.value("heartbeatSeconds", 10));
+    std::thread heartbeat([&]() {
+        std::unique_lock<std::mutex> lock(heartbeatMutex);
+        while (!heartbeatCondition.wait_for(lock, heartbeatInterval, [&done]() { return done; })) {
+            send(channel, { { "command", "heartbeat" } });
+        }
+    });
+
+    TaskExecutor executor(*sharedData->preparedData);
+    ConsoleBacktester backtester(pathToBacktester, backtesterId);
+    int exitCode = 1;
+    size_t executed = 0;
+    while (send(channel, { { "command", "lease" } })) {
+        auto line = channel.readLine();
+        if (!line.has_value()) {
+            std::cerr << "Error: Lost connection to coordinator" << std::endl;
+            break;
+        }
+        nlohmann::json reply = nlohmann::json::parse(line.value(), nullptr, false);
+        std::string event = reply.is_object() ? reply.value("event", "") : "";
+        if (event == "finished") {
+            exitCode = 0;
+            break;
+        }
+        if (event != "lease") {
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+            continue;
+        }
+        size_t leaseId = reply.value("lease", static_cast<size_t>(0));
+        for (const auto& description : reply["tasks"]) {
+            size_t jobIndex = description.value("job", static_cast<size_t>(0));
+            TaskResult result;
+            auto date = TimeUtils::fromFields(description.value("date", std::vector<int>()));
+            if (jobIndex >= jobs.size()) {
+                result.message = "unknown job " + std::to_string(jobIndex);
+            } else if (!date.has_value()) {
+                result.message = "task without a date";
+            } else if (verifyData(description["data"], result.message)) {
+                BacktestTask task;
+                task.job = jobs[jobIndex];
+                task.window.startTime = description.value("start", 0LL);
+                task.window.endTime = description.value("end", 0LL);
+                task.window.start = date.value();
+                result = executor.execute(task, backtester);
+                executed++;
+            }
+            nlohmann::json message = TaskResultJson::serialize(result);
+            message["command"] = "result";
+            message["lease"] = leaseId;
+            message["task"] = description.value("task", static_cast<size_t>(0));
+            send(channel, message);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(heartbeatMutex);
+        done = true;
+    }
+    heartbeatCondition.notify_all();
+    heartbeat.join();
+    std::cout << "Worker " << name << " executed " << executed << " backtests" << std::endl;
+    return exitCode;
+}
@@ -0,0 +1,50 @@
+#include <string>
+#include <map>
+#include <mutex>
+#include <cstdint>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include "SocketChannel.h"
+#include "RatesStorageProvider.h"
+#include "PreparedDataCache.h"
+
+#pragma once
+
+// Remote side of the Coordinator protocol: pulls leased tasks, runs them with the local
+// backtester and streams the results back while heartbeats keep the lease alive
+class WorkerClient {
+public:
+    // History access shared by the workers of one process, created from the first welcome.
+    // Prepared files are shared as well, the same week file must not be written twice at once.
+    class SharedData {
+    public:
+        std::once_flag created;
+        std::unique_ptr<RatesStorageProvider> ratesStorageProvider;
+        std::unique_ptr<PreparedDataCache> preparedData;
+    };
+private:
+    std::string host;
+    int port;
+    std::string name;
+    std::string pathToBacktester;
+    std::string backtesterId;
+    std::shared_ptr<SharedData> sharedData;
+    std::mutex sendMutex;
+
+    class CachedHash {
+    public:
+        uintmax_t size;
+        long long modified;
+        std::string hash;
+    };
+    std::map<std::string, CachedHash> hashes;
+public:
+    WorkerClient(const std::string& host, int port, const std::string& name, const std::string& pathToBacktester, const std::string& backtesterId,
+        const std::shared_ptr<SharedData>& sharedData = std::make_shared<SharedData>());
+    // Works until the coordinator reports the sweep finished, returns the process exit code
+    int run();
+private:
+    bool send(SocketChannel& channel, const nlohmann::json& message);
+    // Checks that this node sees the same history files as the coordinator
+    bool verifyData(const nlohmann::json& data, std::string& message);
+};
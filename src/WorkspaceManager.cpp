@@ -0,0 +1,144 @@
+#include "WorkspaceManager.h"
+#include <filesystem>
+#include <iostream>
+#include <cstdlib>
+#include "ProcessRunner.h"
+
+WorkspaceManager::WorkspaceManager(const std::string& diskRoot) : diskRoot(diskRoot) {
+    cleaner = std::thread([this]() { cleanLoop(); });
+}
+
+WorkspaceManager::~WorkspaceManager() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    pendingChanged.notify_all();
+    cleaner.join();
+}
+
+WorkspaceManager& WorkspaceManager::shared() {
+    static WorkspaceManager instance((std::filesystem::temp_directory_path() / "fxts2_backtester").string());
+    return instance;
+}
+
+void WorkspaceManager::configure(const std::string& memoryRoot, uintmax_t memoryBudgetBytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->memoryRoot = memoryRoot.empty() ? "" : (std::filesystem::path(memoryRoot) / "fxts2_backtester").string();
+    memoryBudget = memoryBudgetBytes;
+}
+
+std::string WorkspaceManager::ownerPrefix() {
+    return "ws_" + std::to_string(ProcessRunner::currentProcessId()) + "_";
+}
+
+std::string WorkspaceManager::create(const std::string& name, uintmax_t expectedBytes) {
+    std::unique_lock<std::mutex> lock(mutex);
+    std::string directoryName = ownerPrefix() + std::to_string(++counter) + "_" + name;
+    if (!memoryRoot.empty() && memoryReserved + expectedBytes <= memoryBudget) {
+        std::error_code error;
+        std::filesystem::path path = std::filesystem::path(memoryRoot) / directoryName;
+        if (std::filesystem::create_directories(path, error)) {
+            memoryReserved += expectedBytes;
+            reservations[path.string()] = expectedBytes;
+            return path.string();
+        }
+        // e.g. no /dev/shm on this host, the disk still works
+    }
+    std::filesystem::path path = std::filesystem::path(diskRoot) / directoryName;
+    lock.unlock();
+    std::filesystem::create_directories(path);
+    return path.string();
+}
+
+void WorkspaceManager::release(const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto reservation = reservations.find(path);
+        if (reservation != reservations.end()) {
+            memoryReserved -= reservation->second;
+            reservations.erase(reservation);
+        }
+        pending.push_back(path);
+    }
+    pendingChanged.notify_all();
+}
+
+void WorkspaceManager::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    pendingChanged.wait(lock, [&]() { return pending.empty() && removing == 0; });
+}
+
+void WorkspaceManager::cleanLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        pendingChanged.wait(lock, [&]() { return stopping || !pending.empty(); });
+        if (pending.empty()) {
+            return;
+        }
+        // Remove everything queued so far in one go, without holding the lock
+        std::vector<std::string> batch;
+        batch.swap(pending);
+        removing = batch.size();
+        lock.unlock();
+        for (const auto& path : batch) {
+            std::error_code error;
+            std::filesystem::remove_all(path, error);
+            if (error) {
+                std::cerr << "Warning: Failed to remove workspace " << path << ": " << error.message() << std::endl;
+            }
+        }
+        lock.lock();
+        removing = 0;
+        pendingChanged.notify_all();
+    }
+}
+
+size_t WorkspaceManager::removeOrphans() {
+    std::vector<std::string> roots;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        roots.push_back(diskRoot);
+        if (!memoryRoot.empty()) {
+            roots.push_back(memoryRoot);
+        }
+    }
+    size_t removed = 0;
+    for (const auto& root : roots) {
+        std::error_code error;
+        std::filesystem::directory_iterator entries(root, error);
+        if (error) {
+            continue;
+        }
+        for (const auto& entry : entries) {
+            // ws_<pid>_<counter>_<name>
+            std::string name = entry.path().filename().string();
+            if (!entry.is_directory(error) || name.rfind("ws_", 0) != 0) {
+                continue;
+            }
+            size_t end = name.find('_', 3);
+            if (end == std::string::npos) {
+                continue;
+            }
+            long owner = std::atol(name.substr(3, end - 3).c_str());
+            if (owner <= 0 || owner == ProcessRunner::currentProcessId() || ProcessRunner::isProcessAlive(owner)) {
+                continue;
+            }
+            std::filesystem::remove_all(entry.path(), error);
+            if (!error) {
+                removed++;
+            }
+        }
+    }
+    return removed;
+}
+
+uintmax_t WorkspaceManager::memoryInUse() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return memoryReserved;
+}
+
+bool WorkspaceManager::isInMemory(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return reservations.count(path) > 0;
+}
@@ -0,0 +1,51 @@
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstdint>
+
+#pragma once
+
+// Hands out scratch directories for prepared price files and backtester runs. They are placed on a
+// RAM-backed file system (e.g. /dev/shm) while the reserved sizes fit in the memory budget and in
+// the temp directory otherwise. Released workspaces are removed in batches on a background thread.
+class WorkspaceManager {
+public:
+    WorkspaceManager(const std::string& diskRoot);
+    ~WorkspaceManager();
+    // Process-wide instance under temp/fxts2_backtester, without a memory root until configured
+    static WorkspaceManager& shared();
+    // An empty memoryRoot keeps every workspace on disk
+    void configure(const std::string& memoryRoot, uintmax_t memoryBudgetBytes);
+    // Creates a new workspace directory expected to hold up to expectedBytes
+    std::string create(const std::string& name, uintmax_t expectedBytes);
+    // Queues the workspace for removal and returns its reservation to the budget
+    void release(const std::string& path);
+    // Blocks until every released workspace is removed
+    void flush();
+    // Removes workspaces of processes that are not running anymore, returns how many
+    size_t removeOrphans();
+    // Bytes reserved by workspaces in memory
+    uintmax_t memoryInUse();
+    bool isInMemory(const std::string& path);
+private:
+    std::string diskRoot;
+    std::string memoryRoot;
+    uintmax_t memoryBudget = 0;
+    uintmax_t memoryReserved = 0;
+    // Memory reservation per workspace path, disk workspaces are not listed
+    std::map<std::string, uintmax_t> reservations;
+    unsigned long long counter = 0;
+
+    std::mutex mutex;
+    std::condition_variable pendingChanged;
+    std::vector<std::string> pending;
+    size_t removing = 0;
+    bool stopping = false;
+    std::thread cleaner;
+
+    void cleanLoop();
+    static std::string ownerPrefix();
+};
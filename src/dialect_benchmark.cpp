@@ -0,0 +1,122 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include "StorageReader.h"
+
+struct BenchmarkConfig {
+    size_t lines = 1000000;
+    int repeat = 3;
+    bool helpRequested = false;
+};
+
+void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " [OPTIONS]" << std::endl;
+    std::cout << "Measures the parsing throughput of every history dialect on generated in-memory files." << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --lines N     Lines per generated file (default: 1000000)" << std::endl;
+    std::cout << "  --repeat N    Passes per dialect, the fastest is reported (default: 3)" << std::endl;
+    std::cout << "  --help        Show this help message" << std::endl;
+}
+
+BenchmarkConfig parseArguments(int argc, char* argv[]) {
+    BenchmarkConfig config;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            config.helpRequested = true;
+        }
+        else if (arg == "--lines" && i + 1 < argc) {
+            config.lines = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        }
+        else if (arg == "--repeat" && i + 1 < argc) {
+            config.repeat = std::max(1, std::atoi(argv[++i]));
+        }
+        else {
+            std::cerr << "Warning: Unknown argument: " << arg << std::endl;
+        }
+    }
+    return config;
+}
+
+template <class Dialect>
+std::string formatPrice(double value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.5f", value);
+    std::string text = buffer;
+    if constexpr (Dialect::decimal != '.') {
+        std::replace(text.begin(), text.end(), '.', Dialect::decimal);
+    }
+    return text;
+}
+
+// A week of minutes, repeated until lines are generated
+template <class Dialect>
+std::string generate(size_t lines) {
+    std::string text;
+    const char separator[2] = { Dialect::separator, 0 };
+    for (size_t i = 0; i < lines; i++) {
+        int minute = static_cast<int>(i % (7 * 24 * 60));
+        char timestamp[32];
+        if constexpr (Dialect::timestampFormat == TimestampFormat::Iso) {
+            std::snprintf(timestamp, sizeof(timestamp), "2024-01-%02dT%02d:%02d:00", 1 + minute / 1440, minute / 60 % 24, minute % 60);
+        } else {
+            std::snprintf(timestamp, sizeof(timestamp), "%02d.01.2024 %02d:%02d:00", 1 + minute / 1440, minute / 60 % 24, minute % 60);
+        }
+        double bid = 1.1 + 0.0001 * static_cast<double>(i % 97);
+        double ask = bid + 0.00015;
+        text += timestamp;
+        if constexpr (Dialect::layout == HistoryLayout::Tick) {
+            text += separator + formatPrice<Dialect>(bid) + separator + formatPrice<Dialect>(ask);
+        } else {
+            text += separator + formatPrice<Dialect>(bid) + separator + formatPrice<Dialect>(bid + 0.0002)
+                + separator + formatPrice<Dialect>(bid - 0.0002) + separator + formatPrice<Dialect>(bid + 0.0001);
+            if constexpr (Dialect::layout == HistoryLayout::BidAsk) {
+                text += separator + formatPrice<Dialect>(ask) + separator + formatPrice<Dialect>(ask + 0.0002)
+                    + separator + formatPrice<Dialect>(ask - 0.0002) + separator + formatPrice<Dialect>(ask + 0.0001);
+            }
+        }
+        text += separator + std::to_string(10 + i % 50) + "\n";
+    }
+    return text;
+}
+
+template <class Dialect>
+void run(HistoryFormat format, const BenchmarkConfig& config) {
+    std::string text = generate<Dialect>(config.lines);
+    double best = 0;
+    size_t bars = 0;
+    double checksum = 0;
+    for (int pass = 0; pass < config.repeat; pass++) {
+        std::istringstream input(text);
+        StorageReadErrors errors;
+        Data data;
+        bars = 0;
+        checksum = 0;
+        auto started = std::chrono::steady_clock::now();
+        while (StorageReader::readNext<Dialect>(input, data, errors)) {
+            bars++;
+            checksum += data.bid.close;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        best = pass == 0 ? seconds : std::min(best, seconds);
+    }
+    double megabytes = static_cast<double>(text.size()) / (1024.0 * 1024.0);
+    std::printf("%-11s %10zu bars %8.3f s %12.0f lines/s %8.1f MB/s  checksum %.2f\n", HistoryFormats::name(format), bars, best,
+        static_cast<double>(bars) / best, megabytes / best, checksum);
+}
+
+int main(int argc, char* argv[]) {
+    BenchmarkConfig config = parseArguments(argc, argv);
+    if (config.helpRequested) {
+        printUsage(argv[0]);
+        return 0;
+    }
+    for (HistoryFormat format : { HistoryFormat::Standard, HistoryFormat::DotDecimal, HistoryFormat::Iso, HistoryFormat::BidOnly, HistoryFormat::Tick }) {
+        HistoryFormats::visit(format, [&](auto dialect) { run<decltype(dialect)>(format, config); });
+    }
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <cstdlib>
+#include "HistoryCompressor.h"
+
+struct CompressConfig {
+    std::string historyPath;
+    // The history itself when empty, compressed weeks are written next to the raw ones
+    std::string outputPath;
+    HistoryCompressor::Settings settings;
+    bool helpRequested = false;
+};
+
+void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " --history_path PATH [OPTIONS]" << std::endl;
+    std::cout << "Compresses every week file of the history into a .fxb file, which is read in its place" << std::endl;
+    std::cout << "when the .csv file is absent." << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --history_path PATH    Path to history" << std::endl;
+    std::cout << "  --output PATH          Tree to write the compressed weeks to (default: the history)" << std::endl;
+    std::cout << "  --threads N            Files compressed in parallel (default: CPU count)" << std::endl;
+    std::cout << "  --io BACKEND           File reads: auto, io_uring or pread (default: auto)" << std::endl;
+    std::cout << "  --queue_depth N        Reads kept in flight (default: 32)" << std::endl;
+    std::cout << "  --verify               Decode each written file and compare it with the source bars" << std::endl;
+    std::cout << "  --help                 Show this help message" << std::endl;
+}
+
+CompressConfig parseArguments(int argc, char* argv[]) {
+    CompressConfig config;
+    config.settings.threads = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            config.helpRequested = true;
+        }
+        else if (arg == "--history_path" && i + 1 < argc) {
+            config.historyPath = argv[++i];
+        }
+        else if (arg == "--output" && i + 1 < argc) {
+            config.outputPath = argv[++i];
+        }
+        else if (arg == "--threads" && i + 1 < argc) {
+            config.settings.threads = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        }
+        else if (arg == "--io" && i + 1 < argc) {
+            std::string name = argv[++i];
+            auto backend = BulkReader::parse(name);
+            if (backend.has_value()) {
+                config.settings.io = backend.value();
+            } else {
+                std::cerr << "Warning: Unknown I/O backend: " << name << std::endl;
+            }
+        }
+        else if (arg == "--queue_depth" && i + 1 < argc) {
+            config.settings.queueDepth = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        }
+        else if (arg == "--verify") {
+            config.settings.verify = true;
+        }
+        else {
+            std::cerr << "Warning: Unknown argument: " << arg << std::endl;
+        }
+    }
+    return config;
+}
+
+int main(int argc, char* argv[]) {
+    CompressConfig config = parseArguments(argc, argv);
+    if (config.helpRequested) {
+        printUsage(argv[0]);
+        return 0;
+    }
+    if (config.historyPath.empty()) {
+        std::cerr << "Error: --history_path is required" << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    auto started = std::chrono::steady_clock::now();
+    HistoryCompressor compressor(config.settings);
+    CompressReport report = compressor.compress(config.historyPath, config.outputPath.empty() ? config.historyPath : config.outputPath);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    double ratio = report.outputBytes > 0 ? static_cast<double>(report.inputBytes) / report.outputBytes : 0.0;
+    std::cout << "Compressed " << report.files << " files, " << report.bars << " bars, " << report.inputBytes << " -> "
+              << report.outputBytes << " bytes (" << ratio << "x) in " << seconds << " s" << std::endl;
+    if (config.settings.verify && report.decodeSeconds > 0) {
+        // Decoded size as BarColumns holds it
+        double megabytes = static_cast<double>(report.bars) * (sizeof(long long) + 8 * sizeof(double) + sizeof(int)) / (1024.0 * 1024.0);
+        std::cout << "Verified, decoding at " << megabytes / report.decodeSeconds << " MB/s per thread" << std::endl;
+    }
+    if (report.malformedLines > 0) {
+        std::cout << report.malformedLines << " malformed lines skipped" << std::endl;
+    }
+    for (const auto& file : report.failedFiles) {
+        std::cerr << "Error: Failed to compress " << file << std::endl;
+    }
+    return report.failedFiles.empty() ? 0 : 1;
+}
@@ -0,0 +1,102 @@
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <cstdlib>
+#include "HistoryIngestor.h"
+#include "IndicatorCache.h"
+
+struct IngestConfig {
+    std::string historyPath;
+    std::string storePath;
+    // Series of changed symbols are removed from it
+    std::string indicatorCache;
+    size_t threads = 1;
+    bool rebuild = false;
+    bool helpRequested = false;
+};
+
+void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " --history_path PATH --store PATH [OPTIONS]" << std::endl;
+    std::cout << "Brings the per-symbol bar stores up to date with the history, parsing only new files" << std::endl;
+    std::cout << "and lines appended to known ones since the last run." << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --history_path PATH      Path to history" << std::endl;
+    std::cout << "  --store PATH             Directory of the bar stores and their manifest" << std::endl;
+    std::cout << "  --indicator_cache DIR    Remove cached indicator series of symbols whose history changed" << std::endl;
+    std::cout << "  --threads N              Symbols updated in parallel (default: CPU count)" << std::endl;
+    std::cout << "  --rebuild                Ignore the manifest and read every file again" << std::endl;
+    std::cout << "  --help                   Show this help message" << std::endl;
+}
+
+IngestConfig parseArguments(int argc, char* argv[]) {
+    IngestConfig config;
+    config.threads = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            config.helpRequested = true;
+        }
+        else if (arg == "--history_path" && i + 1 < argc) {
+            config.historyPath = argv[++i];
+        }
+        else if (arg == "--store" && i + 1 < argc) {
+            config.storePath = argv[++i];
+        }
+        else if (arg == "--indicator_cache" && i + 1 < argc) {
+            config.indicatorCache = argv[++i];
+        }
+        else if (arg == "--threads" && i + 1 < argc) {
+            config.threads = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        }
+        else if (arg == "--rebuild") {
+            config.rebuild = true;
+        }
+        else {
+            std::cerr << "Warning: Unknown argument: " << arg << std::endl;
+        }
+    }
+    return config;
+}
+
+int main(int argc, char* argv[]) {
+    IngestConfig config = parseArguments(argc, argv);
+    if (config.helpRequested) {
+        printUsage(argv[0]);
+        return 0;
+    }
+    if (config.historyPath.empty() || config.storePath.empty()) {
+        std::cerr << "Error: --history_path and --store are required" << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    auto started = std::chrono::steady_clock::now();
+    HistoryIngestor ingestor(config.historyPath, config.storePath, config.threads);
+    std::optional<IngestReport> report = ingestor.ingest(config.rebuild);
+    if (!report.has_value()) {
+        return 1;
+    }
+    size_t removedSeries = 0;
+    if (!config.indicatorCache.empty()) {
+        for (const auto& symbol : report.value().changedSymbols) {
+            removedSeries += IndicatorCache::removeSymbol(config.indicatorCache, symbol);
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    const IngestReport& result = report.value();
+    std::cout << "Ingested " << result.newFiles << " new and " << result.grownFiles << " grown files, "
+              << result.unchangedFiles << " unchanged, " << result.parsedBytes << " bytes parsed, "
+              << result.appendedBars << " bars appended in " << seconds << " s" << std::endl;
+    std::cout << result.changedSymbols.size() << " symbols changed, " << result.rebuiltSymbols << " rebuilt";
+    if (result.malformedLines > 0) {
+        std::cout << ", " << result.malformedLines << " malformed lines skipped";
+    }
+    if (!config.indicatorCache.empty()) {
+        std::cout << ", " << removedSeries << " cached indicator series removed";
+    }
+    std::cout << std::endl;
+    return 0;
+}
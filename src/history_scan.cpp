@@ -0,0 +1,143 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <cstdlib>
+#include "HistoryScanner.h"
+
+struct ScanConfig {
+    std::string historyPath;
+    // JSON lines, one report per file; stdout when empty
+    std::string reportPath;
+    bool quarantine = false;
+    bool issuesOnly = false;
+    HistoryScanner::Settings settings;
+    bool helpRequested = false;
+};
+
+void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " --history_path PATH [OPTIONS]" << std::endl;
+    std::cout << "Checks every week file of the history for malformed lines, crossed quotes, inverted bars," << std::endl;
+    std::cout << "zero prices, timestamp regressions, duplicate minutes, gaps and spikes." << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --history_path PATH    Path to history" << std::endl;
+    std::cout << "  --report FILE          Write the per-file reports as JSON lines (default: stdout)" << std::endl;
+    std::cout << "  --issues_only          Report only files with issues" << std::endl;
+    std::cout << "  --quarantine           Write PATH/quarantine.txt, weeks listed there are not backtested" << std::endl;
+    std::cout << "  --threads N            Files scanned in parallel (default: CPU count)" << std::endl;
+    std::cout << "  --io BACKEND           File reads: auto, io_uring or pread (default: auto)" << std::endl;
+    std::cout << "  --queue_depth N        Reads kept in flight (default: 32)" << std::endl;
+    std::cout << "  --max_gap_minutes N    Longest gap between bars not reported (default: 30)" << std::endl;
+    std::cout << "  --spike_percent X      Largest one-bar move of the mid close not reported (default: 2)" << std::endl;
+    std::cout << "  --help                 Show this help message" << std::endl;
+}
+
+ScanConfig parseArguments(int argc, char* argv[]) {
+    ScanConfig config;
+    config.settings.threads = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            config.helpRequested = true;
+        }
+        else if (arg == "--history_path" && i + 1 < argc) {
+            config.historyPath = argv[++i];
+        }
+        else if (arg == "--report" && i + 1 < argc) {
+            config.reportPath = argv[++i];
+        }
+        else if (arg == "--issues_only") {
+            config.issuesOnly = true;
+        }
+        else if (arg == "--quarantine") {
+            config.quarantine = true;
+        }
+        else if (arg == "--threads" && i + 1 < argc) {
+            config.settings.threads = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        }
+        else if (arg == "--io" && i + 1 < argc) {
+            std::string name = argv[++i];
+            auto backend = BulkReader::parse(name);
+            if (backend.has_value()) {
+                config.settings.io = backend.value();
+            } else {
+                std::cerr << "Warning: Unknown I/O backend: " << name << std::endl;
+            }
+        }
+        else if (arg == "--queue_depth" && i + 1 < argc) {
+            config.settings.queueDepth = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        }
+        else if (arg == "--max_gap_minutes" && i + 1 < argc) {
+            config.settings.maxGapSeconds = std::atoll(argv[++i]) * 60;
+        }
+        else if (arg == "--spike_percent" && i + 1 < argc) {
+            config.settings.spikeFraction = std::atof(argv[++i]) / 100.0;
+        }
+        else {
+            std::cerr << "Warning: Unknown argument: " << arg << std::endl;
+        }
+    }
+    return config;
+}
+
+int main(int argc, char* argv[]) {
+    ScanConfig config = parseArguments(argc, argv);
+    if (config.helpRequested) {
+        printUsage(argv[0]);
+        return 0;
+    }
+    if (config.historyPath.empty() || config.settings.maxGapSeconds <= 0 || config.settings.spikeFraction <= 0) {
+        std::cerr << "Error: --history_path is required, --max_gap_minutes and --spike_percent must be positive" << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    auto started = std::chrono::steady_clock::now();
+    HistoryScanner scanner(config.settings);
+    std::vector<HistoryFileReport> reports = scanner.scan(config.historyPath);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    std::ofstream reportFile;
+    if (!config.reportPath.empty()) {
+        reportFile.open(config.reportPath, std::ios::trunc);
+        if (!reportFile.is_open()) {
+            std::cerr << "Error: Cannot write report: " << config.reportPath << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& output = config.reportPath.empty() ? std::cout : reportFile;
+    // The summary goes next to the reports only when they are not on stdout
+    std::ostream& summary = config.reportPath.empty() ? std::cerr : std::cout;
+
+    size_t bars = 0;
+    size_t withIssues = 0;
+    size_t toQuarantine = 0;
+    size_t unreadable = 0;
+    for (const auto& report : reports) {
+        bars += report.bars;
+        unreadable += report.readFailed ? 1 : 0;
+        withIssues += report.hasIssues() ? 1 : 0;
+        toQuarantine += report.shouldQuarantine() ? 1 : 0;
+        if (!config.issuesOnly || report.hasIssues()) {
+            output << report.toJson().dump() << "\n";
+        }
+    }
+    output.flush();
+
+    summary << "Scanned " << reports.size() << " files, " << bars << " bars in " << seconds << " s: "
+            << withIssues << " with issues, " << toQuarantine << " to quarantine" << std::endl;
+    if (unreadable > 0) {
+        std::cerr << "Error: " << unreadable << " files could not be read" << std::endl;
+    }
+    if (config.quarantine) {
+        auto written = HistoryScanner::writeQuarantine(config.historyPath, reports);
+        if (!written.has_value()) {
+            std::cerr << "Error: Cannot write the quarantine list to " << config.historyPath << std::endl;
+            return 1;
+        }
+        summary << "Quarantined " << written.value() << " files" << std::endl;
+    }
+    return unreadable == 0 ? 0 : 1;
+}
@@ -0,0 +1,204 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <filesystem>
+#include "BulkReader.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+struct WarmConfig {
+    std::string historyPath;
+    BulkReader::Settings settings;
+    bool benchmark = false;
+    bool helpRequested = false;
+};
+
+void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " --history_path PATH [OPTIONS]" << std::endl;
+    std::cout << "Reads every week file of the history once, so that the backtests that follow find it in the" << std::endl;
+    std::cout << "page cache. With --benchmark the I/O backends are compared on a cold cache instead." << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --history_path PATH    Path to history" << std::endl;
+    std::cout << "  --io BACKEND           File reads: auto, io_uring or pread (default: auto)" << std::endl;
+    std::cout << "  --queue_depth N        Reads kept in flight (default: 32)" << std::endl;
+    std::cout << "  --block_kb N           Length of each read in KB (default: 1024)" << std::endl;
+    std::cout << "  --benchmark            Drop the files from the page cache before each backend and time it" << std::endl;
+    std::cout << "  --help                 Show this help message" << std::endl;
+}
+
+WarmConfig parseArguments(int argc, char* argv[]) {
+    WarmConfig config;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            config.helpRequested = true;
+        }
+        else if (arg == "--history_path" && i + 1 < argc) {
+            config.historyPath = argv[++i];
+        }
+        else if (arg == "--io" && i + 1 < argc) {
+            std::string name = argv[++i];
+            auto backend = BulkReader::parse(name);
+            if (backend.has_value()) {
+                config.settings.backend = backend.value();
+            } else {
+                std::cerr << "Warning: Unknown I/O backend: " << name << std::endl;
+            }
+        }
+        else if (arg == "--queue_depth" && i + 1 < argc) {
+            config.settings.queueDepth = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        }
+        else if (arg == "--block_kb" && i + 1 < argc) {
+            config.settings.blockBytes = static_cast<size_t>(std::max(4, std::atoi(argv[++i]))) * 1024;
+        }
+        else if (arg == "--benchmark") {
+            config.benchmark = true;
+        }
+        else {
+            std::cerr << "Warning: Unknown argument: " << arg << std::endl;
+        }
+    }
+    return config;
+}
+
+// Raw and compressed week files of every symbol
+std::vector<std::string> listHistoryFiles(const std::string& historyPath) {
+    std::vector<std::string> paths;
+    std::error_code error;
+    for (const auto& directory : std::filesystem::directory_iterator(historyPath, error)) {
+        if (!directory.is_directory()) {
+            continue;
+        }
+        for (const auto& entry : std::filesystem::directory_iterator(directory.path(), error)) {
+            auto extension = entry.path().extension();
+            if (entry.is_regular_file() && (extension == ".csv" || extension == ".fxb")) {
+                paths.push_back(entry.path().string());
+            }
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+// Asks the kernel to drop the cached pages of the files; false where that is not possible
+bool evict(const std::vector<std::string>& paths) {
+#if defined(_WIN32) || !defined(POSIX_FADV_DONTNEED)
+    (void)paths;
+    return false;
+#else
+    bool evicted = true;
+    for (const auto& path : paths) {
+        int descriptor = open(path.c_str(), O_RDONLY);
+        if (descriptor < 0 || posix_fadvise(descriptor, 0, 0, POSIX_FADV_DONTNEED) != 0) {
+            evicted = false;
+        }
+        if (descriptor >= 0) {
+            close(descriptor);
+        }
+    }
+    return evicted;
+#endif
+}
+
+class ReadResult {
+public:
+    size_t bytes = 0;
+    size_t failed = 0;
+    double seconds = 0;
+};
+
+ReadResult readBulk(const std::vector<std::string>& paths, const BulkReader::Settings& settings, IoBackend& used) {
+    ReadResult result;
+    std::atomic<size_t> bytes(0);
+    std::atomic<size_t> failed(0);
+    auto started = std::chrono::steady_clock::now();
+    used = BulkReader(settings).read(paths, [&](size_t, const char*, size_t size, bool ok) {
+        bytes += size;
+        failed += ok ? 0 : 1;
+    });
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    result.bytes = bytes;
+    result.failed = failed;
+    return result;
+}
+
+// One file after the other through ifstream, as the tools read before BulkReader
+ReadResult readSequential(const std::vector<std::string>& paths) {
+    ReadResult result;
+    std::vector<char> buffer;
+    auto started = std::chrono::steady_clock::now();
+    for (const auto& path : paths) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) {
+            result.failed++;
+            continue;
+        }
+        buffer.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        result.bytes += static_cast<size_t>(file.gcount());
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    return result;
+}
+
+void printResult(const char* name, size_t files, const ReadResult& result) {
+    double megabytes = static_cast<double>(result.bytes) / (1024.0 * 1024.0);
+    std::printf("%-10s %8zu files %10.1f MB %8.3f s %10.1f MB/s %10.0f files/s", name, files, megabytes, result.seconds,
+        result.seconds > 0 ? megabytes / result.seconds : 0.0, result.seconds > 0 ? files / result.seconds : 0.0);
+    if (result.failed > 0) {
+        std::printf("  %zu failed", result.failed);
+    }
+    std::printf("\n");
+}
+
+int main(int argc, char* argv[]) {
+    WarmConfig config = parseArguments(argc, argv);
+    if (config.helpRequested) {
+        printUsage(argv[0]);
+        return 0;
+    }
+    if (config.historyPath.empty()) {
+        std::cerr << "Error: --history_path is required" << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+    std::vector<std::string> paths = listHistoryFiles(config.historyPath);
+
+    if (!config.benchmark) {
+        IoBackend used;
+        ReadResult result = readBulk(paths, config.settings, used);
+        printResult(BulkReader::name(used), paths.size(), result);
+        return result.failed == 0 ? 0 : 1;
+    }
+
+    bool cold = evict(paths);
+    if (!cold) {
+        std::cerr << "Warning: Files could not be dropped from the page cache, timings are for a warm cache" << std::endl;
+    }
+    printResult("ifstream", paths.size(), readSequential(paths));
+    std::vector<IoBackend> backends = { IoBackend::Pread };
+    if (BulkReader::ioUringAvailable()) {
+        backends.push_back(IoBackend::IoUring);
+    } else {
+        std::cerr << "Warning: io_uring is unavailable, only pread is measured" << std::endl;
+    }
+    for (IoBackend backend : backends) {
+        evict(paths);
+        BulkReader::Settings settings = config.settings;
+        settings.backend = backend;
+        IoBackend used;
+        ReadResult result = readBulk(paths, settings, used);
+        printResult(BulkReader::name(used), paths.size(), result);
+    }
+    return 0;
+}
@@ -7,18 +7,96 @@
 #include <iomanip>
 #include <filesystem>
 #include <algorithm>
+#include <sstream>
+#include <functional>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <random>
+#include <nlohmann/json.hpp>
 #include "BacktestProject.h"
 #include "ConsoleBacktester.h"
 #include "DatesIterator.h"
 #include "SymbolInfoParser.h"
 #include "RatesStorageProvider.h"
+#include "JobPlanner.h"
+#include "PreparedDataCache.h"
+#include "BarResampler.h"
+#include "SweepSpec.h"
+#include "TaskExecutor.h"
+#include "DaemonServer.h"
+#include "DaemonClient.h"
+#include "Coordinator.h"
+#include "WorkerClient.h"
+#include "SharedPlan.h"
+#include "SharedPlanNode.h"
+#include "TaskCostModel.h"
+#include "WorkStealingScheduler.h"
+#include "LocalityScheduler.h"
+#include "StragglerMonitor.h"
+#include "ConcurrencyController.h"
+#include "SystemSampler.h"
+#include "ResourceUsageReport.h"
+#include "TaskResultJson.h"
+#include "WorkspaceManager.h"
+#include "PreScreener.h"
+#include "TimeUtils.h"
 
 struct AppConfig {
     std::string sourcesPath;
     std::string strategyId;
-    std::string tradingSymbol;
+    // Each --trading_symbol occurrence is a separate job, a comma-separated value is one portfolio
+    std::vector<std::vector<std::string>> portfolios;
+    std::string accountCurrency = "USD";
+    bool intersectTimestamps = false;
+    std::string period = "m1";
+    int sessionStartMinutes = 0;
     std::string pathToBacktester;
     std::string historyPath;
+    // Per-symbol bar stores from history_ingest, read instead of the week files of the symbols they hold
+    std::string barStore;
+    // Values to try per strategy parameter, from --param NAME=v1,v2
+    std::vector<std::pair<std::string, std::vector<std::string>>> parameters;
+    std::string daemonSocket;
+    int workers = 0;
+    // Stragglers get a speculative copy after this multiple of their p95 duration, 0 disables it
+    double speculateMultiple = 3.0;
+    // A positive --max_workers lets the concurrency follow the load between the bounds
+    int minWorkers = 1;
+    int maxWorkers = 0;
+    int adaptSeconds = 30;
+    // "locality" keeps the tasks of a week together, "cost" runs long tasks first
+    std::string schedule = "locality";
+    // Tasks in flight span at most this many positions of the locality order, 0 for twice the workers
+    int localityWindow = 0;
+    // tmpfs directory for workspaces, e.g. /dev/shm; disk only when empty
+    std::string ramWorkspace;
+    int ramBudgetMb = 1024;
+    // Strategy family simulated natively to keep only the best --prescreen_top parameter sets, empty to run all
+    std::string prescreen;
+    int prescreenTop = 10;
+    // Most recent planned weeks the pre-screening simulates
+    int prescreenWeeks = 12;
+    // Indicator series of the pre-screening are also written here when set
+    std::string indicatorCache;
+    int indicatorCacheMb = 256;
+    std::string submitSocket;
+    std::string sweepFile;
+    std::string owner;
+    bool detach = false;
+    std::string fetchSocket;
+    size_t submission = 0;
+    int coordinatorPort = -1;
+    size_t shardSize = 16;
+    int leaseSeconds = 60;
+    std::string resultsPath;
+    std::string workerAddress;
+    std::string planDirectory;
+    size_t chunkSize = 64;
+    int claimSeconds = 900;
+    std::string node;
+    std::string aggregateDirectory;
     bool helpRequested = false;
 };
 
@@ -27,13 +105,92 @@ void printUsage(const char* programName) {
     std::cout << "Options:" << std::endl;
     std::cout << "  --sources_path PATH    Path to data sources" << std::endl;
     std::cout << "  --strategy_id ID       Strategy identifier" << std::endl;
-    std::cout << "  --trading_symbol SYMBOL Trading symbol (e.g., EURUSD)" << std::endl;
+    std::cout << "  --trading_symbol SYMBOL Trading symbol (e.g., EURUSD) or comma-separated list for a portfolio" << std::endl;
+    std::cout << "                         Repeat to backtest several symbols or portfolios" << std::endl;
+    std::cout << "  --account_currency CCY Account currency (default: USD)" << std::endl;
     std::cout << "  --path_to_backtester PATH Path to backtester" << std::endl;
     std::cout << "  --history_path PATH    Path to history" << std::endl;
+    std::cout << "  --bar_store PATH       Read symbols from the bar stores written by history_ingest when present" << std::endl;
+    std::cout << "  --intersect_timestamps Keep only bars present for every portfolio symbol" << std::endl;
+    std::cout << "  --period PERIOD        Backtest timeframe: m1, m5, m15, m30, H1, H4 or D1 (default: m1)" << std::endl;
+    std::cout << "  --session_start HH:MM  Trading session start used to align H4 and D1 bars (default: 00:00)" << std::endl;
+    std::cout << "  --param NAME=V1,V2     Strategy parameter values, every combination is a separate job" << std::endl;
+    std::cout << "  --workers N            Backtests run in parallel (default: CPU count)" << std::endl;
+    std::cout << "  --max_workers N        Adapt the backtests run in parallel to CPU, I/O wait, memory and throughput, --workers is the start" << std::endl;
+    std::cout << "  --min_workers N        Lower bound of the adaptive concurrency (default: 1)" << std::endl;
+    std::cout << "  --adapt_seconds N      Seconds between concurrency decisions (default: 30)" << std::endl;
+    std::cout << "  --schedule MODE        locality: run the tasks of a week together (default), cost: longest tasks first" << std::endl;
+    std::cout << "  --locality_window N    Tasks in flight at most N positions apart in locality order (default: twice the workers)" << std::endl;
+    std::cout << "  --ram_workspace PATH   Put prepared data and backtester files on a RAM file system, e.g. /dev/shm" << std::endl;
+    std::cout << "  --ram_budget_mb N      Memory for --ram_workspace, workspaces beyond it go to disk (default: 1024)" << std::endl;
+    std::cout << "  --prescreen FAMILY     Simulate ma_cross (Fast, Slow), breakout (Period) or rsi (Period, Lower, Upper)" << std::endl;
+    std::cout << "                         on bar closes and backtest only the best parameter sets" << std::endl;
+    std::cout << "  --prescreen_top N      Parameter sets kept per portfolio by --prescreen (default: 10)" << std::endl;
+    std::cout << "  --prescreen_weeks N    Most recent planned weeks simulated by --prescreen (default: 12)" << std::endl;
+    std::cout << "  --indicator_cache DIR  Keep the pre-screening indicator series as memory-mappable files for later runs" << std::endl;
+    std::cout << "  --indicator_cache_mb N Memory for indicator series, least recently used dropped beyond it (default: 256)" << std::endl;
+    std::cout << "  --speculate_multiple X Re-run a backtest on an idle worker once it exceeds X times the p95 duration (default: 3, 0 disables)" << std::endl;
     std::cout << "  --help                 Show this help message" << std::endl;
     std::cout << std::endl;
+    std::cout << "Daemon mode (not available on Windows):" << std::endl;
+    std::cout << "  --daemon SOCKET        Serve submissions on a Unix socket with warm caches" << std::endl;
+    std::cout << "  --submit SOCKET        Submit a sweep to a running daemon and stream its results" << std::endl;
+    std::cout << "  --sweep FILE           Sweep specification (JSON), defaults to the options above" << std::endl;
+    std::cout << "  --owner NAME           Owner used for fair sharing between submissions (default: $USER)" << std::endl;
+    std::cout << "  --detach               Return once the daemon accepted the submission" << std::endl;
+    std::cout << "  --fetch_results SOCKET Print the results of --submission ID collected so far" << std::endl;
+    std::cout << "  --submission ID        Submission to fetch results for" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Distributed mode (--coordinator and --worker are not available on Windows):" << std::endl;
+    std::cout << "  --coordinator PORT     Hand the sweep out to workers connecting on the TCP port" << std::endl;
+    std::cout << "  --shard_size N         Tasks leased to a worker at once (default: 16)" << std::endl;
+    std::cout << "  --lease_seconds N      Lease lifetime without heartbeats before tasks are reassigned (default: 60)" << std::endl;
+    std::cout << "  --results FILE         Write results of the coordinator as JSON lines (default: stdout)" << std::endl;
+    std::cout << "  --worker HOST:PORT     Run --workers backtesters for a coordinator, history is read from shared storage" << std::endl;
+    std::cout << "  --plan_dir DIR         Claim work from a job-plan directory on a shared filesystem, created on first use" << std::endl;
+    std::cout << "  --chunk_size N         Tasks per claim in the plan directory (default: 64)" << std::endl;
+    std::cout << "  --claim_seconds N      Claim lifetime before a crashed node's chunk is reclaimed (default: 900)" << std::endl;
+    std::cout << "  --node NAME            Node name used for claims and the result shard (default: host and process id)" << std::endl;
+    std::cout << "  --aggregate DIR        Merge the result shards of a plan directory into --results (default: DIR/results.jsonl)" << std::endl;
+    std::cout << std::endl;
     std::cout << "Example:" << std::endl;
     std::cout << "  " << programName << " --sources_path ./data --strategy_id MA_CROSS --trading_symbol EURUSD" << std::endl;
+    std::cout << "  " << programName << " --daemon /tmp/fxts2.sock --path_to_backtester ./bt.exe --history_path ./history" << std::endl;
+    std::cout << "  " << programName << " --submit /tmp/fxts2.sock --strategy_id MA_CROSS --trading_symbol EURUSD --param Period=10,20" << std::endl;
+}
+
+std::vector<std::string> splitSymbols(const std::string& value) {
+    std::vector<std::string> symbols;
+    std::stringstream ss(value);
+    std::string symbol;
+    while (std::getline(ss, symbol, ',')) {
+        if (!symbol.empty()) {
+            symbols.push_back(symbol);
+        }
+    }
+    return symbols;
+}
+
+std::string joinSymbols(const std::vector<std::string>& symbols) {
+    std::string result;
+    for (const auto& symbol : symbols) {
+        if (!result.empty()) {
+            result += ",";
+        }
+        result += symbol;
+    }
+    return result;
+}
+
+std::optional<int> parseSessionStart(const std::string& value) {
+    int hours = 0;
+    int minutes = 0;
+    char separator = 0;
+    std::istringstream ss(value);
+    if (!(ss >> hours >> separator >> minutes) || separator != ':' || hours < 0 || hours > 23 || minutes < 0 || minutes > 59) {
+        return std::nullopt;
+    }
+    return hours * 60 + minutes;
 }
 
 AppConfig parseArguments(int argc, char* argv[]) {
@@ -53,7 +210,13 @@ AppConfig parseArguments(int argc, char* argv[]) {
             config.strategyId = argv[++i];
         }
         else if (arg == "--trading_symbol" && i + 1 < argc) {
-            config.tradingSymbol = argv[++i];
+            auto symbols = splitSymbols(argv[++i]);
+            if (!symbols.empty()) {
+                config.portfolios.push_back(symbols);
+            }
+        }
+        else if (arg == "--account_currency" && i + 1 < argc) {
+            config.accountCurrency = argv[++i];
         }
         else if (arg == "--path_to_backtester" && i + 1 < argc) {
             config.pathToBacktester = argv[++i];
@@ -61,6 +224,125 @@ AppConfig parseArguments(int argc, char* argv[]) {
         else if (arg == "--history_path" && i + 1 < argc) {
             config.historyPath = argv[++i];
         }
+        else if (arg == "--bar_store" && i + 1 < argc) {
+            config.barStore = argv[++i];
+        }
+        else if (arg == "--intersect_timestamps") {
+            config.intersectTimestamps = true;
+        }
+        else if (arg == "--period" && i + 1 < argc) {
+            config.period = argv[++i];
+        }
+        else if (arg == "--param" && i + 1 < argc) {
+            std::string value = argv[++i];
+            size_t separator = value.find('=');
+            if (separator == std::string::npos || separator == 0) {
+                std::cerr << "Error: Invalid parameter: " << value << std::endl;
+                exit(1);
+            }
+            config.parameters.emplace_back(value.substr(0, separator), splitSymbols(value.substr(separator + 1)));
+        }
+        else if (arg == "--daemon" && i + 1 < argc) {
+            config.daemonSocket = argv[++i];
+        }
+        else if (arg == "--workers" && i + 1 < argc) {
+            config.workers = std::atoi(argv[++i]);
+        }
+        else if (arg == "--speculate_multiple" && i + 1 < argc) {
+            config.speculateMultiple = std::atof(argv[++i]);
+        }
+        else if (arg == "--min_workers" && i + 1 < argc) {
+            config.minWorkers = std::atoi(argv[++i]);
+        }
+        else if (arg == "--max_workers" && i + 1 < argc) {
+            config.maxWorkers = std::atoi(argv[++i]);
+        }
+        else if (arg == "--adapt_seconds" && i + 1 < argc) {
+            config.adaptSeconds = std::atoi(argv[++i]);
+        }
+        else if (arg == "--schedule" && i + 1 < argc) {
+            config.schedule = argv[++i];
+        }
+        else if (arg == "--locality_window" && i + 1 < argc) {
+            config.localityWindow = std::atoi(argv[++i]);
+        }
+        else if (arg == "--ram_workspace" && i + 1 < argc) {
+            config.ramWorkspace = argv[++i];
+        }
+        else if (arg == "--ram_budget_mb" && i + 1 < argc) {
+            config.ramBudgetMb = std::atoi(argv[++i]);
+        }
+        else if (arg == "--prescreen" && i + 1 < argc) {
+            config.prescreen = argv[++i];
+        }
+        else if (arg == "--prescreen_top" && i + 1 < argc) {
+            config.prescreenTop = std::atoi(argv[++i]);
+        }
+        else if (arg == "--prescreen_weeks" && i + 1 < argc) {
+            config.prescreenWeeks = std::atoi(argv[++i]);
+        }
+        else if (arg == "--indicator_cache" && i + 1 < argc) {
+            config.indicatorCache = argv[++i];
+        }
+        else if (arg == "--indicator_cache_mb" && i + 1 < argc) {
+            config.indicatorCacheMb = std::atoi(argv[++i]);
+        }
+        else if (arg == "--submit" && i + 1 < argc) {
+            config.submitSocket = argv[++i];
+        }
+        else if (arg == "--sweep" && i + 1 < argc) {
+            config.sweepFile = argv[++i];
+        }
+        else if (arg == "--owner" && i + 1 < argc) {
+            config.owner = argv[++i];
+        }
+        else if (arg == "--detach") {
+            config.detach = true;
+        }
+        else if (arg == "--fetch_results" && i + 1 < argc) {
+            config.fetchSocket = argv[++i];
+        }
+        else if (arg == "--submission" && i + 1 < argc) {
+            config.submission = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--coordinator" && i + 1 < argc) {
+            config.coordinatorPort = std::atoi(argv[++i]);
+        }
+        else if (arg == "--shard_size" && i + 1 < argc) {
+            config.shardSize = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--lease_seconds" && i + 1 < argc) {
+            config.leaseSeconds = std::atoi(argv[++i]);
+        }
+        else if (arg == "--results" && i + 1 < argc) {
+            config.resultsPath = argv[++i];
+        }
+        else if (arg == "--worker" && i + 1 < argc) {
+            config.workerAddress = argv[++i];
+        }
+        else if (arg == "--plan_dir" && i + 1 < argc) {
+            config.planDirectory = argv[++i];
+        }
+        else if (arg == "--chunk_size" && i + 1 < argc) {
+            config.chunkSize = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--claim_seconds" && i + 1 < argc) {
+            config.claimSeconds = std::atoi(argv[++i]);
+        }
+        else if (arg == "--node" && i + 1 < argc) {
+            config.node = argv[++i];
+        }
+        else if (arg == "--aggregate" && i + 1 < argc) {
+            config.aggregateDirectory = argv[++i];
+        }
+        else if (arg == "--session_start" && i + 1 < argc) {
+            auto minutes = parseSessionStart(argv[++i]);
+            if (!minutes.has_value()) {
+                std::cerr << "Error: Invalid session start: " << argv[i] << std::endl;
+                exit(1);
+            }
+            config.sessionStartMinutes = minutes.value();
+        }
         else {
             std::cerr << "Error: Unknown argument or missing value: " << arg << std::endl;
             std::cerr << "Use --help for usage information." << std::endl;
@@ -72,7 +354,72 @@ AppConfig parseArguments(int argc, char* argv[]) {
 }
 
 bool validateConfig(const AppConfig& config) {
-    if (config.sourcesPath.empty()) {
+#ifdef _WIN32
+    // SocketChannel has no Winsock implementation, only the shared plan directory works across machines
+    if (!config.daemonSocket.empty() || !config.submitSocket.empty() || !config.fetchSocket.empty()
+        || config.coordinatorPort >= 0 || !config.workerAddress.empty()) {
+        std::cerr << "Error: --daemon, --submit, --fetch_results, --coordinator and --worker are not supported on Windows, use --plan_dir instead" << std::endl;
+        return false;
+    }
+#endif
+    if (!config.daemonSocket.empty()) {
+        if (config.pathToBacktester.empty() || config.historyPath.empty()) {
+            std::cerr << "Error: --daemon requires --path_to_backtester and --history_path" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    if (!config.aggregateDirectory.empty()) {
+        return true;
+    }
+
+    if (!config.planDirectory.empty()) {
+        if (config.pathToBacktester.empty() || config.claimSeconds <= 0 || config.chunkSize == 0) {
+            std::cerr << "Error: --plan_dir requires --path_to_backtester, a positive --claim_seconds and --chunk_size" << std::endl;
+            return false;
+        }
+        // An existing plan already carries the sweep
+        if (std::filesystem::exists(std::filesystem::path(config.planDirectory) / "plan.json") || !config.sweepFile.empty()) {
+            return true;
+        }
+        if (config.historyPath.empty()) {
+            std::cerr << "Error: --history_path is required to create a plan" << std::endl;
+            return false;
+        }
+    }
+
+    if (!config.workerAddress.empty()) {
+        if (config.pathToBacktester.empty() || config.workerAddress.find(':') == std::string::npos) {
+            std::cerr << "Error: --worker requires HOST:PORT and --path_to_backtester" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    if (config.coordinatorPort >= 0 && (config.historyPath.empty() || config.leaseSeconds <= 0)) {
+        std::cerr << "Error: --coordinator requires --history_path and a positive --lease_seconds" << std::endl;
+        return false;
+    }
+
+    if (config.coordinatorPort >= 0 && !config.sweepFile.empty()) {
+        return true;
+    }
+
+    if (!config.fetchSocket.empty()) {
+        if (config.submission == 0) {
+            std::cerr << "Error: --fetch_results requires --submission" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    if (!config.submitSocket.empty() && !config.sweepFile.empty()) {
+        return true;
+    }
+
+    // Submissions reuse the data sources and history configured in the daemon
+    if (config.sourcesPath.empty() && config.submitSocket.empty() && config.coordinatorPort < 0 && config.planDirectory.empty()) {
         std::cerr << "Error: --sources_path is required" << std::endl;
         return false;
     }
@@ -82,11 +429,36 @@ bool validateConfig(const AppConfig& config) {
         return false;
     }
     
-    if (config.tradingSymbol.empty()) {
+    if (config.portfolios.empty()) {
         std::cerr << "Error: --trading_symbol is required" << std::endl;
         return false;
     }
     
+    if (!BarResampler::parsePeriod(config.period).has_value()) {
+        std::cerr << "Error: Unsupported period: " << config.period << std::endl;
+        return false;
+    }
+
+    if (config.schedule != "locality" && config.schedule != "cost") {
+        std::cerr << "Error: Unknown schedule: " << config.schedule << std::endl;
+        return false;
+    }
+
+    if (!config.prescreen.empty() && (!PreScreener::parseFamily(config.prescreen).has_value() || config.prescreenTop < 1 || config.prescreenWeeks < 1)) {
+        std::cerr << "Error: --prescreen needs ma_cross, breakout or rsi and a positive --prescreen_top and --prescreen_weeks" << std::endl;
+        return false;
+    }
+
+    if (config.indicatorCacheMb < 1) {
+        std::cerr << "Error: --indicator_cache_mb must be positive" << std::endl;
+        return false;
+    }
+
+    if (config.maxWorkers > 0 && (config.minWorkers < 1 || config.minWorkers > config.maxWorkers || config.adaptSeconds < 1)) {
+        std::cerr << "Error: --max_workers needs 1 <= --min_workers <= --max_workers and a positive --adapt_seconds" << std::endl;
+        return false;
+    }
+    
     return true;
 }
 
@@ -94,9 +466,14 @@ void printConfig(const AppConfig& config) {
     std::cout << "Configuration:" << std::endl;
     std::cout << "  Sources Path: " << config.sourcesPath << std::endl;
     std::cout << "  Strategy ID: " << config.strategyId << std::endl;
-    std::cout << "  Trading Symbol: " << config.tradingSymbol << std::endl;
+    for (const auto& portfolio : config.portfolios) {
+        std::cout << "  Trading Symbol: " << joinSymbols(portfolio) << std::endl;
+    }
+    std::cout << "  Account Currency: " << config.accountCurrency << std::endl;
     std::cout << "  Path to Backtester: " << config.pathToBacktester << std::endl;
     std::cout << "  Path to History: " << config.historyPath << std::endl;
+    std::cout << "  Timestamp Alignment: " << (config.intersectTimestamps ? "intersection" : "union") << std::endl;
+    std::cout << "  Period: " << config.period << std::endl;
     std::cout << std::endl;
 }
 
@@ -127,6 +504,258 @@ void printSymbolInfo(const SymbolInfo& symbolInfo) {
     std::cout << std::endl;
 }
 
+SweepSpec createSweepSpec(const AppConfig& config) {
+    SweepSpec spec;
+    spec.owner = config.owner;
+    if (spec.owner.empty()) {
+        const char* user = std::getenv("USER");
+        spec.owner = user != nullptr ? user : "default";
+    }
+    spec.strategy = config.strategyId;
+    spec.portfolios = config.portfolios;
+    spec.accountCurrency = config.accountCurrency;
+    spec.period = config.period;
+    spec.intersectTimestamps = config.intersectTimestamps;
+    spec.parameters = config.parameters;
+    return spec;
+}
+
+// Sweep from --sweep FILE, or from the individual options when no file is given
+std::optional<SweepSpec> loadSweepSpec(const AppConfig& config) {
+    if (config.sweepFile.empty()) {
+        return createSweepSpec(config);
+    }
+    std::ifstream file(config.sweepFile);
+    if (!file.is_open()) {
+        std::cerr << "Error: Failed to open sweep file: " << config.sweepFile << std::endl;
+        return std::nullopt;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    try {
+        SweepSpec spec = SweepSpecParser::parse(buffer.str());
+        if (!config.owner.empty()) {
+            spec.owner = config.owner;
+        }
+        return spec;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: Invalid sweep file " << config.sweepFile << ": " << e.what() << std::endl;
+        return std::nullopt;
+    }
+}
+
+int submitSweep(const AppConfig& config) {
+    auto spec = loadSweepSpec(config);
+    if (!spec.has_value()) {
+        return 1;
+    }
+    nlohmann::json request;
+    request["command"] = "submit";
+    request["sweep"] = nlohmann::json::parse(SweepSpecParser::serialize(spec.value()));
+    request["follow"] = !config.detach;
+    return DaemonClient::request(config.submitSocket, request.dump());
+}
+
+int fetchResults(const AppConfig& config) {
+    nlohmann::json request;
+    request["command"] = "results";
+    request["submission"] = config.submission;
+    return DaemonClient::request(config.fetchSocket, request.dump());
+}
+
+std::string catalogSnapshotPath(const std::string& historyPath) {
+    // The catalog snapshot lives next to the other temporary files, one per history path
+    return (std::filesystem::temp_directory_path() / "fxts2_backtester"
+        / ("symbol_catalog_" + std::to_string(std::hash<std::string>()(historyPath)) + ".bin")).string();
+}
+
+int runDaemon(const AppConfig& config) {
+    RatesStorageProvider ratesStorageProvider(config.historyPath, catalogSnapshotPath(config.historyPath));
+    ratesStorageProvider.setSessionOffset(config.sessionStartMinutes * 60LL);
+    if (!config.barStore.empty()) {
+        ratesStorageProvider.setBarStore(config.barStore);
+    }
+    int workers = config.workers > 0 ? config.workers : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    DaemonServer server(config.daemonSocket, config.pathToBacktester, ratesStorageProvider, workers);
+    return server.run();
+}
+
+int runCoordinator(const AppConfig& config) {
+    auto spec = loadSweepSpec(config);
+    if (!spec.has_value()) {
+        return 1;
+    }
+    RatesStorageProvider ratesStorageProvider(config.historyPath, catalogSnapshotPath(config.historyPath));
+    ratesStorageProvider.setSessionOffset(config.sessionStartMinutes * 60LL);
+    if (!config.barStore.empty()) {
+        ratesStorageProvider.setBarStore(config.barStore);
+    }
+    JobPlanner planner(ratesStorageProvider);
+    auto jobs = planner.planSweep(spec.value());
+    if (!jobs.has_value()) {
+        std::cerr << "Error: Failed to plan jobs" << std::endl;
+        return 1;
+    }
+    auto tasks = JobPlanner::planTasks(jobs.value(), JobPlanner::planWindows(std::time(nullptr)));
+
+    std::ofstream resultsFile;
+    if (!config.resultsPath.empty()) {
+        resultsFile.open(config.resultsPath);
+        if (!resultsFile.is_open()) {
+            std::cerr << "Error: Failed to open results file: " << config.resultsPath << std::endl;
+            return 1;
+        }
+    }
+    Coordinator coordinator(spec.value(), tasks, config.historyPath, ratesStorageProvider, config.shardSize,
+        std::chrono::seconds(config.leaseSeconds), config.resultsPath.empty() ? std::cout : resultsFile);
+    if (!coordinator.listen(config.coordinatorPort)) {
+        std::cerr << "Error: Failed to listen on port " << config.coordinatorPort << std::endl;
+        return 1;
+    }
+    std::cout << "Coordinator listening on port " << coordinator.port() << " with " << tasks.size() << " tasks" << std::endl;
+    size_t completed = coordinator.run();
+    std::cout << "Backtest completed. Processed " << completed << " out of " << tasks.size() << " backtests." << std::endl;
+    return 0;
+}
+
+std::string defaultNodeName() {
+    const char* hostName = std::getenv("HOSTNAME");
+    return std::string(hostName != nullptr ? hostName : "worker") + "-" + std::to_string(std::random_device()() % 100000);
+}
+
+int runWorkers(const AppConfig& config) {
+    size_t separator = config.workerAddress.rfind(':');
+    std::string host = config.workerAddress.substr(0, separator);
+    int port = std::atoi(config.workerAddress.substr(separator + 1).c_str());
+    std::string prefix = defaultNodeName();
+
+    int workers = config.workers > 0 ? config.workers : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<int> exitCodes(workers, 1);
+    std::vector<std::thread> threads;
+    auto sharedData = std::make_shared<WorkerClient::SharedData>();
+    for (int i = 0; i < workers; i++) {
+        threads.emplace_back([&config, &exitCodes, &sharedData, host, port, prefix, i]() {
+            WorkerClient client(host, port, prefix + "-" + std::to_string(i + 1), config.pathToBacktester, std::to_string(i + 1), sharedData);
+            exitCodes[i] = client.run();
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return *std::max_element(exitCodes.begin(), exitCodes.end());
+}
+
+int runPlanNode(const AppConfig& config) {
+    if (!SharedPlan::load(config.planDirectory).has_value()) {
+        auto spec = loadSweepSpec(config);
+        if (!spec.has_value()) {
+            return 1;
+        }
+        RatesStorageProvider ratesStorageProvider(config.historyPath, catalogSnapshotPath(config.historyPath));
+        JobPlanner planner(ratesStorageProvider);
+        auto jobs = planner.planSweep(spec.value());
+        if (!jobs.has_value()) {
+            std::cerr << "Error: Failed to plan jobs" << std::endl;
+            return 1;
+        }
+        SharedPlan plan;
+        plan.spec = spec.value();
+        plan.historyPath = config.historyPath;
+        plan.sessionStartMinutes = config.sessionStartMinutes;
+        plan.barStore = config.barStore;
+        plan.windows = JobPlanner::planWindows(std::time(nullptr));
+        plan.chunkSize = config.chunkSize;
+        plan.taskCount = jobs.value().size() * plan.windows.size();
+        if (!SharedPlan::create(config.planDirectory, plan).has_value()) {
+            return 1;
+        }
+    }
+    std::string node = config.node.empty() ? defaultNodeName() : config.node;
+    int workers = config.workers > 0 ? config.workers : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::cout << "Node " << node << " working on " << config.planDirectory << " with " << workers << " workers" << std::endl;
+    SharedPlanNode planNode(config.planDirectory, node, config.pathToBacktester, std::chrono::seconds(config.claimSeconds));
+    auto completed = planNode.run(workers);
+    if (!completed.has_value()) {
+        return 1;
+    }
+    std::cout << "Node " << node << " completed " << completed.value() << " backtests, all chunks are done" << std::endl;
+    return 0;
+}
+
+int aggregateResults(const AppConfig& config) {
+    std::string outputPath = config.resultsPath.empty()
+        ? (std::filesystem::path(config.aggregateDirectory) / "results.jsonl").string() : config.resultsPath;
+    auto missing = SharedPlanNode::aggregate(config.aggregateDirectory, outputPath);
+    if (!missing.has_value()) {
+        return 1;
+    }
+    if (missing.value() > 0) {
+        std::cerr << "Warning: " << missing.value() << " tasks have no result yet" << std::endl;
+        return 1;
+    }
+    std::cout << "Results merged into " << outputPath << std::endl;
+
+    ResourceUsageReport usageReport;
+    std::ifstream results(outputPath);
+    std::string line;
+    while (std::getline(results, line)) {
+        nlohmann::json result = nlohmann::json::parse(line, nullptr, false);
+        if (!result.is_object()) {
+            continue;
+        }
+        ProcessUsage usage = TaskResultJson::parse(result).backtest.usage;
+        if (usage.spawned) {
+            usageReport.add(result.value("strategy", ""), splitSymbols(result.value("symbols", "")), usage);
+        }
+    }
+    if (!usageReport.empty()) {
+        usageReport.write(std::cout);
+    }
+    return 0;
+}
+
+// Keeps the prescreenTop parameter sets of each portfolio with the best bar-close simulation on its first symbol,
+// over the last prescreenWeeks planned weeks
+std::vector<BacktestJob> prescreenJobs(const AppConfig& config, RatesStorageProvider& ratesStorageProvider, const std::vector<BacktestJob>& jobs, const std::vector<BacktestWindow>& windows) {
+    ScreeningFamily family = PreScreener::parseFamily(config.prescreen).value();
+    IndicatorCache indicators(config.indicatorCache, static_cast<size_t>(config.indicatorCacheMb) * 1024 * 1024);
+    std::vector<BacktestJob> kept;
+    for (const auto& portfolio : config.portfolios) {
+        std::vector<BacktestJob> portfolioJobs;
+        for (const auto& job : jobs) {
+            if (job.symbols == portfolio) {
+                portfolioJobs.push_back(job);
+            }
+        }
+        BarColumns bars;
+        std::vector<size_t> weekStarts;
+        size_t recent = std::min(windows.size(), static_cast<size_t>(config.prescreenWeeks));
+        for (size_t i = windows.size() - recent; i < windows.size(); i++) {
+            weekStarts.push_back(bars.size());
+            ratesStorageProvider.readWeekColumns(portfolio.front(), windows[i].start, config.period, bars);
+        }
+        if (bars.size() == 0) {
+            std::cerr << "Warning: No history to pre-screen " << joinSymbols(portfolio) << ", all parameter sets are kept" << std::endl;
+            kept.insert(kept.end(), portfolioJobs.begin(), portfolioJobs.end());
+            continue;
+        }
+        auto started = std::chrono::steady_clock::now();
+        PreScreener screener(bars, &indicators, portfolio.front(), config.period, weekStarts);
+        std::vector<size_t> selected = screener.selectTop(family, portfolioJobs, static_cast<size_t>(config.prescreenTop));
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        for (size_t index : selected) {
+            kept.push_back(portfolioJobs[index]);
+        }
+        std::cout << "Pre-screening kept " << selected.size() << " of " << portfolioJobs.size() << " parameter sets for "
+                  << joinSymbols(portfolio) << " (" << std::fixed << std::setprecision(0)
+                  << portfolioJobs.size() / std::max(seconds, 1e-6) << " sets/s)" << std::defaultfloat << std::endl;
+    }
+    IndicatorCache::Stats stats = indicators.stats();
+    std::cout << "Indicator cache: " << stats.hits << " hits, " << stats.mapped << " mapped, " << stats.computed
+              << " computed, hit rate " << std::fixed << std::setprecision(0) << stats.hitRate() * 100 << "%" << std::defaultfloat << std::endl;
+    return kept;
+}
+
 int main(int argc, char* argv[]) {
     std::cout << "Welcome to FXTS2 Mass Backtester Console Application!" << std::endl;
     std::cout << "==================================================" << std::endl;
@@ -144,88 +773,229 @@ int main(int argc, char* argv[]) {
         printUsage(argv[0]);
         return 1;
     }
+
+    WorkspaceManager::shared().configure(config.ramWorkspace, static_cast<uintmax_t>(std::max(0, config.ramBudgetMb)) * 1024 * 1024);
+    size_t orphans = WorkspaceManager::shared().removeOrphans();
+    if (orphans > 0) {
+        std::cout << "Removed " << orphans << " workspaces left behind by crashed runs" << std::endl;
+    }
     
+    if (!config.daemonSocket.empty()) {
+        return runDaemon(config);
+    }
+    if (!config.submitSocket.empty()) {
+        return submitSweep(config);
+    }
+    if (!config.fetchSocket.empty()) {
+        return fetchResults(config);
+    }
+    if (config.coordinatorPort >= 0) {
+        return runCoordinator(config);
+    }
+    if (!config.workerAddress.empty()) {
+        return runWorkers(config);
+    }
+    if (!config.planDirectory.empty()) {
+        return runPlanNode(config);
+    }
+    if (!config.aggregateDirectory.empty()) {
+        return aggregateResults(config);
+    }
+
     // Display configuration
     printConfig(config);
     
-    // Get current time and calculate start of current week
-    std::time_t now = std::time(nullptr);
-    
-    DatesIterator datesIterator;
-    int totalWeeks = 0;
-    int completedWeeks = 0;
-
-    RatesStorageProvider ratesStorageProvider(config.historyPath);
-    std::optional<SymbolInfo> symbolInfo = ratesStorageProvider.getSymbolInfo(config.tradingSymbol);
-    if (!symbolInfo.has_value()) {
-        std::cerr << "Warning: Symbol info not found: " << config.tradingSymbol << std::endl;
-        std::cerr << "Using default symbol configuration." << std::endl;
+    int totalRuns = 0;
+    int completedRuns = 0;
+
+    RatesStorageProvider ratesStorageProvider(config.historyPath, catalogSnapshotPath(config.historyPath));
+    ratesStorageProvider.setSessionOffset(config.sessionStartMinutes * 60LL);
+    if (!config.barStore.empty()) {
+        ratesStorageProvider.setBarStore(config.barStore);
+    }
+    for (const auto& portfolio : config.portfolios) {
+        for (const auto& symbol : portfolio) {
+            std::optional<SymbolInfo> symbolInfo = ratesStorageProvider.getSymbolInfo(symbol);
+            if (!symbolInfo.has_value()) {
+                std::cerr << "Error: Symbol info not found: " << symbol << std::endl;
+                return 1;
+            }
+            printSymbolInfo(symbolInfo.value());
+        }
+    }
+
+    // One job per portfolio and parameter set, conversion pairs are added by the planner
+    JobPlanner planner(ratesStorageProvider);
+    std::optional<std::vector<BacktestJob>> jobs = planner.planSweep(createSweepSpec(config));
+    if (!jobs.has_value()) {
+        std::cerr << "Error: Failed to plan jobs" << std::endl;
         return 1;
     }
-    printSymbolInfo(symbolInfo.value());
-    
-    auto backtester = ConsoleBacktester(config.pathToBacktester, "1");
-
-    auto project = BacktestProject();
-    project.strategy = config.strategyId;
-    project.accountCurrency = "USD";
-    project.initialAmount = 50000.0;
-    project.defaultPeriod = "m1";
-    project.accountLotSize = 0;
-    
-    // Create instrument from symbol info
-    project.instruments.emplace_back(
-        symbolInfo.value().name,
-        symbolInfo.value().mmr,
-        symbolInfo.value().pipSize,
-        symbolInfo.value().precision,
-        symbolInfo.value().contractCurrency,
-        symbolInfo.value().profitCurrency,
-        symbolInfo.value().contractMultiplier,
-        symbolInfo.value().baseUnitSize,
-        symbolInfo.value().instrumentType,
-        std::optional<std::string>()
-    );
-    
-    // Loop through each week from start date to current week start
-    std::tm currentDate = datesIterator.current();
-    std::tm nextDate = datesIterator.next();
-    while (std::mktime(&nextDate) < now) {
-        totalWeeks++;
-        
-        // Create project for this week
-        project.startTime = std::mktime(&currentDate);
-        project.endTime = std::mktime(&nextDate);
-        std::cout << "Start date: " << std::put_time(&currentDate, "%Y-%m-%d") 
-                  << ", End date: " << std::put_time(&nextDate, "%Y-%m-%d") << std::endl;
-        
-        // Create trading history path
-        std::optional<std::string> tradingHistoryPath = ratesStorageProvider.prepareWeekData(config.tradingSymbol, currentDate);
-        if (!tradingHistoryPath.has_value()) {
-            std::cout << "Skipping week for symbol " << config.tradingSymbol << std::endl;
-            // Move to next week
-            currentDate = nextDate;
-            nextDate = datesIterator.next();
-            continue;
+    for (const auto& portfolio : config.portfolios) {
+        for (const auto& job : jobs.value()) {
+            if (job.symbols == portfolio && !job.conversionSymbols.empty()) {
+                std::cout << "Conversion pairs for " << joinSymbols(portfolio) << ": "
+                          << joinSymbols(job.conversionSymbols) << std::endl;
+                break;
+            }
         }
-        project.instruments[0].pricesFilePath = tradingHistoryPath.value();
-            
-        std::cout << "Running backtest for week " << tradingHistoryPath.value() << std::endl;
+    }
+
+    std::vector<BacktestWindow> windows = JobPlanner::planWindows(std::time(nullptr));
+    if (!config.prescreen.empty()) {
+        jobs = prescreenJobs(config, ratesStorageProvider, jobs.value(), windows);
+    }
+
+    // Prepared files are shared by the concurrent jobs of a week and removed after the last of them
+    PreparedDataCache sharedData(ratesStorageProvider);
+    std::vector<BacktestTask> tasks = JobPlanner::planTasks(jobs.value(), windows);
 
-        try {
-            backtester.run(project);
-            completedWeeks++;
-        } catch (const std::exception& e) {
-            std::cerr << "Error running backtest for week " << tradingHistoryPath.value() 
-                      << ": " << e.what() << std::endl;
+    // With cost order long tasks start first, the estimates improve with the durations recorded by earlier sweeps
+    std::string costsPath = (std::filesystem::temp_directory_path() / "fxts2_backtester" / "task_costs.txt").string();
+    TaskCostModel costModel(ratesStorageProvider);
+    costModel.load(costsPath);
+    std::vector<double> costs;
+    for (const auto& task : tasks) {
+        costs.push_back(costModel.estimate(task));
+    }
+    int workers = config.workers > 0 ? config.workers : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    // Adaptive runs start a thread per possible worker, the ones above the controller's limit wait
+    ConcurrencyController::Settings concurrency;
+    concurrency.minWorkers = config.maxWorkers > 0 ? config.minWorkers : workers;
+    concurrency.maxWorkers = config.maxWorkers > 0 ? config.maxWorkers : workers;
+    ConcurrencyController controller(concurrency, workers);
+    workers = static_cast<int>(concurrency.maxWorkers);
+    // Locality order keeps the tasks of a week together so each week is prepared once,
+    // cost order starts long tasks first and lets idle workers steal
+    bool localityOrder = config.schedule == "locality";
+    WorkStealingScheduler scheduler(workers);
+    if (!localityOrder) {
+        scheduler.assign(costs);
+    }
+    size_t localityWindow = config.localityWindow > 0 ? static_cast<size_t>(config.localityWindow) : 2 * static_cast<size_t>(workers);
+    LocalityScheduler localityScheduler(localityOrder ? JobPlanner::localityOrder(tasks) : std::vector<size_t>(), localityWindow);
+    if (localityOrder) {
+        // Files of the week in progress stay prepared between its jobs
+        sharedData.setIdleLimit(JobPlanner::preparedEntriesPerWindow(jobs.value()));
+    }
+    if (tasks.empty()) {
+        controller.close();
+    }
+
+    // Idle workers re-run tasks that take far longer than usual for their strategy and symbols
+    StragglerMonitor stragglers(config.speculateMultiple);
+    ResourceUsageReport usageReport;
+    std::mutex progressMutex;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < workers; i++) {
+        threads.emplace_back([&, i]() {
+            auto backtester = ConsoleBacktester(config.pathToBacktester, std::to_string(i + 1));
+            TaskExecutor executor(sharedData);
+            while (true) {
+                std::shared_ptr<StragglerMonitor::Attempt> attempt;
+                controller.waitForSlot(i);
+                // Nothing while the locality window is full, tasks remain to be handed out then
+                auto index = localityOrder ? localityScheduler.next(std::chrono::milliseconds(200)) : scheduler.next(i);
+                bool drained = localityOrder ? localityScheduler.exhausted() : !index.has_value();
+                if (index.has_value()) {
+                    attempt = stragglers.begin(index.value(), TaskCostModel::keyOf(*tasks[index.value()].job));
+                } else {
+                    attempt = stragglers.speculate();
+                    if (attempt == nullptr) {
+                        if (drained && (!stragglers.isEnabled() || !stragglers.hasRunning())) {
+                            break;
+                        }
+                        if (drained) {
+                            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+                        }
+                        continue;
+                    }
+                    std::lock_guard<std::mutex> lock(progressMutex);
+                    std::cout << "Speculatively re-running " << joinSymbols(tasks[attempt->task].job->symbols) << ", week "
+                              << TimeUtils::formatDateTime(TimeUtils::toEpochSeconds(tasks[attempt->task].window.start)).substr(0, 10) << std::endl;
+                }
+                const BacktestTask& task = tasks[attempt->task];
+                TaskResult result = executor.execute(task, backtester, &attempt->cancellation);
+                // Failed runs and killed copies cost resources too
+                if (result.backtest.usage.spawned) {
+                    usageReport.add(task.job->project.strategy, task.job->symbols, result.backtest.usage);
+                }
+                // The slower attempt of a task is killed and ignored, so is a failed one while the other still runs
+                if (!stragglers.finish(attempt, result.completed)) {
+                    continue;
+                }
+                if (localityOrder) {
+                    localityScheduler.finish(attempt->task);
+                }
+                if (result.completed) {
+                    costModel.record(task, std::chrono::duration<double>(std::chrono::steady_clock::now() - attempt->started).count());
+                }
+                {
+                    std::lock_guard<std::mutex> lock(progressMutex);
+                    totalRuns++;
+                    std::string week = TimeUtils::formatDateTime(TimeUtils::toEpochSeconds(task.window.start)).substr(0, 10);
+                    if (result.completed) {
+                        completedRuns++;
+                        std::cout << "Completed backtest for " << joinSymbols(task.job->symbols) << ", week " << week << std::endl;
+                    } else {
+                        std::cout << "Skipping week " << week << " for symbols " << joinSymbols(task.job->symbols) << ": " << result.message << std::endl;
+                    }
+                    if (static_cast<size_t>(totalRuns) == tasks.size()) {
+                        controller.close();
+                    }
+                }
+            }
+        });
+    }
+    if (config.maxWorkers > 0) {
+        threads.emplace_back([&]() {
+            SystemSampler sampler;
+            while (!controller.waitClosed(std::chrono::seconds(config.adaptSeconds))) {
+                size_t finished;
+                {
+                    std::lock_guard<std::mutex> lock(progressMutex);
+                    finished = static_cast<size_t>(completedRuns);
+                }
+                auto sample = sampler.sample(finished);
+                auto decision = controller.update(sample);
+                std::lock_guard<std::mutex> lock(progressMutex);
+                std::cout << ConcurrencyController::describe(decision, sample) << std::endl;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    sharedData.clear();
+    costModel.save(costsPath);
+
+    if (!localityOrder) {
+        auto metrics = scheduler.metrics();
+        double workerSeconds = metrics.makespanSeconds * workers;
+        std::cout << "Tail idle time: " << std::fixed << std::setprecision(1) << metrics.tailIdleSeconds << " s over " << workers << " workers ("
+                  << (workerSeconds > 0 ? 100.0 * metrics.tailIdleSeconds / workerSeconds : 0.0) << "% of " << metrics.makespanSeconds
+                  << " s), " << metrics.steals << " tasks stolen" << std::endl;
+    }
+    auto cacheStats = sharedData.stats();
+    std::cout << "Prepared data: " << cacheStats.prepared << " conversions, " << cacheStats.reused << " reuses, hit rate "
+              << std::fixed << std::setprecision(1) << 100.0 * cacheStats.hitRate() << "%" << std::endl;
+    auto readErrors = ratesStorageProvider.getReadErrors();
+    if (!readErrors.empty()) {
+        size_t malformed = 0;
+        for (const auto& [path, errors] : readErrors) {
+            malformed += errors.total();
         }
-        
-        // Move to next week
-        currentDate = nextDate;
-        nextDate = datesIterator.next();
+        std::cout << "History read errors: " << malformed << " malformed lines skipped in " << readErrors.size() << " files" << std::endl;
+    }
+    auto speculation = stragglers.metrics();
+    if (speculation.copies > 0) {
+        std::cout << "Speculative copies: " << speculation.copies << " started, " << speculation.copiesWon << " finished first" << std::endl;
     }
     
-    std::cout << "Backtest completed. Processed " << completedWeeks << " out of " << totalWeeks << " weeks." << std::endl;
+    if (!usageReport.empty()) {
+        usageReport.write(std::cout);
+    }
+    std::cout << "Backtest completed. Processed " << completedRuns << " out of " << totalRuns << " backtests." << std::endl;
     
     return 0;
 }
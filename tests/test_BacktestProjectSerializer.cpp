@@ -4,6 +4,7 @@
 #include <filesystem>
 #include <ctime>
 #include "../src/BacktestProjectSerializer.h"
+#include "../src/BacktestProjectTemplate.h"
 #include "../src/BacktestProject.h"
 
 class BacktestProjectSerializerTest : public ::testing::Test {
@@ -308,3 +309,107 @@ TEST_F(BacktestProjectSerializerTest, SerializeWithoutPricesFilePath) {
     // Check that pricesFilePath is NOT included when not set
     EXPECT_TRUE(content.find("filename=") == std::string::npos);
 }
+
+// Test complete document layout, byte for byte
+TEST_F(BacktestProjectSerializerTest, SerializeExactDocument) {
+    BacktestProject project = createSampleProject();
+    project.instruments[0].pricesFilePath = "EURUSD_2021-1.csv";
+    std::string outputPath = testDir + "/exact_document.xml";
+
+    BacktestProjectSerializer::serialize(project, outputPath);
+    std::string content = readFileContent(outputPath);
+
+    std::string expected =
+        "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+        "<project>\n"
+        " <simplified-format value=\"1\"/>\n"
+        " <strategy value=\"MA_Cross_Strategy\"/>\n"
+        " <date-from value=\"2021-01-01 00:00:00\"/>\n"
+        " <date-to value=\"2022-01-01 00:00:00\"/>\n"
+        " <account-currency value=\"USD\"/>\n"
+        " <initial-amount value=\"10000.00\"/>\n"
+        " <default-period value=\"H1\"/>\n"
+        " <account-lot-size value=\"100000\"/>\n"
+        " <instruments>\n"
+        " <instrument name=\"EURUSD\" filename=\"EURUSD_2021-1.csv\">\n"
+        " <mmr value=\"0.02\"/>\n"
+        " <pipSize value=\"0.0001\"/>\n"
+        " <precision value=\"5\"/>\n"
+        " <contractCurrency value=\"USD\"/>\n"
+        " <profitCurrency value=\"USD\"/>\n"
+        " <contractMultiplier value=\"1\"/>\n"
+        " <baseUnitSize value=\"100000\"/>\n"
+        " <instrumentType value=\"1\"/>\n"
+        " </instrument>\n"
+        " </instruments>\n"
+        " <strategy-params>\n"
+        " <strategy-param id=\"FastMA\" value=\"10\"/>\n"
+        " <strategy-param id=\"SlowMA\" value=\"20\"/>\n"
+        " </strategy-params>\n"
+        " </project>\n";
+    EXPECT_EQ(content, expected);
+}
+
+// Test that the compiled template reproduces the serializer output byte for byte
+TEST_F(BacktestProjectSerializerTest, TemplateMatchesSerializer) {
+    BacktestProject project = createSampleProject();
+    project.initialAmount = 12345.6789;
+    Instrument instrument2("USDJPY", 0.123456789, 0.00001, 3, "USD", "JPY", 1, 1000, 1, std::optional<std::string>());
+    project.instruments.push_back(instrument2);
+    BacktestProjectTemplate projectTemplate(project);
+
+    // Per-job fields change between renders
+    for (int week = 0; week < 3; week++) {
+        project.startTime = 946684800 + week * 7 * 86400;
+        project.endTime = project.startTime + 7 * 86400 + 3661;
+        project.instruments[0].pricesFilePath = "EURUSD_2000-" + std::to_string(week + 1) + ".csv";
+        if (week > 0) {
+            project.instruments[1].pricesFilePath = "USDJPY_2000-" + std::to_string(week + 1) + ".csv";
+        }
+        project.strategyParameters[1].value = std::to_string(20 + week);
+
+        std::string serializerPath = testDir + "/serializer.xml";
+        std::string templatePath = testDir + "/template.xml";
+        BacktestProjectSerializer::serialize(project, serializerPath);
+        projectTemplate.write(project, templatePath);
+
+        EXPECT_EQ(readFileContent(templatePath), readFileContent(serializerPath));
+    }
+}
+
+// Test template with empty instrument and parameter lists
+TEST_F(BacktestProjectSerializerTest, TemplateMatchesSerializerForEmptyProject) {
+    BacktestProject project;
+    project.strategy = "EmptyStrategy";
+    project.startTime = 0;
+    project.endTime = 0;
+    project.accountCurrency = "USD";
+    project.initialAmount = 0.0;
+    project.defaultPeriod = "M1";
+    project.accountLotSize = 0;
+
+    std::string serializerPath = testDir + "/serializer.xml";
+    BacktestProjectSerializer::serialize(project, serializerPath);
+    std::string rendered;
+    BacktestProjectTemplate(project).render(project, rendered);
+
+    EXPECT_EQ(rendered, readFileContent(serializerPath));
+}
+
+// Test that a project with a different layout is rejected by the template
+TEST_F(BacktestProjectSerializerTest, TemplateRejectsMismatchedProject) {
+    BacktestProject project = createSampleProject();
+    BacktestProjectTemplate projectTemplate(project);
+    project.strategyParameters.pop_back();
+
+    std::string rendered;
+    EXPECT_THROW(projectTemplate.render(project, rendered), std::runtime_error);
+}
+
+// Test template error handling for invalid file path
+TEST_F(BacktestProjectSerializerTest, TemplateWriteInvalidPath) {
+    BacktestProject project = createSampleProject();
+    BacktestProjectTemplate projectTemplate(project);
+
+    EXPECT_THROW(projectTemplate.write(project, "/invalid/path/that/does/not/exist/test.xml"), std::runtime_error);
+}
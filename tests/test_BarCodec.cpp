@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+#include "BarCodec.h"
+#include "HistoryCompressor.h"
+#include "RatesStorageProvider.h"
+#include "TimeUtils.h"
+#include "FileHash.h"
+#include <filesystem>
+#include <fstream>
+#include <cmath>
+#include <cstring>
+#include <string>
+
+class BarCodecTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        testDir = std::filesystem::temp_directory_path() / "bar_codec_test";
+        std::filesystem::remove_all(testDir);
+        std::filesystem::create_directories(testDir / "history" / "EURUSD");
+    }
+
+    void TearDown() override {
+        try {
+            std::filesystem::remove_all(testDir);
+        } catch (const std::exception&) {
+            // Ignore cleanup errors
+        }
+    }
+
+    // A random walk of five-decimal quotes with a weekend gap in the middle
+    static BarColumns walk(size_t count) {
+        BarColumns bars;
+        long long time = 1704240000;
+        long long price = 110000;
+        unsigned seed = 7;
+        for (size_t i = 0; i < count; i++) {
+            seed = seed * 1103515245 + 12345;
+            price += static_cast<long long>(seed >> 16) % 21 - 10;
+            Data data{};
+            data.bid = { price / 1e5, (price + 4) / 1e5, (price - 3) / 1e5, (price + 1) / 1e5 };
+            data.ask = { (price + 2) / 1e5, (price + 6) / 1e5, (price - 1) / 1e5, (price + 3) / 1e5 };
+            data.volume = static_cast<int>(seed % 50);
+            bars.push(time, data);
+            time += i == count / 2 ? 2 * 24 * 60 * 60 : 60;
+        }
+        return bars;
+    }
+
+    static void expectSame(const BarColumns& expected, const BarColumns& actual) {
+        ASSERT_EQ(expected.size(), actual.size());
+        EXPECT_EQ(expected.time, actual.time);
+        EXPECT_EQ(expected.bidOpen, actual.bidOpen);
+        EXPECT_EQ(expected.bidHigh, actual.bidHigh);
+        EXPECT_EQ(expected.bidLow, actual.bidLow);
+        EXPECT_EQ(expected.bidClose, actual.bidClose);
+        EXPECT_EQ(expected.askOpen, actual.askOpen);
+        EXPECT_EQ(expected.askHigh, actual.askHigh);
+        EXPECT_EQ(expected.askLow, actual.askLow);
+        EXPECT_EQ(expected.askClose, actual.askClose);
+        EXPECT_EQ(expected.volume, actual.volume);
+    }
+
+    std::filesystem::path testDir;
+};
+
+TEST_F(BarCodecTest, DecimalPricesRoundTripExactlyAndCompress) {
+    BarColumns bars = walk(10000);
+    std::string encoded;
+    BarCodec::encode(bars, encoded);
+    BarColumns decoded;
+    ASSERT_TRUE(BarCodec::decode(encoded.data(), encoded.size(), decoded));
+    expectSame(bars, decoded);
+    // 76 bytes a bar in columns
+    EXPECT_LT(encoded.size() * 8, bars.size() * 76);
+}
+
+TEST_F(BarCodecTest, PricesWithoutExactScaleKeepTheirBits) {
+    BarColumns bars = walk(100);
+    bars.bidClose[10] = 1.0 / 3.0;
+    bars.askLow[20] = -0.0;
+    bars.askHigh[30] = 1e300;
+    std::string encoded;
+    BarCodec::encode(bars, encoded);
+    BarColumns decoded;
+    ASSERT_TRUE(BarCodec::decode(encoded.data(), encoded.size(), decoded));
+    expectSame(bars, decoded);
+    EXPECT_TRUE(std::signbit(decoded.askLow[20]));
+
+    BarColumns empty;
+    encoded.clear();
+    BarCodec::encode(empty, encoded);
+    EXPECT_TRUE(BarCodec::decode(encoded.data(), encoded.size(), decoded));
+}
+
+TEST_F(BarCodecTest, CorruptBlocksAreRejected) {
+    BarColumns bars = walk(BarCodec::BlockRows + 100);
+    std::string encoded;
+    BarCodec::encode(bars, encoded);
+
+    std::string flipped = encoded;
+    flipped[flipped.size() - 5] ^= 0x10;
+    BarColumns decoded;
+    EXPECT_FALSE(BarCodec::decode(flipped.data(), flipped.size(), decoded));
+    // The first block is intact
+    EXPECT_EQ(decoded.size(), BarCodec::BlockRows);
+
+    // A row count far beyond a block in the first header
+    std::string huge = encoded;
+    uint32_t count = 0xFFFFFFF0u;
+    std::memcpy(&huge[8], &count, sizeof(count));
+    BarColumns oversized;
+    EXPECT_FALSE(BarCodec::decode(huge.data(), huge.size(), oversized));
+    EXPECT_EQ(oversized.size(), 0u);
+
+    BarColumns truncated;
+    EXPECT_FALSE(BarCodec::decode(encoded.data(), encoded.size() - 1, truncated));
+    EXPECT_FALSE(BarCodec::decode("FXBD", 4, truncated));
+
+    std::string path = (testDir / "corrupt.fxb").string();
+    std::ofstream(path, std::ios::binary) << flipped;
+    BarColumns output;
+    EXPECT_FALSE(BarCodec::readFile(path, output));
+    EXPECT_EQ(output.size(), 0u);
+}
+
+TEST_F(BarCodecTest, ChecksumsAreSharedFnv1a) {
+    // Reference values of 64-bit FNV-1a
+    EXPECT_EQ(FileHash::fnv1a("", 0), 0xcbf29ce484222325ULL);
+    EXPECT_EQ(FileHash::fnv1a("a", 1), 0xaf63dc4c8601ec8cULL);
+    EXPECT_EQ(FileHash::fnv1a("ab", 2), FileHash::fnv1a("b", 1, FileHash::fnv1a("a", 1)));
+    // Words first, then the tail byte by byte
+    const char data[] = "0123456789";
+    uint64_t word;
+    std::memcpy(&word, data, sizeof(word));
+    uint64_t expected = FileHash::fnv1a(data + 8, 2, (FileHash::FnvOffsetBasis ^ word) * 1099511628211ULL);
+    EXPECT_EQ(BarCodec::checksum(data, 10), expected);
+}
+
+TEST_F(BarCodecTest, CompressedWeeksReplaceTheRawFiles) {
+    std::ofstream(testDir / "history" / "EURUSD" / "2024-1.csv")
+        << "03.01.2024 00:00:00;1,10000;1,10020;1,09990;1,10010;1,10010;1,10030;1,10000;1,10020;5\n"
+        << "03.01.2024 00:01:00;1,10010;1,10015;1,10005;1,10012;1,10020;1,10025;1,10015;1,10022;3\n"
+        << "bad line\n"
+        << "03.01.2024 01:00:00;1,10012;1,10040;1,10012;1,10030;1,10022;1,10050;1,10022;1,10040;7\n";
+    HistoryCompressor::Settings settings;
+    settings.threads = 2;
+    settings.verify = true;
+    CompressReport report = HistoryCompressor(settings).compress((testDir / "history").string(), (testDir / "compressed").string());
+    EXPECT_EQ(report.files, 1u);
+    EXPECT_EQ(report.bars, 3u);
+    EXPECT_EQ(report.malformedLines, 1u);
+    EXPECT_TRUE(report.failedFiles.empty());
+    ASSERT_TRUE(std::filesystem::exists(testDir / "compressed" / "EURUSD" / "2024-1.fxb"));
+
+    RatesStorageProvider raw((testDir / "history").string());
+    RatesStorageProvider compressed((testDir / "compressed").string());
+    std::tm date = TimeUtils::toUtc(1704240000);
+    BarColumns expected;
+    BarColumns actual;
+    ASSERT_TRUE(raw.readWeekColumns("EUR/USD", date, "H1", expected));
+    ASSERT_TRUE(compressed.readWeekColumns("EUR/USD", date, "H1", actual));
+    expectSame(expected, actual);
+    EXPECT_EQ(compressed.getWeekHistoryBytes("EUR/USD", date), 3 * RatesStorageProvider::RawRowBytes);
+    EXPECT_EQ(compressed.getWeekDataPaths("EUR/USD", date), std::vector<std::string>({ compressed.getCompressedWeekPath("EUR/USD", date) }));
+
+    auto paths = compressed.prepareWeekData(std::vector<std::string>{ "EUR/USD" }, date, AlignmentMode::Union, "m1", (testDir / "prepared").string());
+    ASSERT_TRUE(paths.has_value());
+    std::ifstream prepared(paths.value()[0]);
+    std::string line;
+    size_t lines = 0;
+    while (std::getline(prepared, line)) {
+        lines++;
+    }
+    EXPECT_EQ(lines, 3u);
+}
@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+#include "BarResampler.h"
+#include <vector>
+
+class BarResamplerTest : public ::testing::Test {
+protected:
+    // 2022-04-29 00:00:00 UTC
+    const long long dayStart = 1651190400;
+
+    void addBar(BarColumns& columns, long long timestamp, double open, double high, double low, double close, int volume) {
+        columns.time.push_back(timestamp);
+        columns.bidOpen.push_back(open);
+        columns.bidHigh.push_back(high);
+        columns.bidLow.push_back(low);
+        columns.bidClose.push_back(close);
+        columns.askOpen.push_back(open + 0.0002);
+        columns.askHigh.push_back(high + 0.0002);
+        columns.askLow.push_back(low + 0.0002);
+        columns.askClose.push_back(close + 0.0002);
+        columns.volume.push_back(volume);
+    }
+};
+
+TEST_F(BarResamplerTest, ParseSupportedPeriods) {
+    EXPECT_EQ(BarResampler::parsePeriod("m1").value(), 60);
+    EXPECT_EQ(BarResampler::parsePeriod("m5").value(), 300);
+    EXPECT_EQ(BarResampler::parsePeriod("m15").value(), 900);
+    EXPECT_EQ(BarResampler::parsePeriod("m30").value(), 1800);
+    EXPECT_EQ(BarResampler::parsePeriod("H1").value(), 3600);
+    EXPECT_EQ(BarResampler::parsePeriod("H4").value(), 14400);
+    EXPECT_EQ(BarResampler::parsePeriod("D1").value(), 86400);
+}
+
+TEST_F(BarResamplerTest, ParseInvalidPeriods) {
+    EXPECT_FALSE(BarResampler::parsePeriod("").has_value());
+    EXPECT_FALSE(BarResampler::parsePeriod("m").has_value());
+    EXPECT_FALSE(BarResampler::parsePeriod("m0").has_value());
+    EXPECT_FALSE(BarResampler::parsePeriod("X1").has_value());
+    EXPECT_FALSE(BarResampler::parsePeriod("H1a").has_value());
+    // Counts outside the supported list
+    EXPECT_FALSE(BarResampler::parsePeriod("m7").has_value());
+    EXPECT_FALSE(BarResampler::parsePeriod("H13").has_value());
+    EXPECT_FALSE(BarResampler::parsePeriod("D2").has_value());
+    EXPECT_FALSE(BarResampler::parsePeriod("m01").has_value());
+}
+
+TEST_F(BarResamplerTest, AggregatesM1IntoM5) {
+    BarColumns input;
+    addBar(input, dayStart + 0, 1.10, 1.15, 1.09, 1.12, 1);
+    addBar(input, dayStart + 60, 1.12, 1.20, 1.11, 1.13, 2);
+    addBar(input, dayStart + 120, 1.13, 1.14, 1.05, 1.06, 3);
+    addBar(input, dayStart + 300, 1.06, 1.07, 1.04, 1.05, 4);
+
+    BarResampler resampler(300, 0);
+    BarColumns output;
+    resampler.push(input, output);
+    ASSERT_EQ(output.size(), 1u);
+    resampler.flush(output);
+    ASSERT_EQ(output.size(), 2u);
+
+    EXPECT_EQ(output.time[0], dayStart);
+    EXPECT_DOUBLE_EQ(output.bidOpen[0], 1.10);
+    EXPECT_DOUBLE_EQ(output.bidHigh[0], 1.20);
+    EXPECT_DOUBLE_EQ(output.bidLow[0], 1.05);
+    EXPECT_DOUBLE_EQ(output.bidClose[0], 1.06);
+    EXPECT_DOUBLE_EQ(output.askHigh[0], 1.2002);
+    EXPECT_DOUBLE_EQ(output.askLow[0], 1.0502);
+    EXPECT_EQ(output.volume[0], 6);
+
+    EXPECT_EQ(output.time[1], dayStart + 300);
+    EXPECT_DOUBLE_EQ(output.bidOpen[1], 1.06);
+    EXPECT_EQ(output.volume[1], 4);
+}
+
+TEST_F(BarResamplerTest, GapsProduceNoBars) {
+    BarColumns input;
+    addBar(input, dayStart + 0, 1.0, 1.0, 1.0, 1.0, 1);
+    addBar(input, dayStart + 5 * 3600 + 60, 2.0, 2.0, 2.0, 2.0, 1);
+
+    BarResampler resampler(3600, 0);
+    BarColumns output;
+    resampler.push(input, output);
+    resampler.flush(output);
+
+    ASSERT_EQ(output.size(), 2u);
+    EXPECT_EQ(output.time[0], dayStart);
+    EXPECT_EQ(output.time[1], dayStart + 5 * 3600);
+}
+
+TEST_F(BarResamplerTest, BarCarriesOverBetweenChunks) {
+    BarColumns first;
+    addBar(first, dayStart + 0, 1.0, 1.5, 0.9, 1.1, 1);
+    addBar(first, dayStart + 60, 1.1, 1.2, 0.8, 1.0, 1);
+    BarColumns second;
+    addBar(second, dayStart + 120, 1.0, 1.7, 1.0, 1.3, 1);
+    addBar(second, dayStart + 3600, 1.3, 1.3, 1.3, 1.3, 1);
+
+    BarResampler resampler(3600, 0);
+    BarColumns output;
+    resampler.push(first, output);
+    EXPECT_EQ(output.size(), 0u);
+    resampler.push(second, output);
+    ASSERT_EQ(output.size(), 1u);
+
+    EXPECT_DOUBLE_EQ(output.bidOpen[0], 1.0);
+    EXPECT_DOUBLE_EQ(output.bidHigh[0], 1.7);
+    EXPECT_DOUBLE_EQ(output.bidLow[0], 0.8);
+    EXPECT_DOUBLE_EQ(output.bidClose[0], 1.3);
+    EXPECT_EQ(output.volume[0], 3);
+}
+
+TEST_F(BarResamplerTest, DailyBarsAlignToSessionStart) {
+    // Trading day starts at 22:00 UTC
+    BarResampler resampler(86400, 22 * 3600);
+    BarColumns input;
+    addBar(input, dayStart + 21 * 3600, 1.0, 1.0, 1.0, 1.0, 1);
+    addBar(input, dayStart + 22 * 3600, 2.0, 2.0, 2.0, 2.0, 1);
+    addBar(input, dayStart + 86400 + 21 * 3600 + 59 * 60, 3.0, 3.0, 3.0, 3.0, 1);
+
+    BarColumns output;
+    resampler.push(input, output);
+    resampler.flush(output);
+
+    ASSERT_EQ(output.size(), 2u);
+    EXPECT_EQ(output.time[0], dayStart - 2 * 3600);
+    EXPECT_DOUBLE_EQ(output.bidClose[0], 1.0);
+    EXPECT_EQ(output.time[1], dayStart + 22 * 3600);
+    EXPECT_DOUBLE_EQ(output.bidOpen[1], 2.0);
+    EXPECT_DOUBLE_EQ(output.bidClose[1], 3.0);
+}
+
+TEST_F(BarResamplerTest, H4BarsAlignToSessionStart) {
+    BarResampler resampler(4 * 3600, 22 * 3600);
+    EXPECT_EQ(resampler.bucketOf(dayStart), dayStart - 2 * 3600);
+    EXPECT_EQ(resampler.bucketOf(dayStart + 2 * 3600), dayStart + 2 * 3600);
+    EXPECT_EQ(resampler.bucketOf(dayStart + 5 * 3600 + 59 * 60), dayStart + 2 * 3600);
+}
+
+TEST_F(BarResamplerTest, FlushWithoutInputProducesNothing) {
+    BarResampler resampler(300, 0);
+    BarColumns output;
+    resampler.flush(output);
+    EXPECT_EQ(output.size(), 0u);
+}
+
+TEST_F(BarResamplerTest, KernelsHandleUnalignedLengths) {
+    std::vector<double> values = { 3.0, -1.0, 7.5, 2.0, 9.25, -4.0, 1.0 };
+    std::vector<int> volumes = { 1, 2, 3, 4, 5, 6, 7 };
+    for (size_t count = 1; count <= values.size(); count++) {
+        double expectedMax = values[0];
+        double expectedMin = values[0];
+        long long expectedSum = 0;
+        for (size_t i = 0; i < count; i++) {
+            expectedMax = std::max(expectedMax, values[i]);
+            expectedMin = std::min(expectedMin, values[i]);
+            expectedSum += volumes[i];
+        }
+        EXPECT_DOUBLE_EQ(ColumnKernels::maxOf(values.data(), count), expectedMax);
+        EXPECT_DOUBLE_EQ(ColumnKernels::minOf(values.data(), count), expectedMin);
+        EXPECT_EQ(ColumnKernels::sumOf(volumes.data(), count), expectedSum);
+    }
+}
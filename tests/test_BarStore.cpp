@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include "BarStore.h"
+#include "RatesStorageProvider.h"
+#include "TimeUtils.h"
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+class BarStoreTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        testDir = std::filesystem::temp_directory_path() / "bar_store_test";
+        std::filesystem::remove_all(testDir);
+        std::filesystem::create_directories(testDir / "history");
+    }
+
+    void TearDown() override {
+        try {
+            std::filesystem::remove_all(testDir);
+        } catch (const std::exception&) {
+            // Ignore cleanup errors
+        }
+    }
+
+    static long long at(int year, int month, int day, int hour = 0, int minute = 0) {
+        std::tm date{};
+        date.tm_year = year - 1900;
+        date.tm_mon = month - 1;
+        date.tm_mday = day;
+        date.tm_hour = hour;
+        date.tm_min = minute;
+        return TimeUtils::toEpochSeconds(date);
+    }
+
+    // count m1 bars from start, the close is the row number
+    static BarColumns minutes(long long start, size_t count) {
+        BarColumns bars;
+        for (size_t i = 0; i < count; i++) {
+            Data data{};
+            double value = static_cast<double>(i);
+            data.bid = { value, value, value, value };
+            data.ask = data.bid;
+            data.volume = 1;
+            bars.push(start + static_cast<long long>(i) * 60, data);
+        }
+        return bars;
+    }
+
+    std::filesystem::path testDir;
+};
+
+TEST_F(BarStoreTest, AppendSplitsYearsAndIndexesEveryStride) {
+    BarStore store((testDir / "X").string());
+    ASSERT_TRUE(store.append(minutes(at(2023, 12, 31, 23, 58), 2 + 3000)));
+    EXPECT_EQ(store.years(), (std::vector<int>{ 2023, 2024 }));
+    EXPECT_EQ(store.size(), 3002u);
+    EXPECT_EQ(store.lastTime().value(), at(2024, 1, 1) + 2999 * 60);
+    EXPECT_EQ(std::filesystem::file_size(testDir / "X" / "2024" / "time.idx"), 3 * sizeof(long long));
+
+    // Index entries continue across appends and are rebuilt when lost
+    ASSERT_TRUE(store.append(minutes(at(2024, 1, 1) + 3000 * 60, 100)));
+    EXPECT_EQ(std::filesystem::file_size(testDir / "X" / "2024" / "time.idx"), 4 * sizeof(long long));
+    std::filesystem::remove(testDir / "X" / "2024" / "time.idx");
+    store.repair();
+    EXPECT_EQ(std::filesystem::file_size(testDir / "X" / "2024" / "time.idx"), 4 * sizeof(long long));
+
+    BarColumns all;
+    ASSERT_TRUE(store.read(all));
+    ASSERT_EQ(all.size(), 3102u);
+    EXPECT_EQ(all.time[2], at(2024, 1, 1));
+}
+
+TEST_F(BarStoreTest, SeekFindsRowsThroughTheSparseIndex) {
+    long long start = at(2024, 3, 1);
+    BarStore((testDir / "X").string()).append(minutes(start, 5000));
+    BarStoreReader reader((testDir / "X").string());
+    EXPECT_EQ(reader.seek(2024, start - 60), 0u);
+    EXPECT_EQ(reader.seek(2024, start + 1024 * 60), 1024u);
+    EXPECT_EQ(reader.seek(2024, start + 2500 * 60), 2500u);
+    EXPECT_EQ(reader.seek(2024, start + 2500 * 60 + 30), 2501u);
+    EXPECT_EQ(reader.seek(2024, start + 4999 * 60), 4999u);
+    EXPECT_EQ(reader.seek(2024, start + 6000 * 60), 5000u);
+}
+
+TEST_F(BarStoreTest, RangeReturnsSpansIntoTheMappedYears) {
+    BarStore((testDir / "X").string()).append(minutes(at(2023, 12, 31, 23, 0), 120));
+    BarStoreReader reader((testDir / "X").string());
+
+    auto spans = reader.range(at(2023, 12, 31, 23, 30), at(2024, 1, 1, 0, 10));
+    ASSERT_EQ(spans.size(), 2u);
+    EXPECT_EQ(spans[0].count, 30u);
+    EXPECT_EQ(spans[0].time[0], at(2023, 12, 31, 23, 30));
+    EXPECT_DOUBLE_EQ(spans[0].bidClose[0], 30.0);
+    EXPECT_EQ(spans[1].count, 10u);
+    EXPECT_EQ(spans[1].volume[9], 1);
+    // Same memory on every call, nothing is copied
+    EXPECT_EQ(reader.range(at(2024, 1, 1), at(2024, 1, 2))[0].time, spans[1].time);
+
+    EXPECT_TRUE(reader.range(at(2022, 1, 1), at(2023, 1, 1)).empty());
+    BarColumns copy;
+    EXPECT_EQ(reader.read(at(2024, 1, 1, 0, 50), at(2025, 1, 1), copy), 10u);
+    EXPECT_DOUBLE_EQ(copy.bidClose.back(), 119.0);
+}
+
+TEST_F(BarStoreTest, ProviderReadsWeeksFromTheStore) {
+    BarColumns bars = minutes(at(2024, 1, 3), 2);
+    BarColumns later = minutes(at(2024, 1, 3, 1), 1);
+    BarColumns nextWeek = minutes(at(2024, 1, 9), 1);
+    BarStore store((testDir / "store" / "EURUSD").string());
+    ASSERT_TRUE(store.append(bars));
+    ASSERT_TRUE(store.append(later));
+    ASSERT_TRUE(store.append(nextWeek));
+
+    RatesStorageProvider provider((testDir / "history").string());
+    std::tm date = TimeUtils::toUtc(at(2024, 1, 3));
+    BarColumns output;
+    EXPECT_FALSE(provider.readWeekColumns("EUR/USD", date, "m1", output));
+    provider.setBarStore((testDir / "store").string());
+    ASSERT_TRUE(provider.readWeekColumns("EUR/USD", date, "m1", output));
+    EXPECT_EQ(output.size(), 3u);
+
+    BarColumns hourly;
+    ASSERT_TRUE(provider.readWeekColumns("EUR/USD", date, "H1", hourly));
+    ASSERT_EQ(hourly.size(), 2u);
+    EXPECT_DOUBLE_EQ(hourly.bidClose[0], 1.0);
+    // Symbols without a store still come from their week files
+    EXPECT_FALSE(provider.readWeekColumns("USD/JPY", date, "m1", output));
+}
+
+TEST_F(BarStoreTest, WeekDataPathsAreTheFilesOfTheStoreYear) {
+    BarStore store((testDir / "store" / "EURUSD").string());
+    ASSERT_TRUE(store.append(minutes(at(2024, 1, 3), 2)));
+    RatesStorageProvider provider((testDir / "history").string());
+    std::tm date = TimeUtils::toUtc(at(2024, 1, 3));
+    auto paths = provider.getWeekDataPaths("EUR/USD", date);
+    ASSERT_EQ(paths.size(), 1u);
+    EXPECT_EQ(paths[0], provider.getWeekSourcePath("EUR/USD", date));
+
+    EXPECT_EQ(provider.getWeekHistoryBytes("EUR/USD", date), 0u);
+
+    provider.setBarStore((testDir / "store").string());
+    EXPECT_EQ(provider.getWeekHistoryBytes("EUR/USD", date), 2 * RatesStorageProvider::RawRowBytes);
+    paths = provider.getWeekDataPaths("EUR/USD", date);
+    EXPECT_EQ(paths.size(), 11u);
+    for (const auto& path : paths) {
+        EXPECT_EQ(std::filesystem::path(path).parent_path(), testDir / "store" / "EURUSD" / "2024");
+    }
+}
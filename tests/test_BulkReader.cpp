@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include "BulkReader.h"
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class BulkReaderTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        testDir = std::filesystem::temp_directory_path() / "bulk_reader_test";
+        std::filesystem::remove_all(testDir);
+        std::filesystem::create_directories(testDir);
+        // Empty, within one block, exactly one block and spanning several blocks of 4 KB
+        for (size_t size : { 0, 1, 100, 4095, 4096, 4097, 3 * 4096 + 7, 50000 }) {
+            for (int copy = 0; copy < 4; copy++) {
+                std::string content;
+                for (size_t i = 0; i < size; i++) {
+                    content.push_back(static_cast<char>('a' + (i * 7 + size + copy) % 26));
+                }
+                std::string path = (testDir / (std::to_string(size) + "-" + std::to_string(copy) + ".csv")).string();
+                std::ofstream(path, std::ios::binary) << content;
+                paths.push_back(path);
+                contents.push_back(content);
+            }
+        }
+        paths.push_back((testDir / "missing.csv").string());
+    }
+
+    void TearDown() override {
+        try {
+            std::filesystem::remove_all(testDir);
+        } catch (const std::exception&) {
+            // Ignore cleanup errors
+        }
+    }
+
+    void expectAllRead(IoBackend backend) {
+        BulkReader::Settings settings;
+        settings.backend = backend;
+        settings.queueDepth = 4;
+        settings.blockBytes = 4096;
+        settings.parserThreads = 3;
+        std::mutex mutex;
+        std::vector<std::string> read(paths.size());
+        std::vector<int> calls(paths.size(), 0);
+        std::vector<bool> ok(paths.size(), false);
+        IoBackend used = BulkReader(settings).read(paths, [&](size_t index, const char* data, size_t size, bool success) {
+            std::lock_guard<std::mutex> lock(mutex);
+            read[index].assign(data, size);
+            calls[index]++;
+            ok[index] = success;
+        });
+        if (backend == IoBackend::Pread || !BulkReader::ioUringAvailable()) {
+            EXPECT_EQ(used, IoBackend::Pread);
+        } else {
+            EXPECT_EQ(used, IoBackend::IoUring);
+        }
+        for (size_t i = 0; i < contents.size(); i++) {
+            EXPECT_EQ(calls[i], 1) << paths[i];
+            EXPECT_TRUE(ok[i]) << paths[i];
+            EXPECT_EQ(read[i], contents[i]) << paths[i];
+        }
+        EXPECT_EQ(calls.back(), 1);
+        EXPECT_FALSE(ok.back());
+    }
+
+    std::filesystem::path testDir;
+    std::vector<std::string> paths;
+    std::vector<std::string> contents;
+};
+
+TEST_F(BulkReaderTest, PreadBackendReadsEveryFile) {
+    expectAllRead(IoBackend::Pread);
+}
+
+TEST_F(BulkReaderTest, IoUringBackendReadsEveryFileOrFallsBack) {
+    expectAllRead(IoBackend::IoUring);
+    expectAllRead(IoBackend::Auto);
+}
+
+TEST_F(BulkReaderTest, BackendNamesRoundTrip) {
+    for (IoBackend backend : { IoBackend::Auto, IoBackend::IoUring, IoBackend::Pread }) {
+        EXPECT_EQ(BulkReader::parse(BulkReader::name(backend)), backend);
+    }
+    EXPECT_FALSE(BulkReader::parse("aio").has_value());
+}
+
+TEST_F(BulkReaderTest, MemoryStreamReadsLines) {
+    std::string text = "first\nsecond";
+    MemoryStream input(text.data(), text.size());
+    std::string line;
+    ASSERT_TRUE(std::getline(input, line));
+    EXPECT_EQ(line, "first");
+    ASSERT_TRUE(std::getline(input, line));
+    EXPECT_EQ(line, "second");
+    EXPECT_FALSE(std::getline(input, line));
+}
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include "ConcurrencyController.h"
+#include "SystemSampler.h"
+#include <atomic>
+#include <thread>
+
+namespace {
+    ConcurrencyController::Settings bounds(size_t minWorkers, size_t maxWorkers) {
+        ConcurrencyController::Settings settings;
+        settings.minWorkers = minWorkers;
+        settings.maxWorkers = maxWorkers;
+        settings.cooldownSamples = 2;
+        return settings;
+    }
+
+    ConcurrencyController::Sample sample(double throughput, double cpuBusy, double availableMemoryMb = 8192.0) {
+        ConcurrencyController::Sample result;
+        result.throughput = throughput;
+        result.cpuBusy = cpuBusy;
+        result.availableMemoryMb = availableMemoryMb;
+        return result;
+    }
+}
+
+TEST(ConcurrencyControllerTest, InitialCountIsClampedToBounds) {
+    EXPECT_EQ(ConcurrencyController(bounds(2, 4), 8).limit(), 4u);
+    EXPECT_EQ(ConcurrencyController(bounds(2, 4), 1).limit(), 2u);
+}
+
+TEST(ConcurrencyControllerTest, RaisesWhileCpuIsLeftOverUpToMax) {
+    ConcurrencyController controller(bounds(1, 3), 1);
+    EXPECT_EQ(controller.update(sample(1.0, 0.3)).to, 2u);
+    EXPECT_EQ(controller.update(sample(2.0, 0.6)).to, 3u);
+    auto decision = controller.update(sample(3.0, 0.7));
+    EXPECT_EQ(decision.from, 3u);
+    EXPECT_EQ(decision.to, 3u);
+}
+
+TEST(ConcurrencyControllerTest, HoldsWhenCpuIsSaturated) {
+    ConcurrencyController controller(bounds(1, 8), 4);
+    auto decision = controller.update(sample(4.0, 0.97));
+    EXPECT_EQ(decision.to, 4u);
+    EXPECT_EQ(decision.reason, "CPU saturated");
+}
+
+TEST(ConcurrencyControllerTest, LowersWhenMemoryRunsLow) {
+    ConcurrencyController controller(bounds(1, 8), 4);
+    EXPECT_EQ(controller.update(sample(4.0, 0.5, 100.0)).to, 3u);
+    EXPECT_EQ(controller.update(sample(4.0, 0.5, 100.0)).to, 2u);
+}
+
+TEST(ConcurrencyControllerTest, UndoesRaiseThatHurtThroughputAndCoolsDown) {
+    ConcurrencyController controller(bounds(1, 8), 4);
+    EXPECT_EQ(controller.update(sample(4.0, 0.8)).to, 5u);
+    auto decision = controller.update(sample(3.0, 0.8));
+    EXPECT_EQ(decision.to, 4u);
+    EXPECT_EQ(decision.reason, "throughput dropped after raising");
+    // Two cooldown samples keep the count even though CPU is left over
+    EXPECT_EQ(controller.update(sample(4.0, 0.8)).to, 4u);
+    EXPECT_EQ(controller.update(sample(4.0, 0.8)).to, 4u);
+    EXPECT_EQ(controller.update(sample(4.0, 0.8)).to, 5u);
+}
+
+TEST(ConcurrencyControllerTest, WorkersAboveLimitWaitUntilRaisedOrClosed) {
+    ConcurrencyController controller(bounds(1, 2), 1);
+    EXPECT_TRUE(controller.waitForSlot(0));
+    std::atomic<bool> released(false);
+    std::thread worker([&]() {
+        EXPECT_TRUE(controller.waitForSlot(1));
+        released = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(released);
+    controller.update(sample(1.0, 0.1));
+    worker.join();
+    EXPECT_TRUE(released);
+
+    controller.close();
+    EXPECT_FALSE(controller.waitForSlot(5));
+    EXPECT_TRUE(controller.waitClosed(std::chrono::milliseconds(1)));
+}
+
+TEST(SystemSamplerTest, ParsesProcStat) {
+    auto times = SystemSampler::parseProcStat("cpu  100 10 50 800 40 0 0 0 0 0\ncpu0 50 5 25 400 20 0 0 0 0 0\n");
+    ASSERT_TRUE(times.has_value());
+    EXPECT_EQ(times->total, 1000u);
+    EXPECT_EQ(times->ioWait, 40u);
+    EXPECT_EQ(times->busy, 160u);
+    EXPECT_FALSE(SystemSampler::parseProcStat("intr 1 2 3\n").has_value());
+}
+
+TEST(SystemSamplerTest, ParsesMemAvailable) {
+    auto available = SystemSampler::parseMemInfo("MemTotal:       16384000 kB\nMemFree:         1024000 kB\nMemAvailable:    2048000 kB\n");
+    ASSERT_TRUE(available.has_value());
+    EXPECT_DOUBLE_EQ(available.value(), 2000.0);
+    EXPECT_FALSE(SystemSampler::parseMemInfo("MemTotal: 1 kB\n").has_value());
+}
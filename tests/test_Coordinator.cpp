@@ -0,0 +1,301 @@
+#include <gtest/gtest.h>
+#include "Coordinator.h"
+#include "WorkerClient.h"
+#include "JobPlanner.h"
+#include "TaskExecutor.h"
+#include "TimeUtils.h"
+#include "SocketChannel.h"
+#include <cerrno>
+#include <fstream>
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+TEST(LeaseTableTest, TasksAreLeasedInShards) {
+    LeaseTable table(5, 2, 1000ms);
+    auto now = LeaseTable::Clock::now();
+    auto first = table.acquire("a", now);
+    auto second = table.acquire("b", now);
+    auto third = table.acquire("a", now);
+    ASSERT_TRUE(first.has_value() && second.has_value() && third.has_value());
+    EXPECT_EQ(first.value().tasks, std::vector<size_t>({ 0, 1 }));
+    EXPECT_EQ(second.value().tasks, std::vector<size_t>({ 2, 3 }));
+    EXPECT_EQ(third.value().tasks, std::vector<size_t>({ 4 }));
+    EXPECT_FALSE(table.acquire("b", now).has_value());
+}
+
+TEST(LeaseTableTest, ExpiredLeaseIsReassigned) {
+    LeaseTable table(4, 4, 1000ms);
+    auto now = LeaseTable::Clock::now();
+    auto lease = table.acquire("dead", now).value();
+    EXPECT_TRUE(table.finish(lease.id, 0));
+
+    EXPECT_TRUE(table.expire(now + 500ms).empty());
+    auto expired = table.expire(now + 1000ms);
+    ASSERT_EQ(expired.size(), 1u);
+    EXPECT_EQ(expired[0].worker, "dead");
+
+    // Only the unfinished tasks go to the next worker
+    auto reassigned = table.acquire("alive", now + 1000ms);
+    ASSERT_TRUE(reassigned.has_value());
+    EXPECT_EQ(reassigned.value().tasks, std::vector<size_t>({ 1, 2, 3 }));
+}
+
+TEST(LeaseTableTest, HeartbeatExtendsLease) {
+    LeaseTable table(1, 1, 1000ms);
+    auto now = LeaseTable::Clock::now();
+    table.acquire("a", now);
+    table.heartbeat("a", now + 800ms);
+    EXPECT_TRUE(table.expire(now + 1500ms).empty());
+    EXPECT_EQ(table.expire(now + 1800ms).size(), 1u);
+}
+
+TEST(LeaseTableTest, DuplicateResultIsDropped) {
+    LeaseTable table(2, 2, 1000ms);
+    auto now = LeaseTable::Clock::now();
+    auto slow = table.acquire("slow", now).value();
+    table.expire(now + 2000ms);
+    auto fast = table.acquire("fast", now + 2000ms).value();
+
+    EXPECT_TRUE(table.finish(fast.id, 0));
+    // The late result of the expired lease still counts for the task nobody finished yet
+    EXPECT_FALSE(table.finish(slow.id, 0));
+    EXPECT_TRUE(table.finish(slow.id, 1));
+    EXPECT_FALSE(table.finish(fast.id, 1));
+    EXPECT_TRUE(table.isFinished());
+}
+
+TEST(LeaseTableTest, ReleaseRequeuesWorkerLeases) {
+    LeaseTable table(2, 1, 1000ms);
+    auto now = LeaseTable::Clock::now();
+    table.acquire("a", now);
+    table.acquire("b", now);
+    EXPECT_EQ(table.release("a").size(), 1u);
+    auto lease = table.acquire("b", now);
+    ASSERT_TRUE(lease.has_value());
+    EXPECT_EQ(lease.value().tasks, std::vector<size_t>({ 0 }));
+}
+
+#ifndef _WIN32
+
+class CoordinatorTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        testDir = std::filesystem::temp_directory_path() / "coordinator_test";
+        historyDir = testDir / "history";
+        backtesterDir = testDir / "backtester";
+        std::filesystem::create_directories(historyDir / "EURUSD");
+        std::filesystem::create_directories(backtesterDir);
+        std::ofstream info(historyDir / "EURUSD" / "info.json");
+        info << "{\"Name\": \"EURUSD\", \"ContractCurrency\": \"EUR\", \"ProfitCurrency\": \"USD\"}";
+        info.close();
+        std::ofstream week(historyDir / "EURUSD" / "2000-1.csv");
+        week << "03.01.2000 10:00:00;1,1;1,2;1,0;1,1;1,1;1,2;1,0;1,1;5\n";
+        week.close();
+        // Stand-in backtester that writes the statistics file given after /so
+        std::filesystem::path script = backtesterDir / "ConsoleBacktester.exe";
+        std::ofstream file(script);
+        file << "#!/bin/sh\necho \"profit=1\" > \"$5\"\n";
+        file.close();
+        std::filesystem::permissions(script, std::filesystem::perms::owner_all);
+    }
+
+    void TearDown() override {
+        try {
+            std::filesystem::remove_all(testDir);
+        } catch (const std::exception&) {
+            // Ignore cleanup errors
+        }
+    }
+
+    std::vector<BacktestTask> planTasks(RatesStorageProvider& provider, SweepSpec& spec, size_t windowCount) {
+        spec.strategy = "MA_Cross_Strategy";
+        spec.portfolios = { { "EUR/USD" } };
+        spec.parameters = { { "Fast", { "5", "10" } } };
+        JobPlanner planner(provider);
+        auto windows = JobPlanner::planWindows(std::time(nullptr));
+        windows.resize(windowCount);
+        return JobPlanner::planTasks(planner.planSweep(spec).value(), windows);
+    }
+
+    std::filesystem::path testDir;
+    std::filesystem::path historyDir;
+    std::filesystem::path backtesterDir;
+};
+
+TEST_F(CoordinatorTest, WorkersOnLocalhostCompleteTheSweep) {
+    RatesStorageProvider provider(historyDir.string());
+    SweepSpec spec;
+    auto tasks = planTasks(provider, spec, 3);
+    std::stringstream results;
+    Coordinator coordinator(spec, tasks, historyDir.string(), provider, 2, 5000ms, results);
+    ASSERT_TRUE(coordinator.listen(0));
+
+    size_t completed = 0;
+    std::thread server([&]() { completed = coordinator.run(); });
+    std::vector<int> exitCodes(2, -1);
+    std::vector<std::thread> workers;
+    for (int i = 0; i < 2; i++) {
+        workers.emplace_back([&, i]() {
+            WorkerClient client("127.0.0.1", coordinator.port(), "worker-" + std::to_string(i), backtesterDir.string(), "coordinator_test_" + std::to_string(i));
+            exitCodes[i] = client.run();
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    server.join();
+
+    EXPECT_EQ(exitCodes, std::vector<int>({ 0, 0 }));
+    // Only the first week has history, for both parameter sets
+    EXPECT_EQ(completed, 2u);
+    size_t lines = 0;
+    std::string line;
+    while (std::getline(results, line)) {
+        nlohmann::json result = nlohmann::json::parse(line);
+        if (result["completed"].get<bool>()) {
+            EXPECT_EQ(result["stats"], "profit=1\n");
+            EXPECT_EQ(result["symbols"], "EUR/USD");
+        }
+        lines++;
+    }
+    EXPECT_EQ(lines, tasks.size());
+}
+
+TEST_F(CoordinatorTest, WorkersUseTheSessionStartOfTheCoordinator) {
+    RatesStorageProvider provider(historyDir.string());
+    provider.setSessionOffset(-7 * 3600);
+    SweepSpec spec;
+    auto tasks = planTasks(provider, spec, 1);
+    std::stringstream results;
+    Coordinator coordinator(spec, tasks, historyDir.string(), provider, 4, 5000ms, results);
+    ASSERT_TRUE(coordinator.listen(0));
+    std::thread server([&]() { coordinator.run(); });
+
+    {
+        SocketChannel probe(SocketChannel::connectTcp("127.0.0.1", coordinator.port()));
+        ASSERT_TRUE(probe.sendLine("{\"command\":\"hello\",\"worker\":\"probe\"}"));
+        auto welcome = probe.readLine();
+        ASSERT_TRUE(welcome.has_value());
+        EXPECT_EQ(nlohmann::json::parse(welcome.value())["sessionStartMinutes"], -420);
+        EXPECT_TRUE(nlohmann::json::parse(welcome.value())["barStore"].is_null());
+    }
+
+    auto sharedData = std::make_shared<WorkerClient::SharedData>();
+    WorkerClient client("127.0.0.1", coordinator.port(), "worker", backtesterDir.string(), "coordinator_test_session", sharedData);
+    EXPECT_EQ(client.run(), 0);
+    server.join();
+    EXPECT_EQ(sharedData->ratesStorageProvider->getSessionOffset(), -7 * 3600);
+}
+
+TEST_F(CoordinatorTest, TasksOfDisconnectedWorkerAreReassigned) {
+    RatesStorageProvider provider(historyDir.string());
+    SweepSpec spec;
+    auto tasks = planTasks(provider, spec, 2);
+    std::stringstream results;
+    Coordinator coordinator(spec, tasks, historyDir.string(), provider, 4, 5000ms, results);
+    ASSERT_TRUE(coordinator.listen(0));
+    size_t completed = 0;
+    std::thread server([&]() { completed = coordinator.run(); });
+
+    {
+        // Takes the only shard and vanishes without reporting anything
+        SocketChannel dead(SocketChannel::connectTcp("127.0.0.1", coordinator.port()));
+        ASSERT_TRUE(dead.sendLine("{\"command\":\"hello\",\"worker\":\"dead\"}"));
+        ASSERT_TRUE(dead.readLine().has_value());
+        ASSERT_TRUE(dead.sendLine("{\"command\":\"lease\"}"));
+        auto lease = dead.readLine();
+        ASSERT_TRUE(lease.has_value());
+        nlohmann::json leased = nlohmann::json::parse(lease.value());
+        EXPECT_EQ(leased["tasks"].size(), tasks.size());
+        // Workers rebuild the calendar date of the week, whatever their time zone
+        auto date = TimeUtils::fromFields(leased["tasks"][0]["date"].get<std::vector<int>>());
+        ASSERT_TRUE(date.has_value());
+        EXPECT_EQ(date.value().tm_year, tasks[0].window.start.tm_year);
+        EXPECT_EQ(date.value().tm_yday, tasks[0].window.start.tm_yday);
+    }
+
+    WorkerClient client("127.0.0.1", coordinator.port(), "alive", backtesterDir.string(), "coordinator_test_alive");
+    EXPECT_EQ(client.run(), 0);
+    server.join();
+    EXPECT_EQ(completed, 2u);
+}
+
+TEST_F(CoordinatorTest, WorkerRejectsChangedHistory) {
+    RatesStorageProvider provider(historyDir.string());
+    SweepSpec spec;
+    auto tasks = planTasks(provider, spec, 1);
+    std::stringstream results;
+    Coordinator coordinator(spec, tasks, historyDir.string(), provider, 2, 5000ms, results);
+    ASSERT_TRUE(coordinator.listen(0));
+    std::thread server([&]() { coordinator.run(); });
+
+    {
+        // The coordinator hashes the file when handing out the first lease
+        SocketChannel probe(SocketChannel::connectTcp("127.0.0.1", coordinator.port()));
+        probe.sendLine("{\"command\":\"hello\",\"worker\":\"probe\"}");
+        probe.readLine();
+        probe.sendLine("{\"command\":\"lease\"}");
+        probe.readLine();
+    }
+    std::ofstream week(historyDir / "EURUSD" / "2000-1.csv", std::ios::app);
+    week << "03.01.2000 10:01:00;1,1;1,2;1,0;1,1;1,1;1,2;1,0;1,1;5\n";
+    week.close();
+
+    WorkerClient client("127.0.0.1", coordinator.port(), "worker", backtesterDir.string(), "coordinator_test_changed");
+    EXPECT_EQ(client.run(), 0);
+    server.join();
+    std::string line;
+    ASSERT_TRUE(std::getline(results, line));
+    nlohmann::json result = nlohmann::json::parse(line);
+    EXPECT_FALSE(result["completed"].get<bool>());
+    EXPECT_NE(result["message"].get<std::string>().find("differs"), std::string::npos);
+}
+
+TEST_F(CoordinatorTest, FailingBacktesterIsNotCompleted) {
+    std::ofstream file(backtesterDir / "ConsoleBacktester.exe", std::ios::trunc);
+    file << "#!/bin/sh\necho \"profit=1\" > \"$5\"\nexit 3\n";
+    file.close();
+    RatesStorageProvider provider(historyDir.string());
+    SweepSpec spec;
+    auto tasks = planTasks(provider, spec, 1);
+    PreparedDataCache preparedData(provider);
+    TaskExecutor executor(preparedData);
+    ConsoleBacktester backtester(backtesterDir.string(), "coordinator_test_failing");
+    TaskResult result = executor.execute(tasks[0], backtester);
+    EXPECT_FALSE(result.completed);
+    EXPECT_EQ(result.backtest.exitCode, 3);
+    EXPECT_EQ(result.message, "backtester exited with code 3");
+}
+
+TEST(SocketChannelTest, UnixSocketOfARunningDaemonIsKept) {
+    std::string path = (std::filesystem::temp_directory_path() / "socket_channel_test.sock").string();
+    std::filesystem::remove(path);
+    int first = SocketChannel::listenUnix(path);
+    ASSERT_GE(first, 0);
+    EXPECT_EQ(SocketChannel::listenUnix(path), -1);
+    EXPECT_EQ(errno, EADDRINUSE);
+    SocketChannel client(SocketChannel::connectUnix(path));
+    EXPECT_TRUE(client.isOpen());
+    client.close();
+
+    // Closed without removing the file, as after a crash
+    SocketChannel::closeDescriptor(first);
+    ASSERT_TRUE(std::filesystem::exists(path));
+    int second = SocketChannel::listenUnix(path);
+    EXPECT_GE(second, 0);
+    SocketChannel::closeDescriptor(second);
+
+    // Anything but a socket is left alone
+    std::filesystem::remove(path);
+    std::ofstream(path) << "not a socket";
+    EXPECT_EQ(SocketChannel::listenUnix(path), -1);
+    EXPECT_EQ(errno, EEXIST);
+    EXPECT_TRUE(std::filesystem::exists(path));
+    std::filesystem::remove(path);
+}
+
+#endif
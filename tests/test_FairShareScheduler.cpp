@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include "FairShareScheduler.h"
+#include <thread>
+
+namespace {
+    std::vector<BacktestTask> createTasks(size_t count) {
+        auto job = std::make_shared<const BacktestJob>();
+        std::vector<BacktestTask> tasks(count);
+        for (size_t i = 0; i < count; i++) {
+            tasks[i].job = job;
+            tasks[i].window.startTime = static_cast<long long>(i) * 604800;
+        }
+        return tasks;
+    }
+
+    TaskResult completedResult() {
+        TaskResult result;
+        result.completed = true;
+        return result;
+    }
+}
+
+TEST(FairShareSchedulerTest, SubmissionIdsAreUnique) {
+    FairShareScheduler scheduler;
+    size_t first = scheduler.submit("alice", createTasks(1));
+    size_t second = scheduler.submit("alice", createTasks(1));
+    EXPECT_NE(first, second);
+    EXPECT_EQ(scheduler.status().size(), 2u);
+}
+
+TEST(FairShareSchedulerTest, TasksOfOneSubmissionKeepTheirOrder) {
+    FairShareScheduler scheduler;
+    size_t id = scheduler.submit("alice", createTasks(3));
+    for (size_t i = 0; i < 3; i++) {
+        auto task = scheduler.next();
+        ASSERT_TRUE(task.has_value());
+        EXPECT_EQ(task.value().submission, id);
+        EXPECT_EQ(task.value().index, i);
+        scheduler.complete(task.value(), completedResult());
+    }
+}
+
+TEST(FairShareSchedulerTest, LargeSweepDoesNotStarveOtherOwners) {
+    FairShareScheduler scheduler;
+    size_t large = scheduler.submit("alice", createTasks(100));
+    auto first = scheduler.next();
+    ASSERT_TRUE(first.has_value());
+    EXPECT_EQ(first.value().submission, large);
+
+    // While alice has a task running, bob's submission goes next
+    size_t small = scheduler.submit("bob", createTasks(2));
+    auto second = scheduler.next();
+    ASSERT_TRUE(second.has_value());
+    EXPECT_EQ(second.value().submission, small);
+
+    // Once both were served equally, the owners take turns
+    scheduler.complete(first.value(), completedResult());
+    scheduler.complete(second.value(), completedResult());
+    auto third = scheduler.next();
+    auto fourth = scheduler.next();
+    ASSERT_TRUE(third.has_value() && fourth.has_value());
+    EXPECT_NE(third.value().submission, fourth.value().submission);
+}
+
+TEST(FairShareSchedulerTest, WaitForResultsReturnsResultsBeyondCursor) {
+    FairShareScheduler scheduler;
+    size_t id = scheduler.submit("alice", createTasks(2));
+    scheduler.complete(scheduler.next().value(), completedResult());
+
+    FairShareScheduler::Results results;
+    auto status = scheduler.waitForResults(id, 0, results, std::chrono::milliseconds(0));
+    ASSERT_TRUE(status.has_value());
+    EXPECT_EQ(results.size(), 1u);
+    EXPECT_EQ(status.value().finished, 1u);
+    EXPECT_EQ(status.value().total, 2u);
+
+    results.clear();
+    scheduler.waitForResults(id, 1, results, std::chrono::milliseconds(0));
+    EXPECT_TRUE(results.empty());
+    EXPECT_FALSE(scheduler.waitForResults(id + 1, 0, results, std::chrono::milliseconds(0)).has_value());
+}
+
+TEST(FairShareSchedulerTest, IdleCallbackRunsWhenAllWorkIsDone) {
+    FairShareScheduler scheduler;
+    int idleCount = 0;
+    scheduler.setIdleCallback([&idleCount]() { idleCount++; });
+    scheduler.submit("alice", createTasks(2));
+    auto first = scheduler.next().value();
+    auto second = scheduler.next().value();
+    scheduler.complete(first, completedResult());
+    EXPECT_EQ(idleCount, 0);
+    scheduler.complete(second, completedResult());
+    EXPECT_EQ(idleCount, 1);
+}
+
+TEST(FairShareSchedulerTest, ShutdownReleasesWaitingWorkers) {
+    FairShareScheduler scheduler;
+    std::optional<FairShareScheduler::ScheduledTask> task = FairShareScheduler::ScheduledTask();
+    std::thread worker([&]() { task = scheduler.next(); });
+    scheduler.shutdown();
+    worker.join();
+    EXPECT_FALSE(task.has_value());
+}
+
+TEST(FairShareSchedulerTest, ReleasedSubmissionsExpire) {
+    FairShareScheduler scheduler;
+    size_t id = scheduler.submit("alice", createTasks(1));
+    scheduler.release(id);
+    EXPECT_EQ(scheduler.status().size(), 1u);
+
+    scheduler.complete(scheduler.next().value(), completedResult());
+    scheduler.release(id);
+    FairShareScheduler::Results results;
+    EXPECT_FALSE(scheduler.waitForResults(id, 0, results, std::chrono::milliseconds(0)).has_value());
+    EXPECT_TRUE(scheduler.isExpired(id));
+    EXPECT_FALSE(scheduler.isExpired(id + 1));
+}
+
+TEST(FairShareSchedulerTest, FinishedSubmissionsAreDroppedAfterRetention) {
+    FairShareScheduler scheduler(std::chrono::seconds(0));
+    size_t first = scheduler.submit("alice", createTasks(1));
+    scheduler.complete(scheduler.next().value(), completedResult());
+    size_t second = scheduler.submit("alice", createTasks(1));
+    EXPECT_TRUE(scheduler.isExpired(first));
+    EXPECT_FALSE(scheduler.isExpired(second));
+    EXPECT_EQ(scheduler.status().size(), 1u);
+}
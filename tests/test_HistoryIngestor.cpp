@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+#include "HistoryIngestor.h"
+#include "BarStore.h"
+#include "IndicatorCache.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+class HistoryIngestorTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        testDir = std::filesystem::temp_directory_path() / "history_ingestor_test";
+        historyDir = testDir / "history";
+        storeDir = testDir / "store";
+        std::filesystem::remove_all(testDir);
+        std::filesystem::create_directories(historyDir / "EURUSD");
+        std::filesystem::create_directories(historyDir / "USDJPY");
+    }
+
+    void TearDown() override {
+        try {
+            std::filesystem::remove_all(testDir);
+        } catch (const std::exception&) {
+            // Ignore cleanup errors
+        }
+    }
+
+    void write(const std::string& file, const std::string& content, bool append = false) {
+        std::ofstream output(historyDir / file, append ? std::ios::app : std::ios::trunc);
+        output << content;
+    }
+
+    static std::string bar(int day, const std::string& time, const std::string& bid) {
+        std::ostringstream line;
+        line << (day < 10 ? "0" : "") << day << ".01.2024 " << time << ";" << bid << ";" << bid << ";" << bid << ";" << bid << ";"
+             << bid << ";" << bid << ";" << bid << ";" << bid << ";1\n";
+        return line.str();
+    }
+
+    BarColumns stored(const std::string& symbol) {
+        BarColumns bars;
+        BarStore((storeDir / symbol).string()).read(bars);
+        return bars;
+    }
+
+    std::filesystem::path testDir;
+    std::filesystem::path historyDir;
+    std::filesystem::path storeDir;
+};
+
+TEST_F(HistoryIngestorTest, StoreAppendsAndMergesTheLastBar) {
+    BarStore store((testDir / "store" / "X").string());
+    BarColumns bars;
+    Data data{};
+    data.bid = { 1.0, 1.2, 0.9, 1.1 };
+    data.ask = data.bid;
+    data.volume = 2;
+    bars.push(60, data);
+    bars.push(120, data);
+    ASSERT_TRUE(store.append(bars));
+    EXPECT_EQ(store.size(), 2u);
+    EXPECT_EQ(store.lastTime().value(), 120);
+
+    BarColumns tail;
+    data.bid = { 1.15, 1.3, 1.0, 1.25 };
+    tail.push(120, data);
+    tail.push(180, data);
+    ASSERT_TRUE(store.append(tail));
+    BarColumns earlier;
+    earlier.push(60, data);
+    EXPECT_FALSE(store.append(earlier));
+    // A regression inside the batch leaves the store untouched
+    BarColumns unsorted;
+    unsorted.push(300, data);
+    unsorted.push(240, data);
+    EXPECT_FALSE(store.append(unsorted));
+    EXPECT_EQ(store.lastTime().value(), 180);
+
+    BarColumns all;
+    ASSERT_TRUE(store.read(all));
+    ASSERT_EQ(all.size(), 3u);
+    EXPECT_DOUBLE_EQ(all.bidOpen[1], 1.0);
+    EXPECT_DOUBLE_EQ(all.bidHigh[1], 1.3);
+    EXPECT_DOUBLE_EQ(all.bidLow[1], 0.9);
+    EXPECT_DOUBLE_EQ(all.bidClose[1], 1.25);
+    EXPECT_EQ(all.volume[1], 4);
+
+    // An append interrupted after the first column
+    std::ofstream((testDir / "store" / "X" / "1970" / "time.i64"), std::ios::binary | std::ios::app).write("12345678", 8);
+    EXPECT_EQ(store.size(), 3u);
+    store.repair();
+    EXPECT_EQ(std::filesystem::file_size(testDir / "store" / "X" / "1970" / "time.i64"), 3u * sizeof(long long));
+}
+
+TEST_F(HistoryIngestorTest, OnlyAppendedLinesAreParsed) {
+    write("EURUSD/2024-1.csv", bar(3, "00:00:00", "1,1") + bar(3, "00:01:00", "1,2"));
+    write("EURUSD/2024-10.csv", bar(10, "00:00:00", "1,5"));
+    write("USDJPY/2024-1.csv", bar(3, "00:00:00", "140"));
+    HistoryIngestor ingestor(historyDir.string(), storeDir.string(), 2);
+
+    IngestReport first = ingestor.ingest().value();
+    EXPECT_EQ(first.newFiles, 3u);
+    EXPECT_EQ(first.appendedBars, 4u);
+    EXPECT_EQ(first.changedSymbols.size(), 2u);
+    // Week 10 after week 1, not by name
+    EXPECT_DOUBLE_EQ(stored("EURUSD").bidClose[2], 1.5);
+
+    IngestReport unchanged = HistoryIngestor(historyDir.string(), storeDir.string()).ingest().value();
+    EXPECT_EQ(unchanged.unchangedFiles, 3u);
+    EXPECT_EQ(unchanged.parsedBytes, 0u);
+    EXPECT_TRUE(unchanged.changedSymbols.empty());
+
+    // A line still being written is left for the next run
+    std::string appended = bar(10, "00:01:00", "1,6");
+    write("EURUSD/2024-10.csv", appended + "10.01.2024 00:02", true);
+    IngestReport grown = ingestor.ingest().value();
+    EXPECT_EQ(grown.grownFiles, 1u);
+    EXPECT_EQ(grown.unchangedFiles, 2u);
+    EXPECT_EQ(grown.appendedBars, 1u);
+    EXPECT_EQ(grown.rebuiltSymbols, 0u);
+    EXPECT_EQ(grown.changedSymbols, std::vector<std::string>{ "EURUSD" });
+    write("EURUSD/2024-10.csv", ":00;1,7;1,7;1,7;1,7;1,7;1,7;1,7;1,7;1\n", true);
+    write("EURUSD/2024-11.csv", bar(17, "00:00:00", "1,8"));
+    IngestReport completed = ingestor.ingest().value();
+    EXPECT_EQ(completed.grownFiles, 1u);
+    EXPECT_EQ(completed.newFiles, 1u);
+    EXPECT_EQ(completed.appendedBars, 2u);
+    BarColumns bars = stored("EURUSD");
+    ASSERT_EQ(bars.size(), 6u);
+    EXPECT_DOUBLE_EQ(bars.bidClose[4], 1.7);
+    EXPECT_DOUBLE_EQ(bars.bidClose[5], 1.8);
+    EXPECT_EQ(stored("USDJPY").size(), 1u);
+}
+
+TEST_F(HistoryIngestorTest, RewrittenOrRemovedFilesRebuildOnlyTheirSymbol) {
+    write("EURUSD/2024-1.csv", bar(3, "00:00:00", "1,1") + bar(3, "00:01:00", "1,2"));
+    write("USDJPY/2024-1.csv", bar(3, "00:00:00", "140"));
+    HistoryIngestor ingestor(historyDir.string(), storeDir.string());
+    ingestor.ingest();
+
+    write("EURUSD/2024-1.csv", bar(3, "00:00:00", "1,3") + bar(3, "00:01:00", "1,2") + bar(3, "00:02:00", "1,4"));
+    IngestReport rewritten = ingestor.ingest().value();
+    EXPECT_EQ(rewritten.rebuiltSymbols, 1u);
+    EXPECT_EQ(rewritten.unchangedFiles, 1u);
+    EXPECT_EQ(rewritten.changedSymbols, std::vector<std::string>{ "EURUSD" });
+    BarColumns bars = stored("EURUSD");
+    ASSERT_EQ(bars.size(), 3u);
+    EXPECT_DOUBLE_EQ(bars.bidClose[0], 1.3);
+
+    std::filesystem::remove(historyDir / "EURUSD/2024-1.csv");
+    IngestReport removed = ingestor.ingest().value();
+    EXPECT_EQ(removed.rebuiltSymbols, 1u);
+    EXPECT_EQ(stored("EURUSD").size(), 0u);
+}
+
+TEST_F(HistoryIngestorTest, TickFilesContinueTheOpenMinute) {
+    write("EURUSD/info.json", "{\"Name\": \"EUR/USD\", \"HistoryFormat\": \"Tick\"}");
+    write("EURUSD/2024-1.csv", "2024-01-03T00:00:05,1.1000,1.1002,1\n2024-01-03T00:00:20,1.1010,1.1012,1\n");
+    HistoryIngestor ingestor(historyDir.string(), storeDir.string());
+    ingestor.ingest();
+    write("EURUSD/2024-1.csv", "2024-01-03T00:00:50,1.0990,1.0992,1\n2024-01-03T00:01:10,1.0995,1.0997,1\n", true);
+    IngestReport report = ingestor.ingest().value();
+    EXPECT_EQ(report.grownFiles, 1u);
+    EXPECT_EQ(report.rebuiltSymbols, 0u);
+    BarColumns bars = stored("EURUSD");
+    ASSERT_EQ(bars.size(), 2u);
+    EXPECT_DOUBLE_EQ(bars.bidOpen[0], 1.1000);
+    EXPECT_DOUBLE_EQ(bars.bidLow[0], 1.0990);
+    EXPECT_DOUBLE_EQ(bars.bidClose[0], 1.0990);
+    EXPECT_EQ(bars.volume[0], 3);
+}
+
+TEST_F(HistoryIngestorTest, ChangedSymbolsDropTheirIndicatorSeries) {
+    std::filesystem::path cacheDir = testDir / "indicators";
+    std::filesystem::create_directories(cacheDir);
+    for (const char* name : { "EURUSD_m1_sma_10_00000000000000aa.f64", "EURUSD_m5_rsi_14_00000000000000bb.f64", "USDJPY_m1_sma_10_00000000000000aa.f64" }) {
+        std::ofstream(cacheDir / name) << "x";
+    }
+    EXPECT_EQ(IndicatorCache::removeSymbol(cacheDir.string(), "EUR/USD"), 2u);
+    EXPECT_TRUE(std::filesystem::exists(cacheDir / "USDJPY_m1_sma_10_00000000000000aa.f64"));
+}
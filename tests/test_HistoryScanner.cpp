@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+#include "HistoryScanner.h"
+#include "RatesStorageProvider.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+class HistoryScannerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        historyDir = std::filesystem::temp_directory_path() / "history_scanner_test";
+        std::filesystem::remove_all(historyDir);
+        std::filesystem::create_directories(historyDir / "EURUSD");
+        std::filesystem::create_directories(historyDir / "USDJPY");
+    }
+
+    void TearDown() override {
+        try {
+            std::filesystem::remove_all(historyDir);
+        } catch (const std::exception&) {
+            // Ignore cleanup errors
+        }
+    }
+
+    void writeWeek(const std::string& file, const std::vector<std::string>& lines) {
+        std::ofstream output(historyDir / file);
+        for (const auto& line : lines) {
+            output << line << "\n";
+        }
+    }
+
+    static std::string bar(const std::string& time, double bid, double ask) {
+        std::ostringstream line;
+        line << "03.01.2024 " << time << ";" << bid << ";" << bid << ";" << bid << ";" << bid << ";"
+             << ask << ";" << ask << ";" << ask << ";" << ask << ";10";
+        return line.str();
+    }
+
+    BarColumns columns(const std::vector<double>& bids, const std::vector<double>& asks) {
+        BarColumns bars;
+        for (size_t i = 0; i < bids.size(); i++) {
+            bars.time.push_back(1704240000 + 60 * static_cast<long long>(i));
+            bars.bidOpen.push_back(bids[i]);
+            bars.bidHigh.push_back(bids[i]);
+            bars.bidLow.push_back(bids[i]);
+            bars.bidClose.push_back(bids[i]);
+            bars.askOpen.push_back(asks[i]);
+            bars.askHigh.push_back(asks[i]);
+            bars.askLow.push_back(asks[i]);
+            bars.askClose.push_back(asks[i]);
+            bars.volume.push_back(1);
+        }
+        return bars;
+    }
+
+    std::filesystem::path historyDir;
+};
+
+TEST_F(HistoryScannerTest, KernelsCountBadBars) {
+    BarColumns bars = columns({ 1.0, 1.1, 0.0, 1.0 }, { 1.0002, 1.0, 0.0002, 1.0002 });
+    EXPECT_EQ(QualityKernels::crossedQuotes(bars), 1u);
+    EXPECT_EQ(QualityKernels::zeroPrices(bars), 1u);
+    EXPECT_EQ(QualityKernels::invertedBars(bars), 0u);
+    bars.bidHigh[3] = 0.9;
+    EXPECT_EQ(QualityKernels::invertedBars(bars), 1u);
+    // Mid 1.0 -> 1.05 -> 0 -> 1.0, every move a spike
+    EXPECT_EQ(QualityKernels::spikes(bars, 0.02), 3u);
+
+    std::vector<long long> time = { 0, 60, 60, 30, 3700, 3760 };
+    EXPECT_EQ(QualityKernels::duplicateTimes(time.data(), time.size()), 1u);
+    EXPECT_EQ(QualityKernels::timestampRegressions(time.data(), time.size()), 1u);
+    EXPECT_EQ(QualityKernels::gaps(time.data(), time.size(), 1800), 1u);
+}
+
+TEST_F(HistoryScannerTest, MalformedLinesDoNotEndTheScan) {
+    writeWeek("EURUSD/2024-1.csv", { bar("00:00:00", 1.1, 1.1002), "garbage", bar("00:01:00", 1.1, 1.1002),
+        bar("00:01:00", 1.1, 1.1002), bar("00:02:00", 1.1003, 1.1002) });
+    HistoryScanner scanner(HistoryScanner::Settings{});
+    HistoryFileReport report = scanner.scanFile((historyDir / "EURUSD/2024-1.csv").string(), "EURUSD", "EURUSD/2024-1.csv");
+    EXPECT_EQ(report.lines, 5u);
+    EXPECT_EQ(report.bars, 4u);
+    EXPECT_EQ(report.malformedLines, 1u);
+    EXPECT_EQ(report.firstMalformedLine, 2u);
+    EXPECT_EQ(report.duplicateTimes, 1u);
+    EXPECT_EQ(report.crossedQuotes, 1u);
+    EXPECT_TRUE(report.shouldQuarantine());
+    nlohmann::json json = report.toJson();
+    EXPECT_EQ(json["file"], "EURUSD/2024-1.csv");
+    EXPECT_EQ(json["malformed_lines"], 1);
+    EXPECT_EQ(json["quarantine"], true);
+}
+
+TEST_F(HistoryScannerTest, UnreadableFilesAreNotReportedClean) {
+    HistoryScanner scanner(HistoryScanner::Settings{});
+    HistoryFileReport report = scanner.scanFile((historyDir / "EURUSD/2024-9.csv").string(), "EURUSD", "EURUSD/2024-9.csv");
+    EXPECT_TRUE(report.readFailed);
+    EXPECT_TRUE(report.shouldQuarantine());
+    nlohmann::json json = report.toJson();
+    EXPECT_EQ(json["read_failed"], true);
+    EXPECT_EQ(json["quarantine"], true);
+}
+
+TEST_F(HistoryScannerTest, ScansTreeInParallelAndQuarantines) {
+    writeWeek("EURUSD/2024-1.csv", { bar("00:00:00", 1.1, 1.1002), bar("00:01:00", 1.1, 1.1002) });
+    writeWeek("EURUSD/2024-2.csv", { bar("00:00:00", 1.1, 1.1002), bar("02:00:00", 1.1, 1.1002) });
+    writeWeek("USDJPY/2024-1.csv", { bar("00:00:00", 140.0, 140.02), bar("00:01:00", 0.0, 140.02) });
+    HistoryScanner::Settings settings;
+    settings.threads = 3;
+    std::vector<HistoryFileReport> reports = HistoryScanner(settings).scan(historyDir.string());
+    ASSERT_EQ(reports.size(), 3u);
+    EXPECT_EQ(reports[0].file, "EURUSD/2024-1.csv");
+    EXPECT_FALSE(reports[0].hasIssues());
+    EXPECT_FALSE(reports[0].readFailed);
+    // A gap is reported but does not quarantine the week
+    EXPECT_EQ(reports[1].gaps, 1u);
+    EXPECT_FALSE(reports[1].shouldQuarantine());
+    EXPECT_EQ(reports[2].zeroPrices, 1u);
+    EXPECT_TRUE(reports[2].shouldQuarantine());
+
+    EXPECT_EQ(HistoryScanner::writeQuarantine(historyDir.string(), reports).value(), 1u);
+    std::ifstream list(historyDir / "quarantine.txt");
+    std::string line;
+    std::getline(list, line);
+    EXPECT_EQ(line, "USDJPY/2024-1.csv");
+}
+
+TEST_F(HistoryScannerTest, PreparationSkipsQuarantinedWeeks) {
+    writeWeek("EURUSD/2024-1.csv", { bar("00:00:00", 1.1, 1.1002) });
+    writeWeek("USDJPY/2024-1.csv", { bar("00:00:00", 140.0, 140.02) });
+    writeWeek("quarantine.txt", { "USDJPY/2024-1.csv" });
+    RatesStorageProvider provider(historyDir.string());
+    std::tm week = {};
+    week.tm_year = 124;
+    week.tm_mday = 3;
+    BarColumns bars;
+    EXPECT_TRUE(provider.readWeekColumns("EUR/USD", week, "m1", bars));
+    EXPECT_FALSE(provider.readWeekColumns("USD/JPY", week, "m1", bars));
+    EXPECT_TRUE(provider.isQuarantined("USD/JPY", week));
+    EXPECT_FALSE(provider.prepareWeekData(std::vector<std::string>{ "EURUSD", "USDJPY" }, week, AlignmentMode::Union, "m1",
+        (historyDir / "prepared").string()).has_value());
+}
+
+TEST_F(HistoryScannerTest, SymbolsAreReadInTheirHistoryFormat) {
+    writeWeek("EURUSD/info.json", { "{\"Name\": \"EUR/USD\", \"HistoryFormat\": \"Iso\"}" });
+    writeWeek("EURUSD/2024-1.csv", { "2024-01-03T00:00:00,1.1,1.1,1.1,1.1,1.1002,1.1002,1.1002,1.1002,10",
+        "2024-01-03T00:01:00,1.1,1.1,1.1,1.1,1.1002,1.1002,1.1002,1.1002,10" });
+    writeWeek("USDJPY/2024-1.csv", { bar("00:00:00", 140.0, 140.02) });
+    std::vector<HistoryFileReport> reports = HistoryScanner(HistoryScanner::Settings{}).scan(historyDir.string());
+    ASSERT_EQ(reports.size(), 2u);
+    EXPECT_EQ(reports[0].bars, 2u);
+    EXPECT_EQ(reports[0].malformedLines, 0u);
+    EXPECT_EQ(reports[1].bars, 1u);
+
+    RatesStorageProvider provider(historyDir.string());
+    std::tm week = {};
+    week.tm_year = 124;
+    week.tm_mday = 3;
+    BarColumns bars;
+    ASSERT_TRUE(provider.readWeekColumns("EUR/USD", week, "m1", bars));
+    ASSERT_EQ(bars.size(), 2u);
+    EXPECT_DOUBLE_EQ(bars.askClose[1], 1.1002);
+    EXPECT_TRUE(provider.getReadErrors().empty());
+}
@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+#include "IndicatorCache.h"
+#include <cmath>
+#include <filesystem>
+#include <vector>
+
+class IndicatorCacheTest : public ::testing::Test {
+protected:
+    std::string directory;
+
+    void SetUp() override {
+        directory = (std::filesystem::temp_directory_path() / "indicator_cache_test").string();
+        std::filesystem::remove_all(directory);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(directory);
+    }
+
+    BarColumns bars(size_t count, double step) {
+        BarColumns columns;
+        for (size_t i = 0; i < count; i++) {
+            double close = 1.0 + step * i;
+            columns.time.push_back(1651190400 + 60 * static_cast<long long>(i));
+            columns.bidOpen.push_back(close);
+            columns.bidHigh.push_back(close + 0.001);
+            columns.bidLow.push_back(close - 0.001);
+            columns.bidClose.push_back(close);
+            columns.askOpen.push_back(close);
+            columns.askHigh.push_back(close + 0.001);
+            columns.askLow.push_back(close - 0.001);
+            columns.askClose.push_back(close);
+            columns.volume.push_back(1);
+        }
+        return columns;
+    }
+
+    IndicatorKey key(const BarColumns& columns, IndicatorType type, size_t length) {
+        IndicatorKey result;
+        result.symbol = "EUR/USD";
+        result.period = "m1";
+        result.type = type;
+        result.length = length;
+        result.bars = IndicatorCache::fingerprint(columns);
+        return result;
+    }
+};
+
+TEST_F(IndicatorCacheTest, RollingKernels) {
+    std::vector<double> values = { 1, 2, 3, 4 };
+    std::vector<double> prefix(5);
+    IndicatorKernels::prefixSum(values.data(), 4, prefix.data());
+    EXPECT_EQ(prefix, (std::vector<double>{ 0, 1, 3, 6, 10 }));
+
+    std::vector<double> mean(4);
+    IndicatorKernels::rollingMean(prefix.data(), 4, 2, mean.data());
+    EXPECT_TRUE(std::isnan(mean[0]));
+    EXPECT_DOUBLE_EQ(mean[1], 1.5);
+    EXPECT_DOUBLE_EQ(mean[3], 3.5);
+
+    std::vector<double> gainPrefix = { 0, 0, 2, 2, 2 };
+    std::vector<double> lossPrefix = { 0, 0, 0, 1, 1 };
+    std::vector<double> strength(4);
+    IndicatorKernels::relativeStrength(gainPrefix.data(), lossPrefix.data(), 4, 2, strength.data());
+    EXPECT_TRUE(std::isnan(strength[1]));
+    EXPECT_NEAR(strength[2], 100.0 * 2 / 3, 1e-12);
+    EXPECT_DOUBLE_EQ(strength[3], 0.0);
+
+    // The second bar gaps up from the first close
+    std::vector<double> high = { 2, 5 };
+    std::vector<double> low = { 1, 4 };
+    std::vector<double> close = { 1.5, 4.5 };
+    std::vector<double> range(2);
+    IndicatorKernels::trueRange(high.data(), low.data(), close.data(), 2, range.data());
+    EXPECT_DOUBLE_EQ(range[0], 1.0);
+    EXPECT_DOUBLE_EQ(range[1], 3.5);
+}
+
+TEST_F(IndicatorCacheTest, ComputesIndicatorsOnMidPrices) {
+    BarColumns columns = bars(10, 0.01);
+    std::vector<double> sma = IndicatorCache::compute(IndicatorType::SimpleMovingAverage, 3, columns);
+    EXPECT_NEAR(sma[9], 1.08, 1e-12);
+    std::vector<double> atr = IndicatorCache::compute(IndicatorType::AverageTrueRange, 3, columns);
+    // Every range reaches from the previous close, 0.01 lower, to the high 0.001 above the close
+    EXPECT_NEAR(atr[9], 0.011, 1e-12);
+    std::vector<double> rsi = IndicatorCache::compute(IndicatorType::RelativeStrengthIndex, 3, columns);
+    EXPECT_TRUE(std::isnan(rsi[2]));
+    EXPECT_DOUBLE_EQ(rsi[3], 100.0);
+}
+
+TEST_F(IndicatorCacheTest, SeriesAreSharedFromMemory) {
+    BarColumns columns = bars(100, 0.01);
+    IndicatorCache cache("", 1 << 20);
+    auto first = cache.get(key(columns, IndicatorType::SimpleMovingAverage, 10), columns);
+    auto second = cache.get(key(columns, IndicatorType::SimpleMovingAverage, 10), columns);
+    EXPECT_EQ(first, second);
+    cache.get(key(columns, IndicatorType::SimpleMovingAverage, 20), columns);
+    IndicatorCache::Stats stats = cache.stats();
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.computed, 2u);
+    EXPECT_NEAR(stats.hitRate(), 1.0 / 3, 1e-12);
+    EXPECT_EQ(cache.memoryInUse(), 2 * 100 * sizeof(double));
+}
+
+TEST_F(IndicatorCacheTest, LeastRecentlyUsedSeriesAreEvictedBeyondBudget) {
+    BarColumns columns = bars(100, 0.01);
+    IndicatorCache cache("", 2 * 100 * sizeof(double));
+    auto kept = cache.get(key(columns, IndicatorType::SimpleMovingAverage, 5), columns);
+    cache.get(key(columns, IndicatorType::SimpleMovingAverage, 10), columns);
+    cache.get(key(columns, IndicatorType::SimpleMovingAverage, 5), columns);
+    cache.get(key(columns, IndicatorType::SimpleMovingAverage, 20), columns);
+    EXPECT_EQ(cache.stats().evicted, 1u);
+    EXPECT_LE(cache.memoryInUse(), 2 * 100 * sizeof(double));
+    // Length 10 was the least recently used
+    cache.get(key(columns, IndicatorType::SimpleMovingAverage, 5), columns);
+    cache.get(key(columns, IndicatorType::SimpleMovingAverage, 10), columns);
+    IndicatorCache::Stats stats = cache.stats();
+    EXPECT_EQ(stats.hits, 2u);
+    EXPECT_EQ(stats.computed, 4u);
+    // A series in use stays valid after eviction
+    EXPECT_NEAR((*kept)[99], 1.97, 1e-12);
+}
+
+TEST_F(IndicatorCacheTest, FilesAreMappedByLaterCaches) {
+    BarColumns columns = bars(100, 0.01);
+    std::vector<double> expected = IndicatorCache::compute(IndicatorType::RelativeStrengthIndex, 14, columns);
+    {
+        IndicatorCache cache(directory, 1 << 20);
+        cache.get(key(columns, IndicatorType::RelativeStrengthIndex, 14), columns);
+    }
+    std::string path = (std::filesystem::path(directory) / (key(columns, IndicatorType::RelativeStrengthIndex, 14).toString() + ".f64")).string();
+    EXPECT_EQ(std::filesystem::file_size(path), 24 + 100 * sizeof(double));
+
+    IndicatorCache cache(directory, 1 << 20);
+    auto series = cache.get(key(columns, IndicatorType::RelativeStrengthIndex, 14), columns);
+    EXPECT_EQ(cache.stats().mapped, 1u);
+    EXPECT_EQ(cache.stats().computed, 0u);
+    ASSERT_EQ(series->size(), 100u);
+    for (size_t i = 14; i < 100; i++) {
+        EXPECT_DOUBLE_EQ((*series)[i], expected[i]);
+    }
+}
+
+TEST_F(IndicatorCacheTest, OtherBarsAreNotMapped) {
+    BarColumns columns = bars(100, 0.01);
+    BarColumns changed = bars(100, 0.02);
+    EXPECT_NE(IndicatorCache::fingerprint(columns), IndicatorCache::fingerprint(changed));
+    {
+        IndicatorCache cache(directory, 1 << 20);
+        cache.get(key(columns, IndicatorType::SimpleMovingAverage, 10), columns);
+    }
+    EXPECT_EQ(IndicatorSeries::map((std::filesystem::path(directory) / (key(columns, IndicatorType::SimpleMovingAverage, 10).toString() + ".f64")).string(),
+        IndicatorCache::fingerprint(changed)), nullptr);
+    IndicatorCache cache(directory, 1 << 20);
+    auto series = cache.get(key(changed, IndicatorType::SimpleMovingAverage, 10), changed);
+    EXPECT_EQ(cache.stats().computed, 1u);
+    EXPECT_NEAR((*series)[99], 1.0 + 0.02 * 94.5, 1e-12);
+}
@@ -0,0 +1,204 @@
+#include <gtest/gtest.h>
+#include "JobPlanner.h"
+#include <fstream>
+#include <filesystem>
+#include <string>
+
+class JobPlannerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        historyDir = std::filesystem::temp_directory_path() / "job_planner_test";
+        std::filesystem::create_directories(historyDir);
+        createSymbol("EURUSD", "EUR", "USD");
+        createSymbol("EURJPY", "EUR", "JPY");
+        createSymbol("USDJPY", "USD", "JPY");
+        createSymbol("GBPCHF", "GBP", "CHF");
+    }
+
+    void TearDown() override {
+        try {
+            std::filesystem::remove_all(historyDir);
+        } catch (const std::exception&) {
+            // Ignore cleanup errors
+        }
+    }
+
+    void createSymbol(const std::string& name, const std::string& contractCurrency, const std::string& profitCurrency) {
+        std::filesystem::create_directories(historyDir / name);
+        std::ofstream file(historyDir / name / "info.json");
+        file << "{\"Name\": \"" << name << "\", \"ContractCurrency\": \"" << contractCurrency
+             << "\", \"ProfitCurrency\": \"" << profitCurrency << "\", \"PipSize\": 0.0001, \"Precision\": 5}";
+        file.close();
+    }
+
+    BacktestProject createBaseProject() {
+        BacktestProject project;
+        project.strategy = "MA_Cross_Strategy";
+        project.accountCurrency = "USD";
+        project.initialAmount = 50000.0;
+        project.defaultPeriod = "m1";
+        project.accountLotSize = 0;
+        return project;
+    }
+
+    std::filesystem::path historyDir;
+};
+
+TEST_F(JobPlannerTest, NoConversionNeededForAccountCurrency) {
+    RatesStorageProvider provider(historyDir.string());
+    JobPlanner planner(provider);
+
+    auto job = planner.planJob(createBaseProject(), { "EUR/USD" });
+    ASSERT_TRUE(job.has_value());
+    EXPECT_TRUE(job.value().conversionSymbols.empty());
+    ASSERT_EQ(job.value().project.instruments.size(), 1u);
+    EXPECT_EQ(job.value().project.instruments[0].name, "EURUSD");
+}
+
+TEST_F(JobPlannerTest, AddsConversionPairForForeignProfitCurrency) {
+    RatesStorageProvider provider(historyDir.string());
+    JobPlanner planner(provider);
+
+    auto job = planner.planJob(createBaseProject(), { "EUR/JPY" });
+    ASSERT_TRUE(job.has_value());
+    ASSERT_EQ(job.value().conversionSymbols.size(), 1u);
+    EXPECT_EQ(job.value().conversionSymbols[0], "USD/JPY");
+    ASSERT_EQ(job.value().project.instruments.size(), 2u);
+    EXPECT_EQ(job.value().project.instruments[1].name, "USDJPY");
+}
+
+TEST_F(JobPlannerTest, ConversionPairAddedOnce) {
+    RatesStorageProvider provider(historyDir.string());
+    JobPlanner planner(provider);
+
+    auto job = planner.planJob(createBaseProject(), { "EUR/JPY", "USD/JPY" });
+    ASSERT_TRUE(job.has_value());
+    // USD/JPY is already traded, so it doubles as the conversion instrument
+    EXPECT_TRUE(job.value().conversionSymbols.empty());
+    EXPECT_EQ(job.value().project.instruments.size(), 2u);
+}
+
+TEST_F(JobPlannerTest, MissingConversionPairFailsPlanning) {
+    RatesStorageProvider provider(historyDir.string());
+    JobPlanner planner(provider);
+
+    EXPECT_FALSE(planner.planJob(createBaseProject(), { "GBP/CHF" }).has_value());
+}
+
+TEST_F(JobPlannerTest, UnknownSymbolFailsPlanning) {
+    RatesStorageProvider provider(historyDir.string());
+    JobPlanner planner(provider);
+
+    EXPECT_FALSE(planner.planJob(createBaseProject(), { "AUD/NZD" }).has_value());
+}
+
+TEST_F(JobPlannerTest, FindConversionSymbolInBothDirections) {
+    RatesStorageProvider provider(historyDir.string());
+    JobPlanner planner(provider);
+
+    EXPECT_EQ(planner.findConversionSymbol("JPY", "USD").value(), "USD/JPY");
+    EXPECT_EQ(planner.findConversionSymbol("EUR", "USD").value(), "EUR/USD");
+    EXPECT_FALSE(planner.findConversionSymbol("CHF", "USD").has_value());
+}
+
+TEST_F(JobPlannerTest, ExpandParametersBuildsEveryCombination) {
+    auto sets = JobPlanner::expandParameters({ { "Fast", { "5", "10" } }, { "Slow", { "20", "50", "100" } } });
+    ASSERT_EQ(sets.size(), 6u);
+    EXPECT_EQ(sets[0][0].name, "Fast");
+    EXPECT_EQ(sets[0][0].value, "5");
+    EXPECT_EQ(sets[0][1].value, "20");
+    EXPECT_EQ(sets[5][0].value, "10");
+    EXPECT_EQ(sets[5][1].value, "100");
+}
+
+TEST_F(JobPlannerTest, PlanSweepCreatesJobPerPortfolioAndParameterSet) {
+    RatesStorageProvider provider(historyDir.string());
+    JobPlanner planner(provider);
+
+    SweepSpec spec;
+    spec.strategy = "MA_Cross_Strategy";
+    spec.portfolios = { { "EUR/USD" }, { "EUR/JPY" } };
+    spec.parameters = { { "Fast", { "5", "10" } } };
+    auto jobs = planner.planSweep(spec);
+    ASSERT_TRUE(jobs.has_value());
+    ASSERT_EQ(jobs.value().size(), 4u);
+    EXPECT_EQ(jobs.value()[1].project.strategyParameters[0].value, "10");
+    EXPECT_EQ(jobs.value()[2].conversionSymbols, std::vector<std::string>({ "USD/JPY" }));
+    // Parameter sets of one portfolio share the compiled template
+    EXPECT_EQ(jobs.value()[2].projectTemplate, jobs.value()[3].projectTemplate);
+}
+
+TEST_F(JobPlannerTest, PlanTasksIsWindowMajor) {
+    RatesStorageProvider provider(historyDir.string());
+    JobPlanner planner(provider);
+
+    SweepSpec spec;
+    spec.strategy = "MA_Cross_Strategy";
+    spec.portfolios = { { "EUR/USD" }, { "EUR/JPY" } };
+    auto jobs = planner.planSweep(spec);
+    ASSERT_TRUE(jobs.has_value());
+    auto windows = JobPlanner::planWindows(std::time(nullptr));
+    ASSERT_GT(windows.size(), 2u);
+    auto tasks = JobPlanner::planTasks(jobs.value(), { windows[0], windows[1] });
+    ASSERT_EQ(tasks.size(), 4u);
+    EXPECT_EQ(tasks[0].window.startTime, tasks[1].window.startTime);
+    EXPECT_EQ(tasks[0].job, tasks[2].job);
+    EXPECT_EQ(tasks[1].window.endTime, tasks[2].window.startTime);
+}
+
+TEST(JobPlannerLocalityTest, OrdersByWindowThenSymbols) {
+    auto job = [](const std::vector<std::string>& symbols, const std::vector<std::string>& conversions) {
+        auto result = std::make_shared<BacktestJob>();
+        result->symbols = symbols;
+        result->conversionSymbols = conversions;
+        return std::shared_ptr<const BacktestJob>(result);
+    };
+    auto eurusd = job({ "EUR/USD" }, {});
+    auto eurjpy = job({ "EUR/JPY" }, { "USD/JPY" });
+    auto window = [](long long startTime) {
+        BacktestWindow result = {};
+        result.startTime = startTime;
+        return result;
+    };
+    // Shuffled: (EURUSD, w2), (EURJPY, w1), (EURUSD, w1), (EURJPY, w2), (EURUSD, w1)
+    std::vector<BacktestTask> tasks = {
+        { eurusd, window(2) }, { eurjpy, window(1) }, { eurusd, window(1) }, { eurjpy, window(2) }, { eurusd, window(1) }
+    };
+    EXPECT_EQ(JobPlanner::localityOrder(tasks), std::vector<size_t>({ 1, 2, 4, 3, 0 }));
+}
+
+TEST(JobPlannerLocalityTest, CountsPreparedEntriesPerWindow) {
+    BacktestJob single;
+    single.symbols = { "EUR/JPY" };
+    single.conversionSymbols = { "USD/JPY" };
+    BacktestJob aligned;
+    aligned.symbols = { "EUR/USD", "USD/JPY" };
+    aligned.alignment = AlignmentMode::Intersection;
+    BacktestJob plain;
+    plain.symbols = { "EUR/USD", "USD/JPY" };
+    // EUR/JPY, USD/JPY, the aligned pair and EUR/USD
+    EXPECT_EQ(JobPlanner::preparedEntriesPerWindow({ single, aligned, plain }), 4u);
+}
+
+TEST(SweepSpecParserTest, RoundTrip) {
+    SweepSpec spec = SweepSpecParser::parse(
+        "{\"owner\": \"alice\", \"strategy\": \"MA\", \"symbols\": [\"EUR/USD\", \"EUR/JPY,USD/JPY\"],"
+        " \"period\": \"H1\", \"intersectTimestamps\": true, \"parameters\": {\"Fast\": [5, 10]}}");
+    EXPECT_EQ(spec.owner, "alice");
+    ASSERT_EQ(spec.portfolios.size(), 2u);
+    EXPECT_EQ(spec.portfolios[1], std::vector<std::string>({ "EUR/JPY", "USD/JPY" }));
+    EXPECT_EQ(spec.period, "H1");
+    EXPECT_TRUE(spec.intersectTimestamps);
+    ASSERT_EQ(spec.parameters.size(), 1u);
+    EXPECT_EQ(spec.parameters[0].second, std::vector<std::string>({ "5", "10" }));
+
+    SweepSpec copy = SweepSpecParser::parse(SweepSpecParser::serialize(spec));
+    EXPECT_EQ(copy.owner, spec.owner);
+    EXPECT_EQ(copy.portfolios, spec.portfolios);
+    EXPECT_EQ(copy.parameters, spec.parameters);
+}
+
+TEST(SweepSpecParserTest, MissingStrategyThrows) {
+    EXPECT_THROW(SweepSpecParser::parse("{\"symbols\": \"EUR/USD\"}"), std::runtime_error);
+    EXPECT_THROW(SweepSpecParser::parse("not json"), std::runtime_error);
+}
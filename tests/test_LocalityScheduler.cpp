@@ -0,0 +1,43 @@
+#include <gtest/gtest.h>
+#include "LocalityScheduler.h"
+#include <atomic>
+#include <thread>
+
+TEST(LocalitySchedulerTest, HandsOutTasksInOrder) {
+    LocalityScheduler scheduler({ 2, 0, 1 }, 10);
+    EXPECT_EQ(scheduler.next().value(), 2u);
+    EXPECT_EQ(scheduler.next().value(), 0u);
+    EXPECT_FALSE(scheduler.exhausted());
+    EXPECT_EQ(scheduler.next().value(), 1u);
+    EXPECT_TRUE(scheduler.exhausted());
+    EXPECT_FALSE(scheduler.next().has_value());
+}
+
+TEST(LocalitySchedulerTest, WindowIsBoundedByOldestUnfinishedTask) {
+    LocalityScheduler scheduler({ 0, 1, 2, 3, 4 }, 2);
+    EXPECT_EQ(scheduler.next().value(), 0u);
+    EXPECT_EQ(scheduler.next().value(), 1u);
+    // Task 0 still runs, so task 2 would be too far ahead
+    EXPECT_FALSE(scheduler.next().has_value());
+    EXPECT_FALSE(scheduler.exhausted());
+    // Finishing a newer task does not move the window
+    scheduler.finish(1);
+    EXPECT_FALSE(scheduler.next().has_value());
+    scheduler.finish(0);
+    EXPECT_EQ(scheduler.next().value(), 2u);
+    EXPECT_EQ(scheduler.next().value(), 3u);
+    EXPECT_FALSE(scheduler.next().has_value());
+}
+
+TEST(LocalitySchedulerTest, WaitingWorkerIsWokenByFinish) {
+    LocalityScheduler scheduler({ 0, 1 }, 1);
+    EXPECT_EQ(scheduler.next().value(), 0u);
+    std::atomic<bool> got(false);
+    std::thread worker([&]() {
+        got = scheduler.next(std::chrono::milliseconds(5000)) == std::optional<size_t>(1);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    scheduler.finish(0);
+    worker.join();
+    EXPECT_TRUE(got);
+}
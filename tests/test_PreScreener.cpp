@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include "PreScreener.h"
+#include <cmath>
+#include <vector>
+
+class PreScreenerTest : public ::testing::Test {
+protected:
+    BarColumns bars(const std::vector<double>& closes, double spread = 0.0) {
+        BarColumns columns;
+        long long time = 1651190400;
+        for (double close : closes) {
+            columns.time.push_back(time);
+            columns.bidOpen.push_back(close);
+            columns.bidHigh.push_back(close);
+            columns.bidLow.push_back(close);
+            columns.bidClose.push_back(close - spread / 2);
+            columns.askOpen.push_back(close);
+            columns.askHigh.push_back(close);
+            columns.askLow.push_back(close);
+            columns.askClose.push_back(close + spread / 2);
+            columns.volume.push_back(1);
+            time += 60;
+        }
+        return columns;
+    }
+
+    std::vector<double> trend(double start, double step, size_t count) {
+        std::vector<double> closes;
+        for (size_t i = 0; i < count; i++) {
+            closes.push_back(start + step * i);
+        }
+        return closes;
+    }
+
+    BacktestJob job(const std::vector<StrategyParameter>& parameters) {
+        BacktestJob result;
+        result.project.strategyParameters = parameters;
+        return result;
+    }
+};
+
+TEST_F(PreScreenerTest, ParseFamilies) {
+    EXPECT_EQ(PreScreener::parseFamily("ma_cross").value(), ScreeningFamily::MovingAverageCross);
+    EXPECT_EQ(PreScreener::parseFamily("breakout").value(), ScreeningFamily::Breakout);
+    EXPECT_EQ(PreScreener::parseFamily("rsi").value(), ScreeningFamily::RsiThreshold);
+    EXPECT_FALSE(PreScreener::parseFamily("macd").has_value());
+}
+
+TEST_F(PreScreenerTest, PositionProfitPaysTheSpreadOnEveryChange) {
+    std::vector<double> position = { 1, 1, 0, -1, -1, -1 };
+    std::vector<double> mid = { 1, 2, 4, 4, 3, 1 };
+    std::vector<double> noSpread(6, 0.0);
+    std::vector<double> halfSpread(6, 0.1);
+    // Long 1 -> 4, short 4 -> 1
+    EXPECT_DOUBLE_EQ(ScreeningKernels::positionProfit(position.data(), mid.data(), noSpread.data(), 6), 6.0);
+    // Open, close, open short and close short at the end
+    EXPECT_NEAR(ScreeningKernels::positionProfit(position.data(), mid.data(), halfSpread.data(), 6), 5.6, 1e-12);
+}
+
+TEST_F(PreScreenerTest, MovingAverageCrossFollowsTrend) {
+    BarColumns columns = bars(trend(1.0, 0.01, 50));
+    PreScreener screener(columns);
+    auto score = screener.score(ScreeningFamily::MovingAverageCross, { { "Fast", "2" }, { "Slow", "5" } });
+    ASSERT_TRUE(score.has_value());
+    EXPECT_EQ(score->trades, 1u);
+    // Long from the first bar with both averages, bar 4, to the end
+    EXPECT_NEAR(score->profit, 0.45, 1e-9);
+
+    auto reversed = screener.score(ScreeningFamily::MovingAverageCross, { { "Fast", "5" }, { "Slow", "2" } });
+    ASSERT_TRUE(reversed.has_value());
+    EXPECT_NEAR(reversed->profit, -0.45, 1e-9);
+}
+
+TEST_F(PreScreenerTest, PositionIsClosedOverWeekends) {
+    std::vector<double> closes = trend(1.0, 0.01, 50);
+    std::vector<double> secondWeek = trend(2.0, 0.01, 50);
+    closes.insert(closes.end(), secondWeek.begin(), secondWeek.end());
+    BarColumns columns = bars(closes);
+    auto score = PreScreener(columns, nullptr, "", "", { 0, 50 }).score(ScreeningFamily::MovingAverageCross, { { "Fast", "2" }, { "Slow", "5" } });
+    ASSERT_TRUE(score.has_value());
+    EXPECT_EQ(score->trades, 2u);
+    // Bars 4 to 49 and 50 to 99, the 0.51 gap between the weeks is not earned
+    EXPECT_NEAR(score->profit, 0.94, 1e-9);
+    auto across = PreScreener(columns).score(ScreeningFamily::MovingAverageCross, { { "Fast", "2" }, { "Slow", "5" } });
+    EXPECT_NEAR(across->profit, 1.45, 1e-9);
+}
+
+TEST_F(PreScreenerTest, SpreadMakesChoppyMarketsLose) {
+    std::vector<double> closes;
+    for (size_t i = 0; i < 60; i++) {
+        closes.push_back(i % 4 < 2 ? 1.0 : 1.001);
+    }
+    BarColumns plain = bars(closes);
+    BarColumns spread = bars(closes, 0.002);
+    PreScreener withoutSpread(plain);
+    PreScreener withSpread(spread);
+    auto free = withoutSpread.score(ScreeningFamily::MovingAverageCross, { { "Fast", "1" }, { "Slow", "3" } });
+    auto paid = withSpread.score(ScreeningFamily::MovingAverageCross, { { "Fast", "1" }, { "Slow", "3" } });
+    ASSERT_TRUE(free.has_value());
+    ASSERT_TRUE(paid.has_value());
+    EXPECT_GT(paid->trades, 10u);
+    EXPECT_LT(paid->profit, free->profit);
+    EXPECT_LT(paid->profit, 0.0);
+}
+
+TEST_F(PreScreenerTest, BreakoutAndRsi) {
+    BarColumns columns = bars(trend(1.0, 0.01, 50));
+    PreScreener screener(columns);
+    auto breakout = screener.score(ScreeningFamily::Breakout, { { "Period", "10" } });
+    ASSERT_TRUE(breakout.has_value());
+    EXPECT_EQ(breakout->trades, 1u);
+    EXPECT_NEAR(breakout->profit, 0.39, 1e-9);
+
+    // A steady rise keeps the RSI at 100, so the contrarian short loses
+    auto rsi = screener.score(ScreeningFamily::RsiThreshold, { { "Period", "5" }, { "Lower", "30" }, { "Upper", "70" } });
+    ASSERT_TRUE(rsi.has_value());
+    EXPECT_EQ(rsi->trades, 1u);
+    EXPECT_NEAR(rsi->profit, -0.44, 1e-9);
+}
+
+TEST_F(PreScreenerTest, InvalidParametersAreNotScored) {
+    BarColumns columns = bars(trend(1.0, 0.01, 20));
+    PreScreener screener(columns);
+    EXPECT_FALSE(screener.score(ScreeningFamily::MovingAverageCross, { { "Fast", "2" } }).has_value());
+    EXPECT_FALSE(screener.score(ScreeningFamily::MovingAverageCross, { { "Fast", "x" }, { "Slow", "5" } }).has_value());
+    EXPECT_FALSE(screener.score(ScreeningFamily::Breakout, { { "Period", "0" } }).has_value());
+    EXPECT_FALSE(screener.score(ScreeningFamily::Breakout, { { "Period", "20" } }).has_value());
+    EXPECT_FALSE(screener.score(ScreeningFamily::RsiThreshold, { { "Period", "5" }, { "Lower", "70" }, { "Upper", "30" } }).has_value());
+}
+
+TEST_F(PreScreenerTest, ParameterSetsShareCachedIndicators) {
+    BarColumns columns = bars(trend(1.0, 0.01, 50));
+    IndicatorCache cache("", 1 << 20);
+    PreScreener screener(columns, &cache, "EUR/USD", "m1");
+    screener.score(ScreeningFamily::MovingAverageCross, { { "Fast", "2" }, { "Slow", "5" } });
+    screener.score(ScreeningFamily::MovingAverageCross, { { "Fast", "2" }, { "Slow", "10" } });
+    screener.score(ScreeningFamily::MovingAverageCross, { { "Fast", "5" }, { "Slow", "10" } });
+    IndicatorCache::Stats stats = cache.stats();
+    EXPECT_EQ(stats.computed, 3u);
+    EXPECT_EQ(stats.hits, 3u);
+}
+
+TEST_F(PreScreenerTest, SelectTopKeepsBestAndUnscoredJobs) {
+    BarColumns columns = bars(trend(1.0, 0.01, 50));
+    PreScreener screener(columns);
+    std::vector<BacktestJob> jobs = {
+        job({ { "Fast", "5" }, { "Slow", "2" } }),
+        job({ { "Fast", "2" }, { "Slow", "5" } }),
+        job({ { "Other", "1" } }),
+        job({ { "Fast", "2" }, { "Slow", "20" } }),
+    };
+    std::vector<size_t> selected = screener.selectTop(ScreeningFamily::MovingAverageCross, jobs, 2);
+    EXPECT_EQ(selected, (std::vector<size_t>{ 1, 3, 2 }));
+}
@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+#include "PreparedDataCache.h"
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <iomanip>
+
+class PreparedDataCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        testDir = std::filesystem::temp_directory_path() / "prepared_data_cache_test";
+        std::filesystem::remove_all(testDir);
+        historyDir = testDir / "history";
+        workspaceDir = testDir / "workspaces";
+        std::filesystem::create_directories(historyDir / "EURUSD");
+        std::filesystem::create_directories(workspaceDir);
+        std::ofstream info(historyDir / "EURUSD" / "info.json");
+        info << "{\"Name\": \"EURUSD\", \"ContractCurrency\": \"EUR\", \"ProfitCurrency\": \"USD\"}";
+        info.close();
+        std::ofstream week(historyDir / "EURUSD" / "2000-1.csv");
+        for (int minute = 0; minute < 60 * 24; minute++) {
+            week << "03.01.2000 " << std::setw(2) << std::setfill('0') << minute / 60 << ":" << std::setw(2) << minute % 60
+                 << ":00;1,1;1,2;1,0;1,1;1,1;1,2;1,0;1,1;5\n";
+        }
+        week.close();
+        weekStart = {};
+        weekStart.tm_year = 100;
+        weekStart.tm_mday = 3;
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(testDir);
+    }
+
+    size_t workspaceCount() {
+        size_t count = 0;
+        for (const auto& entry : std::filesystem::directory_iterator(workspaceDir)) {
+            count += entry.is_directory() ? 1 : 0;
+        }
+        return count;
+    }
+
+    static size_t lineCount(const std::string& path) {
+        std::ifstream file(path);
+        size_t count = 0;
+        std::string line;
+        while (std::getline(file, line)) {
+            count++;
+        }
+        return count;
+    }
+
+    std::filesystem::path testDir;
+    std::filesystem::path historyDir;
+    std::filesystem::path workspaceDir;
+    std::tm weekStart;
+};
+
+TEST_F(PreparedDataCacheTest, ConcurrentRequestersShareOneCompleteFile) {
+    RatesStorageProvider provider(historyDir.string());
+    WorkspaceManager workspaces(workspaceDir.string());
+    PreparedDataCache cache(provider, workspaces);
+
+    const size_t requesters = 8;
+    std::vector<std::optional<PreparedDataCache::Lease>> leases(requesters);
+    std::vector<size_t> lines(requesters, 0);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < requesters; i++) {
+        threads.emplace_back([&, i]() {
+            leases[i] = cache.acquire("EUR/USD", weekStart, "m1");
+            if (leases[i].has_value()) {
+                lines[i] = lineCount(leases[i].value().paths[0]);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (size_t i = 0; i < requesters; i++) {
+        ASSERT_TRUE(leases[i].has_value());
+        EXPECT_EQ(leases[i].value().paths[0], leases[0].value().paths[0]);
+        // Nobody saw a partially written file
+        EXPECT_EQ(lines[i], 60u * 24u);
+    }
+    EXPECT_EQ(cache.size(), 1u);
+    EXPECT_EQ(workspaceCount(), 1u);
+}
+
+TEST_F(PreparedDataCacheTest, LastReleaseRemovesFiles) {
+    RatesStorageProvider provider(historyDir.string());
+    WorkspaceManager workspaces(workspaceDir.string());
+    PreparedDataCache cache(provider, workspaces);
+
+    auto first = cache.acquire("EUR/USD", weekStart, "m1");
+    auto second = cache.acquire("EUR/USD", weekStart, "m1");
+    ASSERT_TRUE(first.has_value() && second.has_value());
+    std::string path = first.value().paths[0];
+
+    first.value().release();
+    workspaces.flush();
+    EXPECT_TRUE(std::filesystem::exists(path));
+
+    second.reset();
+    workspaces.flush();
+    EXPECT_FALSE(std::filesystem::exists(path));
+    EXPECT_EQ(cache.size(), 0u);
+}
+
+TEST_F(PreparedDataCacheTest, MissingHistoryLeavesNothingBehind) {
+    RatesStorageProvider provider(historyDir.string());
+    WorkspaceManager workspaces(workspaceDir.string());
+    PreparedDataCache cache(provider, workspaces);
+
+    EXPECT_FALSE(cache.acquire(std::vector<std::string>{ "EUR/USD", "USD/JPY" }, weekStart, AlignmentMode::Union, "m1").has_value());
+    workspaces.flush();
+    EXPECT_EQ(cache.size(), 0u);
+    EXPECT_EQ(workspaceCount(), 0u);
+}
+
+TEST_F(PreparedDataCacheTest, IdleEntriesAreKeptUpToTheLimit) {
+    RatesStorageProvider provider(historyDir.string());
+    WorkspaceManager workspaces(workspaceDir.string());
+    PreparedDataCache cache(provider, workspaces);
+    cache.setIdleLimit(1);
+
+    std::string path = cache.acquire("EUR/USD", weekStart, "m1").value().paths[0];
+    workspaces.flush();
+    EXPECT_TRUE(std::filesystem::exists(path));
+    // The next job of the week reuses the idle files
+    EXPECT_EQ(cache.acquire("EUR/USD", weekStart, "m1").value().paths[0], path);
+    EXPECT_EQ(cache.stats().prepared, 1u);
+    EXPECT_EQ(cache.stats().reused, 1u);
+    EXPECT_DOUBLE_EQ(cache.stats().hitRate(), 0.5);
+
+    // A second idle entry pushes out the least recently released one
+    std::tm otherWeek = weekStart;
+    otherWeek.tm_mday += 7;
+    EXPECT_FALSE(cache.acquire("EUR/USD", otherWeek, "m1").has_value());
+    workspaces.flush();
+    EXPECT_FALSE(std::filesystem::exists(path));
+    EXPECT_EQ(cache.size(), 1u);
+
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0u);
+}
@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include "ResourceUsageReport.h"
+#include "ProcessRunner.h"
+#include <sstream>
+
+namespace {
+    ProcessUsage usage(double userSeconds, long maxRssKb, long blockOutputs) {
+        ProcessUsage result;
+        result.userSeconds = userSeconds;
+        result.systemSeconds = userSeconds / 10;
+        result.maxRssKb = maxRssKb;
+        result.minorFaults = 100;
+        result.blockOutputs = blockOutputs;
+        return result;
+    }
+}
+
+TEST(ResourceUsageReportTest, SumsPerStrategyAndSymbol) {
+    ResourceUsageReport report;
+    EXPECT_TRUE(report.empty());
+    report.add("MA", { "EURUSD" }, usage(1.0, 2048, 8));
+    report.add("MA", { "EURUSD", "USDJPY" }, usage(2.0, 4096, 16));
+    report.add("RSI", { "USDJPY" }, usage(0.5, 1024, 0));
+
+    auto strategies = report.byStrategy();
+    ASSERT_EQ(strategies.size(), 2u);
+    EXPECT_EQ(strategies["MA"].runs, 2u);
+    EXPECT_DOUBLE_EQ(strategies["MA"].usage.userSeconds, 3.0);
+    EXPECT_EQ(strategies["MA"].usage.maxRssKb, 4096);
+    EXPECT_EQ(strategies["MA"].usage.minorFaults, 200);
+    EXPECT_EQ(strategies["MA"].usage.blockOutputs, 24);
+
+    // The portfolio run counts for both of its symbols
+    auto symbols = report.bySymbol();
+    EXPECT_EQ(symbols["EURUSD"].runs, 2u);
+    EXPECT_EQ(symbols["USDJPY"].runs, 2u);
+    EXPECT_DOUBLE_EQ(symbols["USDJPY"].usage.userSeconds, 2.5);
+
+    std::ostringstream output;
+    report.write(output);
+    EXPECT_NE(output.str().find("Resource usage per strategy:"), std::string::npos);
+    EXPECT_NE(output.str().find("  MA: 2 runs"), std::string::npos);
+    EXPECT_NE(output.str().find("  USDJPY: 2 runs"), std::string::npos);
+}
+
+#ifndef _WIN32
+TEST(ResourceUsageReportTest, ChildUsageIsMeasured) {
+    ProcessUsage measured;
+    // Burn some CPU in the child
+    int exitCode = ProcessRunner::run({ "/bin/sh", "-c", "i=0; while [ $i -lt 200000 ]; do i=$((i+1)); done" }, nullptr, &measured);
+    EXPECT_EQ(exitCode, 0);
+    EXPECT_TRUE(measured.spawned);
+    EXPECT_GT(measured.userSeconds + measured.systemSeconds, 0.0);
+    EXPECT_GT(measured.maxRssKb, 0);
+    EXPECT_GT(measured.minorFaults, 0);
+}
+
+TEST(ResourceUsageReportTest, FailedRunsAreMeasuredButNotStartedOnes) {
+    ProcessUsage failed;
+    EXPECT_EQ(ProcessRunner::run({ "/bin/sh", "-c", "exit 3" }, nullptr, &failed), 3);
+    EXPECT_TRUE(failed.spawned);
+    ProcessUsage notStarted;
+    EXPECT_EQ(ProcessRunner::run({}, nullptr, &notStarted), -1);
+    EXPECT_FALSE(notStarted.spawned);
+}
+#endif
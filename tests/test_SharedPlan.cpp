@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include "ClaimDirectory.h"
+#include "SharedPlan.h"
+#include "SharedPlanNode.h"
+#include "JobPlanner.h"
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <nlohmann/json.hpp>
+
+class SharedPlanTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        testDir = std::filesystem::temp_directory_path() / "shared_plan_test";
+        planDir = testDir / "plan";
+        historyDir = testDir / "history";
+        backtesterDir = testDir / "backtester";
+        std::filesystem::create_directories(historyDir / "EURUSD");
+        std::filesystem::create_directories(backtesterDir);
+        std::ofstream info(historyDir / "EURUSD" / "info.json");
+        info << "{\"Name\": \"EURUSD\", \"ContractCurrency\": \"EUR\", \"ProfitCurrency\": \"USD\"}";
+        info.close();
+        std::ofstream week(historyDir / "EURUSD" / "2000-1.csv");
+        week << "03.01.2000 10:00:00;1,1;1,2;1,0;1,1;1,1;1,2;1,0;1,1;5\n";
+        week.close();
+        std::filesystem::path script = backtesterDir / "ConsoleBacktester.exe";
+        std::ofstream file(script);
+        file << "#!/bin/sh\necho \"profit=1\" > \"$5\"\n";
+        file.close();
+        std::filesystem::permissions(script, std::filesystem::perms::owner_all);
+    }
+
+    void TearDown() override {
+        try {
+            std::filesystem::remove_all(testDir);
+        } catch (const std::exception&) {
+            // Ignore cleanup errors
+        }
+    }
+
+    SharedPlan createPlan(size_t windowCount, size_t chunkSize) {
+        SharedPlan plan;
+        plan.spec.strategy = "MA_Cross_Strategy";
+        plan.spec.portfolios = { { "EUR/USD" } };
+        plan.spec.parameters = { { "Fast", { "5", "10" } } };
+        plan.historyPath = historyDir.string();
+        plan.windows = JobPlanner::planWindows(std::time(nullptr));
+        plan.windows.resize(windowCount);
+        plan.chunkSize = chunkSize;
+        plan.taskCount = 2 * windowCount;
+        return plan;
+    }
+
+    std::filesystem::path testDir;
+    std::filesystem::path planDir;
+    std::filesystem::path historyDir;
+    std::filesystem::path backtesterDir;
+};
+
+TEST_F(SharedPlanTest, ClaimsAreExclusive) {
+    ClaimDirectory first(planDir.string(), "first", std::chrono::seconds(60));
+    ClaimDirectory second(planDir.string(), "second", std::chrono::seconds(60));
+    auto a = first.claimNext(2, 1000);
+    auto b = second.claimNext(2, 1000);
+    ASSERT_TRUE(a.has_value() && b.has_value());
+    EXPECT_EQ(a.value().chunk, 0u);
+    EXPECT_EQ(b.value().chunk, 1u);
+    EXPECT_FALSE(first.claimNext(2, 1000).has_value());
+}
+
+TEST_F(SharedPlanTest, ExpiredClaimIsTakenOver) {
+    ClaimDirectory crashed(planDir.string(), "crashed", std::chrono::seconds(60));
+    ClaimDirectory alive(planDir.string(), "alive", std::chrono::seconds(60));
+    auto stale = crashed.claimNext(1, 1000);
+    ASSERT_TRUE(stale.has_value());
+    EXPECT_FALSE(alive.claimNext(1, 1059).has_value());
+
+    auto takenOver = alive.claimNext(1, 1060);
+    ASSERT_TRUE(takenOver.has_value());
+    EXPECT_EQ(takenOver.value().generation, 1u);
+    // The crashed node learns about the takeover when it tries to renew
+    EXPECT_FALSE(crashed.renew(stale.value(), 1061));
+    EXPECT_TRUE(alive.renew(takenOver.value(), 1061));
+    EXPECT_EQ(takenOver.value().expiresAt, 1121);
+}
+
+TEST_F(SharedPlanTest, CompletedChunksAreNotClaimedAgain) {
+    ClaimDirectory claims(planDir.string(), "node", std::chrono::seconds(60));
+    auto claim = claims.claimNext(1, 1000);
+    ASSERT_TRUE(claim.has_value());
+    EXPECT_FALSE(claims.isComplete(1));
+    claims.complete(claim.value());
+    EXPECT_TRUE(claims.isComplete(1));
+    EXPECT_FALSE(claims.claimNext(1, 5000).has_value());
+}
+
+TEST_F(SharedPlanTest, FirstPlanWins) {
+    auto created = SharedPlan::create(planDir.string(), createPlan(3, 2));
+    ASSERT_TRUE(created.has_value());
+    auto other = SharedPlan::create(planDir.string(), createPlan(5, 4));
+    ASSERT_TRUE(other.has_value());
+    EXPECT_EQ(other.value().windows.size(), 3u);
+    EXPECT_EQ(other.value().chunkSize, 2u);
+    EXPECT_EQ(other.value().windows[1].startTime, created.value().windows[1].startTime);
+}
+
+TEST_F(SharedPlanTest, SessionStartIsStoredInThePlan) {
+    SharedPlan plan = createPlan(1, 1);
+    plan.sessionStartMinutes = -420;
+    ASSERT_TRUE(SharedPlan::create(planDir.string(), plan).has_value());
+    auto loaded = SharedPlan::load(planDir.string());
+    ASSERT_TRUE(loaded.has_value());
+    EXPECT_EQ(loaded.value().sessionStartMinutes, -420);
+    EXPECT_EQ(loaded.value().windows[0].start.tm_year, plan.windows[0].start.tm_year);
+    EXPECT_EQ(loaded.value().windows[0].start.tm_yday, plan.windows[0].start.tm_yday);
+    EXPECT_EQ(loaded.value().windows[0].start.tm_mday, plan.windows[0].start.tm_mday);
+}
+
+#ifndef _WIN32
+
+TEST_F(SharedPlanTest, NodesShareThePlanAndResultsAreAggregated) {
+    ASSERT_TRUE(SharedPlan::create(planDir.string(), createPlan(4, 3)).has_value());
+    std::vector<std::optional<size_t>> completed(2);
+    std::vector<std::thread> nodes;
+    for (int i = 0; i < 2; i++) {
+        nodes.emplace_back([&, i]() {
+            SharedPlanNode node(planDir.string(), "node" + std::to_string(i), backtesterDir.string(), std::chrono::seconds(60));
+            completed[i] = node.run(2);
+        });
+    }
+    for (auto& node : nodes) {
+        node.join();
+    }
+    ASSERT_TRUE(completed[0].has_value() && completed[1].has_value());
+    // Only the first week has history, for both parameter sets
+    EXPECT_EQ(completed[0].value() + completed[1].value(), 2u);
+
+    std::string outputPath = (testDir / "results.jsonl").string();
+    auto missing = SharedPlanNode::aggregate(planDir.string(), outputPath);
+    ASSERT_TRUE(missing.has_value());
+    EXPECT_EQ(missing.value(), 0u);
+    std::ifstream output(outputPath);
+    std::string line;
+    size_t expectedTask = 0;
+    while (std::getline(output, line)) {
+        EXPECT_EQ(nlohmann::json::parse(line)["task"].get<size_t>(), expectedTask++);
+    }
+    EXPECT_EQ(expectedTask, 8u);
+}
+
+TEST_F(SharedPlanTest, AggregateReportsMissingTasks) {
+    ASSERT_TRUE(SharedPlan::create(planDir.string(), createPlan(2, 2)).has_value());
+    std::filesystem::create_directories(planDir / "results");
+    std::ofstream shard(planDir / "results" / "node.jsonl");
+    shard << "{\"task\": 0, \"completed\": false}\n{\"task\": 0, \"completed\": true}\n{\"task\": 1, \"comp";
+    shard.close();
+
+    std::string outputPath = (testDir / "results.jsonl").string();
+    auto missing = SharedPlanNode::aggregate(planDir.string(), outputPath);
+    ASSERT_TRUE(missing.has_value());
+    EXPECT_EQ(missing.value(), 3u);
+    std::ifstream output(outputPath);
+    std::string line;
+    ASSERT_TRUE(std::getline(output, line));
+    EXPECT_TRUE(nlohmann::json::parse(line)["completed"].get<bool>());
+}
+
+#endif
@@ -280,3 +280,99 @@ TEST_F(StorageReaderTest, HandleNegativeValues) {
     EXPECT_DOUBLE_EQ(data.ask.close, -112.76);
     EXPECT_EQ(data.volume, -14);
 }
+
+TEST_F(StorageReaderTest, TolerantReadSkipsMalformedLines) {
+    std::string testData =
+        "29.04.2022 14:54:00;118,12;112,75;112,71;112,75;118,17;112,76;112,73;112,76;14\n"
+        "29.04.2022 14:55:00;118,12;112,75\n"
+        "\n"
+        "29-04-2022 14:56:00;118,12;112,75;112,71;112,75;118,17;112,76;112,73;112,76;14\n"
+        "29.04.2022 14:57:00;118,12;x;112,71;112,75;118,17;112,76;112,73;112,76;14\n"
+        "29.04.2022 14:58:00;118,12;112,75;112,71;112,75;118,17;112,76;112,73;112,76;lots\n"
+        "29.04.2022 14:59:00;119,50;113,25;113,20;113,25;119,55;113,30;113,25;113,30;20\r\n";
+    createTestFile(testData);
+
+    std::ifstream file(testFileName);
+    StorageReadErrors errors;
+    Data data;
+
+    ASSERT_TRUE(StorageReader::readNext(file, data, errors));
+    EXPECT_EQ(data.timestamp.tm_min, 54);
+    ASSERT_TRUE(StorageReader::readNext(file, data, errors));
+    EXPECT_EQ(data.timestamp.tm_min, 59);
+    EXPECT_DOUBLE_EQ(data.ask.close, 113.30);
+    EXPECT_EQ(data.volume, 20);
+    // The end of the file, not another parse failure
+    EXPECT_FALSE(StorageReader::readNext(file, data, errors));
+
+    EXPECT_EQ(errors.lines, 7u);
+    EXPECT_EQ(errors.total(), 4u);
+    EXPECT_EQ(errors.fieldCount, 1u);
+    EXPECT_EQ(errors.timestamp, 1u);
+    EXPECT_EQ(errors.price, 1u);
+    EXPECT_EQ(errors.volume, 1u);
+    EXPECT_EQ(errors.lineNumbers, (std::vector<size_t>{ 2, 4, 5, 6 }));
+    EXPECT_EQ(errors.describe(), "4 malformed lines (1 field count, 1 timestamp, 1 price, 1 volume), first at lines 2, 4, 5, 6");
+}
+
+TEST_F(StorageReaderTest, ParseReportsErrorCategory) {
+    Data data;
+    EXPECT_EQ(StorageReader::parse("29.04.2022 14:54:00;1;1;1;1;1;1;1;1;1", data), StorageLineError::None);
+    EXPECT_EQ(StorageReader::parse("29.04.2022 14:54:00;1;1;1;1;1;1;1;1;1;1", data), StorageLineError::FieldCount);
+    EXPECT_EQ(StorageReader::parse("29.04.2022 25:54:00;1;1;1;1;1;1;1;1;1", data), StorageLineError::Timestamp);
+    EXPECT_EQ(StorageReader::parse("29.04.2022 14:54:00;1;1;1;1;1;1;1;1 2;1", data), StorageLineError::Price);
+    EXPECT_EQ(StorageReader::parse("29.04.2022 14:54:00;1;1;1;1;1;1;1;1;x", data), StorageLineError::Volume);
+}
+
+TEST_F(StorageReaderTest, DialectsParseTheirLayouts) {
+    auto parse = [](auto dialect, const std::string& line, Data& data) {
+        return StorageReader::parse<decltype(dialect)>(line.data(), line.data() + line.size(), data);
+    };
+    Data data;
+    ASSERT_EQ(parse(DotDecimalDialect{}, "29.04.2022 14:54:00;1.5;1.6;1.4;1.55;1.6;1.7;1.5;1.65;7", data), StorageLineError::None);
+    EXPECT_DOUBLE_EQ(data.ask.close, 1.65);
+    // Only the standard dialect converts ',' decimals
+    EXPECT_EQ(parse(DotDecimalDialect{}, "29.04.2022 14:54:00;1,5;1,6;1,4;1,55;1,6;1,7;1,5;1,65;7", data), StorageLineError::Price);
+
+    ASSERT_EQ(parse(IsoDialect{}, "2022-04-29T14:54:00,1.5,1.6,1.4,1.55,1.6,1.7,1.5,1.65,7", data), StorageLineError::None);
+    EXPECT_EQ(data.timestamp.tm_year, 122);
+    EXPECT_EQ(data.timestamp.tm_mon, 3);
+    EXPECT_EQ(data.timestamp.tm_mday, 29);
+    EXPECT_EQ(data.timestamp.tm_min, 54);
+    EXPECT_DOUBLE_EQ(data.bid.open, 1.5);
+    EXPECT_EQ(parse(IsoDialect{}, "29.04.2022 14:54:00,1.5,1.6,1.4,1.55,1.6,1.7,1.5,1.65,7", data), StorageLineError::Timestamp);
+
+    ASSERT_EQ(parse(BidOnlyDialect{}, "29.04.2022 14:54:00;1,5;1,6;1,4;1,55;7", data), StorageLineError::None);
+    EXPECT_DOUBLE_EQ(data.bid.high, 1.6);
+    EXPECT_DOUBLE_EQ(data.ask.high, 1.6);
+    EXPECT_DOUBLE_EQ(data.ask.close, 1.55);
+    EXPECT_EQ(data.volume, 7);
+    EXPECT_EQ(parse(BidOnlyDialect{}, "29.04.2022 14:54:00;1,5;1,6;1,4;1,55;1,6;1,7;1,5;1,65;7", data), StorageLineError::FieldCount);
+
+    ASSERT_EQ(parse(TickDialect{}, "2022-04-29 14:54:07.250Z,1.1001,1.1003,2", data), StorageLineError::None);
+    EXPECT_EQ(data.timestamp.tm_sec, 7);
+    EXPECT_DOUBLE_EQ(data.bid.open, 1.1001);
+    EXPECT_DOUBLE_EQ(data.bid.low, 1.1001);
+    EXPECT_DOUBLE_EQ(data.ask.high, 1.1003);
+    EXPECT_EQ(data.volume, 2);
+    EXPECT_EQ(parse(TickDialect{}, "2022-04-29 14:54:07.2x,1.1001,1.1003,2", data), StorageLineError::Timestamp);
+}
+
+TEST_F(StorageReaderTest, LineReaderFollowsFormat) {
+    createTestFile("2022-04-29T14:54:00,1.1001,1.1003,2\n"
+                   "bad line\n"
+                   "2022-04-29T14:54:01,1.1002,1.1004,1\n");
+    std::ifstream file(testFileName);
+    StorageReader::LineReader reader = StorageReader::lineReader(HistoryFormat::Tick);
+    StorageReadErrors errors;
+    Data data;
+    ASSERT_TRUE(reader(file, data, errors));
+    ASSERT_TRUE(reader(file, data, errors));
+    EXPECT_DOUBLE_EQ(data.ask.close, 1.1004);
+    EXPECT_FALSE(reader(file, data, errors));
+    EXPECT_EQ(errors.fieldCount, 1u);
+
+    EXPECT_EQ(HistoryFormats::parse("BidOnly"), HistoryFormat::BidOnly);
+    EXPECT_STREQ(HistoryFormats::name(HistoryFormat::DotDecimal), "DotDecimal");
+    EXPECT_FALSE(HistoryFormats::parse("bidonly").has_value());
+}
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include "StragglerMonitor.h"
+#include "ProcessRunner.h"
+#include <chrono>
+#include <thread>
+
+namespace {
+    typedef StragglerMonitor::Clock Clock;
+
+    // Records durations of 1..count seconds for the key
+    void recordDurations(StragglerMonitor& monitor, const std::string& key, size_t count) {
+        Clock::time_point now = Clock::now();
+        for (size_t i = 1; i <= count; i++) {
+            auto attempt = monitor.begin(1000 + i, key, now - std::chrono::seconds(i));
+            monitor.finish(attempt, true, now);
+        }
+    }
+}
+
+TEST(StragglerMonitorTest, PercentileNeedsEnoughSamples) {
+    StragglerMonitor monitor(3.0, 5);
+    recordDurations(monitor, "MA:m1:EURUSD", 4);
+    EXPECT_FALSE(monitor.percentile95("MA:m1:EURUSD").has_value());
+    recordDurations(monitor, "MA:m1:EURUSD", 20);
+    // 24 samples, the 95th percentile is the 23rd smallest
+    ASSERT_TRUE(monitor.percentile95("MA:m1:EURUSD").has_value());
+    EXPECT_NEAR(monitor.percentile95("MA:m1:EURUSD").value(), 19.0, 1e-6);
+    EXPECT_FALSE(monitor.percentile95("MA:m1:USDJPY").has_value());
+}
+
+TEST(StragglerMonitorTest, OnlyOverdueTasksGetOneCopy) {
+    StragglerMonitor monitor(2.0, 5);
+    recordDurations(monitor, "MA", 10);
+    Clock::time_point now = Clock::now();
+    auto slow = monitor.begin(1, "MA", now - std::chrono::seconds(30));
+    auto normal = monitor.begin(2, "MA", now - std::chrono::seconds(5));
+    auto unknown = monitor.begin(3, "RSI", now - std::chrono::seconds(300));
+
+    auto copy = monitor.speculate(now);
+    ASSERT_NE(copy, nullptr);
+    EXPECT_EQ(copy->task, 1u);
+    EXPECT_TRUE(copy->copy);
+    EXPECT_EQ(monitor.speculate(now), nullptr);
+    EXPECT_EQ(monitor.metrics().copies, 1u);
+}
+
+TEST(StragglerMonitorTest, FirstFinisherWinsAndCancelsTheOther) {
+    StragglerMonitor monitor(2.0, 5);
+    recordDurations(monitor, "MA", 10);
+    Clock::time_point now = Clock::now();
+    auto original = monitor.begin(1, "MA", now - std::chrono::seconds(60));
+    auto copy = monitor.speculate(now);
+    ASSERT_NE(copy, nullptr);
+
+    EXPECT_TRUE(monitor.finish(copy, true, now + std::chrono::seconds(5)));
+    EXPECT_TRUE(original->cancellation.isCancelled());
+    EXPECT_FALSE(copy->cancellation.isCancelled());
+    EXPECT_FALSE(monitor.finish(original, false, now + std::chrono::seconds(6)));
+    EXPECT_FALSE(monitor.hasRunning());
+    EXPECT_EQ(monitor.metrics().copiesWon, 1u);
+}
+
+TEST(StragglerMonitorTest, FailedAttemptLeavesTheOtherRunning) {
+    StragglerMonitor monitor(2.0, 5);
+    recordDurations(monitor, "MA", 10);
+    Clock::time_point now = Clock::now();
+    auto original = monitor.begin(1, "MA", now - std::chrono::seconds(60));
+    auto copy = monitor.speculate(now);
+    ASSERT_NE(copy, nullptr);
+
+    EXPECT_FALSE(monitor.finish(original, false, now + std::chrono::seconds(1)));
+    EXPECT_FALSE(copy->cancellation.isCancelled());
+    EXPECT_TRUE(monitor.hasRunning());
+    // The task already had its copy
+    EXPECT_EQ(monitor.speculate(now + std::chrono::seconds(120)), nullptr);
+    // The last attempt finishes the task even when it fails
+    EXPECT_TRUE(monitor.finish(copy, false, now + std::chrono::seconds(2)));
+    EXPECT_FALSE(monitor.hasRunning());
+    EXPECT_EQ(monitor.metrics().copiesWon, 0u);
+}
+
+TEST(StragglerMonitorTest, DisabledMonitorNeverSpeculates) {
+    StragglerMonitor monitor(0.0, 1);
+    recordDurations(monitor, "MA", 10);
+    monitor.begin(1, "MA", Clock::now() - std::chrono::hours(1));
+    EXPECT_FALSE(monitor.isEnabled());
+    EXPECT_EQ(monitor.speculate(), nullptr);
+}
+
+#ifndef _WIN32
+TEST(ProcessRunnerTest, ReturnsExitCode) {
+    EXPECT_EQ(ProcessRunner::run({ "/bin/sh", "-c", "exit 3" }), 3);
+    EXPECT_EQ(ProcessRunner::run({ "/nonexistent/program" }), 127);
+}
+
+TEST(ProcessRunnerTest, CancellationKillsTheChild) {
+    ProcessCancellation cancellation;
+    auto started = std::chrono::steady_clock::now();
+    std::thread canceller([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        cancellation.cancel();
+    });
+    int exitCode = ProcessRunner::run({ "/bin/sleep", "30" }, &cancellation);
+    canceller.join();
+    EXPECT_EQ(exitCode, -1);
+    EXPECT_TRUE(cancellation.isCancelled());
+    EXPECT_LT(std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count(), 10.0);
+}
+
+TEST(ProcessRunnerTest, CancelledBeforeStartNeverRuns) {
+    ProcessCancellation cancellation;
+    cancellation.cancel();
+    EXPECT_EQ(ProcessRunner::run({ "/bin/sleep", "30" }, &cancellation), -1);
+}
+#endif
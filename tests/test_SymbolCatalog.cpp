@@ -0,0 +1,203 @@
+#include <gtest/gtest.h>
+#include "SymbolCatalog.h"
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+
+class SymbolCatalogTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        testDir = std::filesystem::temp_directory_path() / "symbol_catalog_test";
+        historyDir = testDir / "history";
+        snapshotPath = (testDir / "catalog.bin").string();
+        std::filesystem::create_directories(historyDir);
+    }
+
+    void TearDown() override {
+        try {
+            std::filesystem::remove_all(testDir);
+        } catch (const std::exception&) {
+            // Ignore cleanup errors
+        }
+    }
+
+    void createSymbol(const std::string& directory, const std::string& content) {
+        std::filesystem::create_directories(historyDir / directory);
+        std::ofstream file(historyDir / directory / "info.json");
+        file << content;
+        file.close();
+    }
+
+    std::string symbolJson(const std::string& name, const std::string& profitCurrency) {
+        return "{\"Provider\": \"FXCM\", \"Name\": \"" + name + "\", \"ContractCurrency\": \"USD\", \"ProfitCurrency\": \""
+            + profitCurrency + "\", \"BaseUnitSize\": 100000.0, \"MMR\": 0.02, \"PipSize\": 0.0001, \"Precision\": 5, \"MarginEnabled\": true}";
+    }
+
+    std::filesystem::path testDir;
+    std::filesystem::path historyDir;
+    std::string snapshotPath;
+};
+
+TEST_F(SymbolCatalogTest, ScanFindsAllSymbols) {
+    createSymbol("EURUSD", symbolJson("EURUSD", "USD"));
+    createSymbol("USDJPY", symbolJson("USDJPY", "JPY"));
+
+    SymbolCatalog catalog(historyDir.string(), std::nullopt);
+    catalog.load();
+
+    EXPECT_EQ(catalog.size(), 2u);
+    EXPECT_FALSE(catalog.isLoadedFromSnapshot());
+    auto info = catalog.find("USDJPY");
+    ASSERT_TRUE(info.has_value());
+    EXPECT_EQ(info.value().name, "USDJPY");
+    EXPECT_EQ(info.value().profitCurrency, "JPY");
+    EXPECT_EQ(info.value().provider.value(), "FXCM");
+    EXPECT_DOUBLE_EQ(info.value().pipSize, 0.0001);
+    EXPECT_EQ(info.value().precision, 5);
+    EXPECT_TRUE(info.value().marginEnabled);
+    EXPECT_FALSE(catalog.find("GBPUSD").has_value());
+}
+
+TEST_F(SymbolCatalogTest, StringsAreInterned) {
+    createSymbol("EURUSD", symbolJson("EURUSD", "USD"));
+    createSymbol("GBPUSD", symbolJson("GBPUSD", "USD"));
+
+    SymbolCatalog catalog(historyDir.string(), std::nullopt);
+    catalog.load();
+
+    // FXCM, USD, EURUSD, GBPUSD
+    EXPECT_EQ(catalog.internedStringCount(), 4u);
+}
+
+TEST_F(SymbolCatalogTest, ProviderNullIsPreserved) {
+    createSymbol("EURUSD", "{\"Name\": \"EURUSD\", \"Provider\": null}");
+
+    SymbolCatalog catalog(historyDir.string(), snapshotPath);
+    catalog.load();
+    SymbolCatalog reloaded(historyDir.string(), snapshotPath);
+    reloaded.load();
+
+    ASSERT_TRUE(reloaded.isLoadedFromSnapshot());
+    EXPECT_FALSE(reloaded.find("EURUSD").value().provider.has_value());
+}
+
+TEST_F(SymbolCatalogTest, HistoryFormatIsPreserved) {
+    createSymbol("EURUSD", "{\"Name\": \"EURUSD\", \"HistoryFormat\": \"BidOnly\"}");
+    createSymbol("USDJPY", symbolJson("USDJPY", "JPY"));
+
+    SymbolCatalog catalog(historyDir.string(), snapshotPath);
+    catalog.load();
+    SymbolCatalog reloaded(historyDir.string(), snapshotPath);
+    reloaded.load();
+
+    ASSERT_TRUE(reloaded.isLoadedFromSnapshot());
+    EXPECT_EQ(reloaded.find("EURUSD").value().historyFormat, HistoryFormat::BidOnly);
+    EXPECT_EQ(reloaded.find("USDJPY").value().historyFormat, HistoryFormat::Standard);
+}
+
+TEST_F(SymbolCatalogTest, SnapshotIsReusedWhenUnchanged) {
+    createSymbol("EURUSD", symbolJson("EURUSD", "USD"));
+    createSymbol("USDJPY", symbolJson("USDJPY", "JPY"));
+
+    SymbolCatalog catalog(historyDir.string(), snapshotPath);
+    catalog.load();
+    EXPECT_FALSE(catalog.isLoadedFromSnapshot());
+    EXPECT_TRUE(std::filesystem::exists(snapshotPath));
+
+    SymbolCatalog reloaded(historyDir.string(), snapshotPath);
+    reloaded.load();
+    EXPECT_TRUE(reloaded.isLoadedFromSnapshot());
+    EXPECT_EQ(reloaded.size(), 2u);
+    EXPECT_EQ(reloaded.find("USDJPY").value().profitCurrency, "JPY");
+    EXPECT_DOUBLE_EQ(reloaded.find("EURUSD").value().mmr, 0.02);
+}
+
+TEST_F(SymbolCatalogTest, SnapshotIsRebuiltWhenSourceChanges) {
+    createSymbol("EURUSD", symbolJson("EURUSD", "USD"));
+
+    SymbolCatalog catalog(historyDir.string(), snapshotPath);
+    catalog.load();
+
+    createSymbol("EURUSD", symbolJson("EURUSD", "CHF") + "  ");
+    SymbolCatalog reloaded(historyDir.string(), snapshotPath);
+    reloaded.load();
+    EXPECT_FALSE(reloaded.isLoadedFromSnapshot());
+    EXPECT_EQ(reloaded.find("EURUSD").value().profitCurrency, "CHF");
+}
+
+TEST_F(SymbolCatalogTest, SnapshotIsRebuiltWhenSymbolAdded) {
+    createSymbol("EURUSD", symbolJson("EURUSD", "USD"));
+
+    SymbolCatalog catalog(historyDir.string(), snapshotPath);
+    catalog.load();
+
+    createSymbol("GBPUSD", symbolJson("GBPUSD", "USD"));
+    SymbolCatalog reloaded(historyDir.string(), snapshotPath);
+    reloaded.load();
+    EXPECT_FALSE(reloaded.isLoadedFromSnapshot());
+    EXPECT_TRUE(reloaded.find("GBPUSD").has_value());
+}
+
+TEST_F(SymbolCatalogTest, CorruptSnapshotIsIgnored) {
+    createSymbol("EURUSD", symbolJson("EURUSD", "USD"));
+    std::ofstream snapshot(snapshotPath, std::ios::binary);
+    snapshot << "garbage";
+    snapshot.close();
+
+    SymbolCatalog catalog(historyDir.string(), snapshotPath);
+    catalog.load();
+    EXPECT_FALSE(catalog.isLoadedFromSnapshot());
+    EXPECT_TRUE(catalog.find("EURUSD").has_value());
+}
+
+TEST_F(SymbolCatalogTest, SnapshotWithInvalidIdsOrLengthsIsIgnored) {
+    createSymbol("EURUSD", symbolJson("EURUSD", "USD"));
+    SymbolCatalog catalog(historyDir.string(), snapshotPath);
+    catalog.load();
+    std::string original;
+    {
+        std::ifstream file(snapshotPath, std::ios::binary);
+        original.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    // The name id of the only entry, which ends the file together with its source
+    std::string badId = original;
+    size_t entry = badId.size() - sizeof(SymbolCatalog::Entry) - sizeof(SymbolCatalog::SourceFile);
+    uint32_t id = 1000;
+    std::memcpy(&badId[entry + offsetof(SymbolCatalog::Entry, name)], &id, sizeof(id));
+    // The length of the history path right after magic and version
+    std::string badLength = original;
+    uint32_t length = 0xFFFFFFF0u;
+    std::memcpy(&badLength[8], &length, sizeof(length));
+
+    for (const std::string& corrupt : { badId, badLength }) {
+        std::ofstream(snapshotPath, std::ios::binary | std::ios::trunc) << corrupt;
+        SymbolCatalog reloaded(historyDir.string(), snapshotPath);
+        reloaded.load();
+        EXPECT_FALSE(reloaded.isLoadedFromSnapshot());
+        EXPECT_EQ(reloaded.find("EURUSD").value().name, "EURUSD");
+    }
+}
+
+TEST_F(SymbolCatalogTest, InvalidInfoIsSkipped) {
+    createSymbol("EURUSD", symbolJson("EURUSD", "USD"));
+    createSymbol("BROKEN", "{ invalid json");
+    std::filesystem::create_directories(historyDir / "NOINFO");
+
+    SymbolCatalog catalog(historyDir.string(), std::nullopt);
+    catalog.load();
+    EXPECT_EQ(catalog.size(), 1u);
+    EXPECT_FALSE(catalog.find("BROKEN").has_value());
+    EXPECT_FALSE(catalog.find("NOINFO").has_value());
+}
+
+TEST_F(SymbolCatalogTest, MissingHistoryPathGivesEmptyCatalog) {
+    SymbolCatalog catalog((testDir / "missing").string(), std::nullopt);
+    catalog.load();
+    EXPECT_EQ(catalog.size(), 0u);
+}
@@ -630,3 +630,16 @@ TEST_F(SymbolInfoParserTest, ParseInvalidJson) {
         SymbolInfo info = SymbolInfoParser::parse(filePath);
     }, nlohmann::json::parse_error);
 }
+
+// Test parsing the history format
+TEST_F(SymbolInfoParserTest, ParseHistoryFormat) {
+    createTestFile("tick.json", R"({ "Name": "TEST", "HistoryFormat": "Tick" })");
+    createTestFile("default.json", R"({ "Name": "TEST" })");
+    createTestFile("unknown.json", R"({ "Name": "TEST", "HistoryFormat": "Excel" })");
+
+    EXPECT_EQ(SymbolInfoParser::parse((testDir / "tick.json").string()).historyFormat, HistoryFormat::Tick);
+    EXPECT_EQ(SymbolInfoParser::parse((testDir / "default.json").string()).historyFormat, HistoryFormat::Standard);
+    EXPECT_THROW({
+        SymbolInfo info = SymbolInfoParser::parse((testDir / "unknown.json").string());
+    }, std::runtime_error);
+}
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include "TickBarReader.h"
+#include "RatesStorageProvider.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+class TickBarReaderTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        historyDir = std::filesystem::temp_directory_path() / "tick_bar_reader_test";
+        std::filesystem::remove_all(historyDir);
+        std::filesystem::create_directories(historyDir / "EURUSD");
+        std::filesystem::create_directories(historyDir / "USDJPY");
+        writeFile("EURUSD/info.json", "{\"Name\": \"EUR/USD\", \"HistoryFormat\": \"Tick\"}");
+    }
+
+    void TearDown() override {
+        try {
+            std::filesystem::remove_all(historyDir);
+        } catch (const std::exception&) {
+            // Ignore cleanup errors
+        }
+    }
+
+    void writeFile(const std::string& file, const std::string& content) {
+        std::ofstream output(historyDir / file);
+        output << content;
+    }
+
+    // 2024-01-03 00:00:05, 00:00:40 and 00:00:59 then 00:01:30 and 00:05:10
+    static std::string ticks() {
+        return "2024-01-03T00:00:05.100Z,1.1000,1.1002,3\n"
+               "2024-01-03T00:00:40.000Z,1.1010,1.1012,1\n"
+               "2024-01-03T00:00:59.900Z,1.0990,1.0993,2\n"
+               "2024-01-03T00:01:30.000Z,1.0995,1.0997,1\n"
+               "2024-01-03T00:05:10.000Z,1.1005,1.1008,1\n";
+    }
+
+    std::filesystem::path historyDir;
+};
+
+TEST_F(TickBarReaderTest, AggregatesAcrossChunkBoundaries) {
+    // Chunks of 7 bytes split every line
+    std::istringstream input(ticks());
+    TickBarReader reader(input, 60, 0, 7);
+    BarColumns bars;
+    size_t chunks = 0;
+    while (reader.readChunk(bars)) {
+        chunks++;
+    }
+    EXPECT_GT(chunks, 10u);
+    EXPECT_EQ(reader.ticksRead(), 5u);
+    EXPECT_EQ(reader.errors().total(), 0u);
+    ASSERT_EQ(bars.size(), 3u);
+    EXPECT_EQ(bars.time[0], 1704240000);
+    EXPECT_DOUBLE_EQ(bars.bidOpen[0], 1.1000);
+    EXPECT_DOUBLE_EQ(bars.bidHigh[0], 1.1010);
+    EXPECT_DOUBLE_EQ(bars.bidLow[0], 1.0990);
+    EXPECT_DOUBLE_EQ(bars.bidClose[0], 1.0990);
+    EXPECT_DOUBLE_EQ(bars.askHigh[0], 1.1012);
+    EXPECT_DOUBLE_EQ(bars.askClose[0], 1.0993);
+    // Tick volume
+    EXPECT_EQ(bars.volume[0], 3);
+    EXPECT_EQ(bars.time[1], 1704240060);
+    EXPECT_EQ(bars.time[2], 1704240300);
+}
+
+TEST_F(TickBarReaderTest, ReadsBarByBarAndCountsMalformedTicks) {
+    std::istringstream input("2024-01-03T00:00:05,1.1000,1.1002,1\nnot a tick\n\n2024-01-03T00:00:06,1.1001,1.1003,1");
+    TickBarReader reader(input, 300, 0);
+    Data data;
+    ASSERT_TRUE(reader.readNext(data));
+    EXPECT_DOUBLE_EQ(data.bid.close, 1.1001);
+    EXPECT_EQ(data.volume, 2);
+    EXPECT_FALSE(reader.readNext(data));
+    EXPECT_EQ(reader.errors().lines, 4u);
+    EXPECT_EQ(reader.errors().fieldCount, 1u);
+    EXPECT_EQ(reader.errors().lineNumbers, (std::vector<size_t>{ 2 }));
+}
+
+TEST_F(TickBarReaderTest, ProviderFeedsTicksIntoPreparation) {
+    writeFile("EURUSD/2024-1.csv", ticks());
+    writeFile("USDJPY/2024-1.csv", "03.01.2024 00:01:00;140;140;140;140;140,02;140,02;140,02;140,02;5\n");
+    RatesStorageProvider provider(historyDir.string());
+    std::tm week = {};
+    week.tm_year = 124;
+    week.tm_mday = 3;
+
+    BarColumns bars;
+    ASSERT_TRUE(provider.readWeekColumns("EUR/USD", week, "m5", bars));
+    ASSERT_EQ(bars.size(), 2u);
+    EXPECT_EQ(bars.volume[0], 4);
+    EXPECT_DOUBLE_EQ(bars.bidClose[0], 1.0995);
+
+    auto prepared = provider.prepareWeekData(std::vector<std::string>{ "EUR/USD", "USD/JPY" }, week, AlignmentMode::Intersection, "m1",
+        (historyDir / "prepared").string());
+    ASSERT_TRUE(prepared.has_value());
+    std::ifstream file(prepared.value()[0]);
+    std::string line;
+    size_t lines = 0;
+    while (std::getline(file, line)) {
+        lines++;
+    }
+    // Only 00:01 is common to both symbols
+    EXPECT_EQ(lines, 1u);
+}
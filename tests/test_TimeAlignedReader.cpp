@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+#include "TimeAlignedReader.h"
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+class TimeAlignedReaderTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        testDir = std::filesystem::temp_directory_path() / "time_aligned_reader_test";
+        std::filesystem::create_directories(testDir);
+    }
+
+    void TearDown() override {
+        try {
+            std::filesystem::remove_all(testDir);
+        } catch (const std::exception&) {
+            // Ignore cleanup errors
+        }
+    }
+
+    std::string createTestFile(const std::string& name, const std::string& content) {
+        std::string path = (testDir / name).string();
+        std::ofstream file(path);
+        file << content;
+        file.close();
+        return path;
+    }
+
+    std::string bar(const std::string& time, const std::string& price) {
+        return "29.04.2022 " + time + ";" + price + ";" + price + ";" + price + ";" + price + ";"
+            + price + ";" + price + ";" + price + ";" + price + ";1\n";
+    }
+
+    std::filesystem::path testDir;
+};
+
+TEST_F(TimeAlignedReaderTest, UnionMergesByTimestamp) {
+    std::ifstream first(createTestFile("a.csv", bar("10:00:00", "1,1") + bar("10:02:00", "1,3")));
+    std::ifstream second(createTestFile("b.csv", bar("10:01:00", "2,2") + bar("10:02:00", "2,3")));
+
+    TimeAlignedReader reader({ &first, &second }, AlignmentMode::Union);
+
+    auto bars1 = reader.readNext();
+    ASSERT_TRUE(bars1.has_value());
+    ASSERT_EQ(bars1.value().bars.size(), 2u);
+    EXPECT_TRUE(bars1.value().bars[0].has_value());
+    EXPECT_FALSE(bars1.value().bars[1].has_value());
+    EXPECT_DOUBLE_EQ(bars1.value().bars[0].value().bid.close, 1.1);
+
+    auto bars2 = reader.readNext();
+    ASSERT_TRUE(bars2.has_value());
+    EXPECT_FALSE(bars2.value().bars[0].has_value());
+    EXPECT_TRUE(bars2.value().bars[1].has_value());
+    EXPECT_EQ(bars2.value().timestamp - bars1.value().timestamp, 60);
+
+    auto bars3 = reader.readNext();
+    ASSERT_TRUE(bars3.has_value());
+    EXPECT_TRUE(bars3.value().bars[0].has_value());
+    EXPECT_TRUE(bars3.value().bars[1].has_value());
+    EXPECT_DOUBLE_EQ(bars3.value().bars[1].value().bid.close, 2.3);
+
+    EXPECT_FALSE(reader.readNext().has_value());
+}
+
+TEST_F(TimeAlignedReaderTest, IntersectionKeepsCommonTimestampsOnly) {
+    std::ifstream first(createTestFile("a.csv", bar("10:00:00", "1,1") + bar("10:01:00", "1,2") + bar("10:03:00", "1,4")));
+    std::ifstream second(createTestFile("b.csv", bar("10:01:00", "2,2") + bar("10:02:00", "2,3") + bar("10:03:00", "2,4")));
+
+    TimeAlignedReader reader({ &first, &second }, AlignmentMode::Intersection);
+
+    auto bars1 = reader.readNext();
+    ASSERT_TRUE(bars1.has_value());
+    EXPECT_DOUBLE_EQ(bars1.value().bars[0].value().bid.close, 1.2);
+    EXPECT_DOUBLE_EQ(bars1.value().bars[1].value().bid.close, 2.2);
+
+    auto bars2 = reader.readNext();
+    ASSERT_TRUE(bars2.has_value());
+    EXPECT_DOUBLE_EQ(bars2.value().bars[0].value().bid.close, 1.4);
+    EXPECT_DOUBLE_EQ(bars2.value().bars[1].value().bid.close, 2.4);
+
+    EXPECT_FALSE(reader.readNext().has_value());
+}
+
+TEST_F(TimeAlignedReaderTest, IntersectionStopsWhenOneSourceIsExhausted) {
+    std::ifstream first(createTestFile("a.csv", bar("10:00:00", "1,1")));
+    std::ifstream second(createTestFile("b.csv", bar("10:01:00", "2,2") + bar("10:02:00", "2,3")));
+
+    TimeAlignedReader reader({ &first, &second }, AlignmentMode::Intersection);
+
+    EXPECT_FALSE(reader.readNext().has_value());
+}
+
+TEST_F(TimeAlignedReaderTest, SingleSourcePassesThrough) {
+    std::ifstream first(createTestFile("a.csv", bar("10:00:00", "1,1") + bar("10:01:00", "1,2")));
+
+    TimeAlignedReader reader({ &first }, AlignmentMode::Intersection);
+
+    EXPECT_TRUE(reader.readNext().has_value());
+    EXPECT_TRUE(reader.readNext().has_value());
+    EXPECT_FALSE(reader.readNext().has_value());
+}
+
+TEST_F(TimeAlignedReaderTest, EmptySourcesProduceNothing) {
+    std::ifstream first(createTestFile("a.csv", ""));
+    std::ifstream second(createTestFile("b.csv", ""));
+
+    TimeAlignedReader reader({ &first, &second }, AlignmentMode::Union);
+
+    EXPECT_FALSE(reader.readNext().has_value());
+}
+
+TEST_F(TimeAlignedReaderTest, MalformedLineDoesNotEndTheSource) {
+    std::ifstream first(createTestFile("a.csv", bar("10:00:00", "1,1") + "29.04.2022 10:01:00;broken\n" + bar("10:02:00", "1,3")));
+
+    TimeAlignedReader reader({ &first }, AlignmentMode::Union);
+
+    auto bars1 = reader.readNext();
+    auto bars2 = reader.readNext();
+    ASSERT_TRUE(bars2.has_value());
+    EXPECT_DOUBLE_EQ(bars2.value().bars[0].value().bid.close, 1.3);
+    EXPECT_FALSE(reader.readNext().has_value());
+    EXPECT_EQ(reader.errors(0).fieldCount, 1u);
+    EXPECT_EQ(reader.errors(0).lineNumbers, (std::vector<size_t>{ 2 }));
+}
@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+#include "WorkStealingScheduler.h"
+#include "TaskCostModel.h"
+#include "JobPlanner.h"
+#include <atomic>
+#include <fstream>
+#include <filesystem>
+#include <set>
+#include <thread>
+
+TEST(WorkStealingSchedulerTest, OwnTasksComeMostExpensiveFirst) {
+    WorkStealingScheduler scheduler(1);
+    scheduler.assign({ 1.0, 5.0, 3.0, 0.0 });
+    std::vector<size_t> order;
+    for (auto task = scheduler.next(0); task.has_value(); task = scheduler.next(0)) {
+        order.push_back(task.value());
+    }
+    EXPECT_EQ(order, std::vector<size_t>({ 1, 2, 0, 3 }));
+    EXPECT_EQ(scheduler.metrics().steals, 0u);
+}
+
+TEST(WorkStealingSchedulerTest, CostIsBalancedAcrossWorkers) {
+    WorkStealingScheduler scheduler(2);
+    scheduler.assign({ 10.0, 6.0, 5.0, 1.0 });
+    // 10 and 1 go to the first worker, 6 and 5 to the second
+    EXPECT_EQ(scheduler.next(0).value(), 0u);
+    EXPECT_EQ(scheduler.next(1).value(), 1u);
+    EXPECT_EQ(scheduler.next(1).value(), 2u);
+    EXPECT_EQ(scheduler.next(0).value(), 3u);
+}
+
+TEST(WorkStealingSchedulerTest, IdleWorkerStealsFromTheMostLoaded) {
+    WorkStealingScheduler scheduler(2);
+    scheduler.assign({ 10.0, 4.0, 3.0, 2.0 });
+    // Worker 0 holds 10, worker 1 holds 4, 3 and 2
+    EXPECT_EQ(scheduler.next(1).value(), 1u);
+    EXPECT_EQ(scheduler.next(1).value(), 2u);
+    EXPECT_EQ(scheduler.next(1).value(), 3u);
+    // Worker 0 has not started yet, its long task is taken over
+    EXPECT_EQ(scheduler.next(1).value(), 0u);
+    EXPECT_EQ(scheduler.metrics().steals, 1u);
+    EXPECT_FALSE(scheduler.next(0).has_value());
+    EXPECT_FALSE(scheduler.next(1).has_value());
+}
+
+TEST(WorkStealingSchedulerTest, EveryTaskRunsOnceUnderContention) {
+    const size_t taskCount = 2000;
+    std::vector<double> costs;
+    for (size_t i = 0; i < taskCount; i++) {
+        costs.push_back(static_cast<double>(i % 17));
+    }
+    WorkStealingScheduler scheduler(4);
+    scheduler.assign(costs);
+    std::vector<std::atomic<int>> runs(taskCount);
+    std::vector<std::thread> workers;
+    for (size_t worker = 0; worker < 4; worker++) {
+        workers.emplace_back([&, worker]() {
+            for (auto task = scheduler.next(worker); task.has_value(); task = scheduler.next(worker)) {
+                runs[task.value()]++;
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (size_t i = 0; i < taskCount; i++) {
+        EXPECT_EQ(runs[i].load(), 1) << "task " << i;
+    }
+    auto metrics = scheduler.metrics();
+    EXPECT_GE(metrics.tailIdleSeconds, 0.0);
+    EXPECT_GE(metrics.makespanSeconds, 0.0);
+}
+
+TEST(WorkStealingSchedulerTest, TailIdleTimeIsMeasuredFromEachWorkerRunningDry) {
+    WorkStealingScheduler scheduler(2);
+    scheduler.assign({ 1.0 });
+    auto task = scheduler.next(0);
+    ASSERT_TRUE(task.has_value());
+    EXPECT_FALSE(scheduler.next(1).has_value());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(scheduler.next(0).has_value());
+    auto metrics = scheduler.metrics();
+    EXPECT_GE(metrics.tailIdleSeconds, 0.04);
+    EXPECT_NEAR(metrics.tailIdleSeconds, metrics.makespanSeconds, 0.02);
+}
+
+class TaskCostModelTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        historyDir = std::filesystem::temp_directory_path() / "task_cost_model_test";
+        std::filesystem::create_directories(historyDir / "EURUSD");
+        std::ofstream info(historyDir / "EURUSD" / "info.json");
+        info << "{\"Name\": \"EURUSD\", \"ContractCurrency\": \"EUR\", \"ProfitCurrency\": \"USD\"}";
+        info.close();
+        std::ofstream small(historyDir / "EURUSD" / "2000-1.csv");
+        small << std::string(1000, 'x');
+        small.close();
+        std::ofstream large(historyDir / "EURUSD" / "2000-2.csv");
+        large << std::string(4000, 'x');
+        large.close();
+    }
+
+    void TearDown() override {
+        try {
+            std::filesystem::remove_all(historyDir);
+        } catch (const std::exception&) {
+            // Ignore cleanup errors
+        }
+    }
+
+    std::vector<BacktestTask> planTasks(RatesStorageProvider& provider) {
+        SweepSpec spec;
+        spec.strategy = "MA_Cross_Strategy";
+        spec.portfolios = { { "EUR/USD" } };
+        JobPlanner planner(provider);
+        auto windows = JobPlanner::planWindows(std::time(nullptr));
+        windows.resize(3);
+        return JobPlanner::planTasks(planner.planSweep(spec).value(), windows);
+    }
+
+    std::filesystem::path historyDir;
+};
+
+TEST_F(TaskCostModelTest, HistorySizeOrdersTasksWithoutDurations) {
+    RatesStorageProvider provider(historyDir.string());
+    auto tasks = planTasks(provider);
+    TaskCostModel model(provider);
+    EXPECT_GT(model.estimate(tasks[1]), model.estimate(tasks[0]));
+    EXPECT_EQ(model.estimate(tasks[2]), 0.0);
+}
+
+TEST_F(TaskCostModelTest, RecordedDurationsArePersisted) {
+    RatesStorageProvider provider(historyDir.string());
+    auto tasks = planTasks(provider);
+    TaskCostModel model(provider);
+    model.record(tasks[0], 2.0);
+    EXPECT_DOUBLE_EQ(model.estimate(tasks[1]), 8.0);
+
+    std::string path = (historyDir / "costs.txt").string();
+    ASSERT_TRUE(model.save(path));
+    TaskCostModel loaded(provider);
+    ASSERT_TRUE(loaded.load(path));
+    EXPECT_DOUBLE_EQ(loaded.estimate(tasks[1]), 8.0);
+}
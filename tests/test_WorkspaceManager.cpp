@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include "WorkspaceManager.h"
+#include <filesystem>
+#include <fstream>
+
+class WorkspaceManagerTest : public ::testing::Test {
+protected:
+    std::filesystem::path root;
+
+    void SetUp() override {
+        root = std::filesystem::temp_directory_path() / "fxts2_workspace_test";
+        std::filesystem::remove_all(root);
+        std::filesystem::create_directories(root / "disk");
+        std::filesystem::create_directories(root / "ram");
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(root);
+    }
+};
+
+TEST_F(WorkspaceManagerTest, WithoutMemoryRootEverythingGoesToDisk) {
+    WorkspaceManager workspaces((root / "disk").string());
+    std::string path = workspaces.create("job", 100);
+    EXPECT_TRUE(std::filesystem::is_directory(path));
+    EXPECT_EQ(std::filesystem::path(path).parent_path(), root / "disk");
+    EXPECT_FALSE(workspaces.isInMemory(path));
+    EXPECT_EQ(workspaces.memoryInUse(), 0u);
+}
+
+TEST_F(WorkspaceManagerTest, FallsBackToDiskBeyondBudget) {
+    WorkspaceManager workspaces((root / "disk").string());
+    workspaces.configure((root / "ram").string(), 1000);
+    std::string first = workspaces.create("first", 600);
+    std::string second = workspaces.create("second", 600);
+    EXPECT_TRUE(workspaces.isInMemory(first));
+    EXPECT_EQ(std::filesystem::path(first).parent_path(), root / "ram" / "fxts2_backtester");
+    EXPECT_FALSE(workspaces.isInMemory(second));
+    EXPECT_EQ(workspaces.memoryInUse(), 600u);
+
+    // Releasing returns the reservation, the next workspace fits again
+    workspaces.release(first);
+    EXPECT_EQ(workspaces.memoryInUse(), 0u);
+    EXPECT_TRUE(workspaces.isInMemory(workspaces.create("third", 600)));
+}
+
+TEST_F(WorkspaceManagerTest, ReleasedWorkspacesAreRemovedInBackground) {
+    WorkspaceManager workspaces((root / "disk").string());
+    std::vector<std::string> paths;
+    for (int i = 0; i < 10; i++) {
+        paths.push_back(workspaces.create("job", 0));
+        std::ofstream(std::filesystem::path(paths.back()) / "stats.txt") << "profit=1";
+    }
+    for (const auto& path : paths) {
+        workspaces.release(path);
+    }
+    workspaces.flush();
+    for (const auto& path : paths) {
+        EXPECT_FALSE(std::filesystem::exists(path));
+    }
+}
+
+#ifndef _WIN32
+TEST_F(WorkspaceManagerTest, RemovesOnlyWorkspacesOfDeadProcesses) {
+    // Process ids above the kernel's limit never run
+    std::filesystem::create_directories(root / "disk" / "ws_999999999_1_prepared");
+    std::filesystem::create_directories(root / "disk" / "ws_1_1_prepared");
+    std::filesystem::create_directories(root / "disk" / "unrelated");
+    WorkspaceManager workspaces((root / "disk").string());
+    std::string own = workspaces.create("job", 0);
+
+    EXPECT_EQ(workspaces.removeOrphans(), 1u);
+    EXPECT_FALSE(std::filesystem::exists(root / "disk" / "ws_999999999_1_prepared"));
+    EXPECT_TRUE(std::filesystem::exists(root / "disk" / "ws_1_1_prepared"));
+    EXPECT_TRUE(std::filesystem::exists(root / "disk" / "unrelated"));
+    EXPECT_TRUE(std::filesystem::exists(own));
+}
+#endif